@@ -0,0 +1,172 @@
+// © 2023 Lei Cheng
+
+#include "Backtest.h"
+
+namespace lei
+{
+    namespace
+    {
+        double Fee(double amount, const BacktestSettings& settings)
+        {
+            return std::max(settings.minimum_fee, std::floor(amount * settings.fee_rate * settings.fee_discount));
+        }
+    }
+
+    double GetTickSize(double price)
+    {
+        if (price < 10)
+        {
+            return 0.01;
+        }
+        else if (price < 50)
+        {
+            return 0.05;
+        }
+        else if (price < 100)
+        {
+            return 0.1;
+        }
+        else if (price < 500)
+        {
+            return 0.5;
+        }
+        else if (price < 1000)
+        {
+            return 1;
+        }
+
+        return 5;
+    }
+
+    double RoundToTick(double price, bool round_up)
+    {
+        const auto tick = GetTickSize(price);
+        const auto ticks = price / tick;
+
+        // Prices read from csv are already on the grid up to representation error, which must not move them a tick.
+        const auto rounded = round_up ? std::ceil(ticks - 1e-6) : std::floor(ticks + 1e-6);
+        return rounded * tick;
+    }
+
+    juce::Result Backtester::SetEntry(const juce::String& text)
+    {
+        return entry_.Compile(text);
+    }
+
+    juce::Result Backtester::SetExit(const juce::String& text)
+    {
+        return exit_.Compile(text);
+    }
+
+    BacktestResult Backtester::Run(const KArray& k_array, const BacktestSettings& settings) const
+    {
+        auto entry = entry_;
+        auto exit = exit_;
+        entry.Update(k_array);
+        exit.Update(k_array);
+        return Simulate(k_array, entry.GetResult(), exit.GetResult(), settings);
+    }
+
+    BacktestResult Simulate(const KArray& k_array,
+                            const std::vector<double>& entry_signal_array,
+                            const std::vector<double>& exit_signal_array,
+                            const BacktestSettings& settings)
+    {
+        const auto& open_array = std::get<1>(k_array);
+        const auto& close_array = std::get<4>(k_array);
+        const auto size = std::min({ close_array.size(), entry_signal_array.size(), exit_signal_array.size() });
+
+        BacktestResult result;
+        result.equity_array.resize(size);
+        result.drawdown_array.resize(size);
+        result.final_equity = settings.initial_capital;
+
+        const auto lot_size = std::max(settings.lot_size, 1);
+        double cash = settings.initial_capital;
+        double peak = settings.initial_capital;
+        long long shares = 0;
+        Trade trade;
+
+        const auto execute = [&](int order, double fill, std::size_t index)
+            {
+                if (order > 0 && shares == 0)
+                {
+                    const auto price = RoundToTick(fill, true);
+                    auto buy_shares = static_cast<long long>(cash / (price * lot_size * (1 + settings.fee_rate * settings.fee_discount))) * lot_size;
+                    while (buy_shares > 0 && price * buy_shares + Fee(price * buy_shares, settings) > cash)
+                    {
+                        buy_shares -= lot_size;
+                    }
+
+                    if (buy_shares > 0)
+                    {
+                        const auto fee = Fee(price * buy_shares, settings);
+                        cash -= price * buy_shares + fee;
+                        shares = buy_shares;
+                        trade = { static_cast<int>(index), 0, price, 0, shares, fee, 0 };
+                    }
+                }
+                else if (order < 0 && shares > 0)
+                {
+                    const auto price = RoundToTick(fill, false);
+                    const auto amount = price * shares;
+                    const auto cost = Fee(amount, settings) + std::floor(amount * settings.tax_rate);
+                    cash += amount - cost;
+
+                    trade.exit_index = static_cast<int>(index);
+                    trade.exit_price = price;
+                    trade.cost += cost;
+                    trade.profit = (trade.exit_price - trade.entry_price) * trade.shares - trade.cost;
+                    result.trades.push_back(trade);
+                    shares = 0;
+                }
+            };
+
+        // A signal on the close of bar i fills at open[i + 1], or at close[i] for FillPrice::kClose.
+        const auto next_open = settings.fill_price == FillPrice::kNextOpen;
+        int pending_order = 0;
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            if (pending_order != 0)
+            {
+                execute(pending_order, open_array[i], i);
+                pending_order = 0;
+            }
+
+            // NaN (warm-up) compares unequal to zero, so it is rejected explicitly.
+            const auto entry = entry_signal_array[i];
+            const auto exit = exit_signal_array[i];
+            int order = 0;
+            if (shares == 0 && entry != 0 && !std::isnan(entry))
+            {
+                order = 1;
+            }
+            else if (shares > 0 && exit != 0 && !std::isnan(exit))
+            {
+                order = -1;
+            }
+
+            if (order != 0 && next_open)
+            {
+                pending_order = order;
+            }
+            else if (order != 0)
+            {
+                execute(order, close_array[i], i);
+            }
+
+            const auto equity = cash + shares * close_array[i];
+            peak = std::max(peak, equity);
+            result.equity_array[i] = equity;
+            result.drawdown_array[i] = equity / peak - 1;
+            result.max_drawdown = std::min(result.max_drawdown, result.drawdown_array[i]);
+        }
+
+        if (size > 0)
+        {
+            result.final_equity = result.equity_array.back();
+        }
+
+        return result;
+    }
+}
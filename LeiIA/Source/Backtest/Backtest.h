@@ -0,0 +1,77 @@
+// © 2023 Lei Cheng
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Data/DataCenter.h"
+#include "Expression/ExpressionPlan.h"
+
+namespace lei
+{
+    enum class FillPrice
+    {
+        kNextOpen,
+        kClose
+    };
+
+    // Defaults follow TWSE cash equities: 0.1425% brokerage with a NT$20 minimum on both sides, 0.3% transaction
+    // tax on sells, and 1000-share board lots.
+    struct BacktestSettings
+    {
+        double initial_capital = 1000000;
+        FillPrice fill_price = FillPrice::kNextOpen;
+        double fee_rate = 0.001425;
+        double fee_discount = 1;
+        double minimum_fee = 20;
+        double tax_rate = 0.003;
+        int lot_size = 1000;
+    };
+
+    struct Trade
+    {
+        int entry_index = 0;
+        int exit_index = 0;
+        double entry_price = 0;
+        double exit_price = 0;
+        long long shares = 0;
+        double cost = 0; // fees and tax of both sides
+        double profit = 0;
+    };
+
+    struct BacktestResult
+    {
+        std::vector<double> equity_array;
+        std::vector<double> drawdown_array; // equity / running peak - 1
+        std::vector<Trade> trades; // closed trades, a position still open on the last bar only shows in the equity
+        double max_drawdown = 0;
+        double final_equity = 0;
+    };
+
+    // Price step of the TWSE tick table for a given price.
+    double GetTickSize(double price);
+    double RoundToTick(double price, bool round_up);
+
+    // Long-only, all-in strategy. Entry and exit are expressions evaluated once over the whole series (any non-zero
+    // value is a signal on that bar's close), then a single pass over the bars simulates the fills.
+    class Backtester final
+    {
+    public:
+        Backtester() = default;
+        ~Backtester() = default;
+
+    public:
+        juce::Result SetEntry(const juce::String& text);
+        juce::Result SetExit(const juce::String& text);
+
+        BacktestResult Run(const KArray& k_array, const BacktestSettings& settings) const;
+
+    private:
+        ExpressionPlan entry_;
+        ExpressionPlan exit_;
+    };
+
+    BacktestResult Simulate(const KArray& k_array,
+                            const std::vector<double>& entry_signal_array,
+                            const std::vector<double>& exit_signal_array,
+                            const BacktestSettings& settings);
+}
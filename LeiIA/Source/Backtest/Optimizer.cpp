@@ -0,0 +1,223 @@
+// © 2023 Lei Cheng
+
+#include "Kernel/TaskScheduler.h"
+#include "Optimizer.h"
+
+namespace lei
+{
+    namespace
+    {
+        // Combinations whose own columns are evaluated, simulated and freed together by one task.
+        constexpr std::size_t kCombinationsPerTask = 64;
+
+        int GetStepSize(int min, int max, int step)
+        {
+            return max < min ? 0 : (max - min) / step + 1;
+        }
+    }
+
+    void Optimizer::SetStrategy(const juce::String& entry, const juce::String& exit)
+    {
+        entry_ = entry;
+        exit_ = exit;
+    }
+
+    void Optimizer::AddParameter(const juce::String& name, int min, int max, int step)
+    {
+        jassert(step >= 1);
+        parameters_.push_back({ name, min, max, std::max(step, 1) });
+    }
+
+    void Optimizer::SetRandomSearch(std::size_t size, juce::int64 seed)
+    {
+        random_size_ = size;
+        seed_ = seed;
+    }
+
+    std::size_t Optimizer::GetCombinationSize() const
+    {
+        std::size_t grid_size = 1;
+        for (const auto& parameter : parameters_)
+        {
+            grid_size *= GetStepSize(parameter.min, parameter.max, parameter.step);
+        }
+
+        return random_size_ > 0 ? std::min(random_size_, grid_size) : grid_size;
+    }
+
+    juce::Result Optimizer::Run(const std::vector<std::string>& stock_ids,
+                                DataFrequency frequency,
+                                const BacktestSettings& settings,
+                                const juce::File& output_file) const
+    {
+        const auto combinations = GetCombinations();
+        if (combinations.empty())
+        {
+            return juce::Result::ok();
+        }
+
+        // Roots are entry, exit, entry, exit, ..., so root group i holds the formulas of combination i.
+        juce::StringArray texts;
+        for (const auto& combination : combinations)
+        {
+            texts.add(Substitute(entry_, combination));
+            texts.add(Substitute(exit_, combination));
+        }
+
+        ExpressionPlan compiled_plan;
+        const auto result = compiled_plan.Compile(texts);
+        if (result.failed())
+        {
+            return result;
+        }
+
+        compiled_plan.SetRootGroupSize(2);
+
+        output_file.deleteFile();
+        juce::FileOutputStream output(output_file);
+        if (output.failedToOpen())
+        {
+            return output.getStatus();
+        }
+
+        juce::String header;
+        for (const auto& parameter : parameters_)
+        {
+            header << parameter.name << ",";
+        }
+
+        header << "stock_id,trades,win_rate,return,max_drawdown,final_equity\n";
+        output << header;
+        output.flush();
+
+        std::mutex output_mutex;
+        const auto block_size = (combinations.size() + kCombinationsPerTask - 1) / kCombinationsPerTask;
+        const auto run_stock = [&](const std::string& stock_id)
+        {
+            const auto& k_array = GetKDataCenter().GetKData(stock_id, frequency);
+            if (std::get<0>(k_array).empty())
+            {
+                return;
+            }
+
+            // Every indicator shared by two or more combinations is evaluated once per stock, before any block.
+            auto plan = compiled_plan;
+            plan.UpdateShared(k_array);
+
+            GetTaskScheduler().ParallelFor(block_size, [&](std::size_t block)
+                                           {
+                                               const auto begin = block * kCombinationsPerTask;
+                                               const auto end = std::min(begin + kCombinationsPerTask, combinations.size());
+                                               plan.UpdateGroups(k_array, begin, end);
+
+                                               juce::String rows;
+                                               for (auto i = begin; i < end; ++i)
+                                               {
+                                                   const auto backtest = Simulate(k_array, plan.GetResult(i * 2), plan.GetResult(i * 2 + 1), settings);
+                                                   const auto win_size = std::count_if(backtest.trades.begin(), backtest.trades.end(), [](const Trade& trade)
+                                                                                       {
+                                                                                           return trade.profit > 0;
+                                                                                       });
+
+                                                   for (const auto value : combinations[i])
+                                                   {
+                                                       rows << value << ",";
+                                                   }
+
+                                                   rows << stock_id << ","
+                                                        << static_cast<int>(backtest.trades.size()) << ","
+                                                        << juce::String(backtest.trades.empty() ? 0.0 : static_cast<double>(win_size) / backtest.trades.size(), 4) << ","
+                                                        << juce::String(backtest.final_equity / settings.initial_capital - 1, 4) << ","
+                                                        << juce::String(backtest.max_drawdown, 4) << ","
+                                                        << juce::String(backtest.final_equity, 0) << "\n";
+                                               }
+
+                                               plan.ReleaseGroups(begin, end);
+
+                                               std::lock_guard<std::mutex> lock(output_mutex);
+                                               output << rows;
+                                               output.flush();
+                                           });
+        };
+
+        // Stocks run in parallel when there are enough of them to keep every thread busy, and then the ParallelFor over
+        // the blocks of a stock runs serially on its thread. Otherwise the stocks run in turn with parallel blocks.
+        if (stock_ids.size() >= static_cast<std::size_t>(GetTaskScheduler().GetConcurrency()))
+        {
+            GetTaskScheduler().ParallelFor(stock_ids.size(), [&](std::size_t i)
+                                           {
+                                               run_stock(stock_ids[i]);
+                                           });
+        }
+        else
+        {
+            for (const auto& stock_id : stock_ids)
+            {
+                run_stock(stock_id);
+            }
+        }
+
+        return juce::Result::ok();
+    }
+
+    std::vector<std::vector<int>> Optimizer::GetCombinations() const
+    {
+        std::size_t grid_size = 1;
+        for (const auto& parameter : parameters_)
+        {
+            grid_size *= GetStepSize(parameter.min, parameter.max, parameter.step);
+        }
+
+        std::vector<std::size_t> grid_indices;
+        if (random_size_ > 0 && random_size_ < grid_size)
+        {
+            juce::Random random(seed_);
+            std::unordered_set<std::size_t> picked;
+            while (picked.size() < random_size_)
+            {
+                const auto index = static_cast<std::size_t>(random.nextInt64() & std::numeric_limits<juce::int64>::max()) % grid_size;
+                if (picked.insert(index).second)
+                {
+                    grid_indices.push_back(index);
+                }
+            }
+
+            // Grid order keeps neighbouring combinations, and so their shared indicators, in the same block.
+            std::sort(grid_indices.begin(), grid_indices.end());
+        }
+        else
+        {
+            grid_indices.resize(grid_size);
+            std::iota(grid_indices.begin(), grid_indices.end(), 0);
+        }
+
+        std::vector<std::vector<int>> combinations;
+        combinations.reserve(grid_indices.size());
+        for (auto index : grid_indices)
+        {
+            std::vector<int> combination(parameters_.size());
+            for (auto i = parameters_.size(); i-- > 0;)
+            {
+                const auto& parameter = parameters_[i];
+                const auto step_size = static_cast<std::size_t>(GetStepSize(parameter.min, parameter.max, parameter.step));
+                combination[i] = parameter.min + static_cast<int>(index % step_size) * parameter.step;
+                index /= step_size;
+            }
+
+            combinations.push_back(std::move(combination));
+        }
+
+        return combinations;
+    }
+
+    juce::String Optimizer::Substitute(const juce::String& text, const std::vector<int>& combination) const
+    {
+        auto substituted = text;
+        for (std::size_t i = 0; i < parameters_.size(); ++i)
+        {
+            substituted = substituted.replace("{" + parameters_[i].name + "}", juce::String(combination[i]));
+        }
+
+        return substituted;
+    }
+}
@@ -0,0 +1,57 @@
+// © 2023 Lei Cheng
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Backtest/Backtest.h"
+
+namespace lei
+{
+    // Sweeps integer parameters of an entry/exit strategy over many symbols. Parameters appear in the formulas as
+    // {name}, e.g. "CROSS(MA(C, {fast}), MA(C, {slow}))". All combinations are compiled into one ExpressionPlan, so
+    // for each symbol the indicators shared by any combinations (every MA(C, 22) of the sweep) are evaluated once,
+    // then blocks of combinations evaluate their own nodes on top of them as tasks on the task scheduler. One csv row
+    // per combination and symbol is appended to the output file as soon as its block finishes.
+    class Optimizer final
+    {
+    public:
+        Optimizer() = default;
+        ~Optimizer() = default;
+
+    public:
+        void SetStrategy(const juce::String& entry, const juce::String& exit);
+
+        // min to max inclusive.
+        void AddParameter(const juce::String& name, int min, int max, int step);
+
+        // 0 sweeps the full grid, otherwise that many distinct grid points are drawn at random.
+        void SetRandomSearch(std::size_t size, juce::int64 seed);
+
+        std::size_t GetCombinationSize() const;
+
+        juce::Result Run(const std::vector<std::string>& stock_ids,
+                         DataFrequency frequency,
+                         const BacktestSettings& settings,
+                         const juce::File& output_file) const;
+
+    private:
+        struct Parameter
+        {
+            juce::String name;
+            int min = 0;
+            int max = 0;
+            int step = 1;
+        };
+
+    private:
+        std::vector<std::vector<int>> GetCombinations() const;
+        juce::String Substitute(const juce::String& text, const std::vector<int>& combination) const;
+
+    private:
+        juce::String entry_;
+        juce::String exit_;
+        std::vector<Parameter> parameters_;
+        std::size_t random_size_ = 0;
+        juce::int64 seed_ = 0;
+    };
+}
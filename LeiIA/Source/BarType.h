@@ -0,0 +1,21 @@
+// © 2023 Lei Cheng
+
+#pragma once
+
+namespace lei
+{
+    enum class BarType
+    {
+        kCandle,
+        kHeikinAshi,
+        kRenko,
+        kRange
+    };
+
+    // size is the Renko brick height or the range bar height in price, candles and Heikin-Ashi ignore it.
+    struct BarSetting
+    {
+        BarType type = BarType::kCandle;
+        double size = 0.0;
+    };
+}
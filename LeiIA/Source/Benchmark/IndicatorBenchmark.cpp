@@ -0,0 +1,170 @@
+// © 2023 Lei Cheng
+
+#include "IndicatorBenchmark.h"
+#include "Indicator/ATR.h"
+#include "Indicator/BollingerBands.h"
+#include "Indicator/CCI.h"
+#include "Indicator/DMI.h"
+#include "Indicator/MACD.h"
+#include "Indicator/OBV.h"
+#include "Indicator/RSI.h"
+#include "Indicator/VWAP.h"
+#include "Indicator/WilliamsR.h"
+#include "Kernel/Recurrence.h"
+#include "Kernel/TaskScheduler.h"
+
+namespace lei
+{
+    namespace
+    {
+        constexpr std::size_t kAppendSize = 1000;
+        constexpr int kVisibleSize = 200;
+
+        juce::Range<int> GetVisibleRange(std::size_t size)
+        {
+            const auto end = static_cast<int>(size);
+            return { std::max(end - kVisibleSize, 0), end };
+        }
+
+        // Every EMA is a block scan of its own and every line is materialised before the next, as --self-test checks it.
+        void CalculateUnfusedMACD(const CloseArray& close_array,
+                                  int ema_short_period,
+                                  int ema_long_period,
+                                  int macd_period,
+                                  std::vector<double>& dif_array,
+                                  std::vector<double>& macd_array,
+                                  std::vector<double>& osc_array)
+        {
+            const auto ema_short_array = EMA(close_array, ema_short_period);
+            const auto ema_long_array = EMA(close_array, ema_long_period);
+            dif_array.assign(close_array.size(), 0);
+            for (std::size_t i = ema_long_period; i < close_array.size(); ++i)
+            {
+                dif_array[i] = ema_short_array[i] - ema_long_array[i];
+            }
+
+            macd_array = EMA(dif_array, macd_period);
+            osc_array.assign(close_array.size(), 0);
+            for (std::size_t i = std::max(ema_long_period, macd_period); i < close_array.size(); ++i)
+            {
+                osc_array[i] = dif_array[i] - macd_array[i];
+            }
+        }
+
+        void RunMacdBenchmark(const CloseArray& close_array, std::ostream& output)
+        {
+            using Calculate = std::function<void(std::vector<double>&, std::vector<double>&, std::vector<double>&)>;
+
+            // The fused loop only runs as a block scan when the scheduler has workers; inside a ParallelFor task it runs
+            // serially, which is how a screener or a plan group computes it.
+            auto& scheduler = GetTaskScheduler();
+            const auto concurrency = "concurrency " + juce::String(scheduler.GetConcurrency());
+            const std::vector<std::pair<juce::String, Calculate>> variants = {
+                { "MACD(12, 26, 9) fused serial", [&](auto& dif_array, auto& macd_array, auto& osc_array)
+                    {
+                        scheduler.ParallelFor(1, [&](std::size_t) { CalculateMACD(close_array, 12, 26, 9, dif_array, macd_array, osc_array); });
+                    } },
+                { "MACD(12, 26, 9) fused block scan " + concurrency, [&](auto& dif_array, auto& macd_array, auto& osc_array)
+                    {
+                        CalculateMACD(close_array, 12, 26, 9, dif_array, macd_array, osc_array);
+                    } },
+                { "MACD(12, 26, 9) unfused block scans " + concurrency, [&](auto& dif_array, auto& macd_array, auto& osc_array)
+                    {
+                        CalculateUnfusedMACD(close_array, 12, 26, 9, dif_array, macd_array, osc_array);
+                    } } };
+
+            for (const auto& [name, calculate] : variants)
+            {
+                std::vector<double> dif_array;
+                std::vector<double> macd_array;
+                std::vector<double> osc_array;
+                const auto start = juce::Time::getMillisecondCounterHiRes();
+                calculate(dif_array, macd_array, osc_array);
+                const auto full_ms = juce::Time::getMillisecondCounterHiRes() - start;
+                output << name << "," << close_array.size() << "," << juce::String(full_ms, 2) << ",\n";
+            }
+        }
+    }
+
+    KArray MakeRandomKArray(std::size_t size, juce::int64 seed)
+    {
+        KArray k_array;
+        juce::Random random(seed);
+        const auto start = juce::Time(2023, 0, 2, 9, 0).toMilliseconds();
+        constexpr juce::int64 kMinute = 60 * 1000;
+        constexpr int kSessionMinutes = 270;
+        auto close = 100.0;
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            const auto day = static_cast<juce::int64>(i / kSessionMinutes);
+            const auto minute = static_cast<juce::int64>(i % kSessionMinutes);
+            const auto open = close;
+            close = std::max(open * (1 + (random.nextDouble() - 0.5) * 0.004), 0.01);
+            std::get<0>(k_array).push_back(juce::Time(start + day * 24 * 60 * kMinute + minute * kMinute));
+            std::get<1>(k_array).push_back(open);
+            std::get<2>(k_array).push_back(std::max(open, close) * (1 + random.nextDouble() * 0.001));
+            std::get<3>(k_array).push_back(std::min(open, close) * (1 - random.nextDouble() * 0.001));
+            std::get<4>(k_array).push_back(close);
+            std::get<5>(k_array).push_back(static_cast<unsigned long long>(random.nextInt(100000)) + 1);
+        }
+
+        return k_array;
+    }
+
+    void AppendBar(const KArray& source, std::size_t index, KArray& k_array)
+    {
+        std::get<0>(k_array).push_back(std::get<0>(source)[index]);
+        std::get<1>(k_array).push_back(std::get<1>(source)[index]);
+        std::get<2>(k_array).push_back(std::get<2>(source)[index]);
+        std::get<3>(k_array).push_back(std::get<3>(source)[index]);
+        std::get<4>(k_array).push_back(std::get<4>(source)[index]);
+        std::get<5>(k_array).push_back(std::get<5>(source)[index]);
+    }
+
+    std::vector<std::pair<juce::String, StreamingIndicatorMaker>> GetStreamingIndicatorMakers()
+    {
+        return { { "RSI(14)", [](const auto& GetKArray) { return std::make_unique<RSI>(GetKArray, 14); } },
+                 { "BOLL(20, 2)", [](const auto& GetKArray) { return std::make_unique<BollingerBands>(GetKArray, 20, 2.0); } },
+                 { "ATR(14)", [](const auto& GetKArray) { return std::make_unique<ATR>(GetKArray, 14); } },
+                 { "OBV", [](const auto& GetKArray) { return std::make_unique<OBV>(GetKArray); } },
+                 { "DMI(14)", [](const auto& GetKArray) { return std::make_unique<DMI>(GetKArray, 14); } },
+                 { "W%R(14)", [](const auto& GetKArray) { return std::make_unique<WilliamsR>(GetKArray, 14); } },
+                 { "CCI(20)", [](const auto& GetKArray) { return std::make_unique<CCI>(GetKArray, 20); } },
+                 { "VWAP", [](const auto& GetKArray) { return std::make_unique<VWAP>(GetKArray); } } };
+    }
+
+    int RunIndicatorBenchmark(std::size_t bar_size, std::ostream& output)
+    {
+        const auto source = MakeRandomKArray(bar_size + kAppendSize, 2023);
+
+        output << "indicator,bars,full_ms,append_us_per_bar\n";
+        for (const auto& [name, maker] : GetStreamingIndicatorMakers())
+        {
+            KArray k_array;
+            for (std::size_t i = 0; i < bar_size; ++i)
+            {
+                AppendBar(source, i, k_array);
+            }
+
+            auto indicator = maker([&k_array]() -> const KArray& { return k_array; });
+            const auto full_start = juce::Time::getMillisecondCounterHiRes();
+            indicator->Calculate(GetVisibleRange(bar_size));
+            const auto full_ms = juce::Time::getMillisecondCounterHiRes() - full_start;
+
+            double append_ms = 0;
+            for (std::size_t i = bar_size; i < bar_size + kAppendSize; ++i)
+            {
+                AppendBar(source, i, k_array);
+                const auto append_start = juce::Time::getMillisecondCounterHiRes();
+                indicator->Calculate(GetVisibleRange(i + 1));
+                append_ms += juce::Time::getMillisecondCounterHiRes() - append_start;
+            }
+
+            output << name << "," << bar_size << "," << juce::String(full_ms, 2) << "," << juce::String(append_ms * 1000 / kAppendSize, 2) << "\n";
+        }
+
+        const auto& close_array = std::get<4>(source);
+        RunMacdBenchmark(CloseArray(close_array.begin(), close_array.begin() + bar_size), output);
+        return 0;
+    }
+}
@@ -0,0 +1,24 @@
+// © 2023 Lei Cheng
+
+#pragma once
+
+#include "Data/DataCenter.h"
+#include "Indicator/StreamingIndicator.h"
+#include <ostream>
+
+namespace lei
+{
+    using StreamingIndicatorMaker = std::function<std::unique_ptr<StreamingIndicator>(const std::function<const KArray& ()>&)>;
+
+    // A random walk of one minute bars, the same for the same seed.
+    KArray MakeRandomKArray(std::size_t size, juce::int64 seed);
+
+    void AppendBar(const KArray& source, std::size_t index, KArray& k_array);
+
+    // Every streaming indicator, with the parameters the benchmark and --self-test run it with.
+    std::vector<std::pair<juce::String, StreamingIndicatorMaker>> GetStreamingIndicatorMakers();
+
+    // Times every streaming indicator over a bar_size history, then the average cost of appending one bar. MACD is timed
+    // over the full history only, fused serially, fused as a block scan on the scheduler and unfused.
+    int RunIndicatorBenchmark(std::size_t bar_size, std::ostream& output);
+}
@@ -0,0 +1,378 @@
+// © 2023 Lei Cheng
+
+#include "RenderBenchmark.h"
+#include "Benchmark/IndicatorBenchmark.h"
+#include "Data/DataCenter.h"
+#include "Indicator/BollingerBands.h"
+#include "Indicator/CCI.h"
+#include "Indicator/DMI.h"
+#include "Indicator/K.h"
+#include "Indicator/KD.h"
+#include "Indicator/MA.h"
+#include "Indicator/MACD.h"
+#include "Indicator/RSI.h"
+#include "Indicator/Volume.h"
+#include "Indicator/VolumeProfile.h"
+#include "Indicator/VWAP.h"
+#include "KChart/KChart.h"
+#include "Kernel/SeriesPyramid.h"
+#include "Layout.h"
+#include "Render/ChartLayer.h"
+#include "Tool/ToolFactory.h"
+#include "Tool/ToolType.h"
+
+namespace lei
+{
+    namespace
+    {
+        constexpr int kImageWidth = 1850;
+        constexpr int kImageHeight = 900;
+        constexpr int kFrameSize = 20;
+
+        constexpr int kSubsidiaryChartSize = 3;
+
+        // The software renderer, counting the primitives every Graphics call ends up as. With split_rectangle_lists set,
+        // a rectangle list is filled one rectangle at a time, the way the draw loops submitted bars before batching.
+        class CountingRenderer final : public juce::LowLevelGraphicsSoftwareRenderer
+        {
+        public:
+            explicit CountingRenderer(const juce::Image& image) :
+                juce::LowLevelGraphicsSoftwareRenderer(image)
+            {
+            }
+
+            void fillRect(const juce::Rectangle<int>& rectangle, bool replace_existing_contents) override
+            {
+                ++primitive_size;
+                juce::LowLevelGraphicsSoftwareRenderer::fillRect(rectangle, replace_existing_contents);
+            }
+
+            void fillRect(const juce::Rectangle<float>& rectangle) override
+            {
+                ++primitive_size;
+                juce::LowLevelGraphicsSoftwareRenderer::fillRect(rectangle);
+            }
+
+            void fillRectList(const juce::RectangleList<float>& rectangles) override
+            {
+                if (split_rectangle_lists)
+                {
+                    for (const auto& rectangle : rectangles)
+                    {
+                        fillRect(rectangle);
+                    }
+
+                    return;
+                }
+
+                ++primitive_size;
+                juce::LowLevelGraphicsSoftwareRenderer::fillRectList(rectangles);
+            }
+
+            void fillPath(const juce::Path& path, const juce::AffineTransform& transform) override
+            {
+                ++primitive_size;
+                juce::LowLevelGraphicsSoftwareRenderer::fillPath(path, transform);
+            }
+
+            void drawImage(const juce::Image& image, const juce::AffineTransform& transform) override
+            {
+                ++primitive_size;
+                juce::LowLevelGraphicsSoftwareRenderer::drawImage(image, transform);
+            }
+
+            void drawLine(const juce::Line<float>& line) override
+            {
+                ++primitive_size;
+                juce::LowLevelGraphicsSoftwareRenderer::drawLine(line);
+            }
+
+            void drawGlyphs(juce::Span<const juce::uint16> glyphs, juce::Span<const juce::Point<float>> positions, const juce::AffineTransform& transform) override
+            {
+                ++primitive_size;
+                juce::LowLevelGraphicsSoftwareRenderer::drawGlyphs(glyphs, positions, transform);
+            }
+
+            std::size_t primitive_size = 0;
+            bool split_rectangle_lists = false;
+        };
+
+        // The mean time of kFrameSize frames of Draw on a cleared image. The primitives are those of the last frame.
+        double TimeFrames(juce::Graphics& g, CountingRenderer& renderer, const std::function<void()>& Draw)
+        {
+            const auto start = juce::Time::getMillisecondCounterHiRes();
+            for (int frame = 0; frame < kFrameSize; ++frame)
+            {
+                g.fillAll(juce::Colours::black);
+                renderer.primitive_size = 0;
+                Draw();
+            }
+
+            return (juce::Time::getMillisecondCounterHiRes() - start) / kFrameSize;
+        }
+
+        struct IndicatorSet
+        {
+            std::vector<std::unique_ptr<Indicator>> main;
+            std::vector<std::unique_ptr<Indicator>> overlay;
+            std::vector<std::unique_ptr<Indicator>> subsidiary;
+        };
+
+        // The default indicators, or the default main ones with every overlay and three heavier studies.
+        IndicatorSet MakeIndicatorSet(bool studies, const std::function<const KArray& ()>& GetKArray, const std::function<int()>& GetStride)
+        {
+            IndicatorSet set;
+            set.main.push_back(std::make_unique<K>(GetKArray));
+            set.main.push_back(std::make_unique<MA>(GetKArray, 5, juce::Colours::yellow));
+            set.main.push_back(std::make_unique<MA>(GetKArray, 22, juce::Colours::orange));
+            if (studies)
+            {
+                set.overlay.push_back(std::make_unique<BollingerBands>(GetKArray, 20, 2.0));
+                set.overlay.push_back(std::make_unique<VWAP>(GetKArray));
+                set.overlay.push_back(std::make_unique<VolumeProfile>(GetKArray));
+                set.subsidiary.push_back(std::make_unique<RSI>(GetKArray, 14));
+                set.subsidiary.push_back(std::make_unique<DMI>(GetKArray, 14));
+                set.subsidiary.push_back(std::make_unique<CCI>(GetKArray, 20));
+            }
+            else
+            {
+                set.subsidiary.push_back(std::make_unique<Volume>(GetKArray, GetStride));
+                set.subsidiary.push_back(std::make_unique<KD>(GetKArray, 9, 3, 3));
+                set.subsidiary.push_back(std::make_unique<MACD>(GetKArray, 12, 26, 9));
+            }
+
+            return set;
+        }
+
+        // What HandleZoomChanged does before the chart layer is drawn.
+        std::pair<double, double> CalculateIndicators(IndicatorSet& set, const juce::Range<int>& range)
+        {
+            std::pair<double, double> min_max_label(std::numeric_limits<double>::max(), std::numeric_limits<double>::lowest());
+            for (auto* indicators : { &set.main, &set.overlay })
+            {
+                for (const auto& indicator : *indicators)
+                {
+                    indicator->Calculate(range);
+                    const auto indicator_min_max = indicator->GetMinMaxLabelValue();
+                    min_max_label.first = std::min(indicator_min_max.first, min_max_label.first);
+                    min_max_label.second = std::max(indicator_min_max.second, min_max_label.second);
+                }
+            }
+
+            for (const auto& indicator : set.subsidiary)
+            {
+                indicator->Calculate(range);
+            }
+
+            return min_max_label;
+        }
+
+        // The chart layer of MainComponent with its panes drawn one after another, then the tools over them.
+        void DrawChartLayer(juce::Graphics& g,
+                            const ChartLayout& layout,
+                            const ChartLayerFrame& frame,
+                            const std::vector<std::unique_ptr<Tool>>& tools)
+        {
+            KChart k_chart;
+            g.fillAll(juce::Colours::black);
+            for (const auto& pane : MakeChartPanes(layout, frame, k_chart))
+            {
+                pane.draw(g);
+            }
+
+            for (const auto& tool : tools)
+            {
+                tool->Paint(g);
+            }
+        }
+
+        // Trendlines between random points of the visible K chart.
+        std::vector<std::unique_ptr<Tool>> MakeTrendlines(int tool_size,
+                                                          juce::Component* component,
+                                                          const std::function<const KArray& ()>& GetKArray,
+                                                          const juce::Rectangle<int>& chart_bounds,
+                                                          const std::pair<double, double>& min_max_label,
+                                                          const juce::Range<int>& range,
+                                                          const ViewportTransform& transform)
+        {
+            juce::Random random(2023);
+            const auto RandomPoint = [&random, &chart_bounds]()
+                {
+                    return juce::Point<int>(chart_bounds.getX() + random.nextInt(chart_bounds.getWidth()),
+                                            chart_bounds.getY() + random.nextInt(chart_bounds.getHeight()));
+                };
+
+            std::vector<std::unique_ptr<Tool>> tools;
+            for (int i = 0; i < tool_size; ++i)
+            {
+                auto tool = ToolFactory::GetTool(ToolType::kTrendline, component, GetKArray, [](const auto&) {}, {}, [](const auto&) {}, [](const auto&) {});
+                tool->ToolBegin(RandomPoint(), chart_bounds, min_max_label, range, transform, 0);
+                tool->ToolEnd(RandomPoint());
+                tools.push_back(std::move(tool));
+            }
+
+            return tools;
+        }
+
+        // Nearest rank.
+        double GetPercentile(const std::vector<double>& sorted_values, double percentile)
+        {
+            const auto rank = static_cast<std::size_t>(std::ceil(percentile / 100.0 * sorted_values.size()));
+            return sorted_values[std::clamp<std::size_t>(rank, 1, sorted_values.size()) - 1];
+        }
+    }
+
+    int RunRenderBenchmark(std::size_t bar_size, std::ostream& output)
+    {
+        const auto k_array = MakeRandomKArray(bar_size, 2023);
+        const auto& open_array = std::get<1>(k_array);
+        const auto& close_array = std::get<4>(k_array);
+        SeriesPyramid high_pyramid;
+        SeriesPyramid low_pyramid;
+        SeriesPyramid volume_pyramid;
+        high_pyramid.Extend(std::get<2>(k_array).data(), bar_size);
+        low_pyramid.Extend(std::get<3>(k_array).data(), bar_size);
+        volume_pyramid.Extend(std::get<5>(k_array).data(), bar_size);
+        juce::Image image(juce::Image::RGB, kImageWidth, kImageHeight, true, juce::SoftwareImageType());
+        CountingRenderer renderer(image);
+        juce::Graphics g(renderer);
+
+        auto bounds = image.getBounds();
+        bounds.removeFromTop(kToolbarHeight + kHeaderHeight);
+        bounds.removeFromLeft(kLeftLabelWidth);
+        bounds.removeFromRight(kRightLabelWidth);
+        const auto volume_chart_bounds = bounds.removeFromBottom(bounds.getHeight() * kSubsidiaryChartHeightPercentage / 100);
+        const auto k_chart_bounds = bounds.withTrimmedBottom(kChartGap);
+
+        output << "bar_width,bars,per_bar_ms,batched_ms,speedup,per_bar_primitives,batched_primitives\n";
+        for (const auto bar_width : { 3, 5, 11 })
+        {
+            const auto bar_pitch = static_cast<float>(bar_width + kBarGap);
+            const auto visible_size = std::min(ViewportTransform(0, 0, bar_pitch).GetVisibleBarCount(k_chart_bounds.getWidth()), static_cast<int>(bar_size));
+            const juce::Range<int> range(static_cast<int>(bar_size) - visible_size, static_cast<int>(bar_size));
+            const ViewportTransform transform(k_chart_bounds.getX(), range.getStart(), bar_pitch);
+            const std::pair<double, double> min_max_label(low_pyramid.Get(range.getStart(), range.getEnd()).min, high_pyramid.Get(range.getStart(), range.getEnd()).max);
+
+            // A bar per column at these widths, so the largest column is the largest bar.
+            const auto max_volume = volume_pyramid.Get(range.getStart(), range.getEnd()).max;
+            const auto Draw = [&]()
+            {
+                K::DrawKBar(g, k_chart_bounds, open_array, high_pyramid, low_pyramid, close_array, range, min_max_label, transform);
+                Volume::DrawVolumeBar(g, volume_chart_bounds, volume_pyramid, close_array, range, max_volume, transform);
+            };
+
+            renderer.split_rectangle_lists = true;
+            const auto per_bar_ms = TimeFrames(g, renderer, Draw);
+            const auto per_bar_primitive_size = renderer.primitive_size;
+            renderer.split_rectangle_lists = false;
+            const auto batched_ms = TimeFrames(g, renderer, Draw);
+            output << bar_width << "," << visible_size << "," << juce::String(per_bar_ms, 3) << "," << juce::String(batched_ms, 3) << ","
+                   << juce::String(per_bar_ms / std::max(batched_ms, 1e-9), 2) << "," << per_bar_primitive_size << "," << renderer.primitive_size << "\n";
+        }
+
+        return 0;
+    }
+
+    int RunChartBenchmark(const std::vector<std::string>& stock_ids, DataFrequency frequency, int frame_size, std::ostream& output)
+    {
+        juce::Image image(juce::Image::RGB, kImageWidth, kImageHeight, true, juce::SoftwareImageType());
+        CountingRenderer renderer(image);
+        juce::Graphics g(renderer);
+
+        // Tools repaint and place their erase buttons through a component, which needs no window.
+        juce::Component component;
+        component.setBounds(image.getBounds());
+
+        const auto layout = MakeChartLayout(image.getBounds().withTrimmedTop(kToolbarHeight).withTrimmedBottom(kWidgetsHeight), kSubsidiaryChartSize);
+        const auto k_chart_bounds = layout.k_chart.reduced(kChartBorderThickness);
+
+        // Bar pitches down to the narrowest, one of them between whole pixels, then 2 and 8 bars per column.
+        const std::array<float, 6> zooms = { 13.0f, 8.5f, 7.0f, 5.0f, 2.5f, 0.625f };
+        const std::array<const char*, 3> scroll_names = { "end", "middle", "start" };
+
+        int result = 1;
+        output << "stock_id,bar_pitch,stride,scroll,indicators,tools,bars,p50_ms,p95_ms,p99_ms,primitives\n";
+        for (const auto& stock_id : stock_ids)
+        {
+            const auto& k_array = GetKDataCenter().GetKData(stock_id, frequency);
+            const auto size = static_cast<int>(std::get<0>(k_array).size());
+            if (size == 0)
+            {
+                continue;
+            }
+
+            result = 0;
+            const auto GetKArray = [&k_array]() -> const KArray& { return k_array; };
+            ChartLayerFrame frame;
+            frame.stock_id = stock_id;
+            frame.frequency = frequency;
+            frame.k_array = &k_array;
+            frame.time_boundaries = &GetKDataCenter().GetTimeBoundaries(stock_id, frequency, {});
+            for (const auto bar_pitch : zooms)
+            {
+                const auto visible_size = std::min(ViewportTransform(0, 0, bar_pitch).GetVisibleBarCount(k_chart_bounds.getWidth()), size);
+                const std::array<int, 3> scroll_starts = { size - visible_size, (size - visible_size) / 2, 0 };
+                for (const auto studies : { false, true })
+                {
+                    auto set = MakeIndicatorSet(studies, GetKArray, [&frame]() { return frame.transform.GetStride(); });
+                    frame.k_chart_indicators.clear();
+                    frame.subsidiary_indicators.clear();
+                    for (auto* indicators : { &set.main, &set.overlay })
+                    {
+                        for (const auto& indicator : *indicators)
+                        {
+                            frame.k_chart_indicators.push_back(indicator.get());
+                        }
+                    }
+
+                    for (const auto& indicator : set.subsidiary)
+                    {
+                        frame.subsidiary_indicators.push_back(indicator.get());
+                    }
+
+                    for (std::size_t scroll = 0; scroll < scroll_starts.size(); ++scroll)
+                    {
+                        frame.scroll_bar_current_range = juce::Range<int>(scroll_starts[scroll], scroll_starts[scroll] + visible_size);
+                        frame.transform = ViewportTransform(k_chart_bounds.getX(), scroll_starts[scroll], bar_pitch);
+                        const auto& range = frame.scroll_bar_current_range;
+                        const auto& transform = frame.transform;
+                        for (const auto tool_size : { 0, 20, 100 })
+                        {
+                            const auto tools = MakeTrendlines(tool_size, &component, GetKArray, k_chart_bounds, CalculateIndicators(set, range), range, transform);
+
+                            std::vector<double> frame_ms;
+                            std::size_t primitive_size = 0;
+                            for (int frame_index = -1; frame_index < frame_size; ++frame_index)
+                            {
+                                renderer.primitive_size = 0;
+                                const auto start = juce::Time::getMillisecondCounterHiRes();
+                                frame.k_chart_min_max_label = CalculateIndicators(set, range);
+                                for (const auto& tool : tools)
+                                {
+                                    tool->ZoomChanged(k_chart_bounds, frame.k_chart_min_max_label, range, transform);
+                                }
+
+                                DrawChartLayer(g, layout, frame, tools);
+
+                                // The first frame fills the indicator and text caches and is not counted.
+                                if (frame_index >= 0)
+                                {
+                                    frame_ms.push_back(juce::Time::getMillisecondCounterHiRes() - start);
+                                    primitive_size = renderer.primitive_size;
+                                }
+                            }
+
+                            std::sort(frame_ms.begin(), frame_ms.end());
+                            output << stock_id << "," << bar_pitch << "," << transform.GetStride() << "," << scroll_names[scroll] << ","
+                                   << (studies ? "studies" : "default") << "," << tool_size << "," << visible_size << ","
+                                   << juce::String(GetPercentile(frame_ms, 50), 3) << "," << juce::String(GetPercentile(frame_ms, 95), 3) << ","
+                                   << juce::String(GetPercentile(frame_ms, 99), 3) << "," << primitive_size << "\n";
+                        }
+                    }
+                }
+            }
+        }
+
+        return result;
+    }
+}
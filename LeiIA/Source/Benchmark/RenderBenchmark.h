@@ -0,0 +1,23 @@
+// © 2023 Lei Cheng
+
+#pragma once
+
+#include "DataFrequency.h"
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace lei
+{
+    // Draws a screen of candles and volume bars with K::DrawKBar and Volume::DrawVolumeBar into an offscreen image at
+    // several bar widths. Each width is drawn once with every batched rectangle filled on its own, as before batching,
+    // and once with one fill per colour. Prints the mean frame time and the primitives per frame of both.
+    int RunRenderBenchmark(std::size_t bar_size, std::ostream& output);
+
+    // Draws the chart layer panes of MainComponent for the stocks' data, for every combination of zoom, scroll position,
+    // indicator set and trendline count, frame_size times each into an offscreen image. Prints the p50, p95 and p99
+    // frame time, indicator calculation included, and the primitives drawn per frame. Needs no display, fails when
+    // none of the stocks has data.
+    int RunChartBenchmark(const std::vector<std::string>& stock_ids, DataFrequency frequency, int frame_size, std::ostream& output);
+}
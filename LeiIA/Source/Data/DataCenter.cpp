@@ -1,6 +1,8 @@
 // © 2023 Lei Cheng
 
 #include "DataCenter.h"
+#include "DerivedBars.h"
+#include "TimeBoundaryIndex.h"
 #include "rapidcsv.h"
 #include <filesystem>
 
@@ -46,25 +48,102 @@ namespace lei
         return juce::Time(year, month, day, hours, minutes, seconds);
     }
 
+    KDataCenter::KDataCenter() = default;
+
+    KDataCenter::~KDataCenter() = default;
+
     const KArray& KDataCenter::GetKData(const std::string& stock_id, DataFrequency frequency) const
     {
-        const auto pos = cache_.find(std::make_pair(stock_id, frequency));
-        if (pos != cache_.end())
         {
-            return pos->second;
+            std::lock_guard<std::mutex> lock(mutex_);
+            const auto pos = cache_.find(std::make_pair(stock_id, frequency));
+            if (pos != cache_.end())
+            {
+                return pos->second;
+            }
         }
 
+        // Files are parsed outside the lock so the screener can load many symbols at once. If two threads race on
+        // the same symbol the first insert wins, and references into the map survive rehashing.
+        KArray k_array;
         switch (frequency)
         {
         case lei::DataFrequency::k1Min:
-            return cache_.emplace(std::make_pair(stock_id, frequency), GetMinDatas(stock_id)).first->second;
+            k_array = GetMinDatas(stock_id);
+            break;
         case lei::DataFrequency::kDay:
-            return cache_.emplace(std::make_pair(stock_id, frequency), GetDayDatas(stock_id)).first->second;
+            k_array = GetDayDatas(stock_id);
+            break;
         default:
             break;
         }
 
-        return {};
+        std::lock_guard<std::mutex> lock(mutex_);
+        return cache_.emplace(std::make_pair(stock_id, frequency), std::move(k_array)).first->second;
+    }
+
+    const KArray& KDataCenter::GetKData(const std::string& stock_id, DataFrequency frequency, const BarSetting& setting) const
+    {
+        const auto& source = GetKData(stock_id, frequency);
+        if (setting.type == BarType::kCandle)
+        {
+            return source;
+        }
+
+        // Heikin-Ashi ignores the size, so every size shares one series.
+        const auto size = setting.type == BarType::kHeikinAshi ? 0.0 : setting.size;
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto& bars = derived_cache_[std::make_tuple(stock_id, frequency, setting.type, size)];
+        if (!bars)
+        {
+            bars = std::make_unique<DerivedBars>(BarSetting{ setting.type, size });
+        }
+
+        bars->Update(source);
+        return bars->GetKArray();
+    }
+
+    const TimeBoundaryIndex& KDataCenter::GetTimeBoundaries(const std::string& stock_id, DataFrequency frequency, const BarSetting& setting) const
+    {
+        const auto& date_time_array = std::get<0>(GetKData(stock_id, frequency, setting));
+
+        const auto size = setting.type == BarType::kRenko || setting.type == BarType::kRange ? setting.size : 0.0;
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto& boundaries = boundary_cache_[std::make_tuple(stock_id, frequency, setting.type, size)];
+        if (!boundaries)
+        {
+            boundaries = std::make_unique<TimeBoundaryIndex>();
+        }
+
+        boundaries->Update(date_time_array);
+        return *boundaries;
+    }
+
+    std::vector<std::string> KDataCenter::GetStockIds(DataFrequency frequency) const
+    {
+        const auto folder = frequency == DataFrequency::kDay ? "day_k" : "min_k";
+
+        std::vector<std::string> stock_ids;
+        std::error_code error;
+        for (const auto& market : std::filesystem::directory_iterator(std::filesystem::current_path(), error))
+        {
+            const auto path = market.path() / folder;
+            if (!market.is_directory() || !std::filesystem::is_directory(path))
+            {
+                continue;
+            }
+
+            for (const auto& file : std::filesystem::directory_iterator(path, error))
+            {
+                if (file.path().extension() == ".csv")
+                {
+                    stock_ids.push_back(file.path().stem().string() + "." + market.path().filename().string());
+                }
+            }
+        }
+
+        std::sort(stock_ids.begin(), stock_ids.end());
+        return stock_ids;
     }
 
     KArray KDataCenter::GetDayDatas(const std::string& stock_id) const
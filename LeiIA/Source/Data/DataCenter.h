@@ -3,6 +3,7 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "BarType.h"
 #include "DataFrequency.h"
 #include "Key.h"
 
@@ -17,21 +18,38 @@ namespace lei
     using KType = std::tuple<juce::Time, double, double, double, double, unsigned long long>;
     using KArray = std::tuple<DateTimeArray, OpenArray, HighArray, LowArray, CloseArray, VolumeArray>;
 
+    class DerivedBars;
+    class TimeBoundaryIndex;
+
     class KDataCenter final
     {
     public:
-        KDataCenter() = default;
-        ~KDataCenter() = default;
+        KDataCenter();
+        ~KDataCenter();
 
     public:
+        // Safe to call from several threads, the returned reference stays valid for the lifetime of the data center.
         const KArray& GetKData(const std::string& stock_id, DataFrequency frequency) const;
 
+        // Heikin-Ashi, Renko or range bars of the raw data, built on first request and cached per setting. A grown
+        // source is only extended by its new bars.
+        const KArray& GetKData(const std::string& stock_id, DataFrequency frequency, const BarSetting& setting) const;
+
+        // The time boundaries of GetKData with the same arguments, extended as the series grows.
+        const TimeBoundaryIndex& GetTimeBoundaries(const std::string& stock_id, DataFrequency frequency, const BarSetting& setting) const;
+
+        // Every stock with a data file for the frequency, e.g. "2330.tw".
+        std::vector<std::string> GetStockIds(DataFrequency frequency) const;
+
     private:
         KArray GetDayDatas(const std::string& stock_id) const;
         KArray GetMinDatas(const std::string& stock_id) const;
 
     private:
         mutable std::unordered_map<std::pair<std::string, DataFrequency>, KArray> cache_;
+        mutable std::map<std::tuple<std::string, DataFrequency, BarType, double>, std::unique_ptr<DerivedBars>> derived_cache_;
+        mutable std::map<std::tuple<std::string, DataFrequency, BarType, double>, std::unique_ptr<TimeBoundaryIndex>> boundary_cache_;
+        mutable std::mutex mutex_;
     };
 
     const KDataCenter& GetKDataCenter();
@@ -0,0 +1,170 @@
+// © 2023 Lei Cheng
+
+#include "DerivedBars.h"
+
+namespace lei
+{
+    DerivedBars::DerivedBars(const BarSetting& setting) :
+        setting_(setting)
+    {
+        jassert(setting_.type == BarType::kCandle || setting_.type == BarType::kHeikinAshi || setting_.size > 0.0);
+    }
+
+    void DerivedBars::Reset()
+    {
+        k_array_ = {};
+        source_size_ = 0;
+        brick_top_ = 0.0;
+        brick_bottom_ = 0.0;
+        pending_volume_ = 0;
+        forming_ = false;
+    }
+
+    void DerivedBars::Update(const KArray& source)
+    {
+        const auto size = std::get<0>(source).size();
+        if (size < source_size_)
+        {
+            Reset();
+        }
+
+        if (size == source_size_)
+        {
+            return;
+        }
+
+        switch (setting_.type)
+        {
+        case BarType::kHeikinAshi:
+            ExtendHeikinAshi(source);
+            break;
+        case BarType::kRenko:
+            ExtendRenko(source);
+            break;
+        case BarType::kRange:
+            ExtendRange(source);
+            break;
+        default:
+            k_array_ = source;
+            break;
+        }
+
+        source_size_ = size;
+    }
+
+    const KArray& DerivedBars::GetKArray() const
+    {
+        return k_array_;
+    }
+
+    void DerivedBars::ExtendHeikinAshi(const KArray& source)
+    {
+        const auto& [date_times, opens, highs, lows, closes, volumes] = source;
+        const auto& ha_opens = std::get<1>(k_array_);
+        const auto& ha_closes = std::get<4>(k_array_);
+        for (auto i = source_size_; i < date_times.size(); ++i)
+        {
+            const auto close = (opens[i] + highs[i] + lows[i] + closes[i]) / 4.0;
+            const auto open = i == 0 ? (opens[i] + closes[i]) / 2.0 : (ha_opens[i - 1] + ha_closes[i - 1]) / 2.0;
+            PushBar(date_times[i], open, std::max({ highs[i], open, close }), std::min({ lows[i], open, close }), close, volumes[i]);
+        }
+    }
+
+    void DerivedBars::ExtendRenko(const KArray& source)
+    {
+        const auto& [date_times, opens, highs, lows, closes, volumes] = source;
+        const auto brick = setting_.size;
+        if (brick <= 0.0)
+        {
+            return;
+        }
+
+        for (auto i = source_size_; i < date_times.size(); ++i)
+        {
+            if (i == 0)
+            {
+                brick_top_ = closes[i];
+                brick_bottom_ = closes[i];
+            }
+
+            // Volume traded while no brick formed goes to the next brick.
+            pending_volume_ += volumes[i];
+            while (closes[i] >= brick_top_ + brick)
+            {
+                PushBar(date_times[i], brick_top_, brick_top_ + brick, brick_top_, brick_top_ + brick, pending_volume_);
+                brick_bottom_ = brick_top_;
+                brick_top_ += brick;
+                pending_volume_ = 0;
+            }
+
+            while (closes[i] <= brick_bottom_ - brick)
+            {
+                PushBar(date_times[i], brick_bottom_, brick_bottom_, brick_bottom_ - brick, brick_bottom_ - brick, pending_volume_);
+                brick_top_ = brick_bottom_;
+                brick_bottom_ -= brick;
+                pending_volume_ = 0;
+            }
+        }
+    }
+
+    void DerivedBars::ExtendRange(const KArray& source)
+    {
+        const auto& [date_times, opens, highs, lows, closes, volumes] = source;
+        auto& [range_date_times, range_opens, range_highs, range_lows, range_closes, range_volumes] = k_array_;
+        if (setting_.size <= 0.0)
+        {
+            return;
+        }
+
+        // Without ticks a source bar is not split, so a bar wider than the size closes a range bar on its own.
+        for (auto i = source_size_; i < date_times.size(); ++i)
+        {
+            if (forming_)
+            {
+                range_highs.back() = std::max(range_highs.back(), highs[i]);
+                range_lows.back() = std::min(range_lows.back(), lows[i]);
+                range_closes.back() = closes[i];
+                range_volumes.back() += volumes[i];
+            }
+            else
+            {
+                PushBar(date_times[i], opens[i], highs[i], lows[i], closes[i], volumes[i]);
+            }
+
+            forming_ = range_highs.back() - range_lows.back() < setting_.size;
+        }
+    }
+
+    void DerivedBars::PushBar(const juce::Time& date_time, double open, double high, double low, double close, unsigned long long volume)
+    {
+        auto& [date_times, opens, highs, lows, closes, volumes] = k_array_;
+        date_times.push_back(date_time);
+        opens.push_back(open);
+        highs.push_back(high);
+        lows.push_back(low);
+        closes.push_back(close);
+        volumes.push_back(volume);
+    }
+
+    double SuggestBarSize(const KArray& k_array)
+    {
+        constexpr std::size_t kPeriod = 14;
+
+        const auto& [date_times, opens, highs, lows, closes, volumes] = k_array;
+        const auto size = date_times.size();
+        if (size == 0)
+        {
+            return 0.0;
+        }
+
+        const auto begin = size > kPeriod ? size - kPeriod : 0;
+        double sum = 0.0;
+        for (auto i = begin; i < size; ++i)
+        {
+            const auto previous_close = i == 0 ? closes[i] : closes[i - 1];
+            sum += std::max(highs[i], previous_close) - std::min(lows[i], previous_close);
+        }
+
+        return sum / static_cast<double>(size - begin);
+    }
+}
@@ -0,0 +1,49 @@
+// © 2023 Lei Cheng
+
+#pragma once
+
+#include "BarType.h"
+#include "Data/DataCenter.h"
+
+namespace lei
+{
+    // A bar series built from the raw bars of one symbol and frequency, in the same KArray layout so every indicator
+    // and tool can take it as input. Heikin-Ashi maps one to one onto the source. Renko emits a brick whenever the
+    // close moves a brick beyond the last one, stamped with the time of the source bar that completed it, so a bar
+    // can yield several bricks or none. A range bar merges source bars until its high - low reaches the size and is
+    // stamped with the time of its first source bar; the last one may still be forming.
+    // Source series only grow, so Update continues from the first unseen source bar and only rewrites the forming
+    // range bar.
+    class DerivedBars final
+    {
+    public:
+        explicit DerivedBars(const BarSetting& setting);
+        ~DerivedBars() = default;
+
+    public:
+        void Reset();
+
+        void Update(const KArray& source);
+
+        const KArray& GetKArray() const;
+
+    private:
+        void ExtendHeikinAshi(const KArray& source);
+        void ExtendRenko(const KArray& source);
+        void ExtendRange(const KArray& source);
+        void PushBar(const juce::Time& date_time, double open, double high, double low, double close, unsigned long long volume);
+
+    private:
+        BarSetting setting_;
+        KArray k_array_;
+        std::size_t source_size_ = 0;
+
+        double brick_top_ = 0.0;
+        double brick_bottom_ = 0.0;
+        unsigned long long pending_volume_ = 0;
+        bool forming_ = false;
+    };
+
+    // The mean true range of the last 14 bars, a starting point for a Renko brick or range bar size.
+    double SuggestBarSize(const KArray& k_array);
+}
@@ -0,0 +1,66 @@
+// © 2023 Lei Cheng
+
+#include "FrequencyMap.h"
+
+namespace lei
+{
+    void FrequencyMap::Reset()
+    {
+        map_.clear();
+        coarse_index_ = 0;
+        coarse_size_ = 0;
+    }
+
+    void FrequencyMap::Update(const DateTimeArray& fine_array, const DateTimeArray& coarse_array)
+    {
+        if (fine_array.size() < map_.size() || coarse_array.size() < coarse_size_)
+        {
+            Reset();
+        }
+
+        if (coarse_array.size() > coarse_size_)
+        {
+            const auto last = static_cast<int>(coarse_size_) - 1;
+            while (!map_.empty() && (map_.back() == last || map_.back() == -1))
+            {
+                map_.pop_back();
+            }
+
+            coarse_index_ = map_.empty() ? 0 : map_.back();
+        }
+
+        coarse_size_ = coarse_array.size();
+        if (coarse_array.empty())
+        {
+            map_.assign(fine_array.size(), -1);
+            return;
+        }
+
+        map_.reserve(fine_array.size());
+        for (auto i = map_.size(); i < fine_array.size(); ++i)
+        {
+            while (coarse_index_ + 1 < coarse_array.size() && coarse_array[coarse_index_ + 1] <= fine_array[i])
+            {
+                ++coarse_index_;
+            }
+
+            map_.push_back(coarse_array[coarse_index_] <= fine_array[i] ? static_cast<int>(coarse_index_) : -1);
+        }
+    }
+
+    int FrequencyMap::operator[](std::size_t fine_index) const
+    {
+        return fine_index < map_.size() ? map_[fine_index] : -1;
+    }
+
+    int FrequencyMap::GetClosedIndex(std::size_t fine_index) const
+    {
+        const auto index = (*this)[fine_index];
+        return index >= 0 ? index - 1 : -1;
+    }
+
+    std::size_t FrequencyMap::size() const
+    {
+        return map_.size();
+    }
+}
@@ -0,0 +1,37 @@
+// © 2023 Lei Cheng
+
+#pragma once
+
+#include "Data/DataCenter.h"
+
+namespace lei
+{
+    // Maps every bar of a fine series (e.g. 1 min) to the bar of a coarse series (e.g. day) that contains it: the last
+    // coarse bar starting at or before it, -1 when there is none. Both series only grow, so Update extends the
+    // mapping from where it stopped; when a new coarse bar arrives, only the trailing fine bars that pointed at the
+    // previous last coarse bar are mapped again.
+    class FrequencyMap final
+    {
+    public:
+        FrequencyMap() = default;
+        ~FrequencyMap() = default;
+
+    public:
+        void Reset();
+
+        void Update(const DateTimeArray& fine_array, const DateTimeArray& coarse_array);
+
+        int operator[](std::size_t fine_index) const;
+
+        // The last coarse bar already closed at fine_index, the one before the bar containing it, -1 when there is none.
+        // Values shown per fine bar are taken from it, the containing bar still changes until its last fine bar.
+        int GetClosedIndex(std::size_t fine_index) const;
+
+        std::size_t size() const;
+
+    private:
+        std::vector<int> map_;
+        std::size_t coarse_index_ = 0;
+        std::size_t coarse_size_ = 0;
+    };
+}
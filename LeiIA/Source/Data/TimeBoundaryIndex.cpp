@@ -0,0 +1,78 @@
+// © 2023 Lei Cheng
+
+#include "TimeBoundaryIndex.h"
+
+namespace lei
+{
+    void TimeBoundaryIndex::Reset()
+    {
+        for (auto& boundaries : boundaries_)
+        {
+            boundaries.clear();
+        }
+
+        last_ = {};
+        size_ = 0;
+    }
+
+    void TimeBoundaryIndex::Update(const DateTimeArray& date_time_array)
+    {
+        if (date_time_array.size() < size_)
+        {
+            Reset();
+        }
+
+        for (auto i = size_; i < date_time_array.size(); ++i)
+        {
+            const auto current = ToCalendarTime(date_time_array[i]);
+            if (i > 0)
+            {
+                // The coarsest unit that changed, every finer unit changed with it.
+                int unit = -1;
+                if (current.year != last_.year)
+                {
+                    unit = static_cast<int>(TimeUnit::kYear);
+                }
+                else if (current.month != last_.month)
+                {
+                    unit = static_cast<int>(TimeUnit::kMonth);
+                }
+                else if (current.day != last_.day)
+                {
+                    unit = static_cast<int>(TimeUnit::kDay);
+                }
+                else if (current.hour != last_.hour)
+                {
+                    unit = static_cast<int>(TimeUnit::kHour);
+                }
+
+                for (int u = 0; u <= unit; ++u)
+                {
+                    boundaries_[u].push_back(static_cast<int>(i));
+                }
+            }
+
+            last_ = current;
+        }
+
+        size_ = date_time_array.size();
+    }
+
+    std::span<const int> TimeBoundaryIndex::GetBoundaries(TimeUnit unit, int begin, int end) const
+    {
+        const auto& boundaries = boundaries_[static_cast<std::size_t>(unit)];
+        const auto first = std::lower_bound(boundaries.begin(), boundaries.end(), begin);
+        const auto last = std::lower_bound(first, boundaries.end(), end);
+        return { first, last };
+    }
+
+    std::size_t TimeBoundaryIndex::size() const
+    {
+        return size_;
+    }
+
+    TimeBoundaryIndex::CalendarTime TimeBoundaryIndex::ToCalendarTime(const juce::Time& time)
+    {
+        return { time.getYear(), time.getMonth(), time.getDayOfMonth(), time.getHours() };
+    }
+}
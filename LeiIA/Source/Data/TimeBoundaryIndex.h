@@ -0,0 +1,54 @@
+// © 2023 Lei Cheng
+
+#pragma once
+
+#include "Data/DataCenter.h"
+#include <span>
+
+namespace lei
+{
+    enum class TimeUnit
+    {
+        kHour,
+        kDay,
+        kMonth,
+        kYear,
+        kSize
+    };
+
+    // The bars of a series where a new hour, day, month or year begins in local time, so grid lines and time labels
+    // for any range are a binary search away instead of a calendar conversion per visible bar. A boundary of a unit is
+    // also one of every finer unit. Series only grow, so Update only converts the appended bars.
+    class TimeBoundaryIndex final
+    {
+    public:
+        TimeBoundaryIndex() = default;
+        ~TimeBoundaryIndex() = default;
+
+    public:
+        void Reset();
+
+        void Update(const DateTimeArray& date_time_array);
+
+        // Ascending bar indices in [begin, end) that start a new unit.
+        std::span<const int> GetBoundaries(TimeUnit unit, int begin, int end) const;
+
+        std::size_t size() const;
+
+    private:
+        struct CalendarTime
+        {
+            int year = 0;
+            int month = 0;
+            int day = 0;
+            int hour = 0;
+        };
+
+        static CalendarTime ToCalendarTime(const juce::Time& time);
+
+    private:
+        std::array<std::vector<int>, static_cast<std::size_t>(TimeUnit::kSize)> boundaries_;
+        CalendarTime last_;
+        std::size_t size_ = 0;
+    };
+}
@@ -5,29 +5,35 @@
 
 namespace lei
 {
-    juce::Font GeStockSearchBarFont()
+    // The fonts are built once, so the typeface is looked up once rather than for every label.
+    const juce::Font& GeStockSearchBarFont()
     {
-        return { "Microsoft JhengHei", 18, juce::Font::bold };
+        static const juce::Font font{ "Microsoft JhengHei", 18, juce::Font::bold };
+        return font;
     }
 
-    juce::Font GetHeaderFont()
+    const juce::Font& GetHeaderFont()
     {
-        return { "Microsoft JhengHei", 24, juce::Font::bold };
+        static const juce::Font font{ "Microsoft JhengHei", 24, juce::Font::bold };
+        return font;
     }
 
-    juce::Font GetValueLabelFont()
+    const juce::Font& GetValueLabelFont()
     {
-        return { "Microsoft JhengHei", 18, juce::Font::bold };
+        static const juce::Font font{ "Microsoft JhengHei", 18, juce::Font::bold };
+        return font;
     }
 
-    juce::Font GetTimeLabelFont()
+    const juce::Font& GetTimeLabelFont()
     {
-        return { "Microsoft JhengHei", 18, juce::Font::bold };
+        static const juce::Font font{ "Microsoft JhengHei", 18, juce::Font::bold };
+        return font;
     }
 
-    juce::Font GetWatchToolMessageFont()
+    const juce::Font& GetWatchToolMessageFont()
     {
-        return { "Microsoft JhengHei", 18, juce::Font::bold };
+        static const juce::Font font{ "Microsoft JhengHei", 18, juce::Font::bold };
+        return font;
     }
 
     juce::String GetTimeFormat(DataFrequency frequency)
@@ -8,11 +8,11 @@ namespace lei
 {
     enum class DataFrequency;
 
-    juce::Font GeStockSearchBarFont();
-    juce::Font GetHeaderFont();
-    juce::Font GetValueLabelFont();
-    juce::Font GetTimeLabelFont();
-    juce::Font GetWatchToolMessageFont();
+    const juce::Font& GeStockSearchBarFont();
+    const juce::Font& GetHeaderFont();
+    const juce::Font& GetValueLabelFont();
+    const juce::Font& GetTimeLabelFont();
+    const juce::Font& GetWatchToolMessageFont();
 
     juce::String GetTimeFormat(DataFrequency frequency);
 }
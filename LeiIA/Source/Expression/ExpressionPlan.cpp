@@ -0,0 +1,756 @@
+// © 2023 Lei Cheng
+
+#include "ExpressionPlan.h"
+#include "Kernel/Recurrence.h"
+#include "Kernel/Rolling.h"
+#include "Kernel/Simd.h"
+
+namespace lei
+{
+    struct ExpressionPlan::Cursor
+    {
+        juce::String::CharPointerType position;
+        juce::String error;
+
+        juce::juce_wchar Peek()
+        {
+            position = position.findEndOfWhitespace();
+            return *position;
+        }
+
+        bool Accept(juce::juce_wchar c)
+        {
+            if (Peek() != c)
+            {
+                return false;
+            }
+
+            ++position;
+            return true;
+        }
+
+        bool AcceptKeyword(const char* keyword)
+        {
+            Peek();
+            auto end = position;
+            for (auto c = keyword; *c != 0; ++c, ++end)
+            {
+                if (juce::CharacterFunctions::toUpperCase(*end) != static_cast<juce::juce_wchar>(*c))
+                {
+                    return false;
+                }
+            }
+
+            if (juce::CharacterFunctions::isLetterOrDigit(*end) || *end == '_')
+            {
+                return false;
+            }
+
+            position = end;
+            return true;
+        }
+
+        int Fail(const juce::String& message)
+        {
+            if (error.isEmpty())
+            {
+                error = message;
+            }
+
+            return -1;
+        }
+    };
+
+    namespace
+    {
+        constexpr auto kNaN = std::numeric_limits<double>::quiet_NaN();
+
+        // node_groups_ values besides a group index.
+        constexpr int kUnusedNode = -2;
+        constexpr int kSharedNode = -1;
+
+        bool IsBinary(int left, int right)
+        {
+            return left >= 0 && right >= 0;
+        }
+    }
+
+    bool ExpressionPlan::NodeKey::operator==(const NodeKey& other) const
+    {
+        return op == other.op && left == other.left && right == other.right && period == other.period && constant == other.constant;
+    }
+
+    std::size_t ExpressionPlan::NodeKeyHash::operator()(const NodeKey& key) const
+    {
+        auto hash = static_cast<std::size_t>(key.op);
+        for (const auto value : { static_cast<std::size_t>(key.left + 1), static_cast<std::size_t>(key.right + 1), static_cast<std::size_t>(key.period) })
+        {
+            hash = hash * 31 + value;
+        }
+
+        return hash * 31 + std::hash<double>()(key.constant);
+    }
+
+    juce::Result ExpressionPlan::Compile(const juce::String& text)
+    {
+        return Compile(juce::StringArray(text));
+    }
+
+    juce::Result ExpressionPlan::Compile(const juce::StringArray& texts)
+    {
+        nodes_.clear();
+        node_indices_.clear();
+        values_.clear();
+        roots_.clear();
+        group_nodes_.clear();
+        shared_nodes_.clear();
+        size_ = 0;
+        text_ = texts.joinIntoString("; ").trim();
+
+        for (const auto& text : texts)
+        {
+            Cursor cursor{ text.getCharPointer() };
+            auto root = ParseExpression(cursor);
+            if (root >= 0 && cursor.Peek() != 0)
+            {
+                root = cursor.Fail(juce::translate("unexpected character") + " '" + juce::String::charToString(cursor.Peek()) + "'");
+            }
+
+            if (root < 0)
+            {
+                nodes_.clear();
+                node_indices_.clear();
+                roots_.clear();
+                return juce::Result::fail(cursor.error);
+            }
+
+            roots_.push_back(root);
+        }
+
+        // Only compiling looks nodes up, plans copied per stock don't carry the index.
+        node_indices_ = {};
+        values_.resize(nodes_.size());
+        return juce::Result::ok();
+    }
+
+    void ExpressionPlan::Reset()
+    {
+        for (auto& values : values_)
+        {
+            values.clear();
+        }
+
+        size_ = 0;
+    }
+
+    void ExpressionPlan::Update(const KArray& k_array)
+    {
+        if (roots_.empty())
+        {
+            return;
+        }
+
+        const auto size = std::get<0>(k_array).size();
+        if (size < size_)
+        {
+            Reset();
+        }
+
+        if (size == size_)
+        {
+            return;
+        }
+
+        // Nodes are stored children first, so one pass in order evaluates the whole plan.
+        for (std::size_t i = 0; i < nodes_.size(); ++i)
+        {
+            values_[i].resize(size, kNaN);
+            Evaluate(i, k_array, size_, size);
+        }
+
+        size_ = size;
+    }
+
+    void ExpressionPlan::SetRootGroupSize(std::size_t group_size)
+    {
+        jassert(group_size >= 1);
+        std::vector<int> node_groups(nodes_.size(), kUnusedNode);
+        for (std::size_t i = 0; i < roots_.size(); ++i)
+        {
+            const auto group = static_cast<int>(i / std::max<std::size_t>(group_size, 1));
+            std::vector<int> stack = { roots_[i] };
+            while (!stack.empty())
+            {
+                const auto index = stack.back();
+                stack.pop_back();
+
+                // Below a node this group has already reached, or one already shared, everything is marked already.
+                auto& node_group = node_groups[index];
+                if (node_group == group || node_group == kSharedNode)
+                {
+                    continue;
+                }
+
+                node_group = node_group == kUnusedNode ? group : kSharedNode;
+                for (const auto child : { nodes_[index].left, nodes_[index].right })
+                {
+                    if (child >= 0)
+                    {
+                        stack.push_back(child);
+                    }
+                }
+            }
+        }
+
+        group_nodes_.assign(roots_.empty() ? 0 : (roots_.size() - 1) / std::max<std::size_t>(group_size, 1) + 1, {});
+        shared_nodes_.clear();
+        for (std::size_t i = 0; i < node_groups.size(); ++i)
+        {
+            if (node_groups[i] == kSharedNode)
+            {
+                shared_nodes_.push_back(static_cast<int>(i));
+            }
+            else if (node_groups[i] >= 0)
+            {
+                group_nodes_[node_groups[i]].push_back(static_cast<int>(i));
+            }
+        }
+    }
+
+    void ExpressionPlan::UpdateShared(const KArray& k_array)
+    {
+        EvaluateNodes(k_array, shared_nodes_);
+    }
+
+    void ExpressionPlan::UpdateGroups(const KArray& k_array, std::size_t begin, std::size_t end)
+    {
+        jassert(end <= group_nodes_.size());
+        for (auto group = begin; group < end; ++group)
+        {
+            EvaluateNodes(k_array, group_nodes_[group]);
+        }
+    }
+
+    void ExpressionPlan::ReleaseGroups(std::size_t begin, std::size_t end)
+    {
+        jassert(end <= group_nodes_.size());
+        for (auto group = begin; group < end; ++group)
+        {
+            for (const auto index : group_nodes_[group])
+            {
+                std::vector<double>().swap(values_[index]);
+            }
+        }
+    }
+
+    std::size_t ExpressionPlan::GetRootSize() const
+    {
+        return roots_.size();
+    }
+
+    const std::vector<double>& ExpressionPlan::GetResult(std::size_t root_index) const
+    {
+        static const std::vector<double> empty;
+        return root_index < roots_.size() ? values_[roots_[root_index]] : empty;
+    }
+
+    std::size_t ExpressionPlan::GetFirstValidIndex(std::size_t root_index) const
+    {
+        return root_index < roots_.size() ? nodes_[roots_[root_index]].first_valid : 0;
+    }
+
+    std::size_t ExpressionPlan::GetNodeSize() const
+    {
+        return nodes_.size();
+    }
+
+    const juce::String& ExpressionPlan::GetText() const
+    {
+        return text_;
+    }
+
+    int ExpressionPlan::AddNode(Node node)
+    {
+        if (node.left >= 0)
+        {
+            node.first_valid = nodes_[node.left].first_valid;
+        }
+
+        if (node.right >= 0)
+        {
+            node.first_valid = std::max(node.first_valid, nodes_[node.right].first_valid);
+        }
+
+        switch (node.op)
+        {
+        case Op::kEMA:
+        case Op::kMA:
+        case Op::kLLV:
+        case Op::kHHV:
+            node.first_valid += node.period - 1;
+            break;
+        case Op::kRSV:
+            node.first_valid = node.period - 1;
+            break;
+        case Op::kRef:
+            node.first_valid += node.period;
+            break;
+        case Op::kCross:
+            node.first_valid += 1;
+            break;
+        default:
+            break;
+        }
+
+        const auto [pos, inserted] = node_indices_.try_emplace({ node.op, node.left, node.right, node.period, node.constant }, static_cast<int>(nodes_.size()));
+        if (inserted)
+        {
+            nodes_.push_back(node);
+        }
+
+        return pos->second;
+    }
+
+    int ExpressionPlan::ParseExpression(Cursor& cursor)
+    {
+        auto left = ParseAnd(cursor);
+        while (left >= 0 && cursor.AcceptKeyword("OR"))
+        {
+            const auto right = ParseAnd(cursor);
+            left = IsBinary(left, right) ? AddNode({ Op::kOr, left, right }) : -1;
+        }
+
+        return left;
+    }
+
+    int ExpressionPlan::ParseAnd(Cursor& cursor)
+    {
+        auto left = ParseComparison(cursor);
+        while (left >= 0 && cursor.AcceptKeyword("AND"))
+        {
+            const auto right = ParseComparison(cursor);
+            left = IsBinary(left, right) ? AddNode({ Op::kAnd, left, right }) : -1;
+        }
+
+        return left;
+    }
+
+    int ExpressionPlan::ParseComparison(Cursor& cursor)
+    {
+        const auto left = ParseSum(cursor);
+        if (left < 0)
+        {
+            return -1;
+        }
+
+        Op op;
+        if (cursor.Accept('>'))
+        {
+            op = cursor.Accept('=') ? Op::kGreaterEqual : Op::kGreater;
+        }
+        else if (cursor.Accept('<'))
+        {
+            op = cursor.Accept('=') ? Op::kLessEqual : Op::kLess;
+        }
+        else
+        {
+            return left;
+        }
+
+        const auto right = ParseSum(cursor);
+        return IsBinary(left, right) ? AddNode({ op, left, right }) : -1;
+    }
+
+    int ExpressionPlan::ParseSum(Cursor& cursor)
+    {
+        auto left = ParseTerm(cursor);
+        while (left >= 0)
+        {
+            Op op;
+            if (cursor.Accept('+'))
+            {
+                op = Op::kAdd;
+            }
+            else if (cursor.Accept('-'))
+            {
+                op = Op::kSubtract;
+            }
+            else
+            {
+                break;
+            }
+
+            const auto right = ParseTerm(cursor);
+            left = IsBinary(left, right) ? AddNode({ op, left, right }) : -1;
+        }
+
+        return left;
+    }
+
+    int ExpressionPlan::ParseTerm(Cursor& cursor)
+    {
+        auto left = ParseUnary(cursor);
+        while (left >= 0)
+        {
+            Op op;
+            if (cursor.Accept('*'))
+            {
+                op = Op::kMultiply;
+            }
+            else if (cursor.Accept('/'))
+            {
+                op = Op::kDivide;
+            }
+            else
+            {
+                break;
+            }
+
+            const auto right = ParseUnary(cursor);
+            left = IsBinary(left, right) ? AddNode({ op, left, right }) : -1;
+        }
+
+        return left;
+    }
+
+    int ExpressionPlan::ParseUnary(Cursor& cursor)
+    {
+        if (cursor.Accept('-'))
+        {
+            const auto operand = ParseUnary(cursor);
+            if (operand >= 0 && nodes_[operand].op == Op::kConstant)
+            {
+                return AddNode({ Op::kConstant, -1, -1, 0, -nodes_[operand].constant });
+            }
+
+            return operand >= 0 ? AddNode({ Op::kNegate, operand }) : -1;
+        }
+
+        cursor.Accept('+');
+        return ParsePrimary(cursor);
+    }
+
+    int ExpressionPlan::ParsePrimary(Cursor& cursor)
+    {
+        const auto c = cursor.Peek();
+        if (cursor.Accept('('))
+        {
+            const auto inner = ParseExpression(cursor);
+            if (inner >= 0 && !cursor.Accept(')'))
+            {
+                return cursor.Fail(juce::translate("missing ')'"));
+            }
+
+            return inner;
+        }
+
+        if (juce::CharacterFunctions::isDigit(c) || c == '.')
+        {
+            auto end = cursor.position;
+            const auto value = juce::CharacterFunctions::readDoubleValue(end);
+            cursor.position = end;
+            return AddNode({ Op::kConstant, -1, -1, 0, value });
+        }
+
+        if (juce::CharacterFunctions::isLetter(c))
+        {
+            juce::String name;
+            while (juce::CharacterFunctions::isLetterOrDigit(*cursor.position) || *cursor.position == '_')
+            {
+                name << juce::String::charToString(*cursor.position);
+                ++cursor.position;
+            }
+
+            name = name.toUpperCase();
+            if (cursor.Peek() == '(')
+            {
+                return ParseFunction(cursor, name);
+            }
+
+            static const std::array<std::pair<const char*, Op>, 10> columns = { { { "OPEN", Op::kOpen }, { "O", Op::kOpen },
+                                                                                  { "HIGH", Op::kHigh }, { "H", Op::kHigh },
+                                                                                  { "LOW", Op::kLow }, { "L", Op::kLow },
+                                                                                  { "CLOSE", Op::kClose }, { "C", Op::kClose },
+                                                                                  { "VOLUME", Op::kVolume }, { "V", Op::kVolume } } };
+
+            for (const auto& [column_name, op] : columns)
+            {
+                if (name == column_name)
+                {
+                    return AddNode({ op });
+                }
+            }
+
+            return cursor.Fail(juce::translate("unknown column") + " '" + name + "'");
+        }
+
+        if (c == 0)
+        {
+            return cursor.Fail(juce::translate("unexpected end of expression"));
+        }
+
+        return cursor.Fail(juce::translate("unexpected character") + " '" + juce::String::charToString(c) + "'");
+    }
+
+    int ExpressionPlan::ParseFunction(Cursor& cursor, const juce::String& name)
+    {
+        // name, op, series arguments, period arguments
+        static const std::array<std::tuple<const char*, Op, int, int>, 14> functions = { { { "EMA", Op::kEMA, 1, 1 },
+                                                                                           { "MA", Op::kMA, 1, 1 },
+                                                                                           { "SMA", Op::kMA, 1, 1 },
+                                                                                           { "LLV", Op::kLLV, 1, 1 },
+                                                                                           { "HHV", Op::kHHV, 1, 1 },
+                                                                                           { "REF", Op::kRef, 1, 1 },
+                                                                                           { "ABS", Op::kAbs, 1, 0 },
+                                                                                           { "NOT", Op::kNot, 1, 0 },
+                                                                                           { "MAX", Op::kMax, 2, 0 },
+                                                                                           { "MIN", Op::kMin, 2, 0 },
+                                                                                           { "CROSS", Op::kCross, 2, 0 },
+                                                                                           { "K", Op::kSmooth, 0, 2 },
+                                                                                           { "D", Op::kSmooth, 0, 3 } } };
+
+        const auto pos = std::find_if(functions.begin(), functions.end(), [&name](const auto& function)
+                                      {
+                                          return name == std::get<0>(function);
+                                      });
+
+        if (pos == functions.end())
+        {
+            return cursor.Fail(juce::translate("unknown function") + " '" + name + "'");
+        }
+
+        const auto op = std::get<1>(*pos);
+        const auto series_size = std::get<2>(*pos);
+        const auto argument_size = series_size + std::get<3>(*pos);
+
+        cursor.Accept('(');
+        std::array<int, 3> arguments = { -1, -1, -1 };
+        for (int i = 0; i < argument_size; ++i)
+        {
+            if (i > 0 && !cursor.Accept(','))
+            {
+                return cursor.Fail(juce::translate("wrong number of arguments for") + " " + name);
+            }
+
+            arguments[i] = ParseExpression(cursor);
+            if (arguments[i] < 0)
+            {
+                return -1;
+            }
+
+            if (i >= series_size)
+            {
+                const auto& period = nodes_[arguments[i]];
+                if (period.op != Op::kConstant || period.constant < 1 || period.constant != std::floor(period.constant) || period.constant > std::numeric_limits<int>::max())
+                {
+                    return cursor.Fail(name + ": " + juce::translate("period must be a positive integer"));
+                }
+
+                arguments[i] = static_cast<int>(period.constant);
+            }
+        }
+
+        if (!cursor.Accept(')'))
+        {
+            return cursor.Fail(juce::translate("missing ')'"));
+        }
+
+        if (series_size == argument_size)
+        {
+            return AddNode({ op, arguments[0], arguments[1] });
+        }
+
+        if (series_size == 1)
+        {
+            return AddNode({ op, arguments[0], -1, arguments[1] });
+        }
+
+        // K(n, a) smooths RSV(n) with weight a, D(n, a, b) smooths K(n, a) with weight b.
+        auto smooth = AddNode({ Op::kRSV, -1, -1, arguments[0] });
+        for (int i = 1; i < argument_size; ++i)
+        {
+            smooth = AddNode({ Op::kSmooth, smooth, -1, arguments[i] });
+        }
+
+        return smooth;
+    }
+
+    void ExpressionPlan::EvaluateNodes(const KArray& k_array, const std::vector<int>& indices)
+    {
+        const auto size = std::get<0>(k_array).size();
+        for (const auto index : indices)
+        {
+            values_[index].assign(size, kNaN);
+            Evaluate(index, k_array, 0, size);
+        }
+    }
+
+    void ExpressionPlan::Evaluate(std::size_t index, const KArray& k_array, std::size_t begin, std::size_t end)
+    {
+        const auto& node = nodes_[index];
+        auto& output = values_[index];
+        const auto* left = node.left >= 0 ? values_[node.left].data() : nullptr;
+        const auto* right = node.right >= 0 ? values_[node.right].data() : nullptr;
+
+        // Bars before first_valid stay NaN, the kernels only see the valid part of their inputs.
+        begin = std::max(begin, node.first_valid);
+        if (begin >= end)
+        {
+            return;
+        }
+
+        const auto count = end - begin;
+        switch (node.op)
+        {
+        case Op::kOpen:
+            std::copy(std::get<1>(k_array).begin() + begin, std::get<1>(k_array).begin() + end, output.begin() + begin);
+            break;
+        case Op::kHigh:
+            std::copy(std::get<2>(k_array).begin() + begin, std::get<2>(k_array).begin() + end, output.begin() + begin);
+            break;
+        case Op::kLow:
+            std::copy(std::get<3>(k_array).begin() + begin, std::get<3>(k_array).begin() + end, output.begin() + begin);
+            break;
+        case Op::kClose:
+            std::copy(std::get<4>(k_array).begin() + begin, std::get<4>(k_array).begin() + end, output.begin() + begin);
+            break;
+        case Op::kVolume:
+            std::transform(std::get<5>(k_array).begin() + begin, std::get<5>(k_array).begin() + end, output.begin() + begin, [](auto volume)
+                           {
+                               return static_cast<double>(volume);
+                           });
+            break;
+        case Op::kConstant:
+            std::fill(output.begin() + begin, output.begin() + end, node.constant);
+            break;
+        case Op::kAdd:
+            Add(left + begin, right + begin, output.data() + begin, count);
+            break;
+        case Op::kSubtract:
+            Subtract(left + begin, right + begin, output.data() + begin, count);
+            break;
+        case Op::kMultiply:
+            Multiply(left + begin, right + begin, output.data() + begin, count);
+            break;
+        case Op::kDivide:
+            Divide(left + begin, right + begin, output.data() + begin, count);
+            break;
+        case Op::kNegate:
+            std::transform(left + begin, left + end, output.begin() + begin, std::negate<double>());
+            break;
+        case Op::kAbs:
+            std::transform(left + begin, left + end, output.begin() + begin, [](double value)
+                           {
+                               return std::abs(value);
+                           });
+            break;
+        case Op::kMax:
+            std::transform(left + begin, left + end, right + begin, output.begin() + begin, [](double x, double y)
+                           {
+                               return std::max(x, y);
+                           });
+            break;
+        case Op::kMin:
+            std::transform(left + begin, left + end, right + begin, output.begin() + begin, [](double x, double y)
+                           {
+                               return std::min(x, y);
+                           });
+            break;
+        case Op::kEMA:
+        {
+            // Seeded with the SMA of the first full window, then extended from the last computed value.
+            auto from = begin;
+            if (from == node.first_valid)
+            {
+                output[from] = std::accumulate(left + from + 1 - node.period, left + from + 1, 0.0) / node.period;
+                ++from;
+            }
+
+            const auto alpha = 2.0 / (node.period + 1);
+            LinearRecurrence(left + from, output.data() + from, end - from, 1 - alpha, alpha, output[from - 1]);
+            break;
+        }
+        case Op::kMA:
+            RollingMean(left, output.data(), begin, end, node.period);
+            break;
+        case Op::kLLV:
+            RollingMin(left, output.data(), begin, end, node.period);
+            break;
+        case Op::kHHV:
+            RollingMax(left, output.data(), begin, end, node.period);
+            break;
+        case Op::kRef:
+            std::copy(left + begin - node.period, left + end - node.period, output.begin() + begin);
+            break;
+        case Op::kGreater:
+            std::transform(left + begin, left + end, right + begin, output.begin() + begin, [](double x, double y)
+                           {
+                               return x > y ? 1.0 : 0.0;
+                           });
+            break;
+        case Op::kLess:
+            std::transform(left + begin, left + end, right + begin, output.begin() + begin, [](double x, double y)
+                           {
+                               return x < y ? 1.0 : 0.0;
+                           });
+            break;
+        case Op::kGreaterEqual:
+            std::transform(left + begin, left + end, right + begin, output.begin() + begin, [](double x, double y)
+                           {
+                               return x >= y ? 1.0 : 0.0;
+                           });
+            break;
+        case Op::kLessEqual:
+            std::transform(left + begin, left + end, right + begin, output.begin() + begin, [](double x, double y)
+                           {
+                               return x <= y ? 1.0 : 0.0;
+                           });
+            break;
+        case Op::kAnd:
+            std::transform(left + begin, left + end, right + begin, output.begin() + begin, [](double x, double y)
+                           {
+                               return x != 0 && y != 0 ? 1.0 : 0.0;
+                           });
+            break;
+        case Op::kOr:
+            std::transform(left + begin, left + end, right + begin, output.begin() + begin, [](double x, double y)
+                           {
+                               return x != 0 || y != 0 ? 1.0 : 0.0;
+                           });
+            break;
+        case Op::kNot:
+            std::transform(left + begin, left + end, output.begin() + begin, [](double x)
+                           {
+                               return x == 0 ? 1.0 : 0.0;
+                           });
+            break;
+        case Op::kCross:
+            for (auto i = begin; i < end; ++i)
+            {
+                output[i] = static_cast<double>((left[i] > right[i]) & (left[i - 1] <= right[i - 1]));
+            }
+            break;
+        case Op::kRSV:
+        {
+            // The extrema are written relative to the first window so only the appended bars are allocated.
+            const auto head = static_cast<std::size_t>(node.period - 1);
+            const auto offset = begin - head;
+            std::vector<double> lowest_array(count + head);
+            std::vector<double> highest_array(count + head);
+            RollingMin(std::get<3>(k_array).data() + offset, lowest_array.data(), head, count + head, node.period);
+            RollingMax(std::get<2>(k_array).data() + offset, highest_array.data(), head, count + head, node.period);
+            ScaleToRange(std::get<4>(k_array).data() + begin, lowest_array.data() + head, highest_array.data() + head, output.data() + begin, count, 100, 50);
+            break;
+        }
+        case Op::kSmooth:
+        {
+            const auto weight = static_cast<double>(node.period);
+            LinearRecurrence(left + begin, output.data() + begin, count, (weight - 1) / weight, 1 / weight, begin == node.first_valid ? 50 : output[begin - 1]);
+            break;
+        }
+        default:
+            jassertfalse;
+            break;
+        }
+    }
+}
@@ -0,0 +1,141 @@
+// © 2023 Lei Cheng
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Data/DataCenter.h"
+
+namespace lei
+{
+    // Compiles a user formula such as "EMA(C, 12) - EMA(C, 26)" into a flat list of column kernels. Identical
+    // sub-expressions are shared, and Update only evaluates the bars appended since the previous call.
+    //
+    // Columns: OPEN/O, HIGH/H, LOW/L, CLOSE/C, VOLUME/V
+    // Operators: + - * / and unary -, comparisons > < >= <= yield 1 or 0, combined with AND, OR
+    // Functions: EMA(x, n), MA(x, n), LLV(x, n), HHV(x, n), REF(x, n), ABS(x), MAX(x, y), MIN(x, y),
+    //            CROSS(x, y), NOT(x), K(n, a), D(n, a, b) with the same smoothing as the KD indicator
+    class ExpressionPlan final
+    {
+    public:
+        ExpressionPlan() = default;
+        ~ExpressionPlan() = default;
+
+    public:
+        juce::Result Compile(const juce::String& text);
+
+        // Several formulas in one plan share their common sub-expressions, e.g. a sweep over MA(C, 5..60) pairs.
+        juce::Result Compile(const juce::StringArray& texts);
+
+        void Reset();
+
+        void Update(const KArray& k_array);
+
+        // For sweeps, roots are taken in consecutive groups of group_size (the entry and exit of one combination).
+        // UpdateShared evaluates the nodes used by more than one group once, UpdateGroups the remaining nodes of groups
+        // [begin, end) on top of them and ReleaseGroups frees those again. Both evaluate the whole k_array from scratch,
+        // and disjoint group ranges can be evaluated concurrently.
+        void SetRootGroupSize(std::size_t group_size);
+        void UpdateShared(const KArray& k_array);
+        void UpdateGroups(const KArray& k_array, std::size_t begin, std::size_t end);
+        void ReleaseGroups(std::size_t begin, std::size_t end);
+
+        std::size_t GetRootSize() const;
+
+        const std::vector<double>& GetResult(std::size_t root_index = 0) const;
+
+        std::size_t GetFirstValidIndex(std::size_t root_index = 0) const;
+
+        std::size_t GetNodeSize() const;
+
+        const juce::String& GetText() const;
+
+    private:
+        enum class Op
+        {
+            kOpen,
+            kHigh,
+            kLow,
+            kClose,
+            kVolume,
+            kConstant,
+            kAdd,
+            kSubtract,
+            kMultiply,
+            kDivide,
+            kNegate,
+            kAbs,
+            kMax,
+            kMin,
+            kEMA,
+            kMA,
+            kLLV,
+            kHHV,
+            kRef,
+            kGreater,
+            kLess,
+            kGreaterEqual,
+            kLessEqual,
+            kAnd,
+            kOr,
+            kNot,
+            kCross,
+            kRSV,
+            kSmooth
+        };
+
+        struct Node
+        {
+            Op op = Op::kConstant;
+            int left = -1;
+            int right = -1;
+            int period = 0;
+            double constant = 0;
+            std::size_t first_valid = 0;
+        };
+
+        // Nodes with equal keys compute the same column, the plan keeps one of them.
+        struct NodeKey
+        {
+            Op op = Op::kConstant;
+            int left = -1;
+            int right = -1;
+            int period = 0;
+            double constant = 0;
+
+            bool operator==(const NodeKey& other) const;
+        };
+
+        struct NodeKeyHash
+        {
+            std::size_t operator()(const NodeKey& key) const;
+        };
+
+        struct Cursor;
+
+    private:
+        int AddNode(Node node);
+
+        int ParseExpression(Cursor& cursor);
+        int ParseAnd(Cursor& cursor);
+        int ParseComparison(Cursor& cursor);
+        int ParseSum(Cursor& cursor);
+        int ParseTerm(Cursor& cursor);
+        int ParseUnary(Cursor& cursor);
+        int ParsePrimary(Cursor& cursor);
+        int ParseFunction(Cursor& cursor, const juce::String& name);
+
+        void Evaluate(std::size_t index, const KArray& k_array, std::size_t begin, std::size_t end);
+        void EvaluateNodes(const KArray& k_array, const std::vector<int>& indices);
+
+    private:
+        juce::String text_;
+        std::vector<Node> nodes_;
+        std::unordered_map<NodeKey, int, NodeKeyHash> node_indices_; // while compiling
+        std::vector<std::vector<double>> values_;
+        std::vector<int> roots_;
+        // After SetRootGroupSize, the nodes only reached from each group and those shared between groups, children first.
+        std::vector<std::vector<int>> group_nodes_;
+        std::vector<int> shared_nodes_;
+        std::size_t size_ = 0;
+    };
+}
@@ -0,0 +1,50 @@
+// © 2023 Lei Cheng
+
+#include "ATR.h"
+#include "Indicator/IndicatorType.h"
+#include "Kernel/Recurrence.h"
+
+namespace lei
+{
+    void TrueRange(const KArray& k_array, double* output, std::size_t begin, std::size_t end)
+    {
+        const auto& high_array = std::get<2>(k_array);
+        const auto& low_array = std::get<3>(k_array);
+        const auto& close_array = std::get<4>(k_array);
+        for (auto i = begin; i < end; ++i)
+        {
+            const auto range = high_array[i] - low_array[i];
+            if (i == 0)
+            {
+                output[i] = range;
+                continue;
+            }
+
+            const auto pre_close = close_array[i - 1];
+            output[i] = std::max({ range, std::abs(high_array[i] - pre_close), std::abs(low_array[i] - pre_close) });
+        }
+    }
+
+    ATR::ATR(const std::function<const KArray& ()>& GetKArray, int period) :
+        StreamingIndicator(GetKArray, "ATR(" + juce::String(period) + ")", { { {}, juce::Colours::yellow, {} } }, false),
+        period_(period)
+    {
+        jassert(period_ >= 1);
+    }
+
+    ATR::~ATR()
+    {
+    }
+
+    lei::IndicatorType ATR::GetIndicatorType() const
+    {
+        return IndicatorType::kATR;
+    }
+
+    void ATR::Extend(const KArray& k_array, std::size_t begin, std::size_t end)
+    {
+        true_range_array_.resize(end);
+        TrueRange(k_array, true_range_array_.data(), begin, end);
+        WilderSmooth(true_range_array_.data(), lines_[0].value_array.data(), begin, end, period_);
+    }
+}
@@ -0,0 +1,29 @@
+// © 2023 Lei Cheng
+
+#pragma once
+
+#include "StreamingIndicator.h"
+
+namespace lei
+{
+    // output[i] for i in [begin, end); the first bar has no previous close and uses high - low.
+    void TrueRange(const KArray& k_array, double* output, std::size_t begin, std::size_t end);
+
+    // Average true range with Wilder's smoothing.
+    class ATR : public StreamingIndicator
+    {
+    public:
+        ATR(const std::function<const KArray& ()>& GetKArray, int period);
+        ~ATR() override;
+
+    public:
+        IndicatorType GetIndicatorType() const override;
+
+    private:
+        void Extend(const KArray& k_array, std::size_t begin, std::size_t end) override;
+
+    private:
+        int period_;
+        std::vector<double> true_range_array_;
+    };
+}
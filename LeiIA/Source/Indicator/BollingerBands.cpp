@@ -0,0 +1,52 @@
+// © 2023 Lei Cheng
+
+#include "BollingerBands.h"
+#include "Indicator/IndicatorType.h"
+#include "Kernel/Rolling.h"
+
+namespace lei
+{
+    BollingerBands::BollingerBands(const std::function<const KArray& ()>& GetKArray, int period, double width) :
+        StreamingIndicator(GetKArray,
+                           "BOLL(" + juce::String(period) + ", " + juce::String(width) + ")",
+                           { { "MID", juce::Colours::white, {} }, { "UP", juce::Colours::deepskyblue, {} }, { "DN", juce::Colours::deepskyblue, {} } },
+                           true),
+        period_(period),
+        width_(width)
+    {
+        jassert(period_ >= 1);
+    }
+
+    BollingerBands::~BollingerBands()
+    {
+    }
+
+    lei::IndicatorType BollingerBands::GetIndicatorType() const
+    {
+        return IndicatorType::kBollingerBands;
+    }
+
+    void BollingerBands::Extend(const KArray& k_array, std::size_t begin, std::size_t end)
+    {
+        const auto& close_array = std::get<4>(k_array);
+        variance_array_.resize(end);
+
+        begin = std::max<std::size_t>(begin, period_ - 1);
+        if (begin >= end)
+        {
+            return;
+        }
+
+        auto& middle_array = lines_[0].value_array;
+        auto& upper_array = lines_[1].value_array;
+        auto& lower_array = lines_[2].value_array;
+        RollingMean(close_array.data(), middle_array.data(), begin, end, period_);
+        RollingVariance(close_array.data(), variance_array_.data(), begin, end, period_);
+        for (auto i = begin; i < end; ++i)
+        {
+            const auto band = width_ * std::sqrt(variance_array_[i]);
+            upper_array[i] = middle_array[i] + band;
+            lower_array[i] = middle_array[i] - band;
+        }
+    }
+}
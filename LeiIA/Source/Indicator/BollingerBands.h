@@ -0,0 +1,27 @@
+// © 2023 Lei Cheng
+
+#pragma once
+
+#include "StreamingIndicator.h"
+
+namespace lei
+{
+    // Moving average of the close with bands width standard deviations away, drawn on the k chart.
+    class BollingerBands : public StreamingIndicator
+    {
+    public:
+        BollingerBands(const std::function<const KArray& ()>& GetKArray, int period, double width);
+        ~BollingerBands() override;
+
+    public:
+        IndicatorType GetIndicatorType() const override;
+
+    private:
+        void Extend(const KArray& k_array, std::size_t begin, std::size_t end) override;
+
+    private:
+        int period_;
+        double width_;
+        std::vector<double> variance_array_;
+    };
+}
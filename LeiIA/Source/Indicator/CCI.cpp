@@ -0,0 +1,61 @@
+// © 2023 Lei Cheng
+
+#include "CCI.h"
+#include "Indicator/IndicatorType.h"
+#include "Kernel/Rolling.h"
+
+namespace lei
+{
+    CCI::CCI(const std::function<const KArray& ()>& GetKArray, int period) :
+        StreamingIndicator(GetKArray, "CCI(" + juce::String(period) + ")", { { {}, juce::Colours::yellow, {} } }, false),
+        period_(period)
+    {
+        jassert(period_ >= 1);
+    }
+
+    CCI::~CCI()
+    {
+    }
+
+    lei::IndicatorType CCI::GetIndicatorType() const
+    {
+        return IndicatorType::kCCI;
+    }
+
+    void CCI::Extend(const KArray& k_array, std::size_t begin, std::size_t end)
+    {
+        const auto& high_array = std::get<2>(k_array);
+        const auto& low_array = std::get<3>(k_array);
+        const auto& close_array = std::get<4>(k_array);
+        typical_price_array_.resize(end);
+        mean_array_.resize(end);
+
+        for (auto i = begin; i < end; ++i)
+        {
+            typical_price_array_[i] = (high_array[i] + low_array[i] + close_array[i]) / 3;
+        }
+
+        begin = std::max<std::size_t>(begin, period_ - 1);
+        if (begin >= end)
+        {
+            return;
+        }
+
+        RollingMean(typical_price_array_.data(), mean_array_.data(), begin, end, period_);
+
+        // The mean absolute deviation around the current mean has no sliding update, it is the one O(period) step.
+        auto& cci_array = lines_[0].value_array;
+        for (auto i = begin; i < end; ++i)
+        {
+            const auto mean = mean_array_[i];
+            double deviation = 0;
+            for (auto j = i + 1 - period_; j <= i; ++j)
+            {
+                deviation += std::abs(typical_price_array_[j] - mean);
+            }
+
+            deviation /= period_;
+            cci_array[i] = deviation > 0 ? (typical_price_array_[i] - mean) / (0.015 * deviation) : 0;
+        }
+    }
+}
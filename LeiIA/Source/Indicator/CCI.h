@@ -0,0 +1,27 @@
+// © 2023 Lei Cheng
+
+#pragma once
+
+#include "StreamingIndicator.h"
+
+namespace lei
+{
+    // Commodity channel index over the typical price.
+    class CCI : public StreamingIndicator
+    {
+    public:
+        CCI(const std::function<const KArray& ()>& GetKArray, int period);
+        ~CCI() override;
+
+    public:
+        IndicatorType GetIndicatorType() const override;
+
+    private:
+        void Extend(const KArray& k_array, std::size_t begin, std::size_t end) override;
+
+    private:
+        int period_;
+        std::vector<double> typical_price_array_;
+        std::vector<double> mean_array_;
+    };
+}
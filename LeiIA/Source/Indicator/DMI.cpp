@@ -0,0 +1,79 @@
+// © 2023 Lei Cheng
+
+#include "ATR.h"
+#include "DMI.h"
+#include "Indicator/IndicatorType.h"
+#include "Kernel/Recurrence.h"
+
+namespace lei
+{
+    DMI::DMI(const std::function<const KArray& ()>& GetKArray, int period) :
+        StreamingIndicator(GetKArray,
+                           "DMI(" + juce::String(period) + ")",
+                           { { "+DI", juce::Colours::red, {} }, { "-DI", juce::Colours::green, {} }, { "ADX", juce::Colours::yellow, {} } },
+                           false,
+                           { 0, 100 },
+                           { 20, 50, 80 }),
+        period_(period)
+    {
+        jassert(period_ >= 1);
+    }
+
+    DMI::~DMI()
+    {
+    }
+
+    lei::IndicatorType DMI::GetIndicatorType() const
+    {
+        return IndicatorType::kDMI;
+    }
+
+    void DMI::Extend(const KArray& k_array, std::size_t begin, std::size_t end)
+    {
+        const auto& high_array = std::get<2>(k_array);
+        const auto& low_array = std::get<3>(k_array);
+        for (auto* array : { &true_range_array_, &plus_dm_array_, &minus_dm_array_, &smoothed_true_range_array_, &smoothed_plus_dm_array_, &smoothed_minus_dm_array_, &dx_array_ })
+        {
+            array->resize(end);
+        }
+
+        TrueRange(k_array, true_range_array_.data(), begin, end);
+        for (auto i = std::max<std::size_t>(begin, 1); i < end; ++i)
+        {
+            const auto up = high_array[i] - high_array[i - 1];
+            const auto down = low_array[i - 1] - low_array[i];
+            plus_dm_array_[i] = up > down && up > 0 ? up : 0;
+            minus_dm_array_[i] = down > up && down > 0 ? down : 0;
+        }
+
+        if (end < 2)
+        {
+            return;
+        }
+
+        // Movements start at the second bar, so the smoothing runs one bar behind and DX is defined from period.
+        const auto smooth_begin = std::max<std::size_t>(begin, 1) - 1;
+        WilderSmooth(true_range_array_.data() + 1, smoothed_true_range_array_.data() + 1, smooth_begin, end - 1, period_);
+        WilderSmooth(plus_dm_array_.data() + 1, smoothed_plus_dm_array_.data() + 1, smooth_begin, end - 1, period_);
+        WilderSmooth(minus_dm_array_.data() + 1, smoothed_minus_dm_array_.data() + 1, smooth_begin, end - 1, period_);
+
+        auto& plus_di_array = lines_[0].value_array;
+        auto& minus_di_array = lines_[1].value_array;
+        auto& adx_array = lines_[2].value_array;
+        const auto head = static_cast<std::size_t>(period_);
+        for (auto i = std::max(begin, head); i < end; ++i)
+        {
+            const auto true_range = smoothed_true_range_array_[i];
+            plus_di_array[i] = true_range > 0 ? 100 * smoothed_plus_dm_array_[i] / true_range : 0;
+            minus_di_array[i] = true_range > 0 ? 100 * smoothed_minus_dm_array_[i] / true_range : 0;
+
+            const auto sum = plus_di_array[i] + minus_di_array[i];
+            dx_array_[i] = sum > 0 ? 100 * std::abs(plus_di_array[i] - minus_di_array[i]) / sum : 0;
+        }
+
+        if (end > head)
+        {
+            WilderSmooth(dx_array_.data() + head, adx_array.data() + head, std::max(begin, head) - head, end - head, period_);
+        }
+    }
+}
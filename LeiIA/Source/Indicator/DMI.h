@@ -0,0 +1,32 @@
+// © 2023 Lei Cheng
+
+#pragma once
+
+#include "StreamingIndicator.h"
+
+namespace lei
+{
+    // Directional movement: +DI, -DI and ADX, all smoothed with Wilder's method.
+    class DMI : public StreamingIndicator
+    {
+    public:
+        DMI(const std::function<const KArray& ()>& GetKArray, int period);
+        ~DMI() override;
+
+    public:
+        IndicatorType GetIndicatorType() const override;
+
+    private:
+        void Extend(const KArray& k_array, std::size_t begin, std::size_t end) override;
+
+    private:
+        int period_;
+        std::vector<double> true_range_array_;
+        std::vector<double> plus_dm_array_;
+        std::vector<double> minus_dm_array_;
+        std::vector<double> smoothed_true_range_array_;
+        std::vector<double> smoothed_plus_dm_array_;
+        std::vector<double> smoothed_minus_dm_array_;
+        std::vector<double> dx_array_;
+    };
+}
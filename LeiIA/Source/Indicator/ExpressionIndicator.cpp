@@ -0,0 +1,238 @@
+// © 2023 Lei Cheng
+
+#include "DrawUtility.h"
+#include "ExpressionIndicator.h"
+#include "Indicator/IndicatorType.h"
+#include "Layout.h"
+#include "Render/TextCache.h"
+#include <map>
+
+namespace lei
+{
+    namespace
+    {
+        // Views calculate their indicators on the message thread, so one plan serves every view with the same formula on
+        // the same series. KDataCenter keeps every series it loads, so the KArray address stands for the stock, the
+        // frequency and the bar setting.
+        std::shared_ptr<ExpressionPlan> GetSharedPlan(const KArray& k_array, const ExpressionPlan& compiled_plan)
+        {
+            static std::map<std::pair<const KArray*, std::string>, std::weak_ptr<ExpressionPlan>> plans;
+            const auto key = std::make_pair(&k_array, compiled_plan.GetText().toStdString());
+            if (auto plan = plans[key].lock())
+            {
+                return plan;
+            }
+
+            std::erase_if(plans, [](const auto& it) { return it.second.expired(); });
+            auto plan = std::make_shared<ExpressionPlan>(compiled_plan);
+            plans[key] = plan;
+            return plan;
+        }
+    }
+
+    ExpressionIndicator::ExpressionIndicator(const std::function<const KArray& ()>& GetKArray, ExpressionPlan plan, const juce::Colour& color, bool overlay) :
+        GetKArray_(GetKArray),
+        compiled_plan_(std::move(plan)),
+        plan_(std::make_shared<ExpressionPlan>(compiled_plan_)),
+        color_(color),
+        overlay_(overlay)
+    {
+        jassert(GetKArray_);
+    }
+
+    ExpressionIndicator::ExpressionIndicator(const std::function<const KArray& ()>& GetKArray,
+                                             const std::function<const KArray& ()>& GetSourceKArray,
+                                             ExpressionPlan plan,
+                                             const juce::Colour& color,
+                                             bool overlay) :
+        ExpressionIndicator(GetKArray, std::move(plan), color, overlay)
+    {
+        GetSourceKArray_ = GetSourceKArray;
+        jassert(GetSourceKArray_);
+    }
+
+    ExpressionIndicator::~ExpressionIndicator()
+    {
+    }
+
+    lei::IndicatorType ExpressionIndicator::GetIndicatorType() const
+    {
+        return IndicatorType::kExpression;
+    }
+
+    void ExpressionIndicator::StockChanged()
+    {
+        min_max_label_ = {};
+        plan_ = std::make_shared<ExpressionPlan>(compiled_plan_);
+        plan_k_array_ = nullptr;
+        frequency_map_.Reset();
+        value_array_.clear();
+        pyramid_.Clear();
+    }
+
+    void ExpressionIndicator::Calculate(const juce::Range<int>& scroll_bar_current_range)
+    {
+        // A view that finds the plan already evaluated by another one only extends its own mapping and pyramid.
+        const auto& plan_k_array = GetSourceKArray_ ? GetSourceKArray_() : GetKArray_();
+        if (plan_k_array_ != &plan_k_array)
+        {
+            plan_ = GetSharedPlan(plan_k_array, compiled_plan_);
+            plan_k_array_ = &plan_k_array;
+            frequency_map_.Reset();
+            value_array_.clear();
+            pyramid_.Clear();
+        }
+
+        // Only the bars appended since the last call are evaluated and mapped.
+        plan_->Update(plan_k_array);
+        if (GetSourceKArray_)
+        {
+            frequency_map_.Update(std::get<0>(GetKArray_()), std::get<0>(plan_k_array));
+            for (auto i = value_array_.size(); i < frequency_map_.size(); ++i)
+            {
+                value_array_.push_back(GetValue(i));
+            }
+
+            pyramid_.Extend(value_array_.data(), value_array_.size());
+        }
+        else
+        {
+            pyramid_.Extend(plan_->GetResult().data(), plan_->GetResult().size());
+        }
+
+        min_max_label_ = CalculateMinMaxLabel(scroll_bar_current_range);
+    }
+
+    std::pair<double, double> ExpressionIndicator::GetMinMaxLabelValue() const
+    {
+        return min_max_label_;
+    }
+
+    void ExpressionIndicator::Draw(juce::Graphics& g,
+                                   juce::Rectangle<int> chart_bounds,
+                                   juce::Rectangle<int> label_bounds,
+                                   const ViewportTransform& transform,
+                                   const juce::Range<int>& scroll_bar_current_range,
+                                   const std::pair<double, double>& min_max_label)
+    {
+        const auto size = GetSourceKArray_ ? frequency_map_.size() : plan_->GetResult().size();
+        if (size < scroll_bar_current_range.getEnd() || min_max_label.first >= min_max_label.second)
+        {
+            return;
+        }
+
+        if (!overlay_)
+        {
+            DrawXGridAndLabel(g, chart_bounds, label_bounds, min_max_label);
+        }
+
+        juce::Graphics::ScopedSaveState raii(g);
+        g.setColour(color_);
+
+        const auto ratio = chart_bounds.getHeight() / (min_max_label.second - min_max_label.first);
+        const auto begin = scroll_bar_current_range.getStart();
+        const auto end = scroll_bar_current_range.getEnd();
+
+        // Undefined bars (warm-up, division by zero) break the line instead of joining across them.
+        const auto& value_array = GetSourceKArray_ ? value_array_ : plan_->GetResult();
+        juce::Path path;
+        AddLine(path, value_array.data(), pyramid_, begin, end, chart_bounds.getY(), min_max_label.second, ratio, transform);
+
+        g.strokePath(path, juce::PathStrokeType(1));
+    }
+
+    void ExpressionIndicator::DrawWatchToolMessage(juce::Graphics& g, juce::Rectangle<int> chart_bounds, int k_index)
+    {
+        if (k_index == -1)
+        {
+            return;
+        }
+
+        juce::Graphics::ScopedSaveState raii(g);
+
+        const auto value = GetValue(k_index);
+        juce::String message(compiled_plan_.GetText() + " ");
+        if (std::isfinite(value))
+        {
+            message += juce::String(value, 2);
+        }
+        else
+        {
+            message += "--";
+        }
+
+        g.setColour(color_);
+        g.setFont(GetWatchToolMessageFont());
+        chart_bounds.removeFromLeft(1);
+        DrawCachedText(g, message, chart_bounds, juce::Justification::topLeft);
+    }
+
+    double ExpressionIndicator::GetValue(std::size_t k_index) const
+    {
+        const auto& value_array = plan_->GetResult();
+        const auto index = GetSourceKArray_ ? frequency_map_.GetClosedIndex(k_index) : static_cast<int>(k_index);
+        if (index < 0 || index >= static_cast<int>(value_array.size()))
+        {
+            return std::numeric_limits<double>::quiet_NaN();
+        }
+
+        return value_array[index];
+    }
+
+    std::pair<double, double> ExpressionIndicator::CalculateMinMaxLabel(const juce::Range<int>& scroll_bar_current_range) const
+    {
+        // An empty range must not widen the k chart scale it is merged into.
+        std::pair<double, double> min_max_label = { std::numeric_limits<double>::max(), std::numeric_limits<double>::lowest() };
+
+        const auto begin = GetSourceKArray_ ? scroll_bar_current_range.getStart()
+                                            : std::max<std::size_t>(scroll_bar_current_range.getStart(), plan_->GetFirstValidIndex());
+        const auto end = std::min<std::size_t>(scroll_bar_current_range.getEnd(), GetSourceKArray_ ? frequency_map_.size() : plan_->GetResult().size());
+        const auto summary = pyramid_.Get(begin, end);
+        if (summary.finite_size > 0)
+        {
+            min_max_label = { summary.min, summary.max };
+        }
+
+        if (!overlay_ && min_max_label.first > min_max_label.second)
+        {
+            return {};
+        }
+
+        return min_max_label;
+    }
+
+    void ExpressionIndicator::DrawXGridAndLabel(juce::Graphics& g,
+                                                juce::Rectangle<int> chart_bounds,
+                                                juce::Rectangle<int> label_bounds,
+                                                const std::pair<double, double>& min_max_label)
+    {
+        juce::Graphics::ScopedSaveState raii(g);
+
+        const auto min_max_range = min_max_label.second - min_max_label.first;
+        const std::array<double, 3> label_values = { min_max_label.first + min_max_range / 4,
+                                                     min_max_label.first + min_max_range / 2,
+                                                     min_max_label.second - min_max_range / 4 };
+
+        g.setColour(juce::Colours::grey);
+        for (const auto& label_value : label_values)
+        {
+            g.drawHorizontalLine(juce::roundToInt(chart_bounds.getY() + chart_bounds.getHeight() * (min_max_label.second - label_value) / min_max_range),
+                                 chart_bounds.getX(),
+                                 chart_bounds.getRight());
+        }
+
+        const auto font = GetValueLabelFont();
+        const auto font_height = font.getHeight();
+        g.setFont(font);
+        g.setColour(juce::Colours::white);
+        for (const auto& label_value : label_values)
+        {
+            DrawCachedText(g, juce::String(label_value, 2),
+                           juce::Rectangle<float>(label_bounds.getX(),
+                                                  label_bounds.getY() + label_bounds.getHeight() * (min_max_label.second - label_value) / min_max_range - font_height / 2,
+                                                  label_bounds.getWidth(),
+                                                  font_height),
+                           juce::Justification::centredLeft);
+        }
+    }
+}
@@ -0,0 +1,71 @@
+// © 2023 Lei Cheng
+
+#pragma once
+
+#include "Indicator.h"
+#include "Data/DataCenter.h"
+#include "Data/FrequencyMap.h"
+#include "Expression/ExpressionPlan.h"
+#include "Kernel/SeriesPyramid.h"
+#include <memory>
+
+namespace lei
+{
+    class ExpressionIndicator : public Indicator
+    {
+    public:
+        // overlay draws on the k chart with its price scale, otherwise the indicator owns a subsidiary chart.
+        ExpressionIndicator(const std::function<const KArray& ()>& GetKArray, ExpressionPlan plan, const juce::Colour& color, bool overlay);
+        // The plan is evaluated on the coarser source series (e.g. day k on a 1 min chart) and every chart bar shows the
+        // value of the last source bar closed before it, so the chart never shows a value that uses later bars.
+        ExpressionIndicator(const std::function<const KArray& ()>& GetKArray,
+                            const std::function<const KArray& ()>& GetSourceKArray,
+                            ExpressionPlan plan,
+                            const juce::Colour& color,
+                            bool overlay);
+        ~ExpressionIndicator() override;
+
+    public:
+        IndicatorType GetIndicatorType() const override;
+
+        void StockChanged() override;
+
+        void Calculate(const juce::Range<int>& scroll_bar_current_range) override;
+
+        std::pair<double, double> GetMinMaxLabelValue() const override;
+
+        void Draw(juce::Graphics& g,
+                  juce::Rectangle<int> chart_bounds,
+                  juce::Rectangle<int> label_bounds,
+                  const ViewportTransform& transform,
+                  const juce::Range<int>& scroll_bar_current_range,
+                  const std::pair<double, double>& min_max_label) override;
+
+        void DrawWatchToolMessage(juce::Graphics& g, juce::Rectangle<int> chart_bounds, int k_index) override;
+
+    private:
+        double GetValue(std::size_t k_index) const;
+
+        std::pair<double, double> CalculateMinMaxLabel(const juce::Range<int>& scroll_bar_current_range) const;
+
+        void DrawXGridAndLabel(juce::Graphics& g,
+                               juce::Rectangle<int> chart_bounds,
+                               juce::Rectangle<int> label_bounds,
+                               const std::pair<double, double>& min_max_label);
+
+    private:
+        std::function<const KArray& ()> GetKArray_;
+        std::function<const KArray& ()> GetSourceKArray_;
+        FrequencyMap frequency_map_;
+        // The compiled formula, and the evaluated plan every view drawing it on the same series shares.
+        ExpressionPlan compiled_plan_;
+        std::shared_ptr<ExpressionPlan> plan_;
+        const KArray* plan_k_array_ = nullptr;
+        // The plan result on the chart bars when the plan runs on a source series, every chart bar is mapped once.
+        std::vector<double> value_array_;
+        SeriesPyramid pyramid_;
+        std::pair<double, double> min_max_label_;
+        juce::Colour color_;
+        bool overlay_;
+    };
+}
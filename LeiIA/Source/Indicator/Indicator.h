@@ -7,6 +7,7 @@
 namespace lei
 {
     enum class IndicatorType;
+    class ViewportTransform;
 
     class Indicator
     {
@@ -26,7 +27,7 @@ namespace lei
         virtual void Draw(juce::Graphics& g,
                           juce::Rectangle<int> chart_bounds,
                           juce::Rectangle<int> label_bounds,
-                          int bar_width,
+                          const ViewportTransform& transform,
                           const juce::Range<int>& scroll_bar_current_range,
                           const std::pair<double, double>& min_max_label) = 0;
 
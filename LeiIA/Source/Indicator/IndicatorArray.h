@@ -0,0 +1,36 @@
+// © 2023 Lei Cheng
+
+#pragma once
+
+#include <type_traits>
+#include <vector>
+
+// Define LEI_INDICATOR_FLOAT_STORAGE=1 in the project's preprocessor definitions to store indicator outputs as float.
+// Accumulation (EMA state, rolling sums, K/D blends) always runs in double, only the stored values are narrowed.
+// CalculateMA, CalculateKD and CalculateMACD take the storage type as a template parameter, so --self-test checks the
+// float error bound in either build.
+#ifndef LEI_INDICATOR_FLOAT_STORAGE
+ #define LEI_INDICATOR_FLOAT_STORAGE 0
+#endif
+
+namespace lei
+{
+    using IndicatorValue = std::conditional_t<LEI_INDICATOR_FLOAT_STORAGE, float, double>;
+    using IndicatorArray = std::vector<IndicatorValue>;
+
+    // juce::String(double, 0) prints every digit, which for a float only shows the narrowing noise.
+    constexpr int kIndicatorLabelDecimalPlaces = LEI_INDICATOR_FLOAT_STORAGE ? 2 : 0;
+
+    template<typename Value = IndicatorValue>
+    std::vector<Value> ToIndicatorArray(std::vector<double>&& value_array)
+    {
+        if constexpr (std::is_same_v<Value, double>)
+        {
+            return std::move(value_array);
+        }
+        else
+        {
+            return std::vector<Value>(value_array.begin(), value_array.end());
+        }
+    }
+}
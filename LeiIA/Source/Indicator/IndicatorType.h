@@ -7,10 +7,20 @@ namespace lei
     enum class IndicatorType
     {
         kNull,
+        kATR,
+        kBollingerBands,
+        kCCI,
+        kDMI,
+        kExpression,
         kK,
         kKD,
         kMA,
         kMACD,
-        kVolume
+        kOBV,
+        kRSI,
+        kVolume,
+        kVolumeProfile,
+        kVWAP,
+        kWilliamsR
     };
 }
@@ -4,6 +4,9 @@
 #include "Indicator/IndicatorType.h"
 #include "K.h"
 #include "Layout.h"
+#include "Render/RectangleBatch.h"
+#include "Render/TextCache.h"
+#include <bit>
 
 namespace lei
 {
@@ -24,26 +27,28 @@ namespace lei
     void K::StockChanged()
     {
         min_max_label_ = {};
+        high_pyramid_.Clear();
+        low_pyramid_.Clear();
+        scanner_.Reset();
     }
 
     void K::Calculate(const juce::Range<int>& scroll_bar_current_range)
     {
-        const auto& low_array = std::get<3>(GetKArray_());
-        const auto pos_low = std::min_element(low_array.begin() + scroll_bar_current_range.getStart(),
-                                              low_array.begin() + scroll_bar_current_range.getEnd());
-
-        if (pos_low != low_array.end())
+        if (show_patterns_)
         {
-            min_max_label_.first = *pos_low;
+            scanner_.Update(GetKArray_());
         }
 
         const auto& high_array = std::get<2>(GetKArray_());
-        const auto pos_high = std::max_element(high_array.begin() + scroll_bar_current_range.getStart(),
-                                               high_array.begin() + scroll_bar_current_range.getEnd());
+        const auto& low_array = std::get<3>(GetKArray_());
+        high_pyramid_.Extend(high_array.data(), high_array.size());
+        low_pyramid_.Extend(low_array.data(), low_array.size());
 
-        if (pos_high != high_array.end())
+        const auto low = low_pyramid_.Get(scroll_bar_current_range.getStart(), scroll_bar_current_range.getEnd());
+        const auto high = high_pyramid_.Get(scroll_bar_current_range.getStart(), scroll_bar_current_range.getEnd());
+        if (low.finite_size > 0 && high.finite_size > 0)
         {
-            min_max_label_.second = *pos_high;
+            min_max_label_ = { low.min, high.max };
         }
     }
 
@@ -55,7 +60,7 @@ namespace lei
     void K::Draw(juce::Graphics& g,
                  juce::Rectangle<int> chart_bounds,
                  juce::Rectangle<int> label_bounds,
-                 int bar_width,
+                 const ViewportTransform& transform,
                  const juce::Range<int>& scroll_bar_current_range,
                  const std::pair<double, double>& min_max_label)
     {
@@ -63,12 +68,17 @@ namespace lei
         DrawKBar(g,
                  chart_bounds,
                  std::get<1>(GetKArray_()),
-                 std::get<2>(GetKArray_()),
-                 std::get<3>(GetKArray_()),
+                 high_pyramid_,
+                 low_pyramid_,
                  std::get<4>(GetKArray_()),
                  scroll_bar_current_range,
                  min_max_label,
-                 bar_width);
+                 transform);
+
+        if (show_patterns_)
+        {
+            DrawPatterns(g, chart_bounds, scroll_bar_current_range, min_max_label, transform);
+        }
     }
 
     void K::DrawWatchToolMessage(juce::Graphics& g, juce::Rectangle<int> chart_bounds, int k_index)
@@ -106,17 +116,42 @@ namespace lei
             }
         }
 
-        const auto message = juce::translate("open") + " " + open_str + " " +
+        auto message = juce::translate("open") + " " + open_str + " " +
             juce::translate("high") + " " + high_str + " " +
             juce::translate("low") + " " + low_str + " " +
             juce::translate("close") + " " + close_str + " " +
             juce::translate("up down") + " " + up_down_str + " " +
             juce::translate("up down percentage") + " " + up_down_percentage_str;
 
+        if (show_patterns_)
+        {
+            for (std::size_t pattern = 0; pattern < static_cast<std::size_t>(CandlestickPattern::kSize); ++pattern)
+            {
+                if (scanner_.Test(static_cast<CandlestickPattern>(pattern), k_index))
+                {
+                    message += " [" + juce::translate(GetPatternName(static_cast<CandlestickPattern>(pattern))) + "]";
+                }
+            }
+        }
+
         g.setColour(juce::Colours::white);
         g.setFont(GetWatchToolMessageFont());
         chart_bounds.removeFromLeft(1);
-        g.drawText(message, chart_bounds, juce::Justification::topLeft, false);
+        DrawCachedText(g, message, chart_bounds, juce::Justification::topLeft);
+    }
+
+    void K::ShowPatterns(bool show)
+    {
+        show_patterns_ = show;
+        if (!show_patterns_)
+        {
+            scanner_.Reset();
+        }
+    }
+
+    bool K::IsShowingPatterns() const
+    {
+        return show_patterns_;
     }
 
     void K::DrawXGridAndLabel(juce::Graphics& g,
@@ -147,27 +182,26 @@ namespace lei
         g.setColour(juce::Colours::white);
         for (int i = 1; i <= grid_size; ++i)
         {
-            g.drawText(juce::String(min_max_label.second - price_per_grid * i),
-                       juce::Rectangle<float>(label_bounds.getX(),
-                                              label_bounds.getY() + height_per_grid * i - font_height / 2,
-                                              label_bounds.getWidth(),
-                                              font_height),
-                       juce::Justification::centredLeft,
-                       false);
+            DrawCachedText(g, juce::String(min_max_label.second - price_per_grid * i),
+                           juce::Rectangle<float>(label_bounds.getX(),
+                                                  label_bounds.getY() + height_per_grid * i - font_height / 2,
+                                                  label_bounds.getWidth(),
+                                                  font_height),
+                           juce::Justification::centredLeft);
         }
     }
 
     void K::DrawKBar(juce::Graphics& g,
                      juce::Rectangle<int> chart_bounds,
                      const OpenArray& open_array,
-                     const HighArray& high_array,
-                     const LowArray& low_array,
+                     const SeriesPyramid& high_pyramid,
+                     const SeriesPyramid& low_pyramid,
                      const CloseArray& close_array,
                      const juce::Range<int>& scroll_bar_current_range,
                      const std::pair<double, double>& min_max_label,
-                     int bar_width)
+                     const ViewportTransform& transform)
     {
-        if (min_max_label.first == min_max_label.second)
+        if (high_pyramid.GetSize() < scroll_bar_current_range.getEnd() || min_max_label.first == min_max_label.second)
         {
             return;
         }
@@ -177,22 +211,102 @@ namespace lei
         const auto ratio = chart_bounds.getHeight() / (min_max_label.second - min_max_label.first);
         const auto begin = scroll_bar_current_range.getStart();
         const auto end = scroll_bar_current_range.getEnd();
-        for (int i = begin; i < end; ++i)
+        const auto stride = transform.GetStride();
+        RectangleBatch batch;
+        for (auto column = transform.GetColumnStart(begin); column < end; column += stride)
         {
-            const auto open = open_array[i];
-            const auto close = close_array[i];
-            g.setColour(close > open ? juce::Colours::red : (close < open ? juce::Colours::green : juce::Colours::white));
-
-            chart_bounds.removeFromLeft(kBarGap);
-            const auto bar_bounds = chart_bounds.removeFromLeft(bar_width);
-            g.fillRect(bar_bounds.getX(),
-                       juce::roundToInt(std::min(bar_bounds.getY() + (min_max_label.second - std::max(open, close)) * ratio, bar_bounds.getBottom() - 1.0)),
-                       bar_bounds.getWidth(),
-                       juce::roundToInt(std::max(std::abs(close - open) * ratio, 1.0)));
-
-            g.drawVerticalLine(bar_bounds.getCentreX(),
-                               bar_bounds.getY() + (min_max_label.second - high_array[i]) * ratio,
-                               bar_bounds.getY() + (min_max_label.second - low_array[i]) * ratio);
+            // A column shows its visible bars merged: open of the first, close of the last, high and low over all.
+            const auto first = std::max(column, begin);
+            const auto last = std::min(column + stride, end);
+            const auto open = open_array[first];
+            const auto close = close_array[last - 1];
+            const auto high = high_pyramid.Get(first, last).max;
+            const auto low = low_pyramid.Get(first, last).min;
+            const auto colour = close > open ? juce::Colours::red : (close < open ? juce::Colours::green : juce::Colours::white);
+
+            const auto bar_bounds = transform.GetBarBounds(column, chart_bounds).toNearestInt();
+            batch.Add(colour, juce::Rectangle<int>(bar_bounds.getX(),
+                                                   juce::roundToInt(std::min(bar_bounds.getY() + (min_max_label.second - std::max(open, close)) * ratio, bar_bounds.getBottom() - 1.0)),
+                                                   bar_bounds.getWidth(),
+                                                   juce::roundToInt(std::max(std::abs(close - open) * ratio, 1.0))).toFloat());
+
+            const auto top = static_cast<float>(bar_bounds.getY() + (min_max_label.second - high) * ratio);
+            const auto bottom = static_cast<float>(bar_bounds.getY() + (min_max_label.second - low) * ratio);
+            batch.Add(colour, { std::floor(transform.IndexToX(column)), top, 1.0f, bottom - top });
         }
+
+        batch.Fill(g);
+    }
+
+    void K::DrawPatterns(juce::Graphics& g,
+                         juce::Rectangle<int> chart_bounds,
+                         const juce::Range<int>& scroll_bar_current_range,
+                         const std::pair<double, double>& min_max_label,
+                         const ViewportTransform& transform) const
+    {
+        if (min_max_label.first == min_max_label.second || scanner_.size() < scroll_bar_current_range.getEnd())
+        {
+            return;
+        }
+
+        juce::Graphics::ScopedSaveState raii(g);
+
+        const auto& high_array = std::get<2>(GetKArray_());
+        const auto& low_array = std::get<3>(GetKArray_());
+        const auto ratio = chart_bounds.getHeight() / (min_max_label.second - min_max_label.first);
+        const auto marker_size = std::max(transform.GetBarWidth(), 5.0f);
+        const auto begin = static_cast<std::size_t>(scroll_bar_current_range.getStart());
+        const auto end = static_cast<std::size_t>(scroll_bar_current_range.getEnd());
+
+        // Words without any hit are skipped whole, so a zoomed out chart costs one test per 64 bars.
+        juce::Path bullish_markers;
+        juce::Path bearish_markers;
+        juce::Path neutral_markers;
+        for (auto word_index = begin / 64; word_index * 64 < end; ++word_index)
+        {
+            auto word = scanner_.GetAnyWord(word_index);
+            while (word != 0)
+            {
+                const auto i = word_index * 64 + std::countr_zero(word);
+                word &= word - 1;
+                if (i < begin || i >= end)
+                {
+                    continue;
+                }
+
+                int direction = 0;
+                for (std::size_t pattern = 0; pattern < static_cast<std::size_t>(CandlestickPattern::kSize); ++pattern)
+                {
+                    if (scanner_.Test(static_cast<CandlestickPattern>(pattern), i))
+                    {
+                        direction += GetPatternDirection(static_cast<CandlestickPattern>(pattern));
+                    }
+                }
+
+                const auto centre_x = transform.IndexToX(static_cast<int>(i));
+                if (direction > 0)
+                {
+                    const auto y = static_cast<float>(chart_bounds.getY() + (min_max_label.second - low_array[i]) * ratio) + 2;
+                    bullish_markers.addTriangle(centre_x, y, centre_x - marker_size / 2, y + marker_size, centre_x + marker_size / 2, y + marker_size);
+                }
+                else if (direction < 0)
+                {
+                    const auto y = static_cast<float>(chart_bounds.getY() + (min_max_label.second - high_array[i]) * ratio) - 2;
+                    bearish_markers.addTriangle(centre_x, y, centre_x - marker_size / 2, y - marker_size, centre_x + marker_size / 2, y - marker_size);
+                }
+                else
+                {
+                    const auto y = static_cast<float>(chart_bounds.getY() + (min_max_label.second - high_array[i]) * ratio) - 2 - marker_size / 2;
+                    neutral_markers.addEllipse(centre_x - marker_size / 4, y - marker_size / 4, marker_size / 2, marker_size / 2);
+                }
+            }
+        }
+
+        g.setColour(juce::Colours::red);
+        g.fillPath(bullish_markers);
+        g.setColour(juce::Colours::green);
+        g.fillPath(bearish_markers);
+        g.setColour(juce::Colours::white);
+        g.fillPath(neutral_markers);
     }
 }
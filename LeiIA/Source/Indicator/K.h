@@ -4,6 +4,8 @@
 
 #include "Indicator.h"
 #include "Data/DataCenter.h"
+#include "Kernel/SeriesPyramid.h"
+#include "Pattern/CandlestickScanner.h"
 
 namespace lei
 {
@@ -25,30 +27,46 @@ namespace lei
         void Draw(juce::Graphics& g,
                   juce::Rectangle<int> chart_bounds,
                   juce::Rectangle<int> label_bounds,
-                  int bar_width,
+                  const ViewportTransform& transform,
                   const juce::Range<int>& scroll_bar_current_range,
                   const std::pair<double, double>& min_max_label) override;
 
         void DrawWatchToolMessage(juce::Graphics& g, juce::Rectangle<int> chart_bounds, int k_index) override;
 
-    private:
-        static void DrawXGridAndLabel(juce::Graphics& g,
-                                      juce::Rectangle<int> chart_bounds,
-                                      juce::Rectangle<int> label_bounds,
-                                      const std::pair<double, double>& min_max_label);
+        // Candlestick pattern markers, scanned over the whole history and drawn for the visible bars only.
+        void ShowPatterns(bool show);
+
+        bool IsShowingPatterns() const;
 
+        // One candle per column, its high and low read from the pyramids of the high and low arrays.
         static void DrawKBar(juce::Graphics& g,
                              juce::Rectangle<int> chart_bounds,
                              const OpenArray& open_array,
-                             const HighArray& high_array,
-                             const LowArray& low_array,
+                             const SeriesPyramid& high_pyramid,
+                             const SeriesPyramid& low_pyramid,
                              const CloseArray& close_array,
                              const juce::Range<int>& scroll_bar_current_range,
                              const std::pair<double, double>& min_max_label,
-                             int bar_width);
+                             const ViewportTransform& transform);
+
+    private:
+        static void DrawXGridAndLabel(juce::Graphics& g,
+                                      juce::Rectangle<int> chart_bounds,
+                                      juce::Rectangle<int> label_bounds,
+                                      const std::pair<double, double>& min_max_label);
+
+        void DrawPatterns(juce::Graphics& g,
+                          juce::Rectangle<int> chart_bounds,
+                          const juce::Range<int>& scroll_bar_current_range,
+                          const std::pair<double, double>& min_max_label,
+                          const ViewportTransform& transform) const;
 
     private:
         std::function<const KArray& ()> GetKArray_;
         std::pair<double, double> min_max_label_;
+        SeriesPyramid high_pyramid_;
+        SeriesPyramid low_pyramid_;
+        CandlestickScanner scanner_;
+        bool show_patterns_ = false;
     };
 }
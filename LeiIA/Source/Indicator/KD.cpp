@@ -3,10 +3,54 @@
 #include "DrawUtility.h"
 #include "Indicator/IndicatorType.h"
 #include "KD.h"
+#include "Kernel/Recurrence.h"
+#include "Kernel/Rolling.h"
+#include "Kernel/Simd.h"
 #include "Layout.h"
+#include "Render/TextCache.h"
 
 namespace lei
 {
+    template<typename Value>
+    void CalculateKD(const KArray& k_array,
+                     int period,
+                     int rsv_weight,
+                     int k_weight,
+                     std::vector<Value>& rsv_array,
+                     std::vector<Value>& k_value_array,
+                     std::vector<Value>& d_array)
+    {
+        const auto& high_array = std::get<2>(k_array);
+        const auto& low_array = std::get<3>(k_array);
+        const auto& close_array = std::get<4>(k_array);
+
+        const auto size = close_array.size();
+        const auto head = static_cast<std::size_t>(period - 1);
+        std::vector<double> rsv(std::max(size, head), 50);
+        std::vector<double> k(rsv.size(), 50);
+        std::vector<double> d(rsv.size(), 50);
+
+        if (size > head)
+        {
+            const auto count = size - head;
+            std::vector<double> lowest_array(size);
+            std::vector<double> highest_array(size);
+            RollingMin(low_array.data(), lowest_array.data(), head, size, period);
+            RollingMax(high_array.data(), highest_array.data(), head, size, period);
+
+            ScaleToRange(close_array.data() + head, lowest_array.data() + head, highest_array.data() + head, rsv.data() + head, count, 100, 50);
+            LinearRecurrence(rsv.data() + head, k.data() + head, count, (rsv_weight - 1.0) / rsv_weight, 1.0 / rsv_weight, 50);
+            LinearRecurrence(k.data() + head, d.data() + head, count, (k_weight - 1.0) / k_weight, 1.0 / k_weight, 50);
+        }
+
+        rsv_array = ToIndicatorArray<Value>(std::move(rsv));
+        k_value_array = ToIndicatorArray<Value>(std::move(k));
+        d_array = ToIndicatorArray<Value>(std::move(d));
+    }
+
+    template void CalculateKD<float>(const KArray&, int, int, int, std::vector<float>&, std::vector<float>&, std::vector<float>&);
+    template void CalculateKD<double>(const KArray&, int, int, int, std::vector<double>&, std::vector<double>&, std::vector<double>&);
+
     KD::KD(const std::function<const KArray& ()>& GetKArray, int period, int rsv_weight, int k_weight) :
         GetKArray_(GetKArray),
         period_(period),
@@ -33,6 +77,8 @@ namespace lei
         rsv_array_.clear();
         k_array_.clear();
         d_array_.clear();
+        k_pyramid_.Clear();
+        d_pyramid_.Clear();
         recalculate_ = true;
     }
 
@@ -48,35 +94,11 @@ namespace lei
             return;
         }
 
-        rsv_array_.clear();
-        k_array_.clear();
-        d_array_.clear();
-
-        const auto& high_array = std::get<2>(GetKArray_());
-        const auto& low_array = std::get<3>(GetKArray_());
-        const auto& close_array = std::get<4>(GetKArray_());
-
-        const auto size = close_array.size();
-        rsv_array_.reserve(size);
-        k_array_.reserve(size);
-        d_array_.reserve(size);
-
-        for (int i = 0; i < period_ - 1; ++i)
-        {
-            rsv_array_.push_back(50);
-            k_array_.push_back(50);
-            d_array_.push_back(50);
-        }
-
-        for (int i = period_ - 1; i < size; ++i)
-        {
-            const auto min = *std::min_element(low_array.begin() + i + 1 - period_, low_array.begin() + i + 1);
-            const auto max = *std::max_element(high_array.begin() + i + 1 - period_, high_array.begin() + i + 1);
-            rsv_array_.push_back(min != max ? (close_array[i] - min) / (max - min) * 100 : 50);
-            k_array_.push_back(k_array_[i - 1] * (rsv_weight_ - 1) / rsv_weight_ + rsv_array_[i] * 1 / rsv_weight_);
-            d_array_.push_back(d_array_[i - 1] * (k_weight_ - 1) / k_weight_ + k_array_[i] * 1 / k_weight_);
-        }
-
+        CalculateKD(GetKArray_(), period_, rsv_weight_, k_weight_, rsv_array_, k_array_, d_array_);
+        k_pyramid_.Clear();
+        k_pyramid_.Extend(k_array_.data(), k_array_.size());
+        d_pyramid_.Clear();
+        d_pyramid_.Extend(d_array_.data(), d_array_.size());
         recalculate_ = false;
     }
 
@@ -88,13 +110,13 @@ namespace lei
     void KD::Draw(juce::Graphics& g,
                   juce::Rectangle<int> chart_bounds,
                   juce::Rectangle<int> label_bounds,
-                  int bar_width,
+                  const ViewportTransform& transform,
                   const juce::Range<int>& scroll_bar_current_range,
                   const std::pair<double, double>& min_max_label)
     {
         DrawXGridAndLabel(g, chart_bounds, label_bounds);
-        DrawLine(g, chart_bounds, bar_width, scroll_bar_current_range, min_max_label, juce::Colours::yellow, k_array_, period_);
-        DrawLine(g, chart_bounds, bar_width, scroll_bar_current_range, min_max_label, juce::Colours::orange, d_array_, period_);
+        DrawLine(g, chart_bounds, transform, scroll_bar_current_range, min_max_label, juce::Colours::yellow, k_array_, k_pyramid_, period_);
+        DrawLine(g, chart_bounds, transform, scroll_bar_current_range, min_max_label, juce::Colours::orange, d_array_, d_pyramid_, period_);
     }
 
     void KD::DrawWatchToolMessage(juce::Graphics& g, juce::Rectangle<int> chart_bounds, int k_index)
@@ -123,20 +145,21 @@ namespace lei
 
         g.setColour(juce::Colours::yellow);
         chart_bounds.removeFromLeft(1);
-        g.drawText(k_message, chart_bounds.removeFromLeft(font.getStringWidth(k_message)), juce::Justification::topLeft, false);
+        DrawCachedText(g, k_message, chart_bounds.removeFromLeft(juce::roundToInt(GetCachedStringWidth(font, k_message))), juce::Justification::topLeft);
 
         g.setColour(juce::Colours::orange);
         chart_bounds.removeFromLeft(10);
-        g.drawText(d_message, chart_bounds.removeFromLeft(font.getStringWidth(d_message)), juce::Justification::topLeft, false);
+        DrawCachedText(g, d_message, chart_bounds.removeFromLeft(juce::roundToInt(GetCachedStringWidth(font, d_message))), juce::Justification::topLeft);
     }
 
     void KD::DrawLine(juce::Graphics& g,
                       juce::Rectangle<int> chart_bounds,
-                      int bar_width,
+                      const ViewportTransform& transform,
                       const juce::Range<int>& scroll_bar_current_range,
                       const std::pair<double, double>& min_max_label,
                       const juce::Colour& line_color,
-                      const std::vector<double>& data_array,
+                      const IndicatorArray& data_array,
+                      const SeriesPyramid& pyramid,
                       int period)
     {
         if (data_array.size() < scroll_bar_current_range.getEnd() || min_max_label.first == min_max_label.second)
@@ -148,31 +171,12 @@ namespace lei
         g.setColour(line_color);
 
         const auto ratio = chart_bounds.getHeight() / (min_max_label.second - min_max_label.first);
-        const auto begin = data_array.cbegin() + scroll_bar_current_range.getStart();
-        const auto end = data_array.cbegin() + scroll_bar_current_range.getEnd();
+        const auto begin = scroll_bar_current_range.getStart();
+        const auto end = scroll_bar_current_range.getEnd();
 
-        bool first_point = true;
         juce::Path path;
-        for (auto it = begin; it != end; ++it)
-        {
-            chart_bounds.removeFromLeft(kBarGap);
-            const auto bar_bounds = chart_bounds.removeFromLeft(bar_width);
-
-            if (std::distance(data_array.cbegin(), it) < period - 2)
-            {
-                continue;
-            }
-
-            if (first_point)
-            {
-                path.startNewSubPath(bar_bounds.getCentreX(), bar_bounds.getY() + (min_max_label.second - *it) * ratio);
-                first_point = false;
-            }
-            else
-            {
-                path.lineTo(bar_bounds.getCentreX(), bar_bounds.getY() + (min_max_label.second - *it) * ratio);
-            }
-        }
+        const auto first = juce::jlimit(begin, end, period - 2);
+        AddLine(path, data_array.data(), pyramid, first, end, chart_bounds.getY(), min_max_label.second, ratio, transform);
 
         g.strokePath(path, juce::PathStrokeType(1));
     }
@@ -197,13 +201,12 @@ namespace lei
         g.setColour(juce::Colours::white);
         for (const auto& label_value : label_values)
         {
-            g.drawText(juce::String(label_value),
-                       juce::Rectangle<float>(label_bounds.getX(),
-                                              label_bounds.getBottom() - label_bounds.getHeight() * label_value / 100.0 - font_height / 2,
-                                              label_bounds.getWidth(),
-                                              font_height),
-                       juce::Justification::centredLeft,
-                       false);
+            DrawCachedText(g, juce::String(label_value),
+                           juce::Rectangle<float>(label_bounds.getX(),
+                                                  label_bounds.getBottom() - label_bounds.getHeight() * label_value / 100.0 - font_height / 2,
+                                                  label_bounds.getWidth(),
+                                                  font_height),
+                           juce::Justification::centredLeft);
         }
     }
 }
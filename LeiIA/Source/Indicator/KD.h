@@ -4,9 +4,22 @@
 
 #include "Indicator.h"
 #include "Data/DataCenter.h"
+#include "Indicator/IndicatorArray.h"
+#include "Kernel/SeriesPyramid.h"
 
 namespace lei
 {
+    // RSV, K and D over period bars, the first period - 1 values are 50. period, rsv_weight and k_weight are at least 2.
+    // Instantiated for float and double storage whatever LEI_INDICATOR_FLOAT_STORAGE selects.
+    template<typename Value>
+    void CalculateKD(const KArray& k_array,
+                     int period,
+                     int rsv_weight,
+                     int k_weight,
+                     std::vector<Value>& rsv_array,
+                     std::vector<Value>& k_value_array,
+                     std::vector<Value>& d_array);
+
     class KD : public Indicator
     {
     public:
@@ -25,7 +38,7 @@ namespace lei
         void Draw(juce::Graphics& g,
                   juce::Rectangle<int> chart_bounds,
                   juce::Rectangle<int> label_bounds,
-                  int bar_width,
+                  const ViewportTransform& transform,
                   const juce::Range<int>& scroll_bar_current_range,
                   const std::pair<double, double>& min_max_label) override;
 
@@ -34,11 +47,12 @@ namespace lei
     private:
         static void DrawLine(juce::Graphics& g,
                              juce::Rectangle<int> chart_bounds,
-                             int bar_width,
+                             const ViewportTransform& transform,
                              const juce::Range<int>& scroll_bar_current_range,
                              const std::pair<double, double>& min_max_label,
                              const juce::Colour& line_color,
-                             const std::vector<double>& data_array,
+                             const IndicatorArray& data_array,
+                             const SeriesPyramid& pyramid,
                              int period);
 
         static void DrawXGridAndLabel(juce::Graphics& g, juce::Rectangle<int> chart_bounds, juce::Rectangle<int> label_bounds);
@@ -48,9 +62,11 @@ namespace lei
         int period_;
         int rsv_weight_;
         int k_weight_;
-        std::vector<double> rsv_array_;
-        std::vector<double> k_array_;
-        std::vector<double> d_array_;
+        IndicatorArray rsv_array_;
+        IndicatorArray k_array_;
+        IndicatorArray d_array_;
+        SeriesPyramid k_pyramid_;
+        SeriesPyramid d_pyramid_;
         bool recalculate_ = true;
     };
 }
@@ -3,10 +3,30 @@
 #include "DrawUtility.h"
 #include "Indicator/IndicatorType.h"
 #include "Layout.h"
+#include "Render/TextCache.h"
 #include "MA.h"
 
 namespace lei
 {
+    template<typename Value>
+    void CalculateMA(const CloseArray& close_array, int period, std::vector<Value>& ma_array)
+    {
+        const auto size = static_cast<int>(close_array.size());
+        jassert(period >= 1 && period <= size);
+        ma_array.assign(size, 0);
+
+        auto sum = std::accumulate(close_array.begin(), close_array.begin() + period - 1, 0.0);
+        for (int i = period - 1; i < size; ++i)
+        {
+            sum += close_array[i];
+            ma_array[i] = static_cast<Value>(sum / period);
+            sum -= close_array[i + 1 - period];
+        }
+    }
+
+    template void CalculateMA<float>(const CloseArray&, int, std::vector<float>&);
+    template void CalculateMA<double>(const CloseArray&, int, std::vector<double>&);
+
     MA::MA(const std::function<const KArray& ()>& GetKArray, int period, const juce::Colour& color) :
         GetKArray_(GetKArray),
         period_(period),
@@ -29,6 +49,7 @@ namespace lei
     {
         min_max_label_ = {};
         ma_array_.clear();
+        ma_pyramid_.Clear();
         recalculate_ = true;
     }
 
@@ -48,18 +69,9 @@ namespace lei
             return;
         }
 
-        ma_array_.clear();
-        ma_array_.reserve(size);
-
-        for (int i = 0; i < period_ - 1; ++i)
-        {
-            ma_array_.push_back(0);
-        }
-
-        for (int i = period_ - 1; i < size; ++i)
-        {
-            ma_array_.push_back(std::accumulate(close_array.begin() + i + 1 - period_, close_array.begin() + i + 1, 0.0) / period_);
-        }
+        CalculateMA(close_array, period_, ma_array_);
+        ma_pyramid_.Clear();
+        ma_pyramid_.Extend(ma_array_.data(), ma_array_.size());
 
         min_max_label_ = CalculateMinMaxLabel(scroll_bar_current_range);
         recalculate_ = false;
@@ -73,11 +85,11 @@ namespace lei
     void MA::Draw(juce::Graphics& g,
                   juce::Rectangle<int> chart_bounds,
                   juce::Rectangle<int> label_bounds,
-                  int bar_width,
+                  const ViewportTransform& transform,
                   const juce::Range<int>& scroll_bar_current_range,
                   const std::pair<double, double>& min_max_label)
     {
-        if (min_max_label.first == min_max_label.second)
+        if (ma_array_.size() < scroll_bar_current_range.getEnd() || min_max_label.first == min_max_label.second)
         {
             return;
         }
@@ -86,36 +98,20 @@ namespace lei
         g.setColour(color_);
 
         const auto ratio = chart_bounds.getHeight() / (min_max_label.second - min_max_label.first);
+        const auto begin = scroll_bar_current_range.getStart();
         const auto end = scroll_bar_current_range.getEnd();
 
-        bool first_point = true;
         juce::Path path;
-        for (int i = scroll_bar_current_range.getStart(); i < end; ++i)
+        const auto first = juce::jlimit(begin, end, period_ - 1);
+        AddLine(path, ma_array_.data(), ma_pyramid_, first, end, chart_bounds.getY(), min_max_label.second, ratio, transform);
+
+        const auto marked = end - period_;
+        if (marked >= first && marked < end)
         {
-            chart_bounds.removeFromLeft(kBarGap);
-            const auto bar_bounds = chart_bounds.removeFromLeft(bar_width);
-
-            if (i < period_ - 1)
-            {
-                continue;
-            }
-
-            if (first_point)
-            {
-                path.startNewSubPath(bar_bounds.getCentreX(), bar_bounds.getY() + (min_max_label.second - ma_array_[i]) * ratio);
-                first_point = false;
-            }
-            else
-            {
-                path.lineTo(bar_bounds.getCentreX(), bar_bounds.getY() + (min_max_label.second - ma_array_[i]) * ratio);
-            }
-
-            if (i + period_ == end)
-            {
-                const auto triangle_height = sqrt(3) / 2 * bar_width;
-                g.drawLine(bar_bounds.getX(), bar_bounds.getBottom(), bar_bounds.getCentreX(), bar_bounds.getBottom() - triangle_height);
-                g.drawLine(bar_bounds.getRight(), bar_bounds.getBottom(), bar_bounds.getCentreX(), bar_bounds.getBottom() - triangle_height);
-            }
+            const auto bar_bounds = transform.GetBarBounds(marked, chart_bounds);
+            const auto triangle_height = std::sqrt(3.0f) / 2 * bar_bounds.getWidth();
+            g.drawLine(bar_bounds.getX(), bar_bounds.getBottom(), bar_bounds.getCentreX(), bar_bounds.getBottom() - triangle_height);
+            g.drawLine(bar_bounds.getRight(), bar_bounds.getBottom(), bar_bounds.getCentreX(), bar_bounds.getBottom() - triangle_height);
         }
 
         g.strokePath(path, juce::PathStrokeType(1));
@@ -133,7 +129,7 @@ namespace lei
         juce::String message("MA" + juce::String(period_) + " ");
         if (k_index >= period_ - 1)
         {
-            message += juce::String(ma_array_[k_index]);
+            message += juce::String(ma_array_[k_index], kIndicatorLabelDecimalPlaces);
         }
         else
         {
@@ -143,14 +139,18 @@ namespace lei
         g.setColour(color_);
         g.setFont(GetWatchToolMessageFont());
         chart_bounds.removeFromLeft(1);
-        g.drawText(message, chart_bounds, juce::Justification::topLeft, false);
+        DrawCachedText(g, message, chart_bounds, juce::Justification::topLeft);
     }
 
     std::pair<double, double> MA::CalculateMinMaxLabel(const juce::Range<int>& scroll_bar_current_range) const
     {
-        const auto [min, max] = std::minmax_element(ma_array_.begin() + std::max(scroll_bar_current_range.getStart(), period_ - 1),
-                                                    ma_array_.begin() + scroll_bar_current_range.getEnd());
+        const auto summary = ma_pyramid_.Get(std::max(scroll_bar_current_range.getStart(), period_ - 1), scroll_bar_current_range.getEnd());
+        if (summary.finite_size == 0)
+        {
+            // An empty range must not widen the k chart scale it is merged into.
+            return { std::numeric_limits<double>::max(), std::numeric_limits<double>::lowest() };
+        }
 
-        return std::make_pair(*min, *max);
+        return std::make_pair(summary.min, summary.max);
     }
 }
@@ -4,9 +4,16 @@
 
 #include "Indicator.h"
 #include "Data/DataCenter.h"
+#include "Indicator/IndicatorArray.h"
+#include "Kernel/SeriesPyramid.h"
 
 namespace lei
 {
+    // The simple moving average of close_array, 1 <= period <= close_array.size(), the first period - 1 values are 0.
+    // Instantiated for float and double storage whatever LEI_INDICATOR_FLOAT_STORAGE selects.
+    template<typename Value>
+    void CalculateMA(const CloseArray& close_array, int period, std::vector<Value>& ma_array);
+
     class MA : public Indicator
     {
     public:
@@ -25,7 +32,7 @@ namespace lei
         void Draw(juce::Graphics& g,
                   juce::Rectangle<int> chart_bounds,
                   juce::Rectangle<int> label_bounds,
-                  int bar_width,
+                  const ViewportTransform& transform,
                   const juce::Range<int>& scroll_bar_current_range,
                   const std::pair<double, double>& min_max_label) override;
 
@@ -38,7 +45,8 @@ namespace lei
         std::function<const KArray& ()> GetKArray_;
         std::pair<double, double> min_max_label_;
         int period_;
-        std::vector<double> ma_array_;
+        IndicatorArray ma_array_;
+        SeriesPyramid ma_pyramid_;
         bool recalculate_ = true;
         juce::Colour color_;
     };
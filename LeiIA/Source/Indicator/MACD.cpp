@@ -2,11 +2,239 @@
 
 #include "DrawUtility.h"
 #include "Indicator/IndicatorType.h"
+#include "Kernel/Series.h"
+#include "Kernel/TaskScheduler.h"
 #include "Layout.h"
+#include "Render/RectangleBatch.h"
+#include "Render/TextCache.h"
 #include "MACD.h"
+#include <array>
 
 namespace lei
 {
+    namespace
+    {
+        constexpr std::size_t kParallelMacdMinSize = 1 << 15;
+
+        // The EMA(short), EMA(long) and MACD values carried from one bar to the next.
+        struct MacdState
+        {
+            double ema_short = 0;
+            double ema_long = 0;
+            double macd = 0;
+        };
+
+        // Past the warmup every bar advances the state as state = transition * state + gain * close.
+        struct MacdStep
+        {
+            double short_decay;
+            double short_gain;
+            double long_decay;
+            double long_gain;
+            double macd_decay;
+            double macd_gain;
+        };
+
+        // Row-major, the effect of the state before a run of bars on the state after it when every close is 0.
+        using MacdTransition = std::array<double, 9>;
+
+        MacdStep GetMacdStep(int ema_short_period, int ema_long_period, int macd_period)
+        {
+            const auto short_alpha = 2.0 / (ema_short_period + 1);
+            const auto long_alpha = 2.0 / (ema_long_period + 1);
+            const auto macd_alpha = 2.0 / (macd_period + 1);
+            return { 1 - short_alpha, short_alpha, 1 - long_alpha, long_alpha, 1 - macd_alpha, macd_alpha };
+        }
+
+        MacdTransition Multiply(const MacdTransition& a, const MacdTransition& b)
+        {
+            MacdTransition product{};
+            for (int row = 0; row < 3; ++row)
+            {
+                for (int column = 0; column < 3; ++column)
+                {
+                    for (int k = 0; k < 3; ++k)
+                    {
+                        product[row * 3 + column] += a[row * 3 + k] * b[k * 3 + column];
+                    }
+                }
+            }
+
+            return product;
+        }
+
+        MacdTransition GetMacdTransition(const MacdStep& step, std::size_t bar_size)
+        {
+            // MACD' = macd_decay * MACD + macd_gain * (EMA(short)' - EMA(long)').
+            MacdTransition power{ step.short_decay, 0, 0,
+                                  0, step.long_decay, 0,
+                                  step.macd_gain * step.short_decay, -step.macd_gain * step.long_decay, step.macd_decay };
+            MacdTransition result{ 1, 0, 0, 0, 1, 0, 0, 0, 1 };
+            for (; bar_size > 0; bar_size >>= 1)
+            {
+                if (bar_size & 1)
+                {
+                    result = Multiply(power, result);
+                }
+
+                power = Multiply(power, power);
+            }
+
+            return result;
+        }
+
+        MacdState Apply(const MacdTransition& transition, const MacdState& state)
+        {
+            const auto& t = transition;
+            return { t[0] * state.ema_short + t[1] * state.ema_long + t[2] * state.macd,
+                     t[3] * state.ema_short + t[4] * state.ema_long + t[5] * state.macd,
+                     t[6] * state.ema_short + t[7] * state.ema_long + t[8] * state.macd };
+        }
+
+        void AdvanceMacd(const double* close, std::size_t size, const MacdStep& step, MacdState& state)
+        {
+            for (std::size_t i = 0; i < size; ++i)
+            {
+                state.ema_short = state.ema_short * step.short_decay + close[i] * step.short_gain;
+                state.ema_long = state.ema_long * step.long_decay + close[i] * step.long_gain;
+                state.macd = state.macd * step.macd_decay + (state.ema_short - state.ema_long) * step.macd_gain;
+            }
+        }
+
+        // The same arithmetic as the series Ema nodes, so a block continued from the true state matches the serial loop.
+        template<typename Value>
+        void StepMacd(const double* close, std::size_t size, const MacdStep& step, MacdState state, Value* dif, Value* macd, Value* osc)
+        {
+            for (std::size_t i = 0; i < size; ++i)
+            {
+                state.ema_short = state.ema_short * step.short_decay + close[i] * step.short_gain;
+                state.ema_long = state.ema_long * step.long_decay + close[i] * step.long_gain;
+                const auto dif_value = state.ema_short - state.ema_long;
+                state.macd = state.macd * step.macd_decay + dif_value * step.macd_gain;
+                dif[i] = static_cast<Value>(dif_value);
+                macd[i] = static_cast<Value>(state.macd);
+                osc[i] = static_cast<Value>(dif_value - state.macd);
+            }
+        }
+
+        template<int EmaShortPeriod, int EmaLongPeriod, int MacdPeriod, typename Value>
+        MacdState CalculateFused(const double* close,
+                                 std::size_t size,
+                                 int ema_short_period,
+                                 int ema_long_period,
+                                 int macd_period,
+                                 Value* dif_array,
+                                 Value* macd_array,
+                                 Value* osc_array)
+        {
+            using namespace series;
+
+            const auto max_period = std::max(ema_long_period, macd_period);
+
+            // EMA(short) and EMA(long) are never materialised, DIF, MACD and OSC are written in the same loop.
+            MacdState state;
+            double dif_value = 0;
+            auto dif = Tap(Store(Warmup(Store(Ema<EmaShortPeriod>(Column(close), ema_short_period), &state.ema_short) -
+                                        Store(Ema<EmaLongPeriod>(Column(close), ema_long_period), &state.ema_long),
+                                        ema_long_period,
+                                        0),
+                                 &dif_value),
+                           dif_array);
+
+            auto macd = Tap(Store(Ema<MacdPeriod>(Load(&dif_value), macd_period), &state.macd), macd_array);
+            Materialize(Warmup(std::move(dif) - std::move(macd), max_period, 0), size, osc_array);
+            return state;
+        }
+
+        template<typename Value>
+        MacdState CalculateFused(const double* close,
+                                 std::size_t size,
+                                 int ema_short_period,
+                                 int ema_long_period,
+                                 int macd_period,
+                                 Value* dif_array,
+                                 Value* macd_array,
+                                 Value* osc_array)
+        {
+            if (ema_short_period == 12 && ema_long_period == 26 && macd_period == 9)
+            {
+                return CalculateFused<12, 26, 9>(close, size, ema_short_period, ema_long_period, macd_period, dif_array, macd_array, osc_array);
+            }
+
+            return CalculateFused<0, 0, 0>(close, size, ema_short_period, ema_long_period, macd_period, dif_array, macd_array, osc_array);
+        }
+    }
+
+    template<typename Value>
+    void CalculateMACD(const CloseArray& close_array,
+                       int ema_short_period,
+                       int ema_long_period,
+                       int macd_period,
+                       std::vector<Value>& dif_array,
+                       std::vector<Value>& macd_array,
+                       std::vector<Value>& osc_array)
+    {
+        const auto size = close_array.size();
+        const auto max_period = static_cast<std::size_t>(std::max(ema_long_period, macd_period));
+        dif_array.assign(std::max(size, max_period), 0);
+        macd_array.assign(dif_array.size(), 0);
+        osc_array.assign(dif_array.size(), 0);
+
+        // The fused loop over a long history runs as a block scan of the three EMA states, like LinearRecurrence: the first
+        // block runs the warmup serially, every other block first finds the state it ends in when started from 0, the
+        // block states are composed in order, and then every block writes its bars from the true state it starts in.
+        auto& scheduler = GetTaskScheduler();
+        const auto block_count = std::min<std::size_t>(static_cast<std::size_t>(std::max(1, scheduler.GetConcurrency())), size / (kParallelMacdMinSize / 4) + 1);
+        const auto block_size = (size + block_count - 1) / std::max<std::size_t>(block_count, 1);
+        if (size < kParallelMacdMinSize || !scheduler.CanParallelize() || block_count < 2 || block_size <= max_period)
+        {
+            CalculateFused(close_array.data(), size, ema_short_period, ema_long_period, macd_period, dif_array.data(), macd_array.data(), osc_array.data());
+            return;
+        }
+
+        const auto step = GetMacdStep(ema_short_period, ema_long_period, macd_period);
+        std::vector<MacdState> block_states(block_count);
+
+        // Pass 1: the first block is final, the others scan from a zero state.
+        scheduler.ParallelFor(block_count, [&](std::size_t block)
+                              {
+                                  const auto begin = std::min(block * block_size, size);
+                                  const auto end = std::min(begin + block_size, size);
+                                  if (block == 0)
+                                  {
+                                      block_states[0] = CalculateFused(close_array.data(), end, ema_short_period, ema_long_period, macd_period,
+                                                                       dif_array.data(), macd_array.data(), osc_array.data());
+                                  }
+                                  else
+                                  {
+                                      AdvanceMacd(close_array.data() + begin, end - begin, step, block_states[block]);
+                                  }
+                              });
+
+        // block_states[block] becomes the state block + 1 starts in. Every block but the last has block_size bars.
+        const auto transition = GetMacdTransition(step, block_size);
+        for (std::size_t block = 1; block + 1 < block_count; ++block)
+        {
+            const auto carry = Apply(transition, block_states[block - 1]);
+            block_states[block] = { block_states[block].ema_short + carry.ema_short,
+                                    block_states[block].ema_long + carry.ema_long,
+                                    block_states[block].macd + carry.macd };
+        }
+
+        // Pass 2: every block after the first writes its bars.
+        scheduler.ParallelFor(block_count - 1, [&](std::size_t index)
+                              {
+                                  const auto block = index + 1;
+                                  const auto begin = std::min(block * block_size, size);
+                                  const auto end = std::min(begin + block_size, size);
+                                  StepMacd(close_array.data() + begin, end - begin, step, block_states[block - 1],
+                                           dif_array.data() + begin, macd_array.data() + begin, osc_array.data() + begin);
+                              });
+    }
+
+    template void CalculateMACD<float>(const CloseArray&, int, int, int, std::vector<float>&, std::vector<float>&, std::vector<float>&);
+    template void CalculateMACD<double>(const CloseArray&, int, int, int, std::vector<double>&, std::vector<double>&, std::vector<double>&);
+
     MACD::MACD(const std::function<const KArray& ()>& GetKArray, int ema_short_period, int ema_long_period, int macd_period) :
         GetKArray_(GetKArray),
         ema_short_period_(ema_short_period),
@@ -35,6 +263,9 @@ namespace lei
         dif_array_.clear();
         macd_array_.clear();
         osc_array_.clear();
+        dif_pyramid_.Clear();
+        macd_pyramid_.Clear();
+        osc_pyramid_.Clear();
         recalculate_ = true;
     }
 
@@ -46,10 +277,13 @@ namespace lei
             return;
         }
 
-        const auto& close_array = std::get<4>(GetKArray_());
-        dif_array_ = DIF(EMA(close_array, ema_short_period_), ema_short_period_, EMA(close_array, ema_long_period_), ema_long_period_);
-        macd_array_ = EMA(dif_array_, macd_period_);
-        osc_array_ = OSC(dif_array_, ema_long_period_, macd_array_, macd_period_);
+        CalculateMACD(std::get<4>(GetKArray_()), ema_short_period_, ema_long_period_, macd_period_, dif_array_, macd_array_, osc_array_);
+        for (auto [array, pyramid] : { std::make_pair(&dif_array_, &dif_pyramid_), std::make_pair(&macd_array_, &macd_pyramid_), std::make_pair(&osc_array_, &osc_pyramid_) })
+        {
+            pyramid->Clear();
+            pyramid->Extend(array->data(), array->size());
+        }
+
         min_max_label_ = CalculateMinMaxLabel(scroll_bar_current_range);
         recalculate_ = false;
     }
@@ -62,16 +296,16 @@ namespace lei
     void MACD::Draw(juce::Graphics& g,
                     juce::Rectangle<int> chart_bounds,
                     juce::Rectangle<int> label_bounds,
-                    int bar_width,
+                    const ViewportTransform& transform,
                     const juce::Range<int>& scroll_bar_current_range,
                     const std::pair<double, double>& min_max_label)
     {
         DrawXGridAndLabel(g, chart_bounds, label_bounds, min_max_label);
 
         const auto max_period = std::max(ema_long_period_, macd_period_);
-        DrawLine(g, chart_bounds, bar_width, scroll_bar_current_range, min_max_label, juce::Colours::yellow, dif_array_, max_period);
-        DrawLine(g, chart_bounds, bar_width, scroll_bar_current_range, min_max_label, juce::Colours::orange, macd_array_, max_period);
-        DrawBar(g, chart_bounds, bar_width, scroll_bar_current_range, min_max_label, osc_array_, max_period);
+        DrawLine(g, chart_bounds, transform, scroll_bar_current_range, min_max_label, juce::Colours::yellow, dif_array_, dif_pyramid_, max_period);
+        DrawLine(g, chart_bounds, transform, scroll_bar_current_range, min_max_label, juce::Colours::orange, macd_array_, macd_pyramid_, max_period);
+        DrawBar(g, chart_bounds, transform, scroll_bar_current_range, min_max_label, osc_pyramid_, max_period);
     }
 
     void MACD::DrawWatchToolMessage(juce::Graphics& g, juce::Rectangle<int> chart_bounds, int k_index)
@@ -105,62 +339,44 @@ namespace lei
 
         g.setColour(juce::Colours::yellow);
         chart_bounds.removeFromLeft(1);
-        g.drawText(dif_message, chart_bounds.removeFromLeft(font.getStringWidth(dif_message)), juce::Justification::topLeft, false);
+        DrawCachedText(g, dif_message, chart_bounds.removeFromLeft(juce::roundToInt(GetCachedStringWidth(font, dif_message))), juce::Justification::topLeft);
 
         g.setColour(juce::Colours::orange);
         chart_bounds.removeFromLeft(10);
-        g.drawText(macd_message, chart_bounds.removeFromLeft(font.getStringWidth(macd_message)), juce::Justification::topLeft, false);
+        DrawCachedText(g, macd_message, chart_bounds.removeFromLeft(juce::roundToInt(GetCachedStringWidth(font, macd_message))), juce::Justification::topLeft);
 
         g.setColour(juce::Colours::white);
         chart_bounds.removeFromLeft(10);
-        g.drawText(osc_message, chart_bounds.removeFromLeft(font.getStringWidth(osc_message)), juce::Justification::topLeft, false);
+        DrawCachedText(g, osc_message, chart_bounds.removeFromLeft(juce::roundToInt(GetCachedStringWidth(font, osc_message))), juce::Justification::topLeft);
     }
 
     std::pair<double, double> MACD::CalculateMinMaxLabel(const juce::Range<int>& scroll_bar_current_range) const
     {
-        std::pair<double, double> min_max_label;
-
         const auto max_period = std::max(ema_long_period_, macd_period_);
-        auto [min, max] = std::minmax_element(dif_array_.begin() + std::max(scroll_bar_current_range.getStart(), max_period),
-                                              dif_array_.begin() + std::max(scroll_bar_current_range.getEnd(), max_period));
-
-        if (min != dif_array_.end() && max != dif_array_.end())
+        const auto begin = std::max(scroll_bar_current_range.getStart(), max_period);
+        const auto end = std::max(scroll_bar_current_range.getEnd(), max_period);
+        auto summary = SeriesPyramid::Merge(dif_pyramid_.Get(begin, end), macd_pyramid_.Get(begin, end));
+        summary = SeriesPyramid::Merge(summary, osc_pyramid_.Get(begin, end));
+        if (summary.finite_size == 0)
         {
-            min_max_label = std::make_pair(*min, *max);
-        }
-
-        std::tie(min, max) = std::minmax_element(macd_array_.begin() + std::max(scroll_bar_current_range.getStart(), max_period),
-                                                 macd_array_.begin() + std::max(scroll_bar_current_range.getEnd(), max_period));
-
-        if (min != macd_array_.end() && max != macd_array_.end())
-        {
-            min_max_label.first = std::min(*min, min_max_label.first);
-            min_max_label.second = std::max(*max, min_max_label.second);
-        }
-
-        std::tie(min, max) = std::minmax_element(osc_array_.begin() + std::max(scroll_bar_current_range.getStart(), max_period),
-                                                 osc_array_.begin() + std::max(scroll_bar_current_range.getEnd(), max_period));
-
-        if (min != osc_array_.end() && max != osc_array_.end())
-        {
-            min_max_label.first = std::min(*min, min_max_label.first);
-            min_max_label.second = std::max(*max, min_max_label.second);
+            return {};
         }
 
-        const auto tweak_max = std::max<double>(std::abs(std::floor(min_max_label.first)), std::abs(std::ceil(min_max_label.second)));
+        const auto tweak_max = std::max(std::abs(std::floor(summary.min)), std::abs(std::ceil(summary.max)));
         return std::make_pair(-tweak_max, tweak_max);
     }
 
     void MACD::DrawLine(juce::Graphics& g,
                         juce::Rectangle<int> chart_bounds,
-                        int bar_width,
+                        const ViewportTransform& transform,
                         const juce::Range<int>& scroll_bar_current_range,
                         const std::pair<double, double>& min_max_label,
                         const juce::Colour& line_color,
-                        const std::vector<double>& data_array,
+                        const IndicatorArray& data_array,
+                        const SeriesPyramid& pyramid,
                         int period)
     {
-        if (min_max_label.first == min_max_label.second)
+        if (data_array.size() < scroll_bar_current_range.getEnd() || min_max_label.first == min_max_label.second)
         {
             return;
         }
@@ -169,44 +385,25 @@ namespace lei
         g.setColour(line_color);
 
         const auto ratio = chart_bounds.getHeight() / (min_max_label.second - min_max_label.first);
-        const auto begin = data_array.cbegin() + scroll_bar_current_range.getStart();
-        const auto end = data_array.cbegin() + scroll_bar_current_range.getEnd();
+        const auto begin = scroll_bar_current_range.getStart();
+        const auto end = scroll_bar_current_range.getEnd();
 
-        bool first_point = true;
         juce::Path path;
-        for (auto it = begin; it != end; ++it)
-        {
-            chart_bounds.removeFromLeft(kBarGap);
-            const auto bar_bounds = chart_bounds.removeFromLeft(bar_width);
-
-            if (std::distance(data_array.cbegin(), it) < period)
-            {
-                continue;
-            }
-
-            if (first_point)
-            {
-                path.startNewSubPath(bar_bounds.getCentreX(), bar_bounds.getY() + (min_max_label.second - *it) * ratio);
-                first_point = false;
-            }
-            else
-            {
-                path.lineTo(bar_bounds.getCentreX(), bar_bounds.getY() + (min_max_label.second - *it) * ratio);
-            }
-        }
+        const auto first = juce::jlimit(begin, end, period);
+        AddLine(path, data_array.data(), pyramid, first, end, chart_bounds.getY(), min_max_label.second, ratio, transform);
 
         g.strokePath(path, juce::PathStrokeType(1));
     }
 
     void MACD::DrawBar(juce::Graphics& g,
                        juce::Rectangle<int> chart_bounds,
-                       int bar_width,
+                       const ViewportTransform& transform,
                        const juce::Range<int>& scroll_bar_current_range,
                        const std::pair<double, double>& min_max_label,
-                       const std::vector<double>& data_array,
+                       const SeriesPyramid& pyramid,
                        int period)
     {
-        if (min_max_label.first == min_max_label.second)
+        if (pyramid.GetSize() < scroll_bar_current_range.getEnd() || min_max_label.first == min_max_label.second)
         {
             return;
         }
@@ -215,41 +412,39 @@ namespace lei
         g.setColour(juce::Colours::white);
 
         const auto ratio = chart_bounds.getHeight() / (min_max_label.second - min_max_label.first);
-        const auto begin = data_array.cbegin() + scroll_bar_current_range.getStart();
-        const auto end = data_array.cbegin() + scroll_bar_current_range.getEnd();
+        const auto begin = juce::jlimit(scroll_bar_current_range.getStart(), scroll_bar_current_range.getEnd(), period);
+        const auto end = scroll_bar_current_range.getEnd();
+        const auto stride = transform.GetStride();
 
-        for (auto it = begin; it != end; ++it)
+        RectangleBatch batch;
+        for (auto column = transform.GetColumnStart(begin); column < end; column += stride)
         {
-            chart_bounds.removeFromLeft(kBarGap);
-            const auto bar_bounds = chart_bounds.removeFromLeft(bar_width);
-
-            if (std::distance(data_array.cbegin(), it) < period)
-            {
-                continue;
-            }
-
-            const auto value = *it;
-            g.setColour(value > 0 ? juce::Colours::red : (value < 0 ? juce::Colours::green : juce::Colours::white));
+            // A column shows the value of its visible bars farthest from zero.
+            const auto summary = pyramid.Get(std::max(column, begin), std::min(column + stride, end));
+            const auto bar_bounds = transform.GetBarBounds(column, chart_bounds).toNearestInt();
+            const auto value = std::abs(summary.max) >= std::abs(summary.min) ? summary.max : summary.min;
             if (value > 0)
             {
                 const auto height = juce::roundToInt(std::max(value * ratio, 1.0));
-                g.fillRect(bar_bounds.getX(),
-                           bar_bounds.getCentreY() - height,
-                           bar_bounds.getWidth(),
-                           height);
+                batch.Add(juce::Colours::red, juce::Rectangle<int>(bar_bounds.getX(),
+                                                                   bar_bounds.getCentreY() - height,
+                                                                   bar_bounds.getWidth(),
+                                                                   height).toFloat());
             }
             else if (value < 0)
             {
-                g.fillRect(bar_bounds.getX(),
-                           bar_bounds.getCentreY(),
-                           bar_bounds.getWidth(),
-                           juce::roundToInt(std::max(abs(value) * ratio, 1.0)));
+                batch.Add(juce::Colours::green, juce::Rectangle<int>(bar_bounds.getX(),
+                                                                     bar_bounds.getCentreY(),
+                                                                     bar_bounds.getWidth(),
+                                                                     juce::roundToInt(std::max(abs(value) * ratio, 1.0))).toFloat());
             }
             else
             {
-                g.drawHorizontalLine(bar_bounds.getCentreY(), bar_bounds.getX(), bar_bounds.getRight());
+                batch.Add(juce::Colours::white, juce::Rectangle<int>(bar_bounds.getX(), bar_bounds.getCentreY(), bar_bounds.getWidth(), 1).toFloat());
             }
         }
+
+        batch.Fill(g);
     }
 
     void MACD::DrawXGridAndLabel(juce::Graphics& g,
@@ -276,86 +471,12 @@ namespace lei
         g.setColour(juce::Colours::white);
         for (const auto& label_value : label_values)
         {
-            g.drawText(juce::String(label_value),
-                       juce::Rectangle<float>(label_bounds.getX(),
-                                              label_bounds.getY() + label_bounds.getHeight() * (min_max_label.second - label_value) / min_max_range - font_height / 2,
-                                              label_bounds.getWidth(),
-                                              font_height),
-                       juce::Justification::centredLeft,
-                       false);
-        }
-    }
-
-    std::vector<double> MACD::EMA(const std::vector<double>& value_array, int period)
-    {
-        const auto size = value_array.size();
-        if (period > size)
-        {
-            return {};
-        }
-
-        std::vector<double> ema;
-        ema.reserve(size);
-
-        for (int i = 0; i < period - 1; ++i)
-        {
-            ema.push_back(0);
-        }
-
-        ema.push_back(std::accumulate(value_array.begin(), value_array.begin() + period, 0.0) / period);
-
-        const auto alpha = 2.0 / (period + 1);
-        const auto beta = 1 - alpha;
-        for (int i = period; i < size; ++i)
-        {
-            ema.push_back(ema[i - 1] * beta + value_array[i] * alpha);
-        }
-
-        return ema;
-    }
-
-    std::vector<double> MACD::DIF(const std::vector<double>& ema_short_array,
-                                  int ema_short_period,
-                                  const std::vector<double>& ema_long_array,
-                                  int ema_long_period)
-    {
-        const auto size = ema_short_array.size();
-        std::vector<double> dif_array;
-        dif_array.reserve(size);
-
-        for (int i = 0; i < ema_long_period; ++i)
-        {
-            dif_array.push_back(0);
-        }
-
-        for (int i = ema_long_period; i < size; ++i)
-        {
-            dif_array.push_back(ema_short_array[i] - ema_long_array[i]);
+            DrawCachedText(g, juce::String(label_value),
+                           juce::Rectangle<float>(label_bounds.getX(),
+                                                  label_bounds.getY() + label_bounds.getHeight() * (min_max_label.second - label_value) / min_max_range - font_height / 2,
+                                                  label_bounds.getWidth(),
+                                                  font_height),
+                           juce::Justification::centredLeft);
         }
-
-        return dif_array;
-    }
-
-    std::vector<double> MACD::OSC(const std::vector<double>& dif_array,
-                                  int ema_long_period,
-                                  const std::vector<double>& macd_array,
-                                  int macd_period)
-    {
-        const auto size = dif_array.size();
-        std::vector<double> osc_array;
-        osc_array.reserve(size);
-
-        const auto max_period = std::max(ema_long_period, macd_period);
-        for (int i = 0; i < max_period; ++i)
-        {
-            osc_array.push_back(0);
-        }
-
-        for (int i = max_period; i < size; ++i)
-        {
-            osc_array.push_back(dif_array[i] - macd_array[i]);
-        }
-
-        return osc_array;
     }
 }
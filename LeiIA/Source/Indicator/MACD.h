@@ -4,9 +4,22 @@
 
 #include "Indicator.h"
 #include "Data/DataCenter.h"
+#include "Indicator/IndicatorArray.h"
+#include "Kernel/SeriesPyramid.h"
 
 namespace lei
 {
+    // DIF, MACD and OSC of close_array in one fused pass, the first max(ema_long_period, macd_period) values are 0.
+    // Instantiated for float and double storage whatever LEI_INDICATOR_FLOAT_STORAGE selects.
+    template<typename Value>
+    void CalculateMACD(const CloseArray& close_array,
+                       int ema_short_period,
+                       int ema_long_period,
+                       int macd_period,
+                       std::vector<Value>& dif_array,
+                       std::vector<Value>& macd_array,
+                       std::vector<Value>& osc_array);
+
     class MACD : public Indicator
     {
     public:
@@ -25,7 +38,7 @@ namespace lei
         void Draw(juce::Graphics& g,
                   juce::Rectangle<int> chart_bounds,
                   juce::Rectangle<int> label_bounds,
-                  int bar_width,
+                  const ViewportTransform& transform,
                   const juce::Range<int>& scroll_bar_current_range,
                   const std::pair<double, double>& min_max_label) override;
 
@@ -35,19 +48,20 @@ namespace lei
         std::pair<double, double> CalculateMinMaxLabel(const juce::Range<int>& scroll_bar_current_range) const;
         static void DrawLine(juce::Graphics& g,
                              juce::Rectangle<int> chart_bounds,
-                             int bar_width,
+                             const ViewportTransform& transform,
                              const juce::Range<int>& scroll_bar_current_range,
                              const std::pair<double, double>& min_max_label,
                              const juce::Colour& line_color,
-                             const std::vector<double>& data_array,
+                             const IndicatorArray& data_array,
+                             const SeriesPyramid& pyramid,
                              int period);
 
         static void DrawBar(juce::Graphics& g,
                             juce::Rectangle<int> chart_bounds,
-                            int bar_width,
+                            const ViewportTransform& transform,
                             const juce::Range<int>& scroll_bar_current_range,
                             const std::pair<double, double>& min_max_label,
-                            const std::vector<double>& data_array,
+                            const SeriesPyramid& pyramid,
                             int period);
 
         static void DrawXGridAndLabel(juce::Graphics& g,
@@ -55,26 +69,18 @@ namespace lei
                                       juce::Rectangle<int> label_bounds,
                                       const std::pair<double, double>& min_max_label);
 
-        static std::vector<double> EMA(const std::vector<double>& value_array, int period);
-        static std::vector<double> DIF(const std::vector<double>& ema_short_array,
-                                       int ema_short_period,
-                                       const std::vector<double>& ema_long_array,
-                                       int ema_long_period);
-
-        static std::vector<double> OSC(const std::vector<double>& dif_array,
-                                       int ema_long_period,
-                                       const std::vector<double>& macd_array,
-                                       int macd_period);
-
     private:
         std::function<const KArray& ()> GetKArray_;
         std::pair<double, double> min_max_label_;
         int ema_short_period_;
         int ema_long_period_;
         int macd_period_;
-        std::vector<double> dif_array_;
-        std::vector<double> macd_array_;
-        std::vector<double> osc_array_;
+        IndicatorArray dif_array_;
+        IndicatorArray macd_array_;
+        IndicatorArray osc_array_;
+        SeriesPyramid dif_pyramid_;
+        SeriesPyramid macd_pyramid_;
+        SeriesPyramid osc_pyramid_;
         bool recalculate_ = true;
     };
 }
@@ -0,0 +1,40 @@
+// © 2023 Lei Cheng
+
+#include "Indicator/IndicatorType.h"
+#include "OBV.h"
+
+namespace lei
+{
+    OBV::OBV(const std::function<const KArray& ()>& GetKArray) :
+        StreamingIndicator(GetKArray, "OBV", { { {}, juce::Colours::yellow, {} } }, false)
+    {
+    }
+
+    OBV::~OBV()
+    {
+    }
+
+    lei::IndicatorType OBV::GetIndicatorType() const
+    {
+        return IndicatorType::kOBV;
+    }
+
+    void OBV::Extend(const KArray& k_array, std::size_t begin, std::size_t end)
+    {
+        const auto& close_array = std::get<4>(k_array);
+        const auto& volume_array = std::get<5>(k_array);
+        auto& obv_array = lines_[0].value_array;
+        for (auto i = begin; i < end; ++i)
+        {
+            if (i == 0)
+            {
+                obv_array[i] = 0;
+                continue;
+            }
+
+            const auto volume = static_cast<double>(volume_array[i]);
+            const auto change = close_array[i] - close_array[i - 1];
+            obv_array[i] = obv_array[i - 1] + (change > 0 ? volume : (change < 0 ? -volume : 0));
+        }
+    }
+}
@@ -0,0 +1,22 @@
+// © 2023 Lei Cheng
+
+#pragma once
+
+#include "StreamingIndicator.h"
+
+namespace lei
+{
+    // On balance volume: the volume is added on up closes and subtracted on down closes.
+    class OBV : public StreamingIndicator
+    {
+    public:
+        explicit OBV(const std::function<const KArray& ()>& GetKArray);
+        ~OBV() override;
+
+    public:
+        IndicatorType GetIndicatorType() const override;
+
+    private:
+        void Extend(const KArray& k_array, std::size_t begin, std::size_t end) override;
+    };
+}
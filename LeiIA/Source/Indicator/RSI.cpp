@@ -0,0 +1,62 @@
+// © 2023 Lei Cheng
+
+#include "Indicator/IndicatorType.h"
+#include "Kernel/Recurrence.h"
+#include "RSI.h"
+
+namespace lei
+{
+    RSI::RSI(const std::function<const KArray& ()>& GetKArray, int period) :
+        StreamingIndicator(GetKArray,
+                           "RSI(" + juce::String(period) + ")",
+                           { { {}, juce::Colours::yellow, {} } },
+                           false,
+                           { 0, 100 },
+                           { 30, 50, 70 }),
+        period_(period)
+    {
+        jassert(period_ >= 1);
+    }
+
+    RSI::~RSI()
+    {
+    }
+
+    lei::IndicatorType RSI::GetIndicatorType() const
+    {
+        return IndicatorType::kRSI;
+    }
+
+    void RSI::Extend(const KArray& k_array, std::size_t begin, std::size_t end)
+    {
+        const auto& close_array = std::get<4>(k_array);
+        gain_array_.resize(end);
+        loss_array_.resize(end);
+        average_gain_array_.resize(end);
+        average_loss_array_.resize(end);
+
+        for (auto i = std::max<std::size_t>(begin, 1); i < end; ++i)
+        {
+            const auto change = close_array[i] - close_array[i - 1];
+            gain_array_[i] = std::max(change, 0.0);
+            loss_array_[i] = std::max(-change, 0.0);
+        }
+
+        if (end < 2)
+        {
+            return;
+        }
+
+        // Changes start at the second bar, so the smoothing runs one bar behind.
+        const auto smooth_begin = std::max<std::size_t>(begin, 1) - 1;
+        WilderSmooth(gain_array_.data() + 1, average_gain_array_.data() + 1, smooth_begin, end - 1, period_);
+        WilderSmooth(loss_array_.data() + 1, average_loss_array_.data() + 1, smooth_begin, end - 1, period_);
+
+        auto& rsi_array = lines_[0].value_array;
+        for (auto i = std::max<std::size_t>(begin, period_); i < end; ++i)
+        {
+            const auto sum = average_gain_array_[i] + average_loss_array_[i];
+            rsi_array[i] = sum > 0 ? 100 * average_gain_array_[i] / sum : 50;
+        }
+    }
+}
@@ -0,0 +1,29 @@
+// © 2023 Lei Cheng
+
+#pragma once
+
+#include "StreamingIndicator.h"
+
+namespace lei
+{
+    // Relative strength index with Wilder's smoothing of gains and losses.
+    class RSI : public StreamingIndicator
+    {
+    public:
+        RSI(const std::function<const KArray& ()>& GetKArray, int period);
+        ~RSI() override;
+
+    public:
+        IndicatorType GetIndicatorType() const override;
+
+    private:
+        void Extend(const KArray& k_array, std::size_t begin, std::size_t end) override;
+
+    private:
+        int period_;
+        std::vector<double> gain_array_;
+        std::vector<double> loss_array_;
+        std::vector<double> average_gain_array_;
+        std::vector<double> average_loss_array_;
+    };
+}
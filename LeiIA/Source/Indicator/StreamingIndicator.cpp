@@ -0,0 +1,237 @@
+// © 2023 Lei Cheng
+
+#include "DrawUtility.h"
+#include "Layout.h"
+#include "Render/TextCache.h"
+#include "StreamingIndicator.h"
+
+namespace lei
+{
+    StreamingIndicator::StreamingIndicator(const std::function<const KArray& ()>& GetKArray,
+                                           const juce::String& name,
+                                           std::vector<Line> lines,
+                                           bool overlay,
+                                           const std::pair<double, double>& value_range,
+                                           const std::vector<double>& grid_values) :
+        GetKArray_(GetKArray),
+        lines_(std::move(lines)),
+        name_(name),
+        overlay_(overlay),
+        value_range_(value_range),
+        grid_values_(grid_values),
+        min_max_label_()
+    {
+        jassert(GetKArray_);
+    }
+
+    StreamingIndicator::~StreamingIndicator()
+    {
+    }
+
+    void StreamingIndicator::StockChanged()
+    {
+        for (auto& line : lines_)
+        {
+            line.value_array.clear();
+            line.pyramid.Clear();
+        }
+
+        min_max_label_ = {};
+        size_ = 0;
+        Reset();
+    }
+
+    void StreamingIndicator::Calculate(const juce::Range<int>& scroll_bar_current_range)
+    {
+        const auto& k_array = GetKArray_();
+        const auto size = std::get<0>(k_array).size();
+        if (size < size_)
+        {
+            StockChanged();
+        }
+
+        if (size > size_)
+        {
+            for (auto& line : lines_)
+            {
+                line.value_array.resize(size, std::numeric_limits<double>::quiet_NaN());
+            }
+
+            Extend(k_array, size_, size);
+            for (auto& line : lines_)
+            {
+                line.pyramid.Extend(line.value_array.data(), size);
+            }
+
+            size_ = size;
+        }
+
+        min_max_label_ = CalculateMinMaxLabel(scroll_bar_current_range);
+    }
+
+    std::pair<double, double> StreamingIndicator::GetMinMaxLabelValue() const
+    {
+        return min_max_label_;
+    }
+
+    void StreamingIndicator::Draw(juce::Graphics& g,
+                                  juce::Rectangle<int> chart_bounds,
+                                  juce::Rectangle<int> label_bounds,
+                                  const ViewportTransform& transform,
+                                  const juce::Range<int>& scroll_bar_current_range,
+                                  const std::pair<double, double>& min_max_label)
+    {
+        if (size_ < scroll_bar_current_range.getEnd() || min_max_label.first >= min_max_label.second)
+        {
+            return;
+        }
+
+        if (!overlay_)
+        {
+            DrawXGridAndLabel(g, chart_bounds, label_bounds, min_max_label);
+        }
+
+        for (const auto& line : lines_)
+        {
+            DrawLine(g, chart_bounds, transform, scroll_bar_current_range, min_max_label, line);
+        }
+    }
+
+    void StreamingIndicator::DrawWatchToolMessage(juce::Graphics& g, juce::Rectangle<int> chart_bounds, int k_index)
+    {
+        if (k_index == -1)
+        {
+            return;
+        }
+
+        juce::Graphics::ScopedSaveState raii(g);
+        const auto font = GetWatchToolMessageFont();
+        g.setFont(font);
+        chart_bounds.removeFromLeft(1);
+
+        g.setColour(juce::Colours::white);
+        DrawCachedText(g, name_, chart_bounds.removeFromLeft(juce::roundToInt(GetCachedStringWidth(font, name_))), juce::Justification::topLeft);
+
+        for (const auto& line : lines_)
+        {
+            juce::String message(line.name.isEmpty() ? juce::String() : line.name + " ");
+            if (k_index < line.value_array.size() && std::isfinite(line.value_array[k_index]))
+            {
+                message += juce::String(line.value_array[k_index], 2);
+            }
+            else
+            {
+                message += "--";
+            }
+
+            g.setColour(line.color);
+            chart_bounds.removeFromLeft(10);
+            DrawCachedText(g, message, chart_bounds.removeFromLeft(juce::roundToInt(GetCachedStringWidth(font, message))), juce::Justification::topLeft);
+        }
+    }
+
+    std::size_t StreamingIndicator::GetLineSize() const
+    {
+        return lines_.size();
+    }
+
+    const std::vector<double>& StreamingIndicator::GetLine(std::size_t line_index) const
+    {
+        return lines_[line_index].value_array;
+    }
+
+    void StreamingIndicator::Reset()
+    {
+    }
+
+    std::pair<double, double> StreamingIndicator::CalculateMinMaxLabel(const juce::Range<int>& scroll_bar_current_range) const
+    {
+        if (!overlay_ && value_range_.first < value_range_.second)
+        {
+            return value_range_;
+        }
+
+        // An empty range must not widen the k chart scale it is merged into.
+        std::pair<double, double> min_max_label = { std::numeric_limits<double>::max(), std::numeric_limits<double>::lowest() };
+        const auto begin = static_cast<std::size_t>(scroll_bar_current_range.getStart());
+        const auto end = std::min<std::size_t>(scroll_bar_current_range.getEnd(), size_);
+        for (const auto& line : lines_)
+        {
+            const auto summary = line.pyramid.Get(begin, end);
+            if (summary.finite_size > 0)
+            {
+                min_max_label.first = std::min(min_max_label.first, summary.min);
+                min_max_label.second = std::max(min_max_label.second, summary.max);
+            }
+        }
+
+        if (!overlay_ && min_max_label.first > min_max_label.second)
+        {
+            return {};
+        }
+
+        if (!overlay_ && min_max_label.first == min_max_label.second)
+        {
+            return { min_max_label.first - 1, min_max_label.second + 1 };
+        }
+
+        return min_max_label;
+    }
+
+    void StreamingIndicator::DrawXGridAndLabel(juce::Graphics& g,
+                                               juce::Rectangle<int> chart_bounds,
+                                               juce::Rectangle<int> label_bounds,
+                                               const std::pair<double, double>& min_max_label) const
+    {
+        juce::Graphics::ScopedSaveState raii(g);
+
+        const auto min_max_range = min_max_label.second - min_max_label.first;
+        auto label_values = grid_values_;
+        if (label_values.empty())
+        {
+            label_values = { min_max_label.first + min_max_range / 4, min_max_label.first + min_max_range / 2, min_max_label.second - min_max_range / 4 };
+        }
+
+        g.setColour(juce::Colours::grey);
+        for (const auto& label_value : label_values)
+        {
+            g.drawHorizontalLine(juce::roundToInt(chart_bounds.getY() + chart_bounds.getHeight() * (min_max_label.second - label_value) / min_max_range),
+                                 chart_bounds.getX(),
+                                 chart_bounds.getRight());
+        }
+
+        const auto font = GetValueLabelFont();
+        const auto font_height = font.getHeight();
+        g.setFont(font);
+        g.setColour(juce::Colours::white);
+        for (const auto& label_value : label_values)
+        {
+            DrawCachedText(g, juce::String(label_value, 2),
+                           juce::Rectangle<float>(label_bounds.getX(),
+                                                  label_bounds.getY() + label_bounds.getHeight() * (min_max_label.second - label_value) / min_max_range - font_height / 2,
+                                                  label_bounds.getWidth(),
+                                                  font_height),
+                           juce::Justification::centredLeft);
+        }
+    }
+
+    void StreamingIndicator::DrawLine(juce::Graphics& g,
+                                      juce::Rectangle<int> chart_bounds,
+                                      const ViewportTransform& transform,
+                                      const juce::Range<int>& scroll_bar_current_range,
+                                      const std::pair<double, double>& min_max_label,
+                                      const Line& line)
+    {
+        juce::Graphics::ScopedSaveState raii(g);
+        g.setColour(line.color);
+
+        const auto ratio = chart_bounds.getHeight() / (min_max_label.second - min_max_label.first);
+        const auto begin = scroll_bar_current_range.getStart();
+        const auto end = scroll_bar_current_range.getEnd();
+
+        juce::Path path;
+        AddLine(path, line.value_array.data(), line.pyramid, begin, end, chart_bounds.getY(), min_max_label.second, ratio, transform);
+
+        g.strokePath(path, juce::PathStrokeType(1));
+    }
+}
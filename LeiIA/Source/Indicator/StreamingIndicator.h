@@ -0,0 +1,90 @@
+// © 2023 Lei Cheng
+
+#pragma once
+
+#include "Indicator.h"
+#include "Data/DataCenter.h"
+#include "Kernel/SeriesPyramid.h"
+
+namespace lei
+{
+    // Base of the indicators built on the streaming kernels. Calculate only extends the lines by the bars appended since
+    // the last call; a subclass keeps whatever running state its kernels need between two Extend calls.
+    class StreamingIndicator : public Indicator
+    {
+    public:
+        ~StreamingIndicator() override;
+
+    public:
+        void StockChanged() override;
+
+        void Calculate(const juce::Range<int>& scroll_bar_current_range) override;
+
+        std::pair<double, double> GetMinMaxLabelValue() const override;
+
+        void Draw(juce::Graphics& g,
+                  juce::Rectangle<int> chart_bounds,
+                  juce::Rectangle<int> label_bounds,
+                  const ViewportTransform& transform,
+                  const juce::Range<int>& scroll_bar_current_range,
+                  const std::pair<double, double>& min_max_label) override;
+
+        void DrawWatchToolMessage(juce::Graphics& g, juce::Rectangle<int> chart_bounds, int k_index) override;
+
+        std::size_t GetLineSize() const;
+
+        // Values before a line is defined are NaN.
+        const std::vector<double>& GetLine(std::size_t line_index) const;
+
+    protected:
+        struct Line
+        {
+            juce::String name;
+            juce::Colour color;
+            std::vector<double> value_array;
+            SeriesPyramid pyramid;
+        };
+
+        // overlay draws on the k chart with its price scale. A subsidiary chart uses value_range when it is not empty
+        // (e.g. 0 to 100 for RSI) and the visible values otherwise, grid_values are drawn when given.
+        StreamingIndicator(const std::function<const KArray& ()>& GetKArray,
+                           const juce::String& name,
+                           std::vector<Line> lines,
+                           bool overlay,
+                           const std::pair<double, double>& value_range = {},
+                           const std::vector<double>& grid_values = {});
+
+        // Fills bars [begin, end) of every line, the lines are already sized to end. Bars before begin are final.
+        virtual void Extend(const KArray& k_array, std::size_t begin, std::size_t end) = 0;
+
+        // Clears the running state kept by Extend.
+        virtual void Reset();
+
+    protected:
+        std::function<const KArray& ()> GetKArray_;
+        std::vector<Line> lines_;
+
+    private:
+        std::pair<double, double> CalculateMinMaxLabel(const juce::Range<int>& scroll_bar_current_range) const;
+
+        void DrawXGridAndLabel(juce::Graphics& g,
+                               juce::Rectangle<int> chart_bounds,
+                               juce::Rectangle<int> label_bounds,
+                               const std::pair<double, double>& min_max_label) const;
+
+        static void DrawLine(juce::Graphics& g,
+                             juce::Rectangle<int> chart_bounds,
+                             const ViewportTransform& transform,
+                             const juce::Range<int>& scroll_bar_current_range,
+                             const std::pair<double, double>& min_max_label,
+                             const Line& line);
+
+    private:
+        juce::String name_;
+        bool overlay_;
+        std::pair<double, double> value_range_;
+        std::vector<double> grid_values_;
+        std::pair<double, double> min_max_label_;
+        std::size_t size_ = 0;
+    };
+}
@@ -0,0 +1,63 @@
+// © 2023 Lei Cheng
+
+#include "Indicator/IndicatorType.h"
+#include "VWAP.h"
+
+namespace lei
+{
+    namespace
+    {
+        constexpr juce::int64 kDayMilliseconds = 24 * 60 * 60 * 1000;
+    }
+
+    VWAP::VWAP(const std::function<const KArray& ()>& GetKArray) :
+        StreamingIndicator(GetKArray, "VWAP", { { {}, juce::Colours::violet, {} } }, true)
+    {
+    }
+
+    VWAP::~VWAP()
+    {
+    }
+
+    lei::IndicatorType VWAP::GetIndicatorType() const
+    {
+        return IndicatorType::kVWAP;
+    }
+
+    void VWAP::Extend(const KArray& k_array, std::size_t begin, std::size_t end)
+    {
+        const auto& date_time_array = std::get<0>(k_array);
+        const auto& high_array = std::get<2>(k_array);
+        const auto& low_array = std::get<3>(k_array);
+        const auto& close_array = std::get<4>(k_array);
+        const auto& volume_array = std::get<5>(k_array);
+        auto& vwap_array = lines_[0].value_array;
+        for (auto i = begin; i < end; ++i)
+        {
+            // Only the first bar past the current session converts to local time.
+            const auto time = date_time_array[i].toMilliseconds();
+            if (time < session_begin_ || time >= session_end_)
+            {
+                const auto& date_time = date_time_array[i];
+                session_begin_ = juce::Time(date_time.getYear(), date_time.getMonth(), date_time.getDayOfMonth(), 0, 0).toMilliseconds();
+                session_end_ = session_begin_ + kDayMilliseconds;
+                price_volume_sum_ = 0;
+                volume_sum_ = 0;
+            }
+
+            const auto typical_price = (high_array[i] + low_array[i] + close_array[i]) / 3;
+            const auto volume = static_cast<double>(volume_array[i]);
+            price_volume_sum_ += typical_price * volume;
+            volume_sum_ += volume;
+            vwap_array[i] = volume_sum_ > 0 ? price_volume_sum_ / volume_sum_ : typical_price;
+        }
+    }
+
+    void VWAP::Reset()
+    {
+        price_volume_sum_ = 0;
+        volume_sum_ = 0;
+        session_begin_ = 0;
+        session_end_ = 0;
+    }
+}
@@ -0,0 +1,30 @@
+// © 2023 Lei Cheng
+
+#pragma once
+
+#include "StreamingIndicator.h"
+
+namespace lei
+{
+    // Volume weighted average price of the typical price, restarted at the first bar of every day, drawn on the k chart.
+    class VWAP : public StreamingIndicator
+    {
+    public:
+        explicit VWAP(const std::function<const KArray& ()>& GetKArray);
+        ~VWAP() override;
+
+    public:
+        IndicatorType GetIndicatorType() const override;
+
+    private:
+        void Extend(const KArray& k_array, std::size_t begin, std::size_t end) override;
+
+        void Reset() override;
+
+    private:
+        double price_volume_sum_ = 0;
+        double volume_sum_ = 0;
+        juce::int64 session_begin_ = 0;
+        juce::int64 session_end_ = 0;
+    };
+}
@@ -3,14 +3,18 @@
 #include "DrawUtility.h"
 #include "Indicator/IndicatorType.h"
 #include "Layout.h"
+#include "Render/RectangleBatch.h"
+#include "Render/TextCache.h"
 #include "Volume.h"
 
 namespace lei
 {
-    Volume::Volume(const std::function<const KArray& ()>& GetKArray) :
+    Volume::Volume(const std::function<const KArray& ()>& GetKArray, const std::function<int()>& GetStride) :
         GetKArray_(GetKArray),
+        GetStride_(GetStride),
         min_max_label_()
     {
+        jassert(GetStride_);
     }
 
     Volume::~Volume()
@@ -25,17 +29,29 @@ namespace lei
     void Volume::StockChanged()
     {
         min_max_label_ = {};
+        volume_pyramid_.Clear();
     }
 
     void Volume::Calculate(const juce::Range<int>& scroll_bar_current_range)
     {
         const auto& volume_array = std::get<5>(GetKArray_());
-        const auto [min, max] = std::minmax_element(volume_array.begin() + scroll_bar_current_range.getStart(),
-                                                    volume_array.begin() + scroll_bar_current_range.getEnd());
+        volume_pyramid_.Extend(volume_array.data(), volume_array.size());
 
-        if (min != volume_array.end() && max != volume_array.end())
+        // The columns DrawVolumeBar draws, so the scale fits their sums.
+        const auto begin = scroll_bar_current_range.getStart();
+        const auto end = std::min<int>(scroll_bar_current_range.getEnd(), volume_pyramid_.GetSize());
+        const auto stride = std::max(GetStride_(), 1);
+        std::pair<double, double> min_max_label(std::numeric_limits<double>::max(), 0);
+        for (auto column = begin - begin % stride; column < end; column += stride)
         {
-            min_max_label_ = std::make_pair(*min, *max);
+            const auto sum = volume_pyramid_.Get(std::max(column, begin), std::min(column + stride, end)).sum;
+            min_max_label.first = std::min(min_max_label.first, sum);
+            min_max_label.second = std::max(min_max_label.second, sum);
+        }
+
+        if (min_max_label.first <= min_max_label.second)
+        {
+            min_max_label_ = min_max_label;
         }
     }
 
@@ -47,12 +63,12 @@ namespace lei
     void Volume::Draw(juce::Graphics& g,
                       juce::Rectangle<int> chart_bounds,
                       juce::Rectangle<int> label_bounds,
-                      int bar_width,
+                      const ViewportTransform& transform,
                       const juce::Range<int>& scroll_bar_current_range,
                       const std::pair<double, double>& min_max_label)
     {
         DrawXGridAndLabel(g, chart_bounds, label_bounds, min_max_label.second);
-        DrawVolumeBar(g, chart_bounds, std::get<5>(GetKArray_()), std::get<4>(GetKArray_()), scroll_bar_current_range, min_max_label.second, bar_width);
+        DrawVolumeBar(g, chart_bounds, volume_pyramid_, std::get<4>(GetKArray_()), scroll_bar_current_range, min_max_label.second, transform);
     }
 
     void Volume::DrawWatchToolMessage(juce::Graphics& g, juce::Rectangle<int> chart_bounds, int k_index)
@@ -66,16 +82,15 @@ namespace lei
         g.setColour(juce::Colours::white);
         g.setFont(GetWatchToolMessageFont());
         chart_bounds.removeFromLeft(1);
-        g.drawText(juce::translate("volume chart") + " " + juce::String(std::get<5>(GetKArray_())[k_index]),
-                   chart_bounds,
-                   juce::Justification::topLeft,
-                   false);
+        DrawCachedText(g, juce::translate("volume chart") + " " + juce::String(std::get<5>(GetKArray_())[k_index]),
+                       chart_bounds,
+                       juce::Justification::topLeft);
     }
 
     void Volume::DrawXGridAndLabel(juce::Graphics& g,
                                    juce::Rectangle<int> chart_bounds,
                                    juce::Rectangle<int> label_bounds,
-                                   unsigned long long max_volume)
+                                   double max_volume)
     {
         juce::Graphics::ScopedSaveState raii(g);
 
@@ -85,7 +100,7 @@ namespace lei
         const int kDefGridSize = 4;
         const int max_grid_size = (chart_height - font_height) / font_height;
         const int grid_size = std::min(kDefGridSize, max_grid_size);
-        const auto price_per_grid = juce::roundToInt(max_volume / static_cast<double>(grid_size + 1));
+        const auto price_per_grid = std::llround(max_volume / (grid_size + 1));
         const auto height_per_grid = static_cast<float>(chart_height) / (grid_size + 1);
 
         g.setColour(juce::Colours::grey);
@@ -100,47 +115,52 @@ namespace lei
         g.setColour(juce::Colours::white);
         for (int i = 1; i <= grid_size; ++i)
         {
-            g.drawText(juce::String(max_volume - price_per_grid * i),
-                       juce::Rectangle<float>(label_bounds.getX(),
-                                              label_bounds.getY() + height_per_grid * i - font_height / 2,
-                                              label_bounds.getWidth(),
-                                              font_height),
-                       juce::Justification::centredLeft,
-                       false);
+            DrawCachedText(g, juce::String(std::llround(max_volume) - price_per_grid * i),
+                           juce::Rectangle<float>(label_bounds.getX(),
+                                                  label_bounds.getY() + height_per_grid * i - font_height / 2,
+                                                  label_bounds.getWidth(),
+                                                  font_height),
+                           juce::Justification::centredLeft);
         }
     }
 
     void Volume::DrawVolumeBar(juce::Graphics& g,
                                juce::Rectangle<int> chart_bounds,
-                               const VolumeArray& volume_array,
+                               const SeriesPyramid& volume_pyramid,
                                const CloseArray& close_array,
                                const juce::Range<int>& scroll_bar_current_range,
-                               unsigned long long max_volume,
-                               int bar_width)
+                               double max_volume,
+                               const ViewportTransform& transform)
     {
-        if (max_volume == 0)
+        if (volume_pyramid.GetSize() < scroll_bar_current_range.getEnd() || max_volume <= 0)
         {
             return;
         }
 
         juce::Graphics::ScopedSaveState raii(g);
 
-        const auto ratio = static_cast<double>(chart_bounds.getHeight()) / max_volume;
+        const auto ratio = chart_bounds.getHeight() / max_volume;
         const auto begin = scroll_bar_current_range.getStart();
         const auto end = scroll_bar_current_range.getEnd();
-        for (int i = begin; i < end; ++i)
+        const auto stride = transform.GetStride();
+        RectangleBatch batch;
+        for (auto column = transform.GetColumnStart(begin); column < end; column += stride)
         {
-            const auto close = close_array[i];
-            const auto pre_close = (i == 0 ? close : close_array[i - 1]);
-            g.setColour(close > pre_close ? juce::Colours::red : (close < pre_close ? juce::Colours::green : juce::Colours::white));
-
-            chart_bounds.removeFromLeft(kBarGap);
-            const auto bar_bounds = chart_bounds.removeFromLeft(bar_width);
-            const auto volume = volume_array[i];
-            g.fillRect(bar_bounds.getX(),
-                       juce::roundToInt(std::min(bar_bounds.getY() + (max_volume - volume) * ratio, bar_bounds.getBottom() - 1.0)),
-                       bar_bounds.getWidth(),
-                       juce::roundToInt(std::max(volume * ratio, 1.0)));
+            // A column shows the summed volume of its visible bars, Calculate scales the label to the largest sum.
+            const auto first = std::max(column, begin);
+            const auto last = std::min(column + stride, end);
+            const auto close = close_array[last - 1];
+            const auto pre_close = (first == 0 ? close_array[first] : close_array[first - 1]);
+            const auto colour = close > pre_close ? juce::Colours::red : (close < pre_close ? juce::Colours::green : juce::Colours::white);
+
+            const auto bar_bounds = transform.GetBarBounds(column, chart_bounds).toNearestInt();
+            const auto volume = volume_pyramid.Get(first, last).sum;
+            batch.Add(colour, juce::Rectangle<int>(bar_bounds.getX(),
+                                                   juce::roundToInt(std::min(bar_bounds.getY() + (max_volume - volume) * ratio, bar_bounds.getBottom() - 1.0)),
+                                                   bar_bounds.getWidth(),
+                                                   juce::roundToInt(std::max(volume * ratio, 1.0))).toFloat());
         }
+
+        batch.Fill(g);
     }
 }
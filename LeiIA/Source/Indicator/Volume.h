@@ -4,13 +4,15 @@
 
 #include "Indicator.h"
 #include "Data/DataCenter.h"
+#include "Kernel/SeriesPyramid.h"
 
 namespace lei
 {
     class Volume : public Indicator
     {
     public:
-        explicit Volume(const std::function<const KArray& ()>& GetKArray);
+        // GetStride returns the bars per column of the chart, the scale fits the largest summed column.
+        Volume(const std::function<const KArray& ()>& GetKArray, const std::function<int()>& GetStride);
         ~Volume() override;
 
     public:
@@ -25,28 +27,31 @@ namespace lei
         void Draw(juce::Graphics& g,
                   juce::Rectangle<int> chart_bounds,
                   juce::Rectangle<int> label_bounds,
-                  int bar_width,
+                  const ViewportTransform& transform,
                   const juce::Range<int>& scroll_bar_current_range,
                   const std::pair<double, double>& min_max_label) override;
 
         void DrawWatchToolMessage(juce::Graphics& g, juce::Rectangle<int> chart_bounds, int k_index) override;
 
-    private:
-        static void DrawXGridAndLabel(juce::Graphics& g,
-                                      juce::Rectangle<int> chart_bounds,
-                                      juce::Rectangle<int> label_bounds,
-                                      unsigned long long max_volume);
-
+        // One bar per column showing the summed volume of its visible bars, read from the pyramid of the volume array.
         static void DrawVolumeBar(juce::Graphics& g,
                                   juce::Rectangle<int> chart_bounds,
-                                  const VolumeArray& volume_array,
+                                  const SeriesPyramid& volume_pyramid,
                                   const CloseArray& close_array,
                                   const juce::Range<int>& scroll_bar_current_range,
-                                  unsigned long long max_volume,
-                                  int bar_width);
+                                  double max_volume,
+                                  const ViewportTransform& transform);
+
+    private:
+        static void DrawXGridAndLabel(juce::Graphics& g,
+                                      juce::Rectangle<int> chart_bounds,
+                                      juce::Rectangle<int> label_bounds,
+                                      double max_volume);
 
     private:
         std::function<const KArray& ()> GetKArray_;
+        std::function<int()> GetStride_;
         std::pair<double, double> min_max_label_;
+        SeriesPyramid volume_pyramid_;
     };
 }
@@ -0,0 +1,108 @@
+// © 2023 Lei Cheng
+
+#include "DrawUtility.h"
+#include "Indicator/IndicatorType.h"
+#include "Render/TextCache.h"
+#include "VolumeProfile.h"
+
+namespace lei
+{
+    namespace
+    {
+        // The longest bin reaches this fraction of the chart width.
+        constexpr double kMaxWidthRatio = 0.25;
+    }
+
+    VolumeProfile::VolumeProfile(const std::function<const KArray& ()>& GetKArray) :
+        GetKArray_(GetKArray)
+    {
+        jassert(GetKArray_);
+    }
+
+    VolumeProfile::~VolumeProfile()
+    {
+    }
+
+    lei::IndicatorType VolumeProfile::GetIndicatorType() const
+    {
+        return IndicatorType::kVolumeProfile;
+    }
+
+    void VolumeProfile::StockChanged()
+    {
+        histogram_.Reset();
+        volume_array_.clear();
+        point_of_control_ = 0;
+    }
+
+    void VolumeProfile::Calculate(const juce::Range<int>& scroll_bar_current_range)
+    {
+        // Scrolling only costs a query over the bins, however many bars are visible.
+        const auto& k_array = GetKArray_();
+        histogram_.Update(k_array);
+        histogram_.Query(k_array, scroll_bar_current_range.getStart(), scroll_bar_current_range.getEnd(), volume_array_);
+        point_of_control_ = std::distance(volume_array_.begin(), std::max_element(volume_array_.begin(), volume_array_.end()));
+    }
+
+    std::pair<double, double> VolumeProfile::GetMinMaxLabelValue() const
+    {
+        // Follows the k chart scale instead of widening it.
+        return { std::numeric_limits<double>::max(), std::numeric_limits<double>::lowest() };
+    }
+
+    void VolumeProfile::Draw(juce::Graphics& g,
+                             juce::Rectangle<int> chart_bounds,
+                             juce::Rectangle<int> label_bounds,
+                             const ViewportTransform& transform,
+                             const juce::Range<int>& scroll_bar_current_range,
+                             const std::pair<double, double>& min_max_label)
+    {
+        if (volume_array_.empty() || min_max_label.first >= min_max_label.second)
+        {
+            return;
+        }
+
+        const auto max_volume = volume_array_[point_of_control_];
+        if (max_volume <= 0.0)
+        {
+            return;
+        }
+
+        juce::Graphics::ScopedSaveState raii(g);
+        g.reduceClipRegion(chart_bounds);
+
+        const auto ratio = chart_bounds.getHeight() / (min_max_label.second - min_max_label.first);
+        const auto width_ratio = chart_bounds.getWidth() * kMaxWidthRatio / max_volume;
+        for (std::size_t bin = 0; bin < volume_array_.size(); ++bin)
+        {
+            const auto bin_low = histogram_.GetBinLow(bin);
+            const auto bin_high = histogram_.GetBinHigh(bin);
+            if (volume_array_[bin] <= 0.0 || bin_low > min_max_label.second || bin_high < min_max_label.first)
+            {
+                continue;
+            }
+
+            const auto top = chart_bounds.getY() + (min_max_label.second - bin_high) * ratio;
+            const auto bottom = chart_bounds.getY() + (min_max_label.second - bin_low) * ratio;
+            const auto width = volume_array_[bin] * width_ratio;
+            g.setColour((bin == point_of_control_ ? juce::Colours::orange : juce::Colours::lightblue).withAlpha(0.35f));
+            g.fillRect(juce::Rectangle<double>(chart_bounds.getRight() - width, top, width, std::max(bottom - top - 1.0, 1.0)).toFloat());
+        }
+    }
+
+    void VolumeProfile::DrawWatchToolMessage(juce::Graphics& g, juce::Rectangle<int> chart_bounds, int k_index)
+    {
+        if (volume_array_.empty() || volume_array_[point_of_control_] <= 0.0)
+        {
+            return;
+        }
+
+        juce::Graphics::ScopedSaveState raii(g);
+        g.setColour(juce::Colours::orange);
+        g.setFont(GetWatchToolMessageFont());
+        chart_bounds.removeFromLeft(1);
+        DrawCachedText(g, juce::translate("volume profile") + " POC " + juce::String((histogram_.GetBinLow(point_of_control_) + histogram_.GetBinHigh(point_of_control_)) / 2, 2),
+                       chart_bounds,
+                       juce::Justification::topLeft);
+    }
+}
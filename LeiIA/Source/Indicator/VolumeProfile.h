@@ -0,0 +1,42 @@
+// © 2023 Lei Cheng
+
+#pragma once
+
+#include "Indicator.h"
+#include "Data/DataCenter.h"
+#include "Kernel/PriceHistogram.h"
+
+namespace lei
+{
+    // Volume by price of the visible bars, drawn from the right edge of the k chart with its price scale.
+    class VolumeProfile : public Indicator
+    {
+    public:
+        explicit VolumeProfile(const std::function<const KArray& ()>& GetKArray);
+        ~VolumeProfile() override;
+
+    public:
+        IndicatorType GetIndicatorType() const override;
+
+        void StockChanged() override;
+
+        void Calculate(const juce::Range<int>& scroll_bar_current_range) override;
+
+        std::pair<double, double> GetMinMaxLabelValue() const override;
+
+        void Draw(juce::Graphics& g,
+                  juce::Rectangle<int> chart_bounds,
+                  juce::Rectangle<int> label_bounds,
+                  const ViewportTransform& transform,
+                  const juce::Range<int>& scroll_bar_current_range,
+                  const std::pair<double, double>& min_max_label) override;
+
+        void DrawWatchToolMessage(juce::Graphics& g, juce::Rectangle<int> chart_bounds, int k_index) override;
+
+    private:
+        std::function<const KArray& ()> GetKArray_;
+        PriceHistogram histogram_;
+        std::vector<double> volume_array_;
+        std::size_t point_of_control_ = 0;
+    };
+}
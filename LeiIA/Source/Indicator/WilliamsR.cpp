@@ -0,0 +1,54 @@
+// © 2023 Lei Cheng
+
+#include "Indicator/IndicatorType.h"
+#include "Kernel/Rolling.h"
+#include "WilliamsR.h"
+
+namespace lei
+{
+    WilliamsR::WilliamsR(const std::function<const KArray& ()>& GetKArray, int period) :
+        StreamingIndicator(GetKArray,
+                           "W%R(" + juce::String(period) + ")",
+                           { { {}, juce::Colours::yellow, {} } },
+                           false,
+                           { -100, 0 },
+                           { -80, -50, -20 }),
+        period_(period)
+    {
+        jassert(period_ >= 1);
+    }
+
+    WilliamsR::~WilliamsR()
+    {
+    }
+
+    lei::IndicatorType WilliamsR::GetIndicatorType() const
+    {
+        return IndicatorType::kWilliamsR;
+    }
+
+    void WilliamsR::Extend(const KArray& k_array, std::size_t begin, std::size_t end)
+    {
+        const auto& high_array = std::get<2>(k_array);
+        const auto& low_array = std::get<3>(k_array);
+        const auto& close_array = std::get<4>(k_array);
+        highest_array_.resize(end);
+        lowest_array_.resize(end);
+
+        begin = std::max<std::size_t>(begin, period_ - 1);
+        if (begin >= end)
+        {
+            return;
+        }
+
+        RollingMax(high_array.data(), highest_array_.data(), begin, end, period_);
+        RollingMin(low_array.data(), lowest_array_.data(), begin, end, period_);
+
+        auto& r_array = lines_[0].value_array;
+        for (auto i = begin; i < end; ++i)
+        {
+            const auto range = highest_array_[i] - lowest_array_[i];
+            r_array[i] = range > 0 ? -100 * (highest_array_[i] - close_array[i]) / range : -50;
+        }
+    }
+}
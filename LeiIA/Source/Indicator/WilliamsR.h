@@ -0,0 +1,27 @@
+// © 2023 Lei Cheng
+
+#pragma once
+
+#include "StreamingIndicator.h"
+
+namespace lei
+{
+    // Williams %R: where the close sits in the high-low range of the window, from -100 to 0.
+    class WilliamsR : public StreamingIndicator
+    {
+    public:
+        WilliamsR(const std::function<const KArray& ()>& GetKArray, int period);
+        ~WilliamsR() override;
+
+    public:
+        IndicatorType GetIndicatorType() const override;
+
+    private:
+        void Extend(const KArray& k_array, std::size_t begin, std::size_t end) override;
+
+    private:
+        int period_;
+        std::vector<double> highest_array_;
+        std::vector<double> lowest_array_;
+    };
+}
@@ -3,9 +3,80 @@
 #include "KChart/KChart.h"
 #include "DrawUtility.h"
 #include "Layout.h"
+#include "Render/TextCache.h"
+#include <array>
+#include <span>
 
 namespace lei
 {
+    namespace
+    {
+        constexpr int kTimeLabelGap = 8;
+
+        // Coarser units follow the finest one, so a zoomed out chart moves on to months and years.
+        std::span<const TimeUnit> GetTimeGridUnits(DataFrequency frequency)
+        {
+            static constexpr std::array<TimeUnit, 2> kDayUnits = { TimeUnit::kMonth, TimeUnit::kYear };
+            static constexpr std::array<TimeUnit, 4> kMinuteUnits = { TimeUnit::kHour, TimeUnit::kDay, TimeUnit::kMonth, TimeUnit::kYear };
+            switch (frequency)
+            {
+            case DataFrequency::kDay:
+                return kDayUnits;
+            case DataFrequency::k1Min:
+                return kMinuteUnits;
+            default:
+                break;
+            }
+
+            return {};
+        }
+
+        // The bars that get a grid line and a time label. The unit is the finest one whose boundaries are on average a
+        // label apart at the current pitch, the boundaries that still come closer than a label, such as an hour after
+        // a market break, are skipped. The first visible bar never gets a line.
+        std::vector<int> GetTimeTicks(const DateTimeArray& date_time_array,
+                                      const TimeBoundaryIndex& time_boundaries,
+                                      const juce::Range<int>& scroll_bar_current_range,
+                                      const ViewportTransform& transform,
+                                      DataFrequency frequency)
+        {
+            const auto units = GetTimeGridUnits(frequency);
+            const auto begin = scroll_bar_current_range.getStart() + 1;
+            const auto end = scroll_bar_current_range.getEnd();
+            if (units.empty() || begin >= end)
+            {
+                return {};
+            }
+
+            // Labels of one format only differ in their digits, so the first one gives the width of all of them.
+            const auto label_width = GetCachedStringWidth(GetTimeLabelFont(), date_time_array[begin].formatted(GetTimeFormat(frequency))) + kTimeLabelGap;
+            auto boundaries = time_boundaries.GetBoundaries(units.back(), begin, end);
+            for (const auto unit : units)
+            {
+                const auto candidates = time_boundaries.GetBoundaries(unit, begin, end);
+                if (candidates.empty() || (end - begin) * transform.GetBarPitch() / candidates.size() >= label_width)
+                {
+                    boundaries = candidates;
+                    break;
+                }
+            }
+
+            std::vector<int> ticks;
+            auto next_x = -std::numeric_limits<float>::max();
+            for (const auto i : boundaries)
+            {
+                const auto x = transform.IndexToX(i);
+                if (x >= next_x)
+                {
+                    ticks.push_back(i);
+                    next_x = x + label_width;
+                }
+            }
+
+            return ticks;
+        }
+    }
+
     KChart::KChart()
     {
     }
@@ -58,7 +129,7 @@ namespace lei
         g.setFont(font);
 
         const int kXGap = 1;
-        g.drawText(header_string, header_bounds.reduced(kXGap, 0), juce::Justification::centredLeft, false);
+        DrawCachedText(g, header_string, header_bounds.reduced(kXGap, 0), juce::Justification::centredLeft);
     }
 
     void KChart::DrawBounds(juce::Graphics& g, juce::Rectangle<int> chart_bounds) const
@@ -70,40 +141,18 @@ namespace lei
 
     void KChart::DrawTimeGrid(juce::Graphics& g,
                               juce::Rectangle<int> chart_bounds,
-                              const DateTimeArray& date_time_array,
+                              const lei::DateTimeArray& date_time_array,
+                              const TimeBoundaryIndex& time_boundaries,
                               const juce::Range<int>& scroll_bar_current_range,
-                              int bar_width,
+                              const ViewportTransform& transform,
                               DataFrequency frequency) const
     {
         juce::Graphics::ScopedSaveState raii(g);
         g.setColour(juce::Colours::grey);
 
-        const auto begin = scroll_bar_current_range.getStart();
-        const auto end = scroll_bar_current_range.getEnd();
-        for (int i = begin; i < end; ++i)
+        for (const auto i : GetTimeTicks(date_time_array, time_boundaries, scroll_bar_current_range, transform, frequency))
         {
-            chart_bounds.removeFromLeft(kBarGap);
-            const auto bar_bounds = chart_bounds.removeFromLeft(bar_width);
-            if (frequency == lei::DataFrequency::kDay)
-            {
-                if (i == begin || date_time_array[i].getMonth() == date_time_array[i - 1].getMonth())
-                {
-                    continue;
-                }
-            }
-            else if (frequency == lei::DataFrequency::k1Min)
-            {
-                if (i == begin || date_time_array[i].getHours() == date_time_array[i - 1].getHours())
-                {
-                    continue;
-                }
-            }
-            else
-            {
-                continue;
-            }
-
-            g.drawVerticalLine(bar_bounds.getCentreX(), bar_bounds.getY(), bar_bounds.getBottom());
+            g.drawVerticalLine(static_cast<int>(std::floor(transform.IndexToX(i))), chart_bounds.getY(), chart_bounds.getBottom());
         }
     }
 
@@ -111,8 +160,9 @@ namespace lei
                                juce::Rectangle<int> chart_bounds,
                                const juce::Rectangle<int>& time_label_bounds,
                                const lei::DateTimeArray& date_time_array,
+                               const TimeBoundaryIndex& time_boundaries,
                                const juce::Range<int>& scroll_bar_current_range,
-                               int bar_width,
+                               const ViewportTransform& transform,
                                DataFrequency frequency) const
     {
         juce::Graphics::ScopedSaveState raii(g);
@@ -121,40 +171,16 @@ namespace lei
         const auto font = lei::GetTimeLabelFont();
         g.setFont(font);
 
-        const auto begin = scroll_bar_current_range.getStart();
-        const auto end = scroll_bar_current_range.getEnd();
-        for (int i = begin; i < end; ++i)
+        for (const auto i : GetTimeTicks(date_time_array, time_boundaries, scroll_bar_current_range, transform, frequency))
         {
-            chart_bounds.removeFromLeft(lei::kBarGap);
-            const auto bar_bounds = chart_bounds.removeFromLeft(bar_width);
-            if (frequency == lei::DataFrequency::kDay)
-            {
-                if (i == begin || date_time_array[i].getMonth() == date_time_array[i - 1].getMonth())
-                {
-                    continue;
-                }
-            }
-            else if (frequency == lei::DataFrequency::k1Min)
-            {
-                if (i == begin || date_time_array[i].getHours() == date_time_array[i - 1].getHours())
-                {
-                    continue;
-                }
-            }
-            else
-            {
-                continue;
-            }
-
             const auto label_string = date_time_array[i].formatted(GetTimeFormat(frequency));
-            const auto width = font.getStringWidthFloat(label_string);
-            g.drawText(label_string,
-                       juce::Rectangle<float>(bar_bounds.getCentreX() - width / 2,
-                                              time_label_bounds.getY(),
-                                              width,
-                                              time_label_bounds.getHeight()),
-                       juce::Justification::centred,
-                       false);
+            const auto width = GetCachedStringWidth(font, label_string);
+            DrawCachedText(g, label_string,
+                           juce::Rectangle<float>(transform.IndexToX(i) - width / 2,
+                                                  time_label_bounds.getY(),
+                                                  width,
+                                                  time_label_bounds.getHeight()),
+                           juce::Justification::centred);
         }
     }
 }
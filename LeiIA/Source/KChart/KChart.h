@@ -4,9 +4,12 @@
 
 #include <JuceHeader.h>
 #include "Data/DataCenter.h"
+#include "Data/TimeBoundaryIndex.h"
 
 namespace lei
 {
+    class ViewportTransform;
+
     class KChart
     {
     public:
@@ -28,19 +31,23 @@ namespace lei
 
         void DrawBounds(juce::Graphics& g, juce::Rectangle<int> chart_bounds) const;
 
+        // The grid lines and time labels share the boundaries of one unit, the finest one whose labels fit the pitch,
+        // thinned so that no two labels overlap.
         void DrawTimeGrid(juce::Graphics& g,
                           juce::Rectangle<int> chart_bounds,
-                          const DateTimeArray& date_time_array,
+                          const lei::DateTimeArray& date_time_array,
+                          const TimeBoundaryIndex& time_boundaries,
                           const juce::Range<int>& scroll_bar_current_range,
-                          int bar_width,
+                          const ViewportTransform& transform,
                           DataFrequency frequency) const;
 
         void DrawTimeLabel(juce::Graphics& g,
                            juce::Rectangle<int> chart_bounds,
                            const juce::Rectangle<int>& time_label_bounds,
                            const lei::DateTimeArray& date_time_array,
+                           const TimeBoundaryIndex& time_boundaries,
                            const juce::Range<int>& scroll_bar_current_range,
-                           int bar_width,
+                           const ViewportTransform& transform,
                            DataFrequency frequency) const;
     };
 }
@@ -0,0 +1,180 @@
+// © 2023 Lei Cheng
+
+#include "PriceHistogram.h"
+#include <cmath>
+
+namespace lei
+{
+    namespace
+    {
+        // Headroom above and below the history so that appended bars rarely force a rebuild.
+        constexpr double kRangeMargin = 0.05;
+
+        // Log bins need positive prices, a non-positive quote lands in the lowest bin.
+        constexpr double kMinPrice = 1e-6;
+
+        double ToLogPrice(double price)
+        {
+            return std::log(std::max(price, kMinPrice));
+        }
+    }
+
+    PriceHistogram::PriceHistogram(std::size_t bin_size, std::size_t block_size) :
+        bin_size_(bin_size),
+        block_size_(block_size)
+    {
+        jassert(bin_size_ > 0 && block_size_ > 0);
+    }
+
+    void PriceHistogram::Reset()
+    {
+        prefix_array_.clear();
+        total_array_.clear();
+        log_low_ = 0.0;
+        log_bin_height_ = 0.0;
+        low_ = 0.0;
+        high_ = 0.0;
+        size_ = 0;
+    }
+
+    void PriceHistogram::Update(const KArray& k_array)
+    {
+        const auto& high_array = std::get<2>(k_array);
+        const auto& low_array = std::get<3>(k_array);
+        const auto size = high_array.size();
+        if (size < size_)
+        {
+            Reset();
+        }
+
+        if (size_ == 0)
+        {
+            Rebuild(k_array);
+            return;
+        }
+
+        for (auto i = size_; i < size; ++i)
+        {
+            if (low_array[i] < low_ || high_array[i] > high_)
+            {
+                Rebuild(k_array);
+                return;
+            }
+        }
+
+        Append(k_array, size);
+    }
+
+    void PriceHistogram::Query(const KArray& k_array, std::size_t begin, std::size_t end, std::vector<double>& volume_array) const
+    {
+        volume_array.assign(bin_size_, 0.0);
+        end = std::min(end, size_);
+        if (begin >= end)
+        {
+            return;
+        }
+
+        const auto begin_block = begin / block_size_;
+        const auto end_block = end / block_size_;
+        const auto* begin_row = prefix_array_.data() + begin_block * bin_size_;
+        const auto* end_row = prefix_array_.data() + end_block * bin_size_;
+        for (std::size_t bin = 0; bin < bin_size_; ++bin)
+        {
+            volume_array[bin] = end_row[bin] - begin_row[bin];
+        }
+
+        for (auto i = end_block * block_size_; i < end; ++i)
+        {
+            AddBar(k_array, i, 1.0, volume_array.data());
+        }
+
+        for (auto i = begin_block * block_size_; i < begin; ++i)
+        {
+            AddBar(k_array, i, -1.0, volume_array.data());
+        }
+
+        // Subtracting rows leaves rounding noise where a bin is empty.
+        for (auto& volume : volume_array)
+        {
+            volume = std::max(volume, 0.0);
+        }
+    }
+
+    std::size_t PriceHistogram::GetBinSize() const
+    {
+        return bin_size_;
+    }
+
+    double PriceHistogram::GetBinLow(std::size_t bin) const
+    {
+        return std::exp(log_low_ + log_bin_height_ * bin);
+    }
+
+    double PriceHistogram::GetBinHigh(std::size_t bin) const
+    {
+        return GetBinLow(bin + 1);
+    }
+
+    std::size_t PriceHistogram::size() const
+    {
+        return size_;
+    }
+
+    void PriceHistogram::Rebuild(const KArray& k_array)
+    {
+        Reset();
+
+        const auto& high_array = std::get<2>(k_array);
+        const auto& low_array = std::get<3>(k_array);
+        if (high_array.empty())
+        {
+            return;
+        }
+
+        const auto log_low = ToLogPrice(*std::min_element(low_array.begin(), low_array.end()));
+        const auto log_high = ToLogPrice(*std::max_element(high_array.begin(), high_array.end()));
+        const auto margin = std::max((log_high - log_low) * kRangeMargin, std::log1p(kRangeMargin));
+        log_low_ = log_low - margin;
+        log_bin_height_ = (log_high - log_low + margin * 2) / bin_size_;
+        low_ = GetBinLow(0);
+        high_ = GetBinLow(bin_size_);
+
+        total_array_.assign(bin_size_, 0.0);
+        prefix_array_.reserve((high_array.size() / block_size_ + 1) * bin_size_);
+        prefix_array_.assign(bin_size_, 0.0);
+        Append(k_array, high_array.size());
+    }
+
+    void PriceHistogram::Append(const KArray& k_array, std::size_t size)
+    {
+        for (; size_ < size; ++size_)
+        {
+            AddBar(k_array, size_, 1.0, total_array_.data());
+            if ((size_ + 1) % block_size_ == 0)
+            {
+                prefix_array_.insert(prefix_array_.end(), total_array_.begin(), total_array_.end());
+            }
+        }
+    }
+
+    void PriceHistogram::AddBar(const KArray& k_array, std::size_t index, double sign, double* histogram) const
+    {
+        const auto volume = sign * static_cast<double>(std::get<5>(k_array)[index]);
+        const auto low = (ToLogPrice(std::get<3>(k_array)[index]) - log_low_) / log_bin_height_;
+        const auto high = (ToLogPrice(std::get<2>(k_array)[index]) - log_low_) / log_bin_height_;
+        const auto first = std::min(static_cast<std::size_t>(std::max(low, 0.0)), bin_size_ - 1);
+        const auto last = std::min(static_cast<std::size_t>(std::max(high, 0.0)), bin_size_ - 1);
+        if (first == last || high <= low)
+        {
+            histogram[first] += volume;
+            return;
+        }
+
+        const auto volume_per_bin = volume / (high - low);
+        for (auto bin = first; bin <= last; ++bin)
+        {
+            const auto overlap = std::min(high, bin + 1.0) - std::max(low, static_cast<double>(bin));
+            histogram[bin] += volume_per_bin * overlap;
+        }
+    }
+}
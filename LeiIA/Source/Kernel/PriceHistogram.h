@@ -0,0 +1,54 @@
+// © 2023 Lei Cheng
+
+#pragma once
+
+#include "Data/DataCenter.h"
+
+namespace lei
+{
+    // Volume per price bin for any bar range [begin, end). The bins split the log price range of the whole history evenly,
+    // so every bin spans the same percentage move whether the stock traded at 10 or at 1000, and a prefix histogram is
+    // kept every block_size bars, so a query subtracts two stored rows and patches the partial
+    // blocks at both ends: O(bin_size + block_size) whatever the range length.
+    class PriceHistogram final
+    {
+    public:
+        explicit PriceHistogram(std::size_t bin_size = 256, std::size_t block_size = 256);
+        ~PriceHistogram() = default;
+
+    public:
+        void Reset();
+
+        // Adds the bars appended since the last call. Rebuilds when the data shrank or a new bar leaves the price range.
+        void Update(const KArray& k_array);
+
+        void Query(const KArray& k_array, std::size_t begin, std::size_t end, std::vector<double>& volume_array) const;
+
+        std::size_t GetBinSize() const;
+
+        double GetBinLow(std::size_t bin) const;
+
+        double GetBinHigh(std::size_t bin) const;
+
+        std::size_t size() const;
+
+    private:
+        void Rebuild(const KArray& k_array);
+
+        void Append(const KArray& k_array, std::size_t size);
+
+        // A bar's volume is spread evenly over its log(low)..log(high) range.
+        void AddBar(const KArray& k_array, std::size_t index, double sign, double* histogram) const;
+
+    private:
+        std::size_t bin_size_;
+        std::size_t block_size_;
+        std::vector<double> prefix_array_;
+        std::vector<double> total_array_;
+        double log_low_ = 0.0;
+        double log_bin_height_ = 0.0;
+        double low_ = 0.0;
+        double high_ = 0.0;
+        std::size_t size_ = 0;
+    };
+}
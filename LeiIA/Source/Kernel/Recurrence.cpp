@@ -0,0 +1,122 @@
+// © 2023 Lei Cheng
+
+#include "Recurrence.h"
+#include "TaskScheduler.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace lei
+{
+    namespace
+    {
+        constexpr std::size_t kParallelScanMinSize = 1 << 15;
+
+        void SerialRecurrence(const double* input, double* output, std::size_t size, double multiplier, double gain, double initial)
+        {
+            auto value = initial;
+            for (std::size_t i = 0; i < size; ++i)
+            {
+                value = multiplier * value + gain * input[i];
+                output[i] = value;
+            }
+        }
+    }
+
+    AffineMap Compose(const AffineMap& first, const AffineMap& second)
+    {
+        return { first.multiplier * second.multiplier, first.offset * second.multiplier + second.offset };
+    }
+
+    void LinearRecurrence(const double* input, double* output, std::size_t size, double multiplier, double gain, double initial)
+    {
+        // Short scans, such as appending a few bars, and scans on a scheduler worker, such as a plan group or a screener
+        // symbol, run serially: the two-pass block scan only pays off when the blocks run side by side.
+        auto& scheduler = GetTaskScheduler();
+        if (size < kParallelScanMinSize || !scheduler.CanParallelize())
+        {
+            SerialRecurrence(input, output, size, multiplier, gain, initial);
+            return;
+        }
+
+        const auto block_count = std::min<std::size_t>(static_cast<std::size_t>(std::max(1, scheduler.GetConcurrency())), size / (kParallelScanMinSize / 4) + 1);
+        if (block_count < 2)
+        {
+            SerialRecurrence(input, output, size, multiplier, gain, initial);
+            return;
+        }
+
+        const auto block_size = (size + block_count - 1) / block_count;
+        std::vector<AffineMap> block_maps(block_count);
+
+        // Pass 1: every block scans from a zero state, block 0 starts from the real initial value.
+        scheduler.ParallelFor(block_count, [&](std::size_t block)
+                              {
+                                  const auto begin = std::min(block * block_size, size);
+                                  const auto end = std::min(begin + block_size, size);
+                                  SerialRecurrence(input + begin, output + begin, end - begin, multiplier, gain, block == 0 ? initial : 0);
+                                  block_maps[block] = { std::pow(multiplier, static_cast<double>(end - begin)), end > begin ? output[end - 1] : 0 };
+                              });
+
+        std::vector<double> carries(block_count);
+        AffineMap prefix{ 0, 0 };
+        for (std::size_t block = 0; block < block_count; ++block)
+        {
+            carries[block] = prefix.offset;
+            prefix = Compose(prefix, block_maps[block]);
+        }
+
+        // Pass 2: fold the carry of the preceding blocks into every block except the first.
+        scheduler.ParallelFor(block_count - 1, [&](std::size_t index)
+                              {
+                                  const auto block = index + 1;
+                                  const auto begin = std::min(block * block_size, size);
+                                  const auto end = std::min(begin + block_size, size);
+                                  auto carry = carries[block] * multiplier;
+                                  for (auto i = begin; i < end; ++i)
+                                  {
+                                      output[i] += carry;
+                                      carry *= multiplier;
+                                  }
+                              });
+    }
+
+    std::vector<double> EMA(const std::vector<double>& value_array, int period)
+    {
+        const auto size = value_array.size();
+        if (period <= 0 || period > static_cast<int>(size))
+        {
+            return {};
+        }
+
+        std::vector<double> ema(size, 0);
+        ema[period - 1] = std::accumulate(value_array.begin(), value_array.begin() + period, 0.0) / period;
+
+        const auto alpha = 2.0 / (period + 1);
+        LinearRecurrence(value_array.data() + period, ema.data() + period, size - period, 1 - alpha, alpha, ema[period - 1]);
+        return ema;
+    }
+
+    void WilderSmooth(const double* input, double* output, std::size_t begin, std::size_t end, int period)
+    {
+        if (period < 1)
+        {
+            return;
+        }
+
+        const auto head = static_cast<std::size_t>(period - 1);
+        begin = std::max(begin, head);
+        if (begin >= end)
+        {
+            return;
+        }
+
+        if (begin == head)
+        {
+            output[head] = std::accumulate(input, input + period, 0.0) / period;
+            ++begin;
+        }
+
+        LinearRecurrence(input + begin, output + begin, end - begin, (period - 1.0) / period, 1.0 / period, output[begin - 1]);
+    }
+}
@@ -0,0 +1,28 @@
+// © 2023 Lei Cheng
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace lei
+{
+    // y = multiplier * x + offset, composed left to right by the scan.
+    struct AffineMap
+    {
+        double multiplier = 1;
+        double offset = 0;
+    };
+
+    AffineMap Compose(const AffineMap& first, const AffineMap& second);
+
+    // output[i] = multiplier * output[i - 1] + gain * input[i], with output[-1] = initial.
+    void LinearRecurrence(const double* input, double* output, std::size_t size, double multiplier, double gain, double initial);
+
+    std::vector<double> EMA(const std::vector<double>& value_array, int period);
+
+    // Wilder's smoothing: output[period - 1] is the mean of the first period inputs, then
+    // output[i] = output[i - 1] + (input[i] - output[i - 1]) / period. Writes output[i] for i in [begin, end), begin
+    // is raised to period - 1, and a later begin continues from output[begin - 1].
+    void WilderSmooth(const double* input, double* output, std::size_t begin, std::size_t end, int period);
+}
@@ -0,0 +1,132 @@
+// © 2023 Lei Cheng
+
+#include "Rolling.h"
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+namespace lei
+{
+    namespace
+    {
+        // Monotonic queue of indices: the front is always the extremum of the current window, O(1) amortised per bar.
+        // Each index is pushed once, so a flat buffer with two cursors replaces std::deque.
+        template<typename Compare>
+        void RollingExtremum(const double* input, double* output, std::size_t begin, std::size_t end, int period, Compare compare)
+        {
+            if (begin >= end || period < 1 || begin + 1 < static_cast<std::size_t>(period))
+            {
+                return;
+            }
+
+            const auto first = begin + 1 - period;
+            std::vector<std::size_t> window(end - first);
+            std::size_t front = 0;
+            std::size_t back = 0;
+            for (auto i = first; i < end; ++i)
+            {
+                while (back != front && !compare(input[window[back - 1]], input[i]))
+                {
+                    --back;
+                }
+
+                window[back++] = i;
+                if (window[front] + period <= i)
+                {
+                    ++front;
+                }
+
+                if (i >= begin)
+                {
+                    output[i] = input[window[front]];
+                }
+            }
+        }
+    }
+
+    void RollingSum(const double* input, double* output, std::size_t begin, std::size_t end, int period)
+    {
+        if (begin >= end || period < 1 || begin + 1 < static_cast<std::size_t>(period))
+        {
+            return;
+        }
+
+        double sum = 0;
+        for (auto i = begin + 1 - period; i < begin; ++i)
+        {
+            sum += input[i];
+        }
+
+        for (auto i = begin; i < end; ++i)
+        {
+            sum += input[i];
+            output[i] = sum;
+            sum -= input[i + 1 - period];
+        }
+    }
+
+    void RollingMean(const double* input, double* output, std::size_t begin, std::size_t end, int period)
+    {
+        if (begin >= end || period < 1 || begin + 1 < static_cast<std::size_t>(period))
+        {
+            return;
+        }
+
+        RollingSum(input, output, begin, end, period);
+        for (auto i = begin; i < end; ++i)
+        {
+            output[i] /= period;
+        }
+    }
+
+    void RollingVariance(const double* input, double* output, std::size_t begin, std::size_t end, int period)
+    {
+        if (begin >= end || period < 1 || begin + 1 < static_cast<std::size_t>(period))
+        {
+            return;
+        }
+
+        // The sums are re-accumulated once per period around the current window, so the shift follows the price and
+        // the cost stays O(1) amortised per bar.
+        double shift = 0;
+        double sum = 0;
+        double square_sum = 0;
+        for (auto i = begin; i < end; ++i)
+        {
+            const auto first = i + 1 - period;
+            if ((i - begin) % period == 0)
+            {
+                shift = input[first];
+                sum = 0;
+                square_sum = 0;
+                for (auto j = first; j < i; ++j)
+                {
+                    const auto x = input[j] - shift;
+                    sum += x;
+                    square_sum += x * x;
+                }
+            }
+
+            const auto x = input[i] - shift;
+            sum += x;
+            square_sum += x * x;
+
+            const auto mean = sum / period;
+            output[i] = std::max(square_sum / period - mean * mean, 0.0);
+
+            const auto y = input[first] - shift;
+            sum -= y;
+            square_sum -= y * y;
+        }
+    }
+
+    void RollingMin(const double* input, double* output, std::size_t begin, std::size_t end, int period)
+    {
+        RollingExtremum(input, output, begin, end, period, std::less<double>());
+    }
+
+    void RollingMax(const double* input, double* output, std::size_t begin, std::size_t end, int period)
+    {
+        RollingExtremum(input, output, begin, end, period, std::greater<double>());
+    }
+}
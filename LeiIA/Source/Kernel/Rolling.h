@@ -0,0 +1,17 @@
+// © 2023 Lei Cheng
+
+#pragma once
+
+#include <cstddef>
+
+namespace lei
+{
+    // Rolling window kernels over full windows. They write output[i] for i in [begin, end), where the window of i is
+    // input[i + 1 - period .. i], so begin must be at least period - 1. Extending a series only costs the appended part.
+    void RollingSum(const double* input, double* output, std::size_t begin, std::size_t end, int period);
+    void RollingMean(const double* input, double* output, std::size_t begin, std::size_t end, int period);
+    // Population variance, accumulated around a value of the window to avoid cancellation at price scale.
+    void RollingVariance(const double* input, double* output, std::size_t begin, std::size_t end, int period);
+    void RollingMin(const double* input, double* output, std::size_t begin, std::size_t end, int period);
+    void RollingMax(const double* input, double* output, std::size_t begin, std::size_t end, int period);
+}
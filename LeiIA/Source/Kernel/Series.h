@@ -0,0 +1,250 @@
+// © 2023 Lei Cheng
+
+#pragma once
+
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <type_traits>
+
+namespace lei::series
+{
+    // Series expressions are stepped with strictly increasing indices, so stateful nodes such as Ema
+    // can be fused with element-wise stages into a single loop. Binary nodes step their left operand first.
+    struct ExpressionBase
+    {};
+
+    template<typename T>
+    concept Expression = std::is_base_of_v<ExpressionBase, std::remove_cvref_t<T>>;
+
+    struct ColumnExpression : ExpressionBase
+    {
+        const double* data;
+
+        double Step(std::size_t i)
+        {
+            return data[i];
+        }
+    };
+
+    struct ScalarExpression : ExpressionBase
+    {
+        double value;
+
+        double Step(std::size_t)
+        {
+            return value;
+        }
+    };
+
+    template<Expression L, Expression R, typename Op>
+    struct BinaryExpression : ExpressionBase
+    {
+        L left;
+        R right;
+
+        double Step(std::size_t i)
+        {
+            const auto left_value = left.Step(i);
+            const auto right_value = right.Step(i);
+            return Op{}(left_value, right_value);
+        }
+    };
+
+    template<Expression E, int Period>
+    struct EmaExpression : ExpressionBase
+    {
+        E input;
+        int period;
+        double sum = 0;
+        double value = 0;
+
+        double Step(std::size_t i)
+        {
+            const auto x = input.Step(i);
+            const auto current_period = GetPeriod();
+            if (i + 1 < static_cast<std::size_t>(current_period))
+            {
+                sum += x;
+                return 0;
+            }
+
+            if (i + 1 == static_cast<std::size_t>(current_period))
+            {
+                sum += x;
+                value = sum / current_period;
+                return value;
+            }
+
+            const auto alpha = 2.0 / (current_period + 1);
+            value = value * (1 - alpha) + x * alpha;
+            return value;
+        }
+
+        constexpr int GetPeriod() const
+        {
+            if constexpr (Period > 0)
+            {
+                return Period;
+            }
+            else
+            {
+                return period;
+            }
+        }
+    };
+
+    template<Expression E>
+    struct WarmupExpression : ExpressionBase
+    {
+        E input;
+        std::size_t count;
+        double fill;
+
+        double Step(std::size_t i)
+        {
+            const auto x = input.Step(i);
+            return i < count ? fill : x;
+        }
+    };
+
+    template<Expression E, typename T>
+    struct TapExpression : ExpressionBase
+    {
+        E input;
+        T* sink;
+
+        double Step(std::size_t i)
+        {
+            const auto x = input.Step(i);
+            sink[i] = static_cast<T>(x);
+            return x;
+        }
+    };
+
+    template<Expression E>
+    struct StoreExpression : ExpressionBase
+    {
+        E input;
+        double* slot;
+
+        double Step(std::size_t i)
+        {
+            *slot = input.Step(i);
+            return *slot;
+        }
+    };
+
+    struct LoadExpression : ExpressionBase
+    {
+        const double* slot;
+
+        double Step(std::size_t)
+        {
+            return *slot;
+        }
+    };
+
+    inline ColumnExpression Column(const double* data)
+    {
+        return { {}, data };
+    }
+
+    inline ScalarExpression Scalar(double value)
+    {
+        return { {}, value };
+    }
+
+    // Period is a compile-time constant when it is known, otherwise 0 and the runtime period is used.
+    template<int Period = 0, Expression E>
+    EmaExpression<std::remove_cvref_t<E>, Period> Ema(E&& input, int period = Period)
+    {
+        return { {}, std::forward<E>(input), period };
+    }
+
+    template<Expression E>
+    WarmupExpression<std::remove_cvref_t<E>> Warmup(E&& input, std::size_t count, double fill)
+    {
+        return { {}, std::forward<E>(input), count, fill };
+    }
+
+    // Stores every stepped value into sink, so an intermediate that is drawn is materialised in the same loop.
+    // The stepped value itself keeps double precision whatever the sink type is.
+    template<Expression E, typename T>
+    TapExpression<std::remove_cvref_t<E>, T> Tap(E&& input, T* sink)
+    {
+        return { {}, std::forward<E>(input), sink };
+    }
+
+    // Store keeps the latest double value of a shared stage in slot, a Load stepped after it reads it back.
+    template<Expression E>
+    StoreExpression<std::remove_cvref_t<E>> Store(E&& input, double* slot)
+    {
+        return { {}, std::forward<E>(input), slot };
+    }
+
+    inline LoadExpression Load(const double* slot)
+    {
+        return { {}, slot };
+    }
+
+    template<typename Op, Expression L, Expression R>
+    BinaryExpression<std::remove_cvref_t<L>, std::remove_cvref_t<R>, Op> MakeBinary(L&& left, R&& right)
+    {
+        return { {}, std::forward<L>(left), std::forward<R>(right) };
+    }
+
+    template<Expression L, Expression R>
+    auto operator+(L&& left, R&& right)
+    {
+        return MakeBinary<std::plus<>>(std::forward<L>(left), std::forward<R>(right));
+    }
+
+    template<Expression L, Expression R>
+    auto operator-(L&& left, R&& right)
+    {
+        return MakeBinary<std::minus<>>(std::forward<L>(left), std::forward<R>(right));
+    }
+
+    template<Expression L, Expression R>
+    auto operator*(L&& left, R&& right)
+    {
+        return MakeBinary<std::multiplies<>>(std::forward<L>(left), std::forward<R>(right));
+    }
+
+    template<Expression L, Expression R>
+    auto operator/(L&& left, R&& right)
+    {
+        return MakeBinary<std::divides<>>(std::forward<L>(left), std::forward<R>(right));
+    }
+
+    template<Expression E>
+    auto operator*(E&& expression, double value)
+    {
+        return MakeBinary<std::multiplies<>>(std::forward<E>(expression), Scalar(value));
+    }
+
+    template<Expression E>
+    auto operator*(double value, E&& expression)
+    {
+        return MakeBinary<std::multiplies<>>(Scalar(value), std::forward<E>(expression));
+    }
+
+    template<Expression E, typename T>
+    void Materialize(E expression, std::size_t size, T* output)
+    {
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            output[i] = static_cast<T>(expression.Step(i));
+        }
+    }
+
+    template<Expression E>
+    void Run(E expression, std::size_t size)
+    {
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            expression.Step(i);
+        }
+    }
+}
@@ -0,0 +1,96 @@
+// © 2023 Lei Cheng
+
+#include "SeriesPyramid.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace lei
+{
+    SeriesPyramid::Summary SeriesPyramid::Merge(const Summary& first, const Summary& second)
+    {
+        // fmin and fmax return the other operand for a NaN, so an empty side doesn't hide the other one.
+        return { std::fmin(first.min, second.min), std::fmax(first.max, second.max), first.sum + second.sum, first.finite_size + second.finite_size };
+    }
+
+    template<typename T>
+    void SeriesPyramid::Extend(const T* values, std::size_t size)
+    {
+        if (size < GetSize())
+        {
+            Clear();
+        }
+
+        if (levels_.empty())
+        {
+            levels_.emplace_back();
+        }
+
+        auto changed = GetSize();
+        if (size == changed)
+        {
+            return;
+        }
+
+        auto& leaves = levels_[0];
+        leaves.reserve(size);
+        for (auto i = changed; i < size; ++i)
+        {
+            const auto value = static_cast<double>(values[i]);
+            leaves.push_back(std::isfinite(value) ? Summary{ value, value, value, 1 } : Summary{});
+        }
+
+        // The last block of every level may have been partial, it is rebuilt with the blocks after it.
+        for (std::size_t level = 1; levels_[level - 1].size() > 1; ++level)
+        {
+            if (levels_.size() == level)
+            {
+                levels_.emplace_back();
+            }
+
+            const auto& children = levels_[level - 1];
+            auto& blocks = levels_[level];
+            changed /= 2;
+            blocks.resize((children.size() + 1) / 2);
+            for (auto i = changed; i < blocks.size(); ++i)
+            {
+                blocks[i] = 2 * i + 1 < children.size() ? Merge(children[2 * i], children[2 * i + 1]) : children[2 * i];
+            }
+        }
+    }
+
+    template void SeriesPyramid::Extend<float>(const float*, std::size_t);
+    template void SeriesPyramid::Extend<double>(const double*, std::size_t);
+    template void SeriesPyramid::Extend<unsigned long long>(const unsigned long long*, std::size_t);
+
+    void SeriesPyramid::Clear()
+    {
+        levels_.clear();
+    }
+
+    std::size_t SeriesPyramid::GetSize() const
+    {
+        return levels_.empty() ? 0 : levels_[0].size();
+    }
+
+    SeriesPyramid::Summary SeriesPyramid::Get(std::size_t begin, std::size_t end) const
+    {
+        Summary summary;
+        end = std::min(end, GetSize());
+        while (begin < end)
+        {
+            // The largest block starting at begin that is aligned and fits in the range.
+            auto level = static_cast<std::size_t>(std::bit_width(end - begin) - 1);
+            if (begin != 0)
+            {
+                level = std::min<std::size_t>(level, std::countr_zero(begin));
+            }
+
+            level = std::min(level, levels_.size() - 1);
+            summary = Merge(summary, levels_[level][begin >> level]);
+            begin += std::size_t(1) << level;
+        }
+
+        return summary;
+    }
+}
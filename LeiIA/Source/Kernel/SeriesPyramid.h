@@ -0,0 +1,43 @@
+// © 2023 Lei Cheng
+
+#pragma once
+
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+namespace lei
+{
+    // Min, max and sum of a series over aligned blocks of 2^level values. Chart columns are aligned blocks of stride
+    // values, so a column is a single lookup and any other range takes O(log size) blocks. Non-finite values are
+    // skipped. Extending the series only rebuilds the blocks that reach the appended values.
+    class SeriesPyramid final
+    {
+    public:
+        struct Summary
+        {
+            // NaN when the range holds no finite value.
+            double min = std::numeric_limits<double>::quiet_NaN();
+            double max = std::numeric_limits<double>::quiet_NaN();
+            double sum = 0;
+            std::size_t finite_size = 0;
+        };
+
+    public:
+        static Summary Merge(const Summary& first, const Summary& second);
+
+        // Appends values[GetSize() .. size), the values before GetSize() must be the ones added before. A shorter
+        // series rebuilds the pyramid. Instantiated for the stored indicator values and the volume.
+        template<typename T>
+        void Extend(const T* values, std::size_t size);
+
+        void Clear();
+
+        std::size_t GetSize() const;
+
+        Summary Get(std::size_t begin, std::size_t end) const;
+
+    private:
+        std::vector<std::vector<Summary>> levels_;
+    };
+}
@@ -0,0 +1,237 @@
+// © 2023 Lei Cheng
+
+#include "Simd.h"
+#include <JuceHeader.h>
+#include <functional>
+
+#if JUCE_INTEL
+ #include <immintrin.h>
+ #if defined(__GNUC__) || defined(__clang__)
+  #define LEI_AVX2_TARGET __attribute__((target("avx2")))
+ #else
+  #define LEI_AVX2_TARGET
+ #endif
+#endif
+
+namespace lei
+{
+    namespace
+    {
+        template<typename Op>
+        void BinaryScalar(const double* x, const double* y, double* output, std::size_t size, Op op)
+        {
+            for (std::size_t i = 0; i < size; ++i)
+            {
+                output[i] = op(x[i], y[i]);
+            }
+        }
+
+        void ScaleToRangeScalar(const double* value, const double* low, const double* high, double* output, std::size_t size, double scale, double flat_value)
+        {
+            for (std::size_t i = 0; i < size; ++i)
+            {
+                const auto range = high[i] - low[i];
+                output[i] = range != 0 ? (value[i] - low[i]) / range * scale : flat_value;
+            }
+        }
+
+        template<typename T>
+        void MapToPixelScalar(const T* value, double* output, std::size_t size, double origin, double top_value, double ratio)
+        {
+            for (std::size_t i = 0; i < size; ++i)
+            {
+                output[i] = origin + (top_value - value[i]) * ratio;
+            }
+        }
+
+#if JUCE_INTEL
+        constexpr std::size_t kLanes = 4;
+
+        LEI_AVX2_TARGET void AddAVX2(const double* x, const double* y, double* output, std::size_t size)
+        {
+            std::size_t i = 0;
+            for (; i + kLanes <= size; i += kLanes)
+            {
+                _mm256_storeu_pd(output + i, _mm256_add_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i)));
+            }
+
+            BinaryScalar(x + i, y + i, output + i, size - i, std::plus<double>());
+        }
+
+        LEI_AVX2_TARGET void SubtractAVX2(const double* x, const double* y, double* output, std::size_t size)
+        {
+            std::size_t i = 0;
+            for (; i + kLanes <= size; i += kLanes)
+            {
+                _mm256_storeu_pd(output + i, _mm256_sub_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i)));
+            }
+
+            BinaryScalar(x + i, y + i, output + i, size - i, std::minus<double>());
+        }
+
+        LEI_AVX2_TARGET void MultiplyAVX2(const double* x, const double* y, double* output, std::size_t size)
+        {
+            std::size_t i = 0;
+            for (; i + kLanes <= size; i += kLanes)
+            {
+                _mm256_storeu_pd(output + i, _mm256_mul_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i)));
+            }
+
+            BinaryScalar(x + i, y + i, output + i, size - i, std::multiplies<double>());
+        }
+
+        LEI_AVX2_TARGET void DivideAVX2(const double* x, const double* y, double* output, std::size_t size)
+        {
+            std::size_t i = 0;
+            for (; i + kLanes <= size; i += kLanes)
+            {
+                _mm256_storeu_pd(output + i, _mm256_div_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i)));
+            }
+
+            BinaryScalar(x + i, y + i, output + i, size - i, std::divides<double>());
+        }
+
+        LEI_AVX2_TARGET void ScaleToRangeAVX2(const double* value, const double* low, const double* high, double* output, std::size_t size, double scale, double flat_value)
+        {
+            const auto scale_v = _mm256_set1_pd(scale);
+            const auto flat_v = _mm256_set1_pd(flat_value);
+            const auto zero = _mm256_setzero_pd();
+            std::size_t i = 0;
+            for (; i + kLanes <= size; i += kLanes)
+            {
+                const auto low_v = _mm256_loadu_pd(low + i);
+                const auto range = _mm256_sub_pd(_mm256_loadu_pd(high + i), low_v);
+                const auto flat_mask = _mm256_cmp_pd(range, zero, _CMP_EQ_OQ);
+                const auto scaled = _mm256_mul_pd(_mm256_div_pd(_mm256_sub_pd(_mm256_loadu_pd(value + i), low_v), range), scale_v);
+                _mm256_storeu_pd(output + i, _mm256_blendv_pd(scaled, flat_v, flat_mask));
+            }
+
+            ScaleToRangeScalar(value + i, low + i, high + i, output + i, size - i, scale, flat_value);
+        }
+
+        LEI_AVX2_TARGET void MapToPixelAVX2(const double* value, double* output, std::size_t size, double origin, double top_value, double ratio)
+        {
+            const auto origin_v = _mm256_set1_pd(origin);
+            const auto top_v = _mm256_set1_pd(top_value);
+            const auto ratio_v = _mm256_set1_pd(ratio);
+            std::size_t i = 0;
+            for (; i + kLanes <= size; i += kLanes)
+            {
+                const auto offset = _mm256_mul_pd(_mm256_sub_pd(top_v, _mm256_loadu_pd(value + i)), ratio_v);
+                _mm256_storeu_pd(output + i, _mm256_add_pd(origin_v, offset));
+            }
+
+            MapToPixelScalar(value + i, output + i, size - i, origin, top_value, ratio);
+        }
+
+        LEI_AVX2_TARGET void MapToPixelAVX2(const float* value, double* output, std::size_t size, double origin, double top_value, double ratio)
+        {
+            const auto origin_v = _mm256_set1_pd(origin);
+            const auto top_v = _mm256_set1_pd(top_value);
+            const auto ratio_v = _mm256_set1_pd(ratio);
+            std::size_t i = 0;
+            for (; i + kLanes <= size; i += kLanes)
+            {
+                const auto offset = _mm256_mul_pd(_mm256_sub_pd(top_v, _mm256_cvtps_pd(_mm_loadu_ps(value + i))), ratio_v);
+                _mm256_storeu_pd(output + i, _mm256_add_pd(origin_v, offset));
+            }
+
+            MapToPixelScalar(value + i, output + i, size - i, origin, top_value, ratio);
+        }
+#endif
+    }
+
+    bool IsAVX2Enabled()
+    {
+#if JUCE_INTEL
+        static const bool enabled = juce::SystemStats::hasAVX2();
+        return enabled;
+#else
+        return false;
+#endif
+    }
+
+    void Add(const double* x, const double* y, double* output, std::size_t size)
+    {
+#if JUCE_INTEL
+        if (IsAVX2Enabled())
+        {
+            AddAVX2(x, y, output, size);
+            return;
+        }
+#endif
+        BinaryScalar(x, y, output, size, std::plus<double>());
+    }
+
+    void Subtract(const double* x, const double* y, double* output, std::size_t size)
+    {
+#if JUCE_INTEL
+        if (IsAVX2Enabled())
+        {
+            SubtractAVX2(x, y, output, size);
+            return;
+        }
+#endif
+        BinaryScalar(x, y, output, size, std::minus<double>());
+    }
+
+    void Multiply(const double* x, const double* y, double* output, std::size_t size)
+    {
+#if JUCE_INTEL
+        if (IsAVX2Enabled())
+        {
+            MultiplyAVX2(x, y, output, size);
+            return;
+        }
+#endif
+        BinaryScalar(x, y, output, size, std::multiplies<double>());
+    }
+
+    void Divide(const double* x, const double* y, double* output, std::size_t size)
+    {
+#if JUCE_INTEL
+        if (IsAVX2Enabled())
+        {
+            DivideAVX2(x, y, output, size);
+            return;
+        }
+#endif
+        BinaryScalar(x, y, output, size, std::divides<double>());
+    }
+
+    void ScaleToRange(const double* value, const double* low, const double* high, double* output, std::size_t size, double scale, double flat_value)
+    {
+#if JUCE_INTEL
+        if (IsAVX2Enabled())
+        {
+            ScaleToRangeAVX2(value, low, high, output, size, scale, flat_value);
+            return;
+        }
+#endif
+        ScaleToRangeScalar(value, low, high, output, size, scale, flat_value);
+    }
+
+    void MapToPixel(const double* value, double* output, std::size_t size, double origin, double top_value, double ratio)
+    {
+#if JUCE_INTEL
+        if (IsAVX2Enabled())
+        {
+            MapToPixelAVX2(value, output, size, origin, top_value, ratio);
+            return;
+        }
+#endif
+        MapToPixelScalar(value, output, size, origin, top_value, ratio);
+    }
+
+    void MapToPixel(const float* value, double* output, std::size_t size, double origin, double top_value, double ratio)
+    {
+#if JUCE_INTEL
+        if (IsAVX2Enabled())
+        {
+            MapToPixelAVX2(value, output, size, origin, top_value, ratio);
+            return;
+        }
+#endif
+        MapToPixelScalar(value, output, size, origin, top_value, ratio);
+    }
+}
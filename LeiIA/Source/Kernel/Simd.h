@@ -0,0 +1,24 @@
+// © 2023 Lei Cheng
+
+#pragma once
+
+#include <cstddef>
+
+namespace lei
+{
+    // Element-wise kernels, dispatched once to AVX2 or scalar code by runtime CPU detection.
+    bool IsAVX2Enabled();
+
+    // output[i] = x[i] + y[i], x[i] - y[i], x[i] * y[i] and x[i] / y[i]
+    void Add(const double* x, const double* y, double* output, std::size_t size);
+    void Subtract(const double* x, const double* y, double* output, std::size_t size);
+    void Multiply(const double* x, const double* y, double* output, std::size_t size);
+    void Divide(const double* x, const double* y, double* output, std::size_t size);
+
+    // output[i] = (value[i] - low[i]) / (high[i] - low[i]) * scale, or flat_value when high[i] == low[i]
+    void ScaleToRange(const double* value, const double* low, const double* high, double* output, std::size_t size, double scale, double flat_value);
+
+    // output[i] = origin + (top_value - value[i]) * ratio, the price to y pixel mapping of every pane.
+    void MapToPixel(const double* value, double* output, std::size_t size, double origin, double top_value, double ratio);
+    void MapToPixel(const float* value, double* output, std::size_t size, double origin, double top_value, double ratio);
+}
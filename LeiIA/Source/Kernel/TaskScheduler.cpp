@@ -0,0 +1,214 @@
+// © 2023 Lei Cheng
+
+#include "TaskScheduler.h"
+#include <algorithm>
+
+namespace lei
+{
+    namespace
+    {
+        constexpr std::size_t kChunksPerThread = 8;
+
+        thread_local bool inside_parallel_for = false;
+    }
+
+    TaskScheduler::TaskScheduler(int thread_size)
+    {
+        // queues_[0] belongs to the thread calling ParallelFor.
+        const auto worker_size = static_cast<std::size_t>(std::max(thread_size, 1) - 1);
+        for (std::size_t i = 0; i <= worker_size; ++i)
+        {
+            queues_.push_back(std::make_unique<WorkerQueue>());
+        }
+
+        for (std::size_t i = 1; i <= worker_size; ++i)
+        {
+            threads_.emplace_back(&TaskScheduler::WorkerLoop, this, i);
+        }
+    }
+
+    TaskScheduler::~TaskScheduler()
+    {
+        {
+            std::lock_guard<std::mutex> lock(wake_mutex_);
+            stop_ = true;
+        }
+
+        wake_.notify_all();
+        for (auto& thread : threads_)
+        {
+            thread.join();
+        }
+    }
+
+    void TaskScheduler::ParallelFor(std::size_t size, const std::function<void(std::size_t)>& task)
+    {
+        std::unique_lock<std::mutex> job_lock(job_mutex_, std::defer_lock);
+        if (threads_.empty() || size < 2 || inside_parallel_for || !job_lock.try_lock())
+        {
+            for (std::size_t i = 0; i < size; ++i)
+            {
+                task(i);
+            }
+
+            return;
+        }
+
+        inside_parallel_for = true;
+        task_ = &task;
+
+        const auto chunk_size = std::max<std::size_t>(1, size / (queues_.size() * kChunksPerThread));
+
+        // A worker still draining the previous job can take a chunk as soon as it is pushed, so pending_ is set first.
+        pending_ = (size + chunk_size - 1) / chunk_size;
+        std::size_t chunk_index = 0;
+        for (std::size_t begin = 0; begin < size; begin += chunk_size, ++chunk_index)
+        {
+            auto& queue = *queues_[chunk_index % queues_.size()];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.chunks.push_back({ begin, std::min(begin + chunk_size, size) });
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(wake_mutex_);
+            ++generation_;
+        }
+
+        wake_.notify_all();
+        while (RunChunk(0))
+        {
+        }
+
+        {
+            std::unique_lock<std::mutex> lock(wake_mutex_);
+            done_.wait(lock, [this]
+                       {
+                           return pending_ == 0;
+                       });
+        }
+
+        task_ = nullptr;
+        inside_parallel_for = false;
+    }
+
+    void TaskScheduler::Submit(std::function<void()> task)
+    {
+        if (threads_.empty())
+        {
+            task();
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(wake_mutex_);
+            submitted_.push_back(std::move(task));
+        }
+
+        wake_.notify_one();
+    }
+
+    int TaskScheduler::GetConcurrency() const
+    {
+        return static_cast<int>(queues_.size());
+    }
+
+    bool TaskScheduler::CanParallelize() const
+    {
+        return !threads_.empty() && !inside_parallel_for;
+    }
+
+    void TaskScheduler::WorkerLoop(std::size_t queue_index)
+    {
+        inside_parallel_for = true;
+
+        unsigned long long seen_generation = 0;
+        while (true)
+        {
+            std::function<void()> submitted;
+            {
+                std::unique_lock<std::mutex> lock(wake_mutex_);
+                wake_.wait(lock, [this, &seen_generation]
+                           {
+                               return stop_ || generation_ != seen_generation || !submitted_.empty();
+                           });
+
+                if (stop_)
+                {
+                    return;
+                }
+
+                seen_generation = generation_;
+                if (!submitted_.empty())
+                {
+                    submitted = std::move(submitted_.front());
+                    submitted_.pop_front();
+                }
+            }
+
+            while (RunChunk(queue_index))
+            {
+            }
+
+            // A submitted task is a caller of its own, its ParallelFor deals chunks to every worker including this one.
+            if (submitted)
+            {
+                inside_parallel_for = false;
+                submitted();
+                inside_parallel_for = true;
+            }
+        }
+    }
+
+    bool TaskScheduler::RunChunk(std::size_t queue_index)
+    {
+        Chunk chunk;
+        bool found = false;
+        for (std::size_t i = 0; i < queues_.size() && !found; ++i)
+        {
+            auto& queue = *queues_[(queue_index + i) % queues_.size()];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (queue.chunks.empty())
+            {
+                continue;
+            }
+
+            // Own work is taken LIFO for locality, stolen work FIFO so the victim keeps its hot end.
+            if (i == 0)
+            {
+                chunk = queue.chunks.back();
+                queue.chunks.pop_back();
+            }
+            else
+            {
+                chunk = queue.chunks.front();
+                queue.chunks.pop_front();
+            }
+
+            found = true;
+        }
+
+        if (!found)
+        {
+            return false;
+        }
+
+        for (auto i = chunk.begin; i < chunk.end; ++i)
+        {
+            (*task_)(i);
+        }
+
+        if (pending_.fetch_sub(1) == 1)
+        {
+            std::lock_guard<std::mutex> lock(wake_mutex_);
+            done_.notify_all();
+        }
+
+        return true;
+    }
+
+    TaskScheduler& GetTaskScheduler()
+    {
+        static TaskScheduler instance(static_cast<int>(std::max(1u, std::thread::hardware_concurrency())));
+        return instance;
+    }
+}
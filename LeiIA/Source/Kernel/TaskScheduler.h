@@ -0,0 +1,71 @@
+// © 2023 Lei Cheng
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace lei
+{
+    // Persistent worker pool. ParallelFor splits [0, size) into chunks dealt round-robin to per-thread deques; a thread
+    // pops its own chunks from the back and steals from the front of the others when it runs dry, so uneven tasks
+    // (symbols with 30 years of bars next to new listings) still finish together. The calling thread works as well.
+    class TaskScheduler final
+    {
+    public:
+        explicit TaskScheduler(int thread_size);
+        ~TaskScheduler();
+
+    public:
+        // Blocks until task has run for every index. Nested or concurrent calls run serially on the calling thread.
+        void ParallelFor(std::size_t size, const std::function<void(std::size_t)>& task);
+
+        // Runs task once on a worker and returns at once, or runs it on the calling thread if there are no workers. The
+        // task may call ParallelFor like any other thread. Tasks still queued when the scheduler is destroyed are dropped.
+        void Submit(std::function<void()> task);
+
+        int GetConcurrency() const;
+
+        // False on a worker or inside a ParallelFor task, where ParallelFor would run serially on this thread.
+        bool CanParallelize() const;
+
+    private:
+        struct Chunk
+        {
+            std::size_t begin = 0;
+            std::size_t end = 0;
+        };
+
+        struct WorkerQueue
+        {
+            std::mutex mutex;
+            std::deque<Chunk> chunks;
+        };
+
+    private:
+        void WorkerLoop(std::size_t queue_index);
+        bool RunChunk(std::size_t queue_index);
+
+    private:
+        std::vector<std::unique_ptr<WorkerQueue>> queues_;
+        std::vector<std::thread> threads_;
+
+        std::mutex job_mutex_;
+        std::mutex wake_mutex_;
+        std::condition_variable wake_;
+        std::condition_variable done_;
+        const std::function<void(std::size_t)>* task_ = nullptr;
+        std::deque<std::function<void()>> submitted_;
+        std::atomic<std::size_t> pending_ = 0;
+        unsigned long long generation_ = 0;
+        bool stop_ = false;
+    };
+
+    TaskScheduler& GetTaskScheduler();
+}
@@ -3,12 +3,17 @@
 #pragma once
 
 #include <string>
+#include <tuple>
 #include <utility>
 #include <functional>
 
 namespace lei
 {
     enum class DataFrequency;
+    enum class BarType;
+
+    // Drawing tools are anchored to bar times, which differ between candles, Renko and range bars of one stock.
+    using ToolKey = std::tuple<std::string, DataFrequency, BarType>;
 }
 
 template<>
@@ -22,3 +27,15 @@ struct std::hash<std::pair<std::string, lei::DataFrequency>>
         return h1 ^ (h2 + 0x9e3779b9 + (h1 << 6) + (h1 >> 2));
     }
 };
+
+template<>
+struct std::hash<lei::ToolKey>
+{
+    std::size_t operator()(const lei::ToolKey& key) const noexcept
+    {
+        auto h = std::hash<std::pair<std::string, lei::DataFrequency>>{}({ std::get<0>(key), std::get<1>(key) });
+        const auto h3 = std::hash<std::underlying_type_t<lei::BarType>>{}(static_cast<std::underlying_type_t<lei::BarType>>(std::get<2>(key)));
+
+        return h ^ (h3 + 0x9e3779b9 + (h << 6) + (h >> 2));
+    }
+};
@@ -4,18 +4,237 @@
 
 namespace lei
 {
+    namespace
+    {
+        template<typename T>
+        void AddSeriesLine(juce::Path& path,
+                           const T* value_array,
+                           const SeriesPyramid& pyramid,
+                           int begin,
+                           int end,
+                           double origin,
+                           double top_value,
+                           double ratio,
+                           const ViewportTransform& transform)
+        {
+            const auto ToY = [=](double value)
+            {
+                return static_cast<float>(origin + (top_value - value) * ratio);
+            };
+
+            bool first_point = true;
+            const auto stride = transform.GetStride();
+            for (auto column = transform.GetColumnStart(begin); column < end; column += stride)
+            {
+                const auto x = transform.IndexToX(column);
+                float first = 0.0f;
+                float low = 0.0f;
+                float high = 0.0f;
+                float last = 0.0f;
+                int size = 0;
+                const auto flush = [&]()
+                {
+                    if (size == 0)
+                    {
+                        return;
+                    }
+
+                    if (first_point)
+                    {
+                        path.startNewSubPath(x, first);
+                        first_point = false;
+                    }
+                    else
+                    {
+                        path.lineTo(x, first);
+                    }
+
+                    for (const auto y : { low, high })
+                    {
+                        if (y != first && y != last)
+                        {
+                            path.lineTo(x, y);
+                        }
+                    }
+
+                    if (size > 1)
+                    {
+                        path.lineTo(x, last);
+                    }
+
+                    size = 0;
+                };
+
+                const auto column_begin = std::max(column, begin);
+                const auto column_end = std::min(column + stride, end);
+                const auto summary = pyramid.Get(column_begin, column_end);
+                if (summary.finite_size == static_cast<std::size_t>(column_end - column_begin))
+                {
+                    // The y axis points down, the smallest y is the largest value.
+                    first = ToY(value_array[column_begin]);
+                    low = ToY(summary.max);
+                    high = ToY(summary.min);
+                    last = ToY(value_array[column_end - 1]);
+                    size = column_end - column_begin;
+                    flush();
+                    continue;
+                }
+
+                // Only a column with undefined bars is walked bar by bar, to break the line at them.
+                for (auto i = column_begin; i < column_end; ++i)
+                {
+                    if (!std::isfinite(static_cast<double>(value_array[i])))
+                    {
+                        flush();
+                        first_point = true;
+                        continue;
+                    }
+
+                    const auto y = ToY(value_array[i]);
+                    first = size == 0 ? y : first;
+                    low = size == 0 ? y : std::min(low, y);
+                    high = size == 0 ? y : std::max(high, y);
+                    last = y;
+                    ++size;
+                }
+
+                flush();
+            }
+        }
+    }
+
+    ChartLayout MakeChartLayout(juce::Rectangle<int> bounds, int subsidiary_chart_size)
+    {
+        ChartLayout layout;
+        layout.header = bounds.removeFromTop(kHeaderHeight);
+        layout.time_label = bounds.removeFromBottom(kTimeLabelHeight);
+
+        layout.charts = bounds;
+        layout.charts.removeFromLeft(kLeftLabelWidth);
+        layout.charts.removeFromRight(kRightLabelWidth);
+
+        const auto chart_height = bounds.getHeight();
+        layout.subsidiary_charts.resize(subsidiary_chart_size);
+        layout.subsidiary_labels.resize(subsidiary_chart_size);
+        for (int i = subsidiary_chart_size - 1; i >= 0; --i)
+        {
+            auto chart_bounds = bounds.removeFromBottom(chart_height * kSubsidiaryChartHeightPercentage / 100.0);
+            chart_bounds.removeFromTop(kChartGap);
+            chart_bounds.removeFromLeft(kLeftLabelWidth);
+            layout.subsidiary_labels[i] = chart_bounds.removeFromRight(kRightLabelWidth);
+            layout.subsidiary_charts[i] = chart_bounds;
+        }
+
+        layout.k_chart = bounds;
+        layout.k_chart.removeFromLeft(kLeftLabelWidth);
+        layout.k_price_label = layout.k_chart.removeFromRight(kRightLabelWidth);
+        return layout;
+    }
+
+    ViewportTransform::ViewportTransform(int origin_x, double first_position, float bar_pitch)
+        : origin_x_(origin_x)
+        , first_position_(first_position)
+        , bar_pitch_(bar_pitch)
+    {
+        jassert(bar_pitch > 0.0f);
+        while (bar_pitch_ * stride_ < kMinBarPitch)
+        {
+            stride_ *= 2;
+        }
+    }
+
+    double ViewportTransform::GetFirstPosition() const
+    {
+        return first_position_;
+    }
+
+    float ViewportTransform::GetBarPitch() const
+    {
+        return bar_pitch_;
+    }
+
+    int ViewportTransform::GetStride() const
+    {
+        return stride_;
+    }
+
+    int ViewportTransform::GetColumnStart(int index) const
+    {
+        return index - index % stride_;
+    }
+
+    float ViewportTransform::GetBarWidth() const
+    {
+        return std::max(bar_pitch_ * stride_ - kBarGap, 1.0f);
+    }
+
+    int ViewportTransform::GetVisibleBarCount(int chart_width) const
+    {
+        return std::max(static_cast<int>((chart_width - kBarGap) / bar_pitch_), 0);
+    }
+
+    juce::Range<float> ViewportTransform::GetBarRange(int index) const
+    {
+        const auto left = static_cast<float>(origin_x_ + kBarGap + (GetColumnStart(index) - first_position_) * bar_pitch_);
+        const auto snapped_left = std::round(left);
+        const auto snapped_right = std::max(std::round(left + GetBarWidth()), snapped_left + 1.0f);
+        return { snapped_left, snapped_right };
+    }
+
+    juce::Rectangle<float> ViewportTransform::GetBarBounds(int index, const juce::Rectangle<int>& chart_bounds) const
+    {
+        const auto range = GetBarRange(index);
+        return { range.getStart(), static_cast<float>(chart_bounds.getY()), range.getLength(), static_cast<float>(chart_bounds.getHeight()) };
+    }
+
+    float ViewportTransform::IndexToX(int index) const
+    {
+        const auto range = GetBarRange(index);
+        return (range.getStart() + range.getEnd()) / 2.0f;
+    }
+
+    int ViewportTransform::XToIndex(float x) const
+    {
+        return static_cast<int>(std::floor(first_position_ + (x - origin_x_ - kBarGap / 2.0) / bar_pitch_));
+    }
+
+    void AddLine(juce::Path& path,
+                 const double* value_array,
+                 const SeriesPyramid& pyramid,
+                 int begin,
+                 int end,
+                 double origin,
+                 double top_value,
+                 double ratio,
+                 const ViewportTransform& transform)
+    {
+        AddSeriesLine(path, value_array, pyramid, begin, end, origin, top_value, ratio, transform);
+    }
+
+    void AddLine(juce::Path& path,
+                 const float* value_array,
+                 const SeriesPyramid& pyramid,
+                 int begin,
+                 int end,
+                 double origin,
+                 double top_value,
+                 double ratio,
+                 const ViewportTransform& transform)
+    {
+        AddSeriesLine(path, value_array, pyramid, begin, end, origin, top_value, ratio, transform);
+    }
+
     juce::Time ToKTime(const juce::Point<int>& pt,
                        const std::function<const KArray& ()>& GetKArray,
                        const juce::Range<int>& scroll_bar_current_range,
-                       const juce::Rectangle<int>& chart_bounds,
-                       int bar_width)
+                       const ViewportTransform& transform)
     {
         if (scroll_bar_current_range.getLength() == 0)
         {
             return {};
         }
 
-        int index = scroll_bar_current_range.getStart() + (pt.getX() - chart_bounds.getX() - lei::kBarGap / 2.0) / (bar_width + lei::kBarGap);
+        auto index = transform.XToIndex(static_cast<float>(pt.getX()));
         index = std::max(index, scroll_bar_current_range.getStart());
         index = std::min(index, scroll_bar_current_range.getEnd() - 1);
         return std::get<0>(GetKArray())[index];
@@ -30,27 +249,18 @@ namespace lei
 
     int ToPositionX(const juce::Time& k_time,
                     const std::function<const KArray& ()>& GetKArray,
-                    const juce::Range<int>& scroll_bar_current_range,
-                    const juce::Rectangle<int>& chart_bounds,
-                    int bar_width)
+                    const ViewportTransform& transform)
     {
-        const auto& date_time_array = std::get<0>(GetKArray());
-        const auto index = std::distance(date_time_array.begin(), std::lower_bound(date_time_array.begin(), date_time_array.end(), k_time));
-        const auto distance = index - scroll_bar_current_range.getStart();
-        return chart_bounds.getX() + lei::kBarGap + distance * (bar_width + lei::kBarGap) + bar_width / 2.0; // don't use round to int, because bar_bounds.getCentreX in K::DrawKBar not use.
+        return ToPositionX(k_time, 0, GetKArray, transform);
     }
 
     int ToPositionX(const juce::Time& k_time,
                     int offsets,
                     const std::function<const KArray& ()>& GetKArray,
-                    const juce::Range<int>& scroll_bar_current_range,
-                    const juce::Rectangle<int>& chart_bounds,
-                    int bar_width)
+                    const ViewportTransform& transform)
     {
-        const auto& date_time_array = std::get<0>(GetKArray());
-        const auto index = std::distance(date_time_array.begin(), std::lower_bound(date_time_array.begin(), date_time_array.end(), k_time));
-        const auto distance = index + offsets - scroll_bar_current_range.getStart();
-        return chart_bounds.getX() + lei::kBarGap + distance * (bar_width + lei::kBarGap) + bar_width / 2.0; // don't use round to int, because bar_bounds.getCentreX in K::DrawKBar not use.
+        const auto index = KTimeToKIndex(k_time, GetKArray);
+        return static_cast<int>(std::floor(transform.IndexToX(index + offsets))); // don't use round to int, the wick of K::DrawKBar is the pixel left of the centre.
     }
 
     int ToPositionY(double price, const juce::Rectangle<int>& chart_bounds, const std::pair<double, double>& min_max_label)
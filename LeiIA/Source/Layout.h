@@ -4,6 +4,7 @@
 
 #include <JuceHeader.h>
 #include "Data/DataCenter.h"
+#include "Kernel/SeriesPyramid.h"
 
 namespace lei
 {
@@ -25,32 +26,111 @@ namespace lei
         kDataFrequencyButtonHeight = 28,
         kToolButtonWidth = 70,
         kToolButtonHeight = 28,
+        kIndicatorButtonWidth = 70,
+        kIndicatorButtonHeight = 28,
+        kScreenerButtonWidth = 70,
+        kScreenerButtonHeight = 28,
+        kBacktestButtonWidth = 70,
+        kBacktestButtonHeight = 28,
+        kLayoutButtonWidth = 70,
+        kLayoutButtonHeight = 28,
+        kMaxWorkspaceGridSize = 4,
+        kMinViewWidth = 360,
+        kMinViewHeight = 200,
         kChartBorderThickness = 1,
         kDefaultBarWidth = 11,
         kBarGap = 2,
+        kMinBarPitch = 5,
         kToolEraseButtonWidthHeight = 16
     };
 
+    // The chart panes of a window, each with its border: the header, the K chart with its price labels, the time
+    // labels and the subsidiary charts with theirs. charts spans the K chart and the subsidiary charts.
+    struct ChartLayout
+    {
+        juce::Rectangle<int> header;
+        juce::Rectangle<int> charts;
+        juce::Rectangle<int> time_label;
+        juce::Rectangle<int> k_chart;
+        juce::Rectangle<int> k_price_label;
+        std::vector<juce::Rectangle<int>> subsidiary_charts;
+        std::vector<juce::Rectangle<int>> subsidiary_labels;
+    };
+
+    // Lays the panes out in bounds, the window without its toolbar and widgets.
+    ChartLayout MakeChartLayout(juce::Rectangle<int> bounds, int subsidiary_chart_size);
+
+    // Maps bar indices to x and back for one frame in constant time. The pitch is the distance from a bar to the next
+    // one and may be fractional, bar bodies are snapped to whole pixels so their edges stay sharp at every zoom.
+    // Below kMinBarPitch, bars share columns of stride bars, aligned to multiples of the stride so that scrolling
+    // doesn't regroup them. Every bar of a column maps to the column, draw loops aggregate the bars of a column.
+    // The view may start between two bars, first_position is the fractional index at the origin, so zooming around a
+    // point keeps the bar under it in place.
+    class ViewportTransform final
+    {
+    public:
+        ViewportTransform() = default;
+        ViewportTransform(int origin_x, double first_position, float bar_pitch);
+
+    public:
+        double GetFirstPosition() const;
+        float GetBarPitch() const;
+        int GetStride() const;
+        int GetColumnStart(int index) const;
+        float GetBarWidth() const;
+        int GetVisibleBarCount(int chart_width) const;
+
+        juce::Range<float> GetBarRange(int index) const;
+        juce::Rectangle<float> GetBarBounds(int index, const juce::Rectangle<int>& chart_bounds) const;
+        float IndexToX(int index) const;
+        int XToIndex(float x) const;
+
+    private:
+        int origin_x_ = 0;
+        double first_position_ = 0.0;
+        float bar_pitch_ = kDefaultBarWidth + kBarGap;
+        int stride_ = 1;
+    };
+
+    // Adds the line through bars begin .. end of value_array to path with one x per column, a value maps to
+    // origin + (top_value - value) * ratio like MapToPixel. Bars sharing a column add a vertical stroke over their
+    // extremes, read from pyramid, the pyramid of value_array, so no spike is dropped and a frame costs the visible
+    // columns rather than the visible bars. Non-finite values break the line.
+    void AddLine(juce::Path& path,
+                 const double* value_array,
+                 const SeriesPyramid& pyramid,
+                 int begin,
+                 int end,
+                 double origin,
+                 double top_value,
+                 double ratio,
+                 const ViewportTransform& transform);
+
+    void AddLine(juce::Path& path,
+                 const float* value_array,
+                 const SeriesPyramid& pyramid,
+                 int begin,
+                 int end,
+                 double origin,
+                 double top_value,
+                 double ratio,
+                 const ViewportTransform& transform);
+
     juce::Time ToKTime(const juce::Point<int>& pt,
                        const std::function<const KArray& ()>& GetKArray,
                        const juce::Range<int>& scroll_bar_current_range,
-                       const juce::Rectangle<int>& chart_bounds,
-                       int bar_width);
+                       const ViewportTransform& transform);
 
     double ToPrice(const juce::Point<int>& pt, const juce::Rectangle<int>& chart_bounds, const std::pair<double, double>& min_max_label);
 
     int ToPositionX(const juce::Time& k_time,
                     const std::function<const KArray& ()>& GetKArray,
-                    const juce::Range<int>& scroll_bar_current_range,
-                    const juce::Rectangle<int>& chart_bounds,
-                    int bar_width);
+                    const ViewportTransform& transform);
 
     int ToPositionX(const juce::Time& k_time,
                     int offsets,
                     const std::function<const KArray& ()>& GetKArray,
-                    const juce::Range<int>& scroll_bar_current_range,
-                    const juce::Rectangle<int>& chart_bounds,
-                    int bar_width);
+                    const ViewportTransform& transform);
 
     int ToPositionY(double price, const juce::Rectangle<int>& chart_bounds, const std::pair<double, double>& min_max_label);
     int KTimeToKIndex(const juce::Time& k_time, const std::function<const KArray& ()>& GetKArray);
@@ -7,8 +7,25 @@
 */
 
 #include <JuceHeader.h>
-#include "MainComponent.h"
 #include "MainMenu.h"
+#include "Backtest/Backtest.h"
+#include "Backtest/Optimizer.h"
+#include "Benchmark/IndicatorBenchmark.h"
+#include "Benchmark/RenderBenchmark.h"
+#include "DrawUtility.h"
+#include "Pattern/CandlestickScanner.h"
+#include "Portfolio/Correlation.h"
+#include "Screener/Screener.h"
+#include "Test/SelfTest.h"
+#include "Workspace.h"
+#include <iostream>
+
+#if JUCE_WINDOWS
+ #ifndef NOMINMAX
+  #define NOMINMAX
+ #endif
+ #include <windows.h>
+#endif
 
 //==============================================================================
 class LeiIAApplication : public juce::JUCEApplication
@@ -25,6 +42,89 @@ public:
     void initialise(const juce::String& commandLine) override
     {
         // This method is where you should put your application's initialisation code..
+        // Headless runs:
+        // LeiIA --screen "C > MA(C, 22)" [--rank "V"] [--frequency min]
+        // LeiIA --backtest 2330.tw --entry "CROSS(MA(C, 5), MA(C, 22))" --exit "CROSS(MA(C, 22), MA(C, 5))" [--fill close] [--frequency min]
+        // LeiIA --optimize sweep.csv --entry "CROSS(MA(C, {fast}), MA(C, {slow}))" --exit "CROSS(MA(C, {slow}), MA(C, {fast}))"
+        //       --parameters "fast=3:20:1,slow=10:120:2" [--stocks "2330.tw,2317.tw"] [--random 5000] [--fill close] [--frequency min]
+        // LeiIA --correlation matrix.csv [--stocks "2330.tw,2317.tw"] [--window 250] [--covariance] [--rolling rolling.csv]
+        // LeiIA --patterns hits.csv [--stocks "2330.tw,2317.tw"] [--last 1] [--frequency min]
+        // LeiIA --benchmark-indicators [--bars 1000000]
+        // LeiIA --benchmark-render [--bars 10000]
+        // LeiIA --benchmark-charts [--stocks "2330.tw,2308.tw"] [--frequency min] [--frames 30]
+        // LeiIA --self-test
+        // On Linux the Builds/LinuxMakefile target prints to the terminal as is.
+        const juce::ArgumentList arguments(getApplicationName(), commandLine);
+        if (arguments.size() > 0)
+        {
+            AttachToParentConsole();
+        }
+
+        if (arguments.containsOption("--screen"))
+        {
+            setApplicationReturnValue(Screen(arguments));
+            quit();
+            return;
+        }
+
+        if (arguments.containsOption("--backtest"))
+        {
+            setApplicationReturnValue(Backtest(arguments));
+            quit();
+            return;
+        }
+
+        if (arguments.containsOption("--optimize"))
+        {
+            setApplicationReturnValue(Optimize(arguments));
+            quit();
+            return;
+        }
+
+        if (arguments.containsOption("--correlation"))
+        {
+            setApplicationReturnValue(Correlate(arguments));
+            quit();
+            return;
+        }
+
+        if (arguments.containsOption("--patterns"))
+        {
+            setApplicationReturnValue(Patterns(arguments));
+            quit();
+            return;
+        }
+
+        if (arguments.containsOption("--benchmark-indicators"))
+        {
+            const auto bar_size = arguments.containsOption("--bars") ? arguments.getValueForOption("--bars").getLargeIntValue() : 1000000;
+            setApplicationReturnValue(lei::RunIndicatorBenchmark(static_cast<std::size_t>(std::max<juce::int64>(bar_size, 1)), std::cout));
+            quit();
+            return;
+        }
+
+        if (arguments.containsOption("--benchmark-render"))
+        {
+            const auto bar_size = arguments.containsOption("--bars") ? arguments.getValueForOption("--bars").getLargeIntValue() : 10000;
+            setApplicationReturnValue(lei::RunRenderBenchmark(static_cast<std::size_t>(std::max<juce::int64>(bar_size, 1)), std::cout));
+            quit();
+            return;
+        }
+
+        if (arguments.containsOption("--benchmark-charts"))
+        {
+            setApplicationReturnValue(BenchmarkCharts(arguments));
+            quit();
+            return;
+        }
+
+        if (arguments.containsOption("--self-test"))
+        {
+            setApplicationReturnValue(lei::RunSelfTest(std::cout));
+            quit();
+            return;
+        }
+
         juce::LookAndFeel::getDefaultLookAndFeel().setDefaultSansSerifTypefaceName("Microsoft JhengHei");
 
         mainWindow.reset(new MainWindow(getApplicationName()));
@@ -55,7 +155,7 @@ public:
     //==============================================================================
     /*
         This class implements the desktop window that contains an instance of
-        our MainComponent class.
+        our Workspace class.
     */
     class MainWindow : public juce::DocumentWindow
     {
@@ -70,7 +170,7 @@ public:
 
             setUsingNativeTitleBar(true);
             //setMenuBar(&main_menu_);
-            setContentOwned(new MainComponent(), true);
+            setContentOwned(new Workspace(), true);
 
 #if JUCE_IOS || JUCE_ANDROID
             setFullScreen(true);
@@ -109,6 +209,284 @@ public:
         JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MainWindow)
     };
 
+private:
+    // The Windows build links to the GUI subsystem and has no console of its own, a headless run writes to the one it
+    // was started from.
+    static void AttachToParentConsole()
+    {
+#if JUCE_WINDOWS
+        if (AttachConsole(ATTACH_PARENT_PROCESS))
+        {
+            FILE* stream = nullptr;
+            freopen_s(&stream, "CONOUT$", "w", stdout);
+            freopen_s(&stream, "CONOUT$", "w", stderr);
+        }
+#endif
+    }
+
+    int Screen(const juce::ArgumentList& arguments)
+    {
+        lei::Screener screener;
+        auto result = screener.SetCondition(arguments.getValueForOption("--screen"));
+        if (result.wasOk())
+        {
+            result = screener.SetRank(arguments.getValueForOption("--rank"));
+        }
+
+        if (result.failed())
+        {
+            std::cerr << result.getErrorMessage() << std::endl;
+            return 1;
+        }
+
+        const auto frequency = arguments.getValueForOption("--frequency").equalsIgnoreCase("min") ? lei::DataFrequency::k1Min : lei::DataFrequency::kDay;
+        for (const auto& match : screener.Run(lei::GetKDataCenter().GetStockIds(frequency), frequency))
+        {
+            std::cout << match.stock_id << '\t' << match.close << '\t' << match.score << '\n';
+        }
+
+        return 0;
+    }
+
+    int Backtest(const juce::ArgumentList& arguments)
+    {
+        lei::Backtester backtester;
+        auto result = backtester.SetEntry(arguments.getValueForOption("--entry"));
+        if (result.wasOk())
+        {
+            result = backtester.SetExit(arguments.getValueForOption("--exit"));
+        }
+
+        if (result.failed())
+        {
+            std::cerr << result.getErrorMessage() << std::endl;
+            return 1;
+        }
+
+        lei::BacktestSettings settings;
+        settings.fill_price = arguments.getValueForOption("--fill").equalsIgnoreCase("close") ? lei::FillPrice::kClose : lei::FillPrice::kNextOpen;
+
+        const auto frequency = arguments.getValueForOption("--frequency").equalsIgnoreCase("min") ? lei::DataFrequency::k1Min : lei::DataFrequency::kDay;
+        const auto& k_array = lei::GetKDataCenter().GetKData(arguments.getValueForOption("--backtest").toStdString(), frequency);
+        const auto& date_time_array = std::get<0>(k_array);
+        const auto backtest = backtester.Run(k_array, settings);
+
+        for (const auto& trade : backtest.trades)
+        {
+            std::cout << date_time_array[trade.entry_index].toString(true, false) << '\t' << trade.entry_price << '\t'
+                      << date_time_array[trade.exit_index].toString(true, false) << '\t' << trade.exit_price << '\t'
+                      << trade.shares << '\t' << trade.cost << '\t' << trade.profit << '\n';
+        }
+
+        std::cout << "final equity\t" << backtest.final_equity << "\nmax drawdown\t" << backtest.max_drawdown << '\n';
+        return 0;
+    }
+
+    int Optimize(const juce::ArgumentList& arguments)
+    {
+        lei::Optimizer optimizer;
+        optimizer.SetStrategy(arguments.getValueForOption("--entry"), arguments.getValueForOption("--exit"));
+
+        for (const auto& parameter : juce::StringArray::fromTokens(arguments.getValueForOption("--parameters"), ",", {}))
+        {
+            const auto range = juce::StringArray::fromTokens(parameter.fromFirstOccurrenceOf("=", false, false), ":", {});
+            if (range.size() < 2)
+            {
+                std::cerr << "bad parameter " << parameter << std::endl;
+                return 1;
+            }
+
+            optimizer.AddParameter(parameter.upToFirstOccurrenceOf("=", false, false).trim(),
+                                   range[0].getIntValue(),
+                                   range[1].getIntValue(),
+                                   range.size() > 2 ? range[2].getIntValue() : 1);
+        }
+
+        if (arguments.containsOption("--random"))
+        {
+            optimizer.SetRandomSearch(arguments.getValueForOption("--random").getIntValue(), juce::Time::currentTimeMillis());
+        }
+
+        lei::BacktestSettings settings;
+        settings.fill_price = arguments.getValueForOption("--fill").equalsIgnoreCase("close") ? lei::FillPrice::kClose : lei::FillPrice::kNextOpen;
+
+        const auto frequency = arguments.getValueForOption("--frequency").equalsIgnoreCase("min") ? lei::DataFrequency::k1Min : lei::DataFrequency::kDay;
+        std::vector<std::string> stock_ids;
+        for (const auto& stock_id : juce::StringArray::fromTokens(arguments.getValueForOption("--stocks"), ",", {}))
+        {
+            stock_ids.push_back(stock_id.trim().toStdString());
+        }
+
+        if (stock_ids.empty())
+        {
+            stock_ids = lei::GetKDataCenter().GetStockIds(frequency);
+        }
+
+        const auto result = optimizer.Run(stock_ids, frequency, settings, juce::File::getCurrentWorkingDirectory().getChildFile(arguments.getValueForOption("--optimize")));
+        if (result.failed())
+        {
+            std::cerr << result.getErrorMessage() << std::endl;
+            return 1;
+        }
+
+        return 0;
+    }
+
+    int Correlate(const juce::ArgumentList& arguments)
+    {
+        std::vector<std::string> stock_ids;
+        for (const auto& stock_id : juce::StringArray::fromTokens(arguments.getValueForOption("--stocks"), ",", {}))
+        {
+            stock_ids.push_back(stock_id.trim().toStdString());
+        }
+
+        if (stock_ids.empty())
+        {
+            stock_ids = lei::GetKDataCenter().GetStockIds(lei::DataFrequency::kDay);
+        }
+
+        // Without --window the matrix covers every common date, otherwise only the last window of returns.
+        const auto returns = lei::BuildReturnMatrix(stock_ids, lei::DataFrequency::kDay);
+        const auto date_size = returns.GetDateSize();
+        const auto window = arguments.containsOption("--window") ? static_cast<std::size_t>(arguments.getValueForOption("--window").getIntValue()) : date_size;
+        auto matrix = lei::Covariance(returns, date_size - std::min(window, date_size), date_size);
+        if (!arguments.containsOption("--covariance"))
+        {
+            matrix = lei::ToCorrelation(matrix, returns.GetSymbolSize());
+        }
+
+        const auto output_file = juce::File::getCurrentWorkingDirectory().getChildFile(arguments.getValueForOption("--correlation"));
+        output_file.deleteFile();
+        juce::FileOutputStream output(output_file);
+        if (output.failedToOpen())
+        {
+            std::cerr << output.getStatus().getErrorMessage() << std::endl;
+            return 1;
+        }
+
+        const auto n = returns.GetSymbolSize();
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            output << "," << returns.stock_ids[i];
+        }
+
+        output << "\n";
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            juce::String row(returns.stock_ids[i]);
+            for (std::size_t j = 0; j < n; ++j)
+            {
+                row << "," << juce::String(matrix[i * n + j], 6);
+            }
+
+            output << row << "\n";
+        }
+
+        // --rolling also writes, for every date once the window is full, the value of each symbol against the first.
+        if (arguments.containsOption("--rolling") && n > 0)
+        {
+            const auto rolling_file = juce::File::getCurrentWorkingDirectory().getChildFile(arguments.getValueForOption("--rolling"));
+            rolling_file.deleteFile();
+            juce::FileOutputStream rolling_output(rolling_file);
+            if (rolling_output.failedToOpen())
+            {
+                std::cerr << rolling_output.getStatus().getErrorMessage() << std::endl;
+                return 1;
+            }
+
+            rolling_output << "date";
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                rolling_output << "," << returns.stock_ids[i];
+            }
+
+            rolling_output << "\n";
+
+            const auto rolling_window = std::max<std::size_t>(std::min(window, date_size), 2);
+            lei::RollingCovariance rolling(n, rolling_window);
+            for (std::size_t t = 0; t < date_size; ++t)
+            {
+                rolling.Add(returns.values.data() + t * n);
+                if (rolling.GetSize() < rolling_window)
+                {
+                    continue;
+                }
+
+                const auto rolling_matrix = arguments.containsOption("--covariance") ? rolling.GetCovariance() : rolling.GetCorrelation();
+                juce::String row(returns.dates[t].formatted(lei::GetTimeFormat(lei::DataFrequency::kDay)));
+                for (std::size_t i = 0; i < n; ++i)
+                {
+                    row << "," << juce::String(rolling_matrix[i], 6);
+                }
+
+                rolling_output << row << "\n";
+            }
+        }
+
+        return 0;
+    }
+
+    int Patterns(const juce::ArgumentList& arguments)
+    {
+        const auto frequency = arguments.getValueForOption("--frequency").equalsIgnoreCase("min") ? lei::DataFrequency::k1Min : lei::DataFrequency::kDay;
+        std::vector<std::string> stock_ids;
+        for (const auto& stock_id : juce::StringArray::fromTokens(arguments.getValueForOption("--stocks"), ",", {}))
+        {
+            stock_ids.push_back(stock_id.trim().toStdString());
+        }
+
+        if (stock_ids.empty())
+        {
+            stock_ids = lei::GetKDataCenter().GetStockIds(frequency);
+        }
+
+        const auto last_size = arguments.containsOption("--last") ? std::max(arguments.getValueForOption("--last").getIntValue(), 1) : 1;
+        const auto hits = lei::ScanPatterns(stock_ids, frequency, static_cast<std::size_t>(last_size));
+
+        const auto output_file = juce::File::getCurrentWorkingDirectory().getChildFile(arguments.getValueForOption("--patterns"));
+        output_file.deleteFile();
+        juce::FileOutputStream output(output_file);
+        if (output.failedToOpen())
+        {
+            std::cerr << output.getStatus().getErrorMessage() << std::endl;
+            return 1;
+        }
+
+        output << "stock_id,date,pattern,direction\n";
+        for (const auto& hit : hits)
+        {
+            output << hit.stock_id << "," << hit.date_time.formatted(lei::GetTimeFormat(frequency)) << "," << lei::GetPatternName(hit.pattern) << ","
+                   << lei::GetPatternDirection(hit.pattern) << "\n";
+        }
+
+        std::cout << hits.size() << " pattern hits in " << stock_ids.size() << " symbols" << std::endl;
+        return 0;
+    }
+
+    int BenchmarkCharts(const juce::ArgumentList& arguments)
+    {
+        const auto frequency = arguments.getValueForOption("--frequency").equalsIgnoreCase("min") ? lei::DataFrequency::k1Min : lei::DataFrequency::kDay;
+        std::vector<std::string> stock_ids;
+        for (const auto& stock_id : juce::StringArray::fromTokens(arguments.getValueForOption("--stocks"), ",", {}))
+        {
+            stock_ids.push_back(stock_id.trim().toStdString());
+        }
+
+        if (stock_ids.empty())
+        {
+            stock_ids = lei::GetKDataCenter().GetStockIds(frequency);
+        }
+
+        const auto frame_size = arguments.containsOption("--frames") ? std::max(arguments.getValueForOption("--frames").getIntValue(), 1) : 30;
+        if (lei::RunChartBenchmark(stock_ids, frequency, frame_size, std::cout) != 0)
+        {
+            std::cerr << "no bars for the stocks, run from the folder with the tw data" << std::endl;
+            return 1;
+        }
+
+        return 0;
+    }
+
 private:
     std::unique_ptr<MainWindow> mainWindow;
 };
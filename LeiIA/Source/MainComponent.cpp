@@ -1,42 +1,55 @@
 // © 2023 Lei Cheng
 
 #include "MainComponent.h"
+#include "Backtest/Backtest.h"
+#include "Data/DerivedBars.h"
 #include "DrawUtility.h"
+#include "Indicator/ATR.h"
+#include "Indicator/BollingerBands.h"
+#include "Indicator/CCI.h"
+#include "Indicator/DMI.h"
+#include "Indicator/ExpressionIndicator.h"
+#include "Indicator/IndicatorType.h"
 #include "Indicator/K.h"
 #include "Indicator/KD.h"
 #include "Indicator/MA.h"
 #include "Indicator/MACD.h"
+#include "Indicator/OBV.h"
+#include "Indicator/RSI.h"
 #include "Indicator/Volume.h"
+#include "Indicator/VolumeProfile.h"
+#include "Indicator/VWAP.h"
+#include "Indicator/WilliamsR.h"
 #include "Tool/ToolFactory.h"
 
 namespace
 {
+    // The bars wholly inside the view, which may start and end between two bars.
     juce::Range<int> ToInt(const juce::Range<double>& range)
     {
-        return { juce::roundToInt(range.getStart()), juce::roundToInt(range.getEnd()) };
+        constexpr double kEpsilon = 1e-6;
+        return { static_cast<int>(std::ceil(range.getStart() - kEpsilon)), static_cast<int>(std::floor(range.getEnd() + kEpsilon)) };
     }
 }
 
-MainComponent::MainComponent() :
+MainComponent::MainComponent(const std::string& stock_id) :
     chart_scroll_bar_(false),
-    stock_id_("2330.tw"),
+    frame_scheduler_(std::bind(&MainComponent::RunFrame, this)),
+    stock_id_(stock_id),
     data_frequency_(lei::DataFrequency::kDay),
     tool_type_(lei::ToolType::kNone),
     tool_(lei::ToolFactory::GetTool(lei::ToolType::kNone,
                                     this,
                                     std::bind(&MainComponent::GetKArray, this),
-                                    GetTools(stock_id_, data_frequency_),
+                                    [this](const juce::Rectangle<int>& area) { ScheduleRepaint(area); },
+                                    GetTools(GetToolKey()),
                                     std::bind(&MainComponent::RegisterEraseButton, this, std::placeholders::_1),
                                     std::bind(&MainComponent::UnregisterEraseButton, this, std::placeholders::_1))),
-    watch_tool_(this, std::bind(&MainComponent::GetKArray, this)),
-    main_indicators_{ std::make_unique<lei::K>(std::bind(&MainComponent::GetKArray, this)),
-                      std::make_unique<lei::MA>(std::bind(&MainComponent::GetKArray, this), 5, juce::Colours::yellow),
-                      std::make_unique<lei::MA>(std::bind(&MainComponent::GetKArray, this), 22, juce::Colours::orange) },
-    subsidiary_indicators_{ std::make_unique<lei::Volume>(std::bind(&MainComponent::GetKArray, this)),
-                            std::make_unique<lei::KD>(std::bind(&MainComponent::GetKArray, this), 9, 3, 3),
-                            std::make_unique<lei::MACD>(std::bind(&MainComponent::GetKArray, this), 12, 26, 9) },
+    watch_tool_(this, std::bind(&MainComponent::GetKArray, this), [this](const juce::Rectangle<int>& area) { ScheduleRepaint(area); }),
     k_chart_(std::make_unique<lei::KChart>())
 {
+    SetDefaultIndicators();
+
     stock_search_bar_.setFont(lei::GeStockSearchBarFont());
     stock_search_bar_.setTextToShowWhenEmpty(juce::translate("stock id"), juce::Colours::grey);
     stock_search_bar_.addListener(this);
@@ -55,6 +68,16 @@ MainComponent::MainComponent() :
                          data_frequency_ == lei::DataFrequency::kDay,
                          std::bind(&MainComponent::DataFrequencyChanged, this, lei::DataFrequency::kDay));
 
+            menu.addSeparator();
+            const std::array<std::pair<const char*, lei::BarType>, 4> bar_types = { { { "candles", lei::BarType::kCandle },
+                                                                                     { "heikin-ashi", lei::BarType::kHeikinAshi },
+                                                                                     { "renko", lei::BarType::kRenko },
+                                                                                     { "range bars", lei::BarType::kRange } } };
+            for (const auto& [name, type] : bar_types)
+            {
+                menu.addItem(juce::translate(name), true, bar_setting_.type == type, std::bind(&MainComponent::ChooseBarType, this, type));
+            }
+
             menu.showMenuAsync(juce::PopupMenu::Options().withTargetComponent(data_frequency_button_));
         };
 
@@ -106,23 +129,125 @@ MainComponent::MainComponent() :
 
             menu.addItem(juce::translate("erase all"), true, false, [this]()
                          {
-                             const auto pos = tools_.find({ stock_id_, data_frequency_ });
+                             const auto pos = tools_.find(GetToolKey());
                              if (pos != tools_.end())
                              {
+                                 InvalidateChartLayer();
                                  pos->second.clear();
-                                 repaint();
+                                 ScheduleRepaint();
                              }
 
                              ToolChanged(lei::ToolType::kNone);
                          });
 
+            menu.addSeparator();
+            menu.addItem(juce::translate("log repaint stats"), true, log_repaint_stats_, [this]()
+                         {
+                             log_repaint_stats_ = !log_repaint_stats_;
+                             repaint_stats_.Reset();
+                             frame_scheduler_.ResetStats();
+                         });
+
+            juce::PopupMenu frame_rate_menu;
+            for (const auto frames_per_second : { 60, 30 })
+            {
+                frame_rate_menu.addItem(juce::String(frames_per_second) + " fps",
+                                        true,
+                                        frame_scheduler_.GetFrameRate() == frames_per_second,
+                                        [this, frames_per_second]()
+                                        {
+                                            frame_scheduler_.SetFrameRate(frames_per_second);
+                                        });
+            }
+
+            menu.addSubMenu(juce::translate("frame rate cap"), frame_rate_menu);
+
             menu.showMenuAsync(juce::PopupMenu::Options().withTargetComponent(tool_button_));
         };
 
     tool_button_.setButtonText(juce::translate("tools"));
     addAndMakeVisible(tool_button_);
 
-    chart_scroll_bar_.setRangeLimits(0, std::get<0>(lei::GetKDataCenter().GetKData(stock_id_, data_frequency_)).size());
+    indicator_button_.onClick = [this]
+        {
+            juce::PopupMenu menu;
+            menu.addItem(juce::translate("add expression overlay"), std::bind(&MainComponent::AddExpressionIndicator, this, 0));
+
+            for (int i = 1; i <= GetSubsidiaryChartSize(); ++i)
+            {
+                menu.addItem(juce::translate("expression chart") + " " + juce::String(i), std::bind(&MainComponent::AddExpressionIndicator, this, i));
+            }
+
+            menu.addSeparator();
+            const std::array<std::pair<const char*, lei::IndicatorType>, 3> overlays = { { { "volume profile", lei::IndicatorType::kVolumeProfile },
+                                                                                          { "bollinger bands", lei::IndicatorType::kBollingerBands },
+                                                                                          { "session vwap", lei::IndicatorType::kVWAP } } };
+            for (const auto& [name, type] : overlays)
+            {
+                const auto ticked = std::any_of(overlay_indicators_.begin(), overlay_indicators_.end(), [type](const auto& indicator)
+                                                {
+                                                    return indicator->GetIndicatorType() == type;
+                                                });
+
+                menu.addItem(juce::translate(name), true, ticked, std::bind(&MainComponent::ToggleOverlayIndicator, this, type));
+            }
+
+            if (auto* k = dynamic_cast<lei::K*>(main_indicators_[0].get()))
+            {
+                menu.addItem(juce::translate("candlestick patterns"), true, k->IsShowingPatterns(), [this, k]()
+                             {
+                                 InvalidateChartLayer();
+                                 k->ShowPatterns(!k->IsShowingPatterns());
+                                 HandleZoomChanged();
+                                 ScheduleRepaint();
+                             });
+            }
+
+            menu.addSeparator();
+            const std::array<std::pair<const char*, lei::IndicatorType>, 6> studies = { { { "RSI", lei::IndicatorType::kRSI },
+                                                                                         { "ATR", lei::IndicatorType::kATR },
+                                                                                         { "OBV", lei::IndicatorType::kOBV },
+                                                                                         { "DMI", lei::IndicatorType::kDMI },
+                                                                                         { "Williams %R", lei::IndicatorType::kWilliamsR },
+                                                                                         { "CCI", lei::IndicatorType::kCCI } } };
+            for (int i = 1; i <= GetSubsidiaryChartSize(); ++i)
+            {
+                juce::PopupMenu chart_menu;
+                for (const auto& [name, type] : studies)
+                {
+                    chart_menu.addItem(name,
+                                       true,
+                                       subsidiary_indicators_[i - 1]->GetIndicatorType() == type,
+                                       std::bind(&MainComponent::SetSubsidiaryIndicator, this, i, type));
+                }
+
+                menu.addSubMenu(juce::translate("chart") + " " + juce::String(i), chart_menu);
+            }
+
+            menu.addSeparator();
+            menu.addItem(juce::translate("default indicators"), [this]()
+                         {
+                             InvalidateChartLayer();
+                             SetDefaultIndicators();
+                             HandleZoomChanged();
+                             ScheduleRepaint();
+                         });
+
+            menu.showMenuAsync(juce::PopupMenu::Options().withTargetComponent(indicator_button_));
+        };
+
+    indicator_button_.setButtonText(juce::translate("indicators"));
+    addAndMakeVisible(indicator_button_);
+
+    screener_button_.onClick = std::bind(&MainComponent::RunScreener, this);
+    screener_button_.setButtonText(juce::translate("screener"));
+    addAndMakeVisible(screener_button_);
+
+    backtest_button_.onClick = std::bind(&MainComponent::RunBacktest, this);
+    backtest_button_.setButtonText(juce::translate("backtest"));
+    addAndMakeVisible(backtest_button_);
+
+    chart_scroll_bar_.setRangeLimits(0, std::get<0>(GetKArray()).size());
     chart_scroll_bar_.setSingleStepSize(1);
     chart_scroll_bar_.scrollToBottom();
     chart_scroll_bar_.addListener(this);
@@ -164,29 +289,54 @@ MainComponent::~MainComponent()
 
 void MainComponent::paint(juce::Graphics& g)
 {
-    g.fillAll(getLookAndFeel().findColour(juce::ResizableWindow::backgroundColourId));
-    DrawKChart(g);
-    DrawSubsidiaryCharts(g);
+    const auto paint_begin = juce::Time::getMillisecondCounterHiRes();
 
-    const auto pos = tools_.find({ stock_id_, data_frequency_ });
-    if (pos != tools_.end())
+    // Charts and finished tools come from the cached layer, only the tool being drawn and the crosshair are painted
+    // on every mouse move. A new layer renders in the background, the previous one is shown until it is done. Indicators
+    // are only calculated for a pending zoom change in the next frame, which renders the layer then.
+    const auto scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+    if ((!chart_layer_valid_ || chart_layer_scale_ != scale) && !zoom_changed_pending_)
     {
-        for (const auto& tool : pos->second)
-        {
-            const auto chart_index = tool.second->GetChartIndex();
-            tool.second->Paint(g);
-        }
+        RenderChartLayer(scale);
+    }
+
+    const auto& chart_layer = pane_renderer_.GetImage();
+    if (chart_layer.isValid())
+    {
+        g.drawImageTransformed(chart_layer, juce::AffineTransform::scale(1.0f / pane_renderer_.GetScale()));
+    }
+    else
+    {
+        g.fillAll(getLookAndFeel().findColour(juce::ResizableWindow::backgroundColourId));
     }
 
-    const auto chart_index = tool_->GetChartIndex();
     tool_->Paint(g);
 
     watch_tool_.Paint(g);
     DrawWatchToolMessage(g);
+
+    repaint_stats_.AddFrame(juce::Time::getMillisecondCounterHiRes() - paint_begin);
+    frame_scheduler_.FramePainted();
+    if (log_repaint_stats_ && repaint_stats_.GetFrameCount() % lei::RepaintStats::kWindowSize == 0)
+    {
+        juce::Logger::writeToLog(repaint_stats_.ToString() + ", " + frame_scheduler_.ToString());
+    }
+}
+
+void MainComponent::visibilityChanged()
+{
+    // A hidden view runs no frames and keeps no chart layer, it renders a new one when it shows again.
+    frame_scheduler_.SetActive(isVisible());
+    if (!isVisible())
+    {
+        InvalidateChartLayer();
+        pane_renderer_.Release();
+    }
 }
 
 void MainComponent::resized()
 {
+    InvalidateChartLayer();
     auto bounds = getLocalBounds();
 
     toolbar_bounds_ = bounds.removeFromTop(lei::kToolbarHeight);
@@ -196,7 +346,13 @@ void MainComponent::resized()
     box.alignItems = juce::FlexBox::AlignItems::center;
     box.items = { juce::FlexItem(lei::kStockSearchBarWidth, lei::kStockSearchBarHeight, stock_search_bar_).withMargin({lei::kToolGap}),
         juce::FlexItem(lei::kDataFrequencyButtonWidth, lei::kDataFrequencyButtonHeight, data_frequency_button_).withMargin({lei::kToolGap}),
-        juce::FlexItem(lei::kToolButtonWidth, lei::kToolButtonHeight, tool_button_).withMargin({lei::kToolGap}) };
+        juce::FlexItem(lei::kToolButtonWidth, lei::kToolButtonHeight, tool_button_).withMargin({lei::kToolGap}),
+        juce::FlexItem(lei::kIndicatorButtonWidth, lei::kIndicatorButtonHeight, indicator_button_).withMargin({lei::kToolGap}) };
+    if (!compact_)
+    {
+        box.items.add(juce::FlexItem(lei::kScreenerButtonWidth, lei::kScreenerButtonHeight, screener_button_).withMargin({lei::kToolGap}));
+        box.items.add(juce::FlexItem(lei::kBacktestButtonWidth, lei::kBacktestButtonHeight, backtest_button_).withMargin({lei::kToolGap}));
+    }
 
     box.performLayout(toolbar_bounds_);
 
@@ -207,29 +363,7 @@ void MainComponent::resized()
 
     chart_scroll_bar_.setBounds(widgets_bounds);
 
-    header_bounds_ = bounds.removeFromTop(lei::kHeaderHeight);
-    time_label_bounds_ = bounds.removeFromBottom(lei::kTimeLabelHeight);
-
-    chart_bounds_ = bounds;
-    chart_bounds_.removeFromLeft(lei::kLeftLabelWidth);
-    chart_bounds_.removeFromRight(lei::kRightLabelWidth);
-
-    const auto chart_height = bounds.getHeight();
-
-    subsidiary_charts_bounds_.clear();
-    subsidiary_labels_bounds_.clear();
-    for (int i = 0; i < kSubsidiaryChartSize; ++i)
-    {
-        auto chart_bounds_ = bounds.removeFromBottom(chart_height * lei::kSubsidiaryChartHeightPercentage / 100.0);
-        chart_bounds_.removeFromTop(lei::kChartGap);
-        chart_bounds_.removeFromLeft(lei::kLeftLabelWidth);
-        subsidiary_labels_bounds_.push_front(chart_bounds_.removeFromRight(lei::kRightLabelWidth));
-        subsidiary_charts_bounds_.push_front(chart_bounds_);
-    }
-
-    k_chart_bounds_ = bounds;
-    k_chart_bounds_.removeFromLeft(lei::kLeftLabelWidth);
-    k_price_label_bounds_ = k_chart_bounds_.removeFromRight(lei::kRightLabelWidth);
+    chart_layout_ = lei::MakeChartLayout(bounds, GetSubsidiaryChartSize());
 
     const auto screen_k_size = CalculateScreenKSize();
     chart_scroll_bar_.setCurrentRange(chart_scroll_bar_.getCurrentRange().getEnd() - screen_k_size, screen_k_size);
@@ -240,53 +374,36 @@ void MainComponent::scrollBarMoved(juce::ScrollBar* scroll_bar_that_has_moved, d
 {
     if (scroll_bar_that_has_moved == &chart_scroll_bar_)
     {
-        HandleZoomChanged();
-        repaint();
+        ScheduleZoomChanged();
     }
 }
 
 void MainComponent::buttonClicked(juce::Button* button)
 {
+    const float kZoomButtonStep = 1.25f;
     if (button == &zoom_in_button_)
     {
-        int kMaxBarWidth = k_chart_bounds_.reduced(lei::kChartBorderThickness, 0).getWidth() - lei::kBarGap * 2;
-        if (kMaxBarWidth % 2 == 0) // Must odd
-        {
-            --kMaxBarWidth;
-        }
-
-        bar_width_ += 2;
-        bar_width_ = std::min(bar_width_, kMaxBarWidth);
-        const auto screen_k_size = CalculateScreenKSize();
-        chart_scroll_bar_.setCurrentRange(chart_scroll_bar_.getCurrentRange().getEnd() - screen_k_size, screen_k_size);
-        HandleZoomChanged();
-        repaint();
+        Zoom(bar_pitch_ * kZoomButtonStep, std::nullopt);
     }
     else if (button == &zoom_out_button_)
     {
-        const int kMinBarWidth = 3;
-        bar_width_ -= 2;
-        bar_width_ = std::max(bar_width_, kMinBarWidth);
-        const auto screen_k_size = CalculateScreenKSize();
-        chart_scroll_bar_.setCurrentRange(chart_scroll_bar_.getCurrentRange().getEnd() - screen_k_size, screen_k_size);
-        HandleZoomChanged();
-        repaint();
+        Zoom(bar_pitch_ / kZoomButtonStep, std::nullopt);
     }
     else if (button == &zoom_reset_button_)
     {
-        bar_width_ = lei::kDefaultBarWidth;
+        bar_pitch_ = lei::kDefaultBarWidth + lei::kBarGap;
         const auto screen_k_size = CalculateScreenKSize();
         chart_scroll_bar_.setCurrentRange(chart_scroll_bar_.getCurrentRange().getEnd() - screen_k_size, screen_k_size);
-        HandleZoomChanged();
-        repaint();
+        ScheduleZoomChanged();
     }
     else if (button->getName().equalsIgnoreCase("erase tool"))
     {
-        const auto pos = tools_.find({ stock_id_, data_frequency_ });
+        const auto pos = tools_.find(GetToolKey());
         if (pos != tools_.end())
         {
+            InvalidateChartLayer();
             pos->second.erase(button->getButtonText());
-            repaint();
+            ScheduleRepaint();
         }
     }
 }
@@ -304,114 +421,65 @@ void MainComponent::textEditorReturnKeyPressed(juce::TextEditor& text_editor)
         if (!new_stock_id.equalsIgnoreCase(stock_id_.c_str()))
         {
             StockChanged(new_stock_id.toStdString());
-            repaint();
+            ScheduleRepaint();
         }
     }
 }
 
 void MainComponent::mouseMove(const juce::MouseEvent& event)
 {
-    const auto pt = event.position.roundToInt();
-    k_index_ = GetKIndexRestrictInBounds(pt);
-    watch_tool_.MouseEvent(pt,
-                           k_index_,
-                           chart_bounds_.reduced(lei::kChartBorderThickness),
-                           GetChartBounds(pt).reduced(lei::kChartBorderThickness),
-                           GetPriceLabelBounds(pt).reduced(lei::kChartBorderThickness),
-                           time_label_bounds_.reduced(lei::kChartBorderThickness),
-                           GetChartMinMaxLabel(pt),
-                           data_frequency_,
-                           GetKCentreXRestrictInBounds(pt));
+    pending_mouse_position_ = event.position.roundToInt();
+    frame_scheduler_.RequestFrame();
 }
 
 void MainComponent::mouseEnter(const juce::MouseEvent& event)
 {
-    const auto pt = event.position.roundToInt();
-    k_index_ = GetKIndexRestrictInBounds(pt);
-    watch_tool_.MouseEvent(pt,
-                           k_index_,
-                           chart_bounds_.reduced(lei::kChartBorderThickness),
-                           GetChartBounds(pt).reduced(lei::kChartBorderThickness),
-                           GetPriceLabelBounds(pt).reduced(lei::kChartBorderThickness),
-                           time_label_bounds_.reduced(lei::kChartBorderThickness),
-                           GetChartMinMaxLabel(pt),
-                           data_frequency_,
-                           GetKCentreXRestrictInBounds(pt));
+    pending_mouse_position_ = event.position.roundToInt();
+    frame_scheduler_.RequestFrame();
 }
 
 void MainComponent::mouseExit(const juce::MouseEvent& event)
 {
-    const auto pt = event.position.roundToInt();
-    k_index_ = GetKIndexRestrictInBounds(pt);
-    watch_tool_.MouseEvent(pt,
-                           k_index_,
-                           chart_bounds_.reduced(lei::kChartBorderThickness),
-                           GetChartBounds(pt).reduced(lei::kChartBorderThickness),
-                           GetPriceLabelBounds(pt).reduced(lei::kChartBorderThickness),
-                           time_label_bounds_.reduced(lei::kChartBorderThickness),
-                           GetChartMinMaxLabel(pt),
-                           data_frequency_,
-                           GetKCentreXRestrictInBounds(pt));
+    pending_mouse_position_ = event.position.roundToInt();
+    frame_scheduler_.RequestFrame();
 }
 
 void MainComponent::mouseDown(const juce::MouseEvent& event)
 {
     const auto pt = event.position.roundToInt();
-    k_index_ = GetKIndexRestrictInBounds(pt);
-    watch_tool_.MouseEvent(pt,
-                           k_index_,
-                           chart_bounds_.reduced(lei::kChartBorderThickness),
-                           GetChartBounds(pt).reduced(lei::kChartBorderThickness),
-                           GetPriceLabelBounds(pt).reduced(lei::kChartBorderThickness),
-                           time_label_bounds_.reduced(lei::kChartBorderThickness),
-                           GetChartMinMaxLabel(pt),
-                           data_frequency_,
-                           GetKCentreXRestrictInBounds(pt));
+    pending_mouse_position_.reset();
+    pending_drag_position_.reset();
+    WatchToolMouseEvent(pt);
 
     tool_->ToolBegin(pt,
-                     IsAcrossCharts(tool_->GetToolType()) ? chart_bounds_.reduced(lei::kChartBorderThickness) : GetChartBounds(pt).reduced(lei::kChartBorderThickness),
+                     IsAcrossCharts(tool_->GetToolType()) ? chart_layout_.charts.reduced(lei::kChartBorderThickness) : GetChartBounds(pt).reduced(lei::kChartBorderThickness),
                      GetChartMinMaxLabel(pt),
                      ToInt(chart_scroll_bar_.getCurrentRange()),
-                     bar_width_,
+                     GetViewportTransform(),
                      GetChartIndex(pt));
 }
 
 void MainComponent::mouseDrag(const juce::MouseEvent& event)
 {
-    const auto pt = event.position.roundToInt();
-    k_index_ = GetKIndexRestrictInBounds(pt);
-    watch_tool_.MouseEvent(pt,
-                           k_index_,
-                           chart_bounds_.reduced(lei::kChartBorderThickness),
-                           GetChartBounds(pt).reduced(lei::kChartBorderThickness),
-                           GetPriceLabelBounds(pt).reduced(lei::kChartBorderThickness),
-                           time_label_bounds_.reduced(lei::kChartBorderThickness),
-                           GetChartMinMaxLabel(pt),
-                           data_frequency_,
-                           GetKCentreXRestrictInBounds(pt));
-
-    tool_->ToolProcess(pt);
+    pending_mouse_position_ = event.position.roundToInt();
+    pending_drag_position_ = pending_mouse_position_;
+    frame_scheduler_.RequestFrame();
 }
 
 void MainComponent::mouseUp(const juce::MouseEvent& event)
 {
+    // The release position supersedes a drag still waiting for its frame.
     const auto pt = event.position.roundToInt();
-    k_index_ = GetKIndexRestrictInBounds(pt);
-    watch_tool_.MouseEvent(pt,
-                           k_index_,
-                           chart_bounds_.reduced(lei::kChartBorderThickness),
-                           GetChartBounds(pt).reduced(lei::kChartBorderThickness),
-                           GetPriceLabelBounds(pt).reduced(lei::kChartBorderThickness),
-                           time_label_bounds_.reduced(lei::kChartBorderThickness),
-                           GetChartMinMaxLabel(pt),
-                           data_frequency_,
-                           GetKCentreXRestrictInBounds(pt));
+    pending_mouse_position_.reset();
+    pending_drag_position_.reset();
+    WatchToolMouseEvent(pt);
 
     tool_->ToolEnd(pt);
 
     if (tool_->IsToolFinished())
     {
-        const std::pair<std::string, lei::DataFrequency> key = { stock_id_, data_frequency_ };
+        InvalidateChartLayer();
+        const auto key = GetToolKey();
         const auto pos = tools_.find(key);
         if (pos != tools_.end())
         {
@@ -427,100 +495,232 @@ void MainComponent::mouseUp(const juce::MouseEvent& event)
         tool_ = lei::ToolFactory::GetTool(tool_type_,
                                           this,
                                           std::bind(&MainComponent::GetKArray, this),
-                                          GetTools(stock_id_, data_frequency_),
+                                          [this](const juce::Rectangle<int>& area) { ScheduleRepaint(area); },
+                                          GetTools(GetToolKey()),
                                           std::bind(&MainComponent::RegisterEraseButton, this, std::placeholders::_1),
                                           std::bind(&MainComponent::UnregisterEraseButton, this, std::placeholders::_1));
     }
 }
 
+void MainComponent::mouseWheelMove(const juce::MouseEvent& event, const juce::MouseWheelDetails& wheel)
+{
+    if (!chart_layout_.charts.contains(event.getPosition()) || wheel.deltaY == 0.0f)
+    {
+        Component::mouseWheelMove(event, wheel);
+        return;
+    }
+
+    const auto delta = wheel.isReversed ? -wheel.deltaY : wheel.deltaY;
+    Zoom(bar_pitch_ * std::exp2(delta), event.getPosition().getX());
+}
+
+void MainComponent::mouseMagnify(const juce::MouseEvent& event, float scale_factor)
+{
+    if (!chart_layout_.charts.contains(event.getPosition()))
+    {
+        Component::mouseMagnify(event, scale_factor);
+        return;
+    }
+
+    Zoom(bar_pitch_ * scale_factor, event.getPosition().getX());
+}
+
+void MainComponent::WatchToolMouseEvent(const juce::Point<int>& pt)
+{
+    const auto k_index = GetKIndexRestrictInBounds(pt);
+    if (k_index != k_index_)
+    {
+        k_index_ = k_index;
+        for (const auto& rectangle : GetWatchToolMessageArea())
+        {
+            ScheduleRepaint(rectangle);
+        }
+    }
+
+    watch_tool_.MouseEvent(pt,
+                           k_index_,
+                           chart_layout_.charts.reduced(lei::kChartBorderThickness),
+                           GetChartBounds(pt).reduced(lei::kChartBorderThickness),
+                           GetPriceLabelBounds(pt).reduced(lei::kChartBorderThickness),
+                           chart_layout_.time_label.reduced(lei::kChartBorderThickness),
+                           GetChartMinMaxLabel(pt),
+                           data_frequency_,
+                           GetKCentreXRestrictInBounds(pt));
+}
+
+void MainComponent::ScheduleZoomChanged()
+{
+    zoom_changed_pending_ = true;
+    ScheduleRepaint();
+}
+
+void MainComponent::ScheduleRepaint()
+{
+    ScheduleRepaint(getLocalBounds());
+}
+
+void MainComponent::ScheduleRepaint(const juce::Rectangle<int>& area)
+{
+    pending_repaint_.add(area);
+    frame_scheduler_.RequestFrame();
+}
+
+bool MainComponent::RunFrame()
+{
+    // The zoom goes first, so the crosshair snaps to the bars as they are laid out in this frame.
+    if (zoom_changed_pending_)
+    {
+        zoom_changed_pending_ = false;
+        HandleZoomChanged();
+    }
+
+    // Only the latest mouse position of the frame moves the crosshair.
+    if (pending_mouse_position_)
+    {
+        const auto pt = *pending_mouse_position_;
+        pending_mouse_position_.reset();
+        WatchToolMouseEvent(pt);
+    }
+
+    // Likewise only the latest drag position moves the tool being drawn.
+    if (pending_drag_position_)
+    {
+        const auto pt = *pending_drag_position_;
+        pending_drag_position_.reset();
+        tool_->ToolProcess(pt);
+    }
+
+    // The list keeps its rectangles disjoint, so their areas add up to the pixels repainted.
+    repaint_stats_.AddRepaint(pending_repaint_);
+    for (const auto& rectangle : pending_repaint_)
+    {
+        repaint(rectangle);
+    }
+
+    const auto repainted = !pending_repaint_.isEmpty();
+    pending_repaint_.clear();
+    return repainted;
+}
+
+void MainComponent::SetCompact(bool compact)
+{
+    if (compact != compact_)
+    {
+        compact_ = compact;
+        screener_button_.setVisible(!compact_);
+        backtest_button_.setVisible(!compact_);
+        resized();
+    }
+}
+
 const lei::KArray& MainComponent::GetKArray() const
 {
-    return lei::GetKDataCenter().GetKData(stock_id_, data_frequency_);
+    return lei::GetKDataCenter().GetKData(stock_id_, data_frequency_, bar_setting_);
 }
 
-void MainComponent::DrawKChart(juce::Graphics& g)
+const lei::TimeBoundaryIndex& MainComponent::GetTimeBoundaries() const
 {
-    const auto& k_array = lei::GetKDataCenter().GetKData(stock_id_, data_frequency_);
-    k_chart_->DrawHeader(g,
-                         header_bounds_.reduced(lei::kChartBorderThickness),
-                         stock_id_,
-                         std::get<0>(k_array),
-                         std::get<1>(k_array),
-                         std::get<2>(k_array),
-                         std::get<3>(k_array),
-                         std::get<4>(k_array),
-                         std::get<5>(k_array),
-                         lei::GetHeaderFont(),
-                         data_frequency_);
-
-    k_chart_->DrawBounds(g, k_chart_bounds_);
+    return lei::GetKDataCenter().GetTimeBoundaries(stock_id_, data_frequency_, bar_setting_);
+}
 
-    const auto scroll_bar_current_range = ToInt(chart_scroll_bar_.getCurrentRange());
-    k_chart_->DrawTimeGrid(g,
-                           k_chart_bounds_.reduced(lei::kChartBorderThickness),
-                           std::get<0>(k_array),
-                           scroll_bar_current_range,
-                           bar_width_,
-                           data_frequency_);
-
-    k_chart_->DrawTimeLabel(g,
-                            k_chart_bounds_.reduced(lei::kChartBorderThickness),
-                            time_label_bounds_.reduced(lei::kChartBorderThickness),
-                            std::get<0>(k_array),
-                            scroll_bar_current_range,
-                            bar_width_,
-                            data_frequency_);
+void MainComponent::InvalidateChartLayer()
+{
+    // The frame being rendered was recorded before the change and is dropped, the next paint starts a new one.
+    pane_renderer_.Discard();
+    chart_layer_valid_ = false;
+}
 
+void MainComponent::RenderChartLayer(float scale)
+{
+    lei::ChartLayerFrame frame;
+    frame.stock_id = stock_id_;
+    frame.frequency = data_frequency_;
+    frame.scroll_bar_current_range = ToInt(chart_scroll_bar_.getCurrentRange());
+    frame.transform = GetViewportTransform();
+    frame.k_chart_min_max_label = k_chart_min_max_label_;
+    frame.k_array = &GetKArray();
+    frame.time_boundaries = &GetTimeBoundaries();
     for (const auto& indicator : main_indicators_)
     {
-        indicator->Draw(g,
-                        k_chart_bounds_.reduced(lei::kChartBorderThickness),
-                        k_price_label_bounds_.reduced(lei::kChartBorderThickness),
-                        bar_width_,
-                        scroll_bar_current_range,
-                        k_chart_min_max_label_);
+        frame.k_chart_indicators.push_back(indicator.get());
+    }
+
+    for (const auto& indicator : overlay_indicators_)
+    {
+        frame.k_chart_indicators.push_back(indicator.get());
+    }
+
+    for (int i = 0; i < GetSubsidiaryChartSize(); ++i)
+    {
+        frame.subsidiary_indicators.push_back(subsidiary_indicators_[i].get());
+    }
+
+    if (pane_renderer_.Render(getLocalBounds(),
+                              scale,
+                              getLookAndFeel().findColour(juce::ResizableWindow::backgroundColourId),
+                              lei::MakeChartPanes(chart_layout_, frame, *k_chart_),
+                              std::bind(&MainComponent::DrawTools, this, std::placeholders::_1),
+                              [this]() { ScheduleRepaint(); }))
+    {
+        chart_layer_scale_ = scale;
+        chart_layer_valid_ = true;
     }
 }
 
-void MainComponent::DrawSubsidiaryCharts(juce::Graphics& g)
+void MainComponent::DrawTools(juce::Graphics& g)
 {
-    const auto scroll_bar_current_range = ToInt(chart_scroll_bar_.getCurrentRange());
-    for (int i = 0; i < kSubsidiaryChartSize; ++i)
+    const auto pos = tools_.find(GetToolKey());
+    if (pos != tools_.end())
     {
-        k_chart_->DrawBounds(g, subsidiary_charts_bounds_[i]);
-        k_chart_->DrawTimeGrid(g,
-                               subsidiary_charts_bounds_[i].reduced(lei::kChartBorderThickness),
-                               std::get<0>(lei::GetKDataCenter().GetKData(stock_id_, data_frequency_)),
-                               scroll_bar_current_range,
-                               bar_width_,
-                               data_frequency_);
-
-        subsidiary_indicators_[i]->Draw(g,
-                                        subsidiary_charts_bounds_[i].reduced(lei::kChartBorderThickness),
-                                        subsidiary_labels_bounds_[i].reduced(lei::kChartBorderThickness),
-                                        bar_width_,
-                                        scroll_bar_current_range,
-                                        subsidiary_indicators_[i]->GetMinMaxLabelValue());
+        for (const auto& tool : pos->second)
+        {
+            if (IsToolShown(*tool.second))
+            {
+                tool.second->Paint(g);
+            }
+        }
     }
 }
 
 void MainComponent::DrawWatchToolMessage(juce::Graphics& g)
 {
-    auto k_chart_bounds_exclude_border = k_chart_bounds_.reduced(lei::kChartBorderThickness);
+    auto k_chart_bounds_exclude_border = chart_layout_.k_chart.reduced(lei::kChartBorderThickness);
     const auto font = lei::GetWatchToolMessageFont();
     for (const auto& indicator : main_indicators_)
     {
         indicator->DrawWatchToolMessage(g, k_chart_bounds_exclude_border.removeFromTop(font.getHeight()), k_index_);
     }
 
-    for (int i = 0; i < kSubsidiaryChartSize; ++i)
+    for (const auto& indicator : overlay_indicators_)
+    {
+        indicator->DrawWatchToolMessage(g, k_chart_bounds_exclude_border.removeFromTop(font.getHeight()), k_index_);
+    }
+
+    for (int i = 0; i < GetSubsidiaryChartSize(); ++i)
+    {
+        subsidiary_indicators_[i]->DrawWatchToolMessage(g, chart_layout_.subsidiary_charts[i], k_index_);
+    }
+}
+
+juce::RectangleList<int> MainComponent::GetWatchToolMessageArea() const
+{
+    // The rows DrawWatchToolMessage writes into.
+    const auto font_height = juce::roundToInt(std::ceil(lei::GetWatchToolMessageFont().getHeight()));
+    const auto k_chart_rows = static_cast<int>(main_indicators_.size() + overlay_indicators_.size());
+
+    juce::RectangleList<int> area;
+    area.add(chart_layout_.k_chart.reduced(lei::kChartBorderThickness).withHeight(font_height * k_chart_rows));
+    for (const auto& bounds : chart_layout_.subsidiary_charts)
     {
-        subsidiary_indicators_[i]->DrawWatchToolMessage(g, subsidiary_charts_bounds_[i], k_index_);
+        area.add(bounds.withHeight(font_height));
     }
+
+    return area;
 }
 
 void MainComponent::HandleZoomChanged()
 {
+    InvalidateChartLayer();
     k_chart_min_max_label_.first = std::numeric_limits<double>::max();
     k_chart_min_max_label_.second = std::numeric_limits<double>::min();
 
@@ -534,21 +734,35 @@ void MainComponent::HandleZoomChanged()
         k_chart_min_max_label_.second = std::max(min_max_label.second, k_chart_min_max_label_.second);
     }
 
-    for (const auto& indicator : subsidiary_indicators_)
+    for (const auto& indicator : overlay_indicators_)
     {
         indicator->Calculate(scroll_bar_current_range);
+        const auto min_max_label = indicator->GetMinMaxLabelValue();
+        k_chart_min_max_label_.first = std::min(min_max_label.first, k_chart_min_max_label_.first);
+        k_chart_min_max_label_.second = std::max(min_max_label.second, k_chart_min_max_label_.second);
     }
 
-    const auto pos = tools_.find({ stock_id_, data_frequency_ });
+    // Charts a compact view doesn't show are calculated when it shows them again.
+    for (int i = 0; i < GetSubsidiaryChartSize(); ++i)
+    {
+        subsidiary_indicators_[i]->Calculate(scroll_bar_current_range);
+    }
+
+    const auto pos = tools_.find(GetToolKey());
     if (pos != tools_.end())
     {
         for (auto& it : pos->second)
         {
+            if (!IsToolShown(*it.second))
+            {
+                continue;
+            }
+
             const auto chart_index = it.second->GetChartIndex();
-            it.second->ZoomChanged(IsAcrossCharts(it.second->GetToolType()) ? chart_bounds_.reduced(lei::kChartBorderThickness) : GetChartBounds(chart_index).reduced(lei::kChartBorderThickness),
+            it.second->ZoomChanged(IsAcrossCharts(it.second->GetToolType()) ? chart_layout_.charts.reduced(lei::kChartBorderThickness) : GetChartBounds(chart_index).reduced(lei::kChartBorderThickness),
                                    GetChartMinMaxLabel(chart_index),
                                    ToInt(chart_scroll_bar_.getCurrentRange()),
-                                   bar_width_);
+                                   GetViewportTransform());
         }
     }
 
@@ -558,38 +772,76 @@ void MainComponent::HandleZoomChanged()
     }
 }
 
-void MainComponent::StockChanged(const std::string& stock_id)
+void MainComponent::Zoom(float bar_pitch, std::optional<int> anchor_x)
 {
-    stock_id_ = stock_id;
-    chart_scroll_bar_.setRangeLimits(0, std::get<0>(lei::GetKDataCenter().GetKData(stock_id_, data_frequency_)).size());
-    chart_scroll_bar_.scrollToBottom();
+    const auto chart_bounds = chart_layout_.k_chart.reduced(lei::kChartBorderThickness);
+    if (chart_bounds.getWidth() <= lei::kMinBarPitch + lei::kBarGap)
+    {
+        return;
+    }
 
-    const auto current_range = ToInt(chart_scroll_bar_.getCurrentRange());
-    k_index_ = current_range.getEnd() - 1;
+    // The bar under the anchor stays under it. The view keeps its fractional start, so repeated zooms don't drift.
+    const auto anchor_offset = anchor_x ? (*anchor_x - chart_bounds.getX() - lei::kBarGap / 2.0) / bar_pitch_ : 0.0;
+    const auto anchor_bar = chart_scroll_bar_.getCurrentRangeStart() + anchor_offset;
 
-    watch_tool_.Clear();
+    // Narrower than the narrowest bar, bars share columns until the whole series fits.
+    bar_pitch_ = juce::jlimit<float>(GetMinBarPitch(), chart_bounds.getWidth() - lei::kBarGap, bar_pitch);
 
-    for (const auto& indicator : main_indicators_)
+    const auto screen_k_size = CalculateScreenKSize();
+    if (anchor_x)
     {
-        indicator->StockChanged();
+        const auto new_anchor_offset = (*anchor_x - chart_bounds.getX() - lei::kBarGap / 2.0) / bar_pitch_;
+        chart_scroll_bar_.setCurrentRange(anchor_bar - new_anchor_offset, screen_k_size);
     }
-
-    for (const auto& indicator : subsidiary_indicators_)
+    else
     {
-        indicator->StockChanged();
+        chart_scroll_bar_.setCurrentRange(chart_scroll_bar_.getCurrentRange().getEnd() - screen_k_size, screen_k_size);
     }
 
+    ScheduleZoomChanged();
+}
+
+void MainComponent::StockChanged(const std::string& stock_id)
+{
+    InvalidateChartLayer();
+    stock_id_ = stock_id;
+    UpdateBarSize();
+
+    // Bars sharing columns was a zoom of the previous series, the new one starts at the narrowest single bar at most.
+    bar_pitch_ = std::max(bar_pitch_, static_cast<float>(lei::kMinBarPitch));
+    const auto screen_k_size = CalculateScreenKSize();
+    chart_scroll_bar_.setRangeLimits(0, std::get<0>(GetKArray()).size());
+    chart_scroll_bar_.setCurrentRange(chart_scroll_bar_.getMaximumRangeLimit() - screen_k_size, screen_k_size);
+
+    const auto current_range = ToInt(chart_scroll_bar_.getCurrentRange());
+    k_index_ = current_range.getEnd() - 1;
+
+    watch_tool_.Clear();
+    ResetIndicators();
+
     HandleZoomChanged();
 }
 
 void MainComponent::DataFrequencyChanged(lei::DataFrequency frequency)
 {
+    InvalidateChartLayer();
     data_frequency_ = frequency;
-    chart_scroll_bar_.setRangeLimits(0, std::get<0>(lei::GetKDataCenter().GetKData(stock_id_, data_frequency_)).size());
-    chart_scroll_bar_.scrollToBottom();
+    UpdateBarSize();
+
+    // The other frequency has its own bar count, so shared columns are not carried over.
+    bar_pitch_ = std::max(bar_pitch_, static_cast<float>(lei::kMinBarPitch));
+    const auto screen_k_size = CalculateScreenKSize();
+    chart_scroll_bar_.setRangeLimits(0, std::get<0>(GetKArray()).size());
+    chart_scroll_bar_.setCurrentRange(chart_scroll_bar_.getMaximumRangeLimit() - screen_k_size, screen_k_size);
     k_index_ = 0;
     watch_tool_.Clear();
+    ResetIndicators();
+
+    HandleZoomChanged();
+}
 
+void MainComponent::ResetIndicators()
+{
     for (const auto& indicator : main_indicators_)
     {
         indicator->StockChanged();
@@ -600,7 +852,69 @@ void MainComponent::DataFrequencyChanged(lei::DataFrequency frequency)
         indicator->StockChanged();
     }
 
-    HandleZoomChanged();
+    for (const auto& indicator : overlay_indicators_)
+    {
+        indicator->StockChanged();
+    }
+}
+
+void MainComponent::ChooseBarType(lei::BarType type)
+{
+    if (type == lei::BarType::kCandle || type == lei::BarType::kHeikinAshi)
+    {
+        BarSettingChanged({ type, 0.0 });
+        return;
+    }
+
+    // Suggested from the raw bars, since the current ones may already be Renko or range bars.
+    const auto& k_array = lei::GetKDataCenter().GetKData(stock_id_, data_frequency_);
+    const auto suggestion = bar_setting_.type == type ? bar_setting_.size : lei::SuggestBarSize(k_array);
+    auto* window = new juce::AlertWindow(type == lei::BarType::kRenko ? juce::translate("renko") : juce::translate("range bars"),
+                                         type == lei::BarType::kRenko ? juce::translate("brick size") : juce::translate("bar range"),
+                                         juce::MessageBoxIconType::NoIcon,
+                                         this);
+
+    window->addTextEditor("size", juce::String(suggestion, 2), {});
+    window->addButton(juce::translate("ok"), 1, juce::KeyPress(juce::KeyPress::returnKey));
+    window->addButton(juce::translate("cancel"), 0, juce::KeyPress(juce::KeyPress::escapeKey));
+    window->enterModalState(true, juce::ModalCallbackFunction::create([this, window, type](int result)
+                            {
+                                if (result == 0)
+                                {
+                                    return;
+                                }
+
+                                const auto size = window->getTextEditorContents("size").getDoubleValue();
+                                if (size <= 0.0)
+                                {
+                                    juce::AlertWindow::showMessageBoxAsync(juce::MessageBoxIconType::WarningIcon,
+                                                                           window->getName(),
+                                                                           juce::translate("the size must be positive"));
+                                    return;
+                                }
+
+                                BarSettingChanged({ type, size });
+                            }),
+                            true);
+}
+
+void MainComponent::BarSettingChanged(const lei::BarSetting& setting)
+{
+    // Every indicator and tool reads bars through GetKArray, so switching the series is a frequency change in place.
+    InvalidateChartLayer();
+    bar_setting_ = setting;
+    const auto average_true_range = lei::SuggestBarSize(lei::GetKDataCenter().GetKData(stock_id_, data_frequency_));
+    bar_size_in_atr_ = average_true_range > 0.0 ? setting.size / average_true_range : 0.0;
+    DataFrequencyChanged(data_frequency_);
+    ScheduleRepaint();
+}
+
+void MainComponent::UpdateBarSize()
+{
+    if (bar_setting_.type == lei::BarType::kRenko || bar_setting_.type == lei::BarType::kRange)
+    {
+        bar_setting_.size = bar_size_in_atr_ * lei::SuggestBarSize(lei::GetKDataCenter().GetKData(stock_id_, data_frequency_));
+    }
 }
 
 void MainComponent::ToolChanged(lei::ToolType tool_type)
@@ -614,21 +928,314 @@ void MainComponent::ToolChanged(lei::ToolType tool_type)
     tool_ = lei::ToolFactory::GetTool(tool_type,
                                       this,
                                       std::bind(&MainComponent::GetKArray, this),
-                                      GetTools(stock_id_, data_frequency_),
+                                      [this](const juce::Rectangle<int>& area) { ScheduleRepaint(area); },
+                                      GetTools(GetToolKey()),
                                       std::bind(&MainComponent::RegisterEraseButton, this, std::placeholders::_1),
                                       std::bind(&MainComponent::UnregisterEraseButton, this, std::placeholders::_1));
 }
 
+void MainComponent::SetDefaultIndicators()
+{
+    main_indicators_ = { std::make_unique<lei::K>(std::bind(&MainComponent::GetKArray, this)),
+                         std::make_unique<lei::MA>(std::bind(&MainComponent::GetKArray, this), 5, juce::Colours::yellow),
+                         std::make_unique<lei::MA>(std::bind(&MainComponent::GetKArray, this), 22, juce::Colours::orange) };
+
+    subsidiary_indicators_ = { std::make_unique<lei::Volume>(std::bind(&MainComponent::GetKArray, this), [this]() { return GetViewportTransform().GetStride(); }),
+                               std::make_unique<lei::KD>(std::bind(&MainComponent::GetKArray, this), 9, 3, 3),
+                               std::make_unique<lei::MACD>(std::bind(&MainComponent::GetKArray, this), 12, 26, 9) };
+
+    overlay_indicators_.clear();
+}
+
+void MainComponent::AddExpressionIndicator(int chart_index)
+{
+    auto* window = new juce::AlertWindow(juce::translate("indicator expression"),
+                                         juce::translate("e.g. EMA(C, 12) - EMA(C, 26)"),
+                                         juce::MessageBoxIconType::NoIcon,
+                                         this);
+
+    window->addTextEditor("expression", {}, {});
+    window->addComboBox("frequency", { juce::translate("chart frequency"), juce::translate("day") }, juce::translate("calculate on"));
+    window->addButton(juce::translate("ok"), 1, juce::KeyPress(juce::KeyPress::returnKey));
+    window->addButton(juce::translate("cancel"), 0, juce::KeyPress(juce::KeyPress::escapeKey));
+    window->enterModalState(true, juce::ModalCallbackFunction::create([this, window, chart_index](int result)
+                            {
+                                if (result == 0)
+                                {
+                                    return;
+                                }
+
+                                lei::ExpressionPlan plan;
+                                const auto compiled = plan.Compile(window->getTextEditorContents("expression"));
+                                if (compiled.failed())
+                                {
+                                    juce::AlertWindow::showMessageBoxAsync(juce::MessageBoxIconType::WarningIcon,
+                                                                           juce::translate("indicator expression"),
+                                                                           compiled.getErrorMessage());
+                                    return;
+                                }
+
+                                // A day source is drawn on the current chart through a bar mapping, e.g. the day MA(C, 22) or
+                                // yesterday's REF(H, 1) and REF(L, 1) on a 1 min chart.
+                                const auto overlay = chart_index == 0;
+                                const std::array<juce::Colour, 4> overlay_colors = { juce::Colours::cyan, juce::Colours::magenta, juce::Colours::lime, juce::Colours::skyblue };
+                                const auto color = overlay ? overlay_colors[overlay_indicators_.size() % overlay_colors.size()] : juce::Colours::yellow;
+                                std::unique_ptr<lei::ExpressionIndicator> indicator;
+                                if (window->getComboBoxComponent("frequency")->getSelectedItemIndex() == 1)
+                                {
+                                    indicator = std::make_unique<lei::ExpressionIndicator>(std::bind(&MainComponent::GetKArray, this),
+                                                                                           [this]() -> const lei::KArray&
+                                                                                           {
+                                                                                               return lei::GetKDataCenter().GetKData(stock_id_, lei::DataFrequency::kDay);
+                                                                                           },
+                                                                                           std::move(plan),
+                                                                                           color,
+                                                                                           overlay);
+                                }
+                                else
+                                {
+                                    indicator = std::make_unique<lei::ExpressionIndicator>(std::bind(&MainComponent::GetKArray, this), std::move(plan), color, overlay);
+                                }
+
+                                InvalidateChartLayer();
+                                if (overlay)
+                                {
+                                    overlay_indicators_.push_back(std::move(indicator));
+                                }
+                                else
+                                {
+                                    subsidiary_indicators_[chart_index - 1] = std::move(indicator);
+                                }
+
+                                HandleZoomChanged();
+                                ScheduleRepaint();
+                            }),
+                            true);
+}
+
+void MainComponent::ToggleOverlayIndicator(lei::IndicatorType type)
+{
+    const auto pos = std::find_if(overlay_indicators_.begin(), overlay_indicators_.end(), [type](const auto& indicator)
+                                  {
+                                      return indicator->GetIndicatorType() == type;
+                                  });
+
+    InvalidateChartLayer();
+    if (pos != overlay_indicators_.end())
+    {
+        overlay_indicators_.erase(pos);
+    }
+    else
+    {
+        overlay_indicators_.push_back(MakeIndicator(type));
+    }
+
+    HandleZoomChanged();
+    ScheduleRepaint();
+}
+
+void MainComponent::SetSubsidiaryIndicator(int chart_index, lei::IndicatorType type)
+{
+    InvalidateChartLayer();
+    subsidiary_indicators_[chart_index - 1] = MakeIndicator(type);
+    HandleZoomChanged();
+    ScheduleRepaint();
+}
+
+std::unique_ptr<lei::Indicator> MainComponent::MakeIndicator(lei::IndicatorType type)
+{
+    const auto GetKArray = std::bind(&MainComponent::GetKArray, this);
+    switch (type)
+    {
+    case lei::IndicatorType::kATR:
+        return std::make_unique<lei::ATR>(GetKArray, 14);
+    case lei::IndicatorType::kBollingerBands:
+        return std::make_unique<lei::BollingerBands>(GetKArray, 20, 2.0);
+    case lei::IndicatorType::kCCI:
+        return std::make_unique<lei::CCI>(GetKArray, 20);
+    case lei::IndicatorType::kDMI:
+        return std::make_unique<lei::DMI>(GetKArray, 14);
+    case lei::IndicatorType::kOBV:
+        return std::make_unique<lei::OBV>(GetKArray);
+    case lei::IndicatorType::kRSI:
+        return std::make_unique<lei::RSI>(GetKArray, 14);
+    case lei::IndicatorType::kVolumeProfile:
+        return std::make_unique<lei::VolumeProfile>(GetKArray);
+    case lei::IndicatorType::kVWAP:
+        return std::make_unique<lei::VWAP>(GetKArray);
+    case lei::IndicatorType::kWilliamsR:
+        return std::make_unique<lei::WilliamsR>(GetKArray, 14);
+    default:
+        jassertfalse;
+        return nullptr;
+    }
+}
+
+void MainComponent::RunScreener()
+{
+    auto* window = new juce::AlertWindow(juce::translate("screener"),
+                                         juce::translate("e.g. C > MA(C, 22) AND CROSS(K(9, 3), D(9, 3, 3))"),
+                                         juce::MessageBoxIconType::NoIcon,
+                                         this);
+
+    window->addTextEditor("condition", {}, juce::translate("condition"));
+    window->addTextEditor("rank", "V", juce::translate("rank by"));
+    window->addButton(juce::translate("ok"), 1, juce::KeyPress(juce::KeyPress::returnKey));
+    window->addButton(juce::translate("cancel"), 0, juce::KeyPress(juce::KeyPress::escapeKey));
+    window->enterModalState(true, juce::ModalCallbackFunction::create([this, window](int result)
+                            {
+                                if (result == 0)
+                                {
+                                    return;
+                                }
+
+                                auto screener = std::make_shared<lei::Screener>();
+                                auto compiled = screener->SetCondition(window->getTextEditorContents("condition"));
+                                if (compiled.wasOk())
+                                {
+                                    compiled = screener->SetRank(window->getTextEditorContents("rank"));
+                                }
+
+                                if (compiled.failed())
+                                {
+                                    juce::AlertWindow::showMessageBoxAsync(juce::MessageBoxIconType::WarningIcon,
+                                                                           juce::translate("screener"),
+                                                                           compiled.getErrorMessage());
+                                    return;
+                                }
+
+                                // The first run loads every data file, so it stays off the message thread.
+                                screener_button_.setEnabled(false);
+                                juce::Thread::launch([safe_this = juce::Component::SafePointer<MainComponent>(this), screener, frequency = data_frequency_]
+                                                     {
+                                                         const auto start = juce::Time::getMillisecondCounterHiRes();
+                                                         auto results = screener->Run(lei::GetKDataCenter().GetStockIds(frequency), frequency);
+                                                         const auto elapsed = juce::Time::getMillisecondCounterHiRes() - start;
+
+                                                         juce::MessageManager::callAsync([safe_this, results = std::move(results), elapsed]
+                                                                                         {
+                                                                                             if (safe_this != nullptr)
+                                                                                             {
+                                                                                                 safe_this->ShowScreenerResults(results, elapsed);
+                                                                                             }
+                                                                                         });
+                                                     });
+                            }),
+                            true);
+}
+
+void MainComponent::ShowScreenerResults(const std::vector<lei::ScreenerResult>& results, double elapsed_ms)
+{
+    screener_button_.setEnabled(true);
+
+    const int kMaxMenuSize = 100;
+    juce::PopupMenu menu;
+    menu.addSectionHeader(juce::String(results.size()) + " " + juce::translate("matches") + ", " + juce::String(juce::roundToInt(elapsed_ms)) + " ms");
+    for (int i = 0; i < std::min<int>(results.size(), kMaxMenuSize); ++i)
+    {
+        const auto& match = results[i];
+        menu.addItem(juce::String(match.stock_id) + "    " + juce::String(match.close, 2) + "    " + juce::String(match.score, 2), [this, stock_id = match.stock_id]()
+                     {
+                         if (stock_id != stock_id_)
+                         {
+                             StockChanged(stock_id);
+                             ScheduleRepaint();
+                         }
+                     });
+    }
+
+    menu.showMenuAsync(juce::PopupMenu::Options().withTargetComponent(screener_button_));
+}
+
+void MainComponent::RunBacktest()
+{
+    auto* window = new juce::AlertWindow(juce::translate("backtest"),
+                                         juce::translate("e.g. CROSS(MA(C, 5), MA(C, 22))"),
+                                         juce::MessageBoxIconType::NoIcon,
+                                         this);
+
+    window->addTextEditor("entry", "CROSS(MA(C, 5), MA(C, 22))", juce::translate("entry"));
+    window->addTextEditor("exit", "CROSS(MA(C, 22), MA(C, 5))", juce::translate("exit"));
+    window->addComboBox("fill", { juce::translate("next open"), juce::translate("close") }, juce::translate("fill price"));
+    window->getComboBoxComponent("fill")->setSelectedItemIndex(0);
+    window->addButton(juce::translate("ok"), 1, juce::KeyPress(juce::KeyPress::returnKey));
+    window->addButton(juce::translate("cancel"), 0, juce::KeyPress(juce::KeyPress::escapeKey));
+    window->enterModalState(true, juce::ModalCallbackFunction::create([this, window](int result)
+                            {
+                                if (result == 0)
+                                {
+                                    return;
+                                }
+
+                                lei::Backtester backtester;
+                                auto compiled = backtester.SetEntry(window->getTextEditorContents("entry"));
+                                if (compiled.wasOk())
+                                {
+                                    compiled = backtester.SetExit(window->getTextEditorContents("exit"));
+                                }
+
+                                if (compiled.failed())
+                                {
+                                    juce::AlertWindow::showMessageBoxAsync(juce::MessageBoxIconType::WarningIcon,
+                                                                           juce::translate("backtest"),
+                                                                           compiled.getErrorMessage());
+                                    return;
+                                }
+
+                                lei::BacktestSettings settings;
+                                settings.fill_price = window->getComboBoxComponent("fill")->getSelectedItemIndex() == 0 ? lei::FillPrice::kNextOpen : lei::FillPrice::kClose;
+
+                                const auto backtest = backtester.Run(GetKArray(), settings);
+                                const auto win_size = std::count_if(backtest.trades.begin(), backtest.trades.end(), [](const lei::Trade& trade)
+                                                                    {
+                                                                        return trade.profit > 0;
+                                                                    });
+
+                                juce::String message;
+                                message << juce::translate("trades") << ": " << static_cast<int>(backtest.trades.size()) << "\n"
+                                        << juce::translate("win rate") << ": " << juce::String(backtest.trades.empty() ? 0.0 : 100.0 * win_size / backtest.trades.size(), 2) << "%\n"
+                                        << juce::translate("return") << ": " << juce::String(100.0 * (backtest.final_equity / settings.initial_capital - 1), 2) << "%\n"
+                                        << juce::translate("max drawdown") << ": " << juce::String(100.0 * backtest.max_drawdown, 2) << "%\n"
+                                        << juce::translate("final equity") << ": " << juce::String(backtest.final_equity, 0);
+
+                                juce::AlertWindow::showMessageBoxAsync(juce::MessageBoxIconType::InfoIcon, juce::translate("backtest") + " " + stock_id_, message);
+                            }),
+                            true);
+}
+
+int MainComponent::GetSubsidiaryChartSize() const
+{
+    return compact_ ? kCompactSubsidiaryChartSize : kSubsidiaryChartSize;
+}
+
+bool MainComponent::IsToolShown(const lei::Tool& tool) const
+{
+    // Tools on charts a compact view doesn't show come back with the charts.
+    return IsAcrossCharts(tool.GetToolType()) || tool.GetChartIndex() <= GetSubsidiaryChartSize();
+}
+
 int MainComponent::CalculateScreenKSize() const
 {
-    return (k_chart_bounds_.reduced(lei::kChartBorderThickness).getWidth() - lei::kBarGap) / (bar_width_ + lei::kBarGap);
+    return GetViewportTransform().GetVisibleBarCount(chart_layout_.k_chart.reduced(lei::kChartBorderThickness).getWidth());
+}
+
+float MainComponent::GetMinBarPitch() const
+{
+    // The pitch at which the whole series fits, a short one stops at the narrowest bar.
+    const auto chart_width = chart_layout_.k_chart.reduced(lei::kChartBorderThickness).getWidth();
+    const auto bar_size = std::max<std::size_t>(std::get<0>(GetKArray()).size(), 1);
+    return std::min(static_cast<float>(lei::kMinBarPitch), static_cast<float>(chart_width - lei::kBarGap) / bar_size);
+}
+
+lei::ViewportTransform MainComponent::GetViewportTransform() const
+{
+    return { chart_layout_.k_chart.reduced(lei::kChartBorderThickness).getX(), chart_scroll_bar_.getCurrentRangeStart(), bar_pitch_ };
 }
 
 int MainComponent::GetKIndexRestrictInBounds(const juce::Point<int>& pt) const
 {
-    const auto bounds = k_chart_bounds_.reduced(lei::kChartBorderThickness);
     const auto current_range = ToInt(chart_scroll_bar_.getCurrentRange());
-    int index = current_range.getStart() + (pt.getX() - bounds.getX() - lei::kBarGap / 2.0) / (bar_width_ + lei::kBarGap);
+    auto index = GetViewportTransform().XToIndex(static_cast<float>(pt.getX()));
     index = std::max(index, current_range.getStart());
     index = std::min(index, current_range.getEnd() - 1);
     return index;
@@ -636,26 +1243,25 @@ int MainComponent::GetKIndexRestrictInBounds(const juce::Point<int>& pt) const
 
 int MainComponent::GetKCentreXRestrictInBounds(const juce::Point<int>& pt) const
 {
-    const auto bounds = k_chart_bounds_.reduced(lei::kChartBorderThickness);
-    const auto distance = GetKIndexRestrictInBounds(pt) - juce::roundToInt(chart_scroll_bar_.getCurrentRangeStart());
-    return bounds.getX() + lei::kBarGap + distance * (bar_width_ + lei::kBarGap) + bar_width_ / 2.0; // don't use round to int, because bar_bounds.getCentreX in K::DrawKBar not use.
+    // Floor, the wick of K::DrawKBar is the pixel left of the centre.
+    return static_cast<int>(std::floor(GetViewportTransform().IndexToX(GetKIndexRestrictInBounds(pt))));
 }
 
 int MainComponent::GetChartIndex(const juce::Point<int>& pt) const
 {
-    if (pt.getY() <= k_chart_bounds_.getBottom())
+    if (pt.getY() <= chart_layout_.k_chart.getBottom())
     {
         return 0;
     }
-    else if (pt.getY() >= subsidiary_charts_bounds_.rbegin()->getY())
+    else if (pt.getY() >= chart_layout_.subsidiary_charts.rbegin()->getY())
     {
-        return kSubsidiaryChartSize;
+        return GetSubsidiaryChartSize();
     }
     else
     {
-        for (int i = 0; i < kSubsidiaryChartSize - 1; ++i)
+        for (int i = 0; i < GetSubsidiaryChartSize() - 1; ++i)
         {
-            if (subsidiary_charts_bounds_[i].getY() <= pt.getY() && pt.getY() <= subsidiary_charts_bounds_[i].getBottom())
+            if (chart_layout_.subsidiary_charts[i].getY() <= pt.getY() && pt.getY() <= chart_layout_.subsidiary_charts[i].getBottom())
             {
                 return i + 1;
             }
@@ -667,21 +1273,21 @@ int MainComponent::GetChartIndex(const juce::Point<int>& pt) const
 
 juce::Rectangle<int> MainComponent::GetChartBounds(const juce::Point<int>& pt) const
 {
-    if (pt.getY() <= k_chart_bounds_.getBottom())
+    if (pt.getY() <= chart_layout_.k_chart.getBottom())
     {
-        return k_chart_bounds_;
+        return chart_layout_.k_chart;
     }
-    else if (pt.getY() >= subsidiary_charts_bounds_.rbegin()->getY())
+    else if (pt.getY() >= chart_layout_.subsidiary_charts.rbegin()->getY())
     {
-        return *subsidiary_charts_bounds_.rbegin();
+        return *chart_layout_.subsidiary_charts.rbegin();
     }
     else
     {
-        for (int i = 0; i < kSubsidiaryChartSize - 1; ++i)
+        for (int i = 0; i < GetSubsidiaryChartSize() - 1; ++i)
         {
-            if (subsidiary_charts_bounds_[i].getY() <= pt.getY() && pt.getY() <= subsidiary_charts_bounds_[i].getBottom())
+            if (chart_layout_.subsidiary_charts[i].getY() <= pt.getY() && pt.getY() <= chart_layout_.subsidiary_charts[i].getBottom())
             {
-                return subsidiary_charts_bounds_[i];
+                return chart_layout_.subsidiary_charts[i];
             }
         }
     }
@@ -693,11 +1299,11 @@ juce::Rectangle<int> MainComponent::GetChartBounds(int chart_index) const
 {
     if (chart_index == 0)
     {
-        return k_chart_bounds_;
+        return chart_layout_.k_chart;
     }
-    else if (1 <= chart_index && chart_index <= kSubsidiaryChartSize)
+    else if (1 <= chart_index && chart_index <= GetSubsidiaryChartSize())
     {
-        return subsidiary_charts_bounds_[chart_index - 1];
+        return chart_layout_.subsidiary_charts[chart_index - 1];
     }
 
     return {};
@@ -705,21 +1311,21 @@ juce::Rectangle<int> MainComponent::GetChartBounds(int chart_index) const
 
 juce::Rectangle<int> MainComponent::GetPriceLabelBounds(const juce::Point<int>& pt) const
 {
-    if (pt.getY() <= k_chart_bounds_.getBottom())
+    if (pt.getY() <= chart_layout_.k_chart.getBottom())
     {
-        return k_price_label_bounds_;
+        return chart_layout_.k_price_label;
     }
-    else if (pt.getY() >= subsidiary_charts_bounds_.rbegin()->getY())
+    else if (pt.getY() >= chart_layout_.subsidiary_charts.rbegin()->getY())
     {
-        return *subsidiary_labels_bounds_.rbegin();
+        return *chart_layout_.subsidiary_labels.rbegin();
     }
     else
     {
-        for (int i = 0; i < kSubsidiaryChartSize - 1; ++i)
+        for (int i = 0; i < GetSubsidiaryChartSize() - 1; ++i)
         {
-            if (subsidiary_charts_bounds_[i].getY() <= pt.getY() && pt.getY() <= subsidiary_charts_bounds_[i].getBottom())
+            if (chart_layout_.subsidiary_charts[i].getY() <= pt.getY() && pt.getY() <= chart_layout_.subsidiary_charts[i].getBottom())
             {
-                return subsidiary_labels_bounds_[i];
+                return chart_layout_.subsidiary_labels[i];
             }
         }
     }
@@ -729,19 +1335,19 @@ juce::Rectangle<int> MainComponent::GetPriceLabelBounds(const juce::Point<int>&
 
 std::pair<double, double> MainComponent::GetChartMinMaxLabel(const juce::Point<int>& pt) const
 {
-    if (pt.getY() <= k_chart_bounds_.getBottom())
+    if (pt.getY() <= chart_layout_.k_chart.getBottom())
     {
         return k_chart_min_max_label_;
     }
-    else if (pt.getY() >= subsidiary_charts_bounds_.rbegin()->getY())
+    else if (pt.getY() >= chart_layout_.subsidiary_charts.rbegin()->getY())
     {
-        return (*subsidiary_indicators_.rbegin())->GetMinMaxLabelValue();
+        return subsidiary_indicators_[GetSubsidiaryChartSize() - 1]->GetMinMaxLabelValue();
     }
     else
     {
-        for (int i = 0; i < kSubsidiaryChartSize - 1; ++i)
+        for (int i = 0; i < GetSubsidiaryChartSize() - 1; ++i)
         {
-            if (subsidiary_charts_bounds_[i].getY() <= pt.getY() && pt.getY() <= subsidiary_charts_bounds_[i].getBottom())
+            if (chart_layout_.subsidiary_charts[i].getY() <= pt.getY() && pt.getY() <= chart_layout_.subsidiary_charts[i].getBottom())
             {
                 return subsidiary_indicators_[i]->GetMinMaxLabelValue();
             }
@@ -757,7 +1363,7 @@ std::pair<double, double> MainComponent::GetChartMinMaxLabel(int chart_index) co
     {
         return k_chart_min_max_label_;
     }
-    else if (1 <= chart_index && chart_index <= kSubsidiaryChartSize)
+    else if (1 <= chart_index && chart_index <= GetSubsidiaryChartSize())
     {
         return subsidiary_indicators_[chart_index - 1]->GetMinMaxLabelValue();
     }
@@ -775,9 +1381,14 @@ void MainComponent::UnregisterEraseButton(const std::shared_ptr<juce::Button>& e
     erase_button->removeListener(this);
 }
 
-std::unordered_map<juce::Uuid, std::weak_ptr<lei::Tool>> MainComponent::GetTools(const std::string& stock_id, lei::DataFrequency data_frequency) const
+lei::ToolKey MainComponent::GetToolKey() const
+{
+    return { stock_id_, data_frequency_, bar_setting_.type };
+}
+
+std::unordered_map<juce::Uuid, std::weak_ptr<lei::Tool>> MainComponent::GetTools(const lei::ToolKey& key) const
 {
-    const auto pos = tools_.find({ stock_id_, data_frequency_ });
+    const auto pos = tools_.find(key);
     if (pos != tools_.end())
     {
         std::unordered_map<juce::Uuid, std::weak_ptr<lei::Tool>> tools;
@@ -1,13 +1,20 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "BarType.h"
 #include "Indicator/Indicator.h"
 #include "KChart/KChart.h"
 #include "Key.h"
 #include "Layout.h"
+#include "Render/ChartLayer.h"
+#include "Render/FrameScheduler.h"
+#include "Render/PaneRenderer.h"
+#include "Render/RepaintStats.h"
+#include "Screener/Screener.h"
 #include "Tool/Tool.h"
 #include "Tool/ToolType.h"
 #include "WatchTool/WatchTool.h"
+#include <optional>
 
 //==============================================================================
 /*
@@ -18,12 +25,13 @@
 class MainComponent : public juce::Component, public juce::ScrollBar::Listener, public juce::Button::Listener, public juce::TextEditor::Listener
 {
 public:
-    MainComponent();
+    explicit MainComponent(const std::string& stock_id);
     ~MainComponent() override;
 
 public:
     void paint(juce::Graphics& g) override;
     void resized() override;
+    void visibilityChanged() override;
     void scrollBarMoved(juce::ScrollBar* scroll_bar_that_has_moved, double new_range_start) override;
     void buttonClicked(juce::Button* button) override;
     void textEditorReturnKeyPressed(juce::TextEditor& text_editor) override;
@@ -33,19 +41,48 @@ public:
     void mouseDown(const juce::MouseEvent& event) override;
     void mouseDrag(const juce::MouseEvent& event) override;
     void mouseUp(const juce::MouseEvent& event) override;
+    void mouseWheelMove(const juce::MouseEvent& event, const juce::MouseWheelDetails& wheel) override;
+    void mouseMagnify(const juce::MouseEvent& event, float scale_factor) override;
 
 public:
+    // A compact view, for a cell of a grid, has no screener and backtest buttons and shows fewer subsidiary charts.
+    void SetCompact(bool compact);
     const lei::KArray& GetKArray() const;
+    const lei::TimeBoundaryIndex& GetTimeBoundaries() const;
 
 private:
-    void DrawKChart(juce::Graphics& g);
-    void DrawSubsidiaryCharts(juce::Graphics& g);
+    void ScheduleZoomChanged();
+    void ScheduleRepaint();
+    void ScheduleRepaint(const juce::Rectangle<int>& area);
+    bool RunFrame();
+    void InvalidateChartLayer();
+    void RenderChartLayer(float scale);
+    void DrawTools(juce::Graphics& g);
     void DrawWatchToolMessage(juce::Graphics& g);
+    void WatchToolMouseEvent(const juce::Point<int>& pt);
+    juce::RectangleList<int> GetWatchToolMessageArea() const;
     void HandleZoomChanged();
+    void Zoom(float bar_pitch, std::optional<int> anchor_x);
     void StockChanged(const std::string& stock_id);
     void DataFrequencyChanged(lei::DataFrequency frequency);
+    void ResetIndicators();
+    void ChooseBarType(lei::BarType type);
+    void BarSettingChanged(const lei::BarSetting& setting);
+    void UpdateBarSize();
     void ToolChanged(lei::ToolType tool_type);
+    void SetDefaultIndicators();
+    void AddExpressionIndicator(int chart_index);
+    void ToggleOverlayIndicator(lei::IndicatorType type);
+    void SetSubsidiaryIndicator(int chart_index, lei::IndicatorType type);
+    std::unique_ptr<lei::Indicator> MakeIndicator(lei::IndicatorType type);
+    void RunScreener();
+    void ShowScreenerResults(const std::vector<lei::ScreenerResult>& results, double elapsed_ms);
+    void RunBacktest();
+    int GetSubsidiaryChartSize() const;
+    bool IsToolShown(const lei::Tool& tool) const;
     int CalculateScreenKSize() const;
+    float GetMinBarPitch() const;
+    lei::ViewportTransform GetViewportTransform() const;
     int GetKIndexRestrictInBounds(const juce::Point<int>& pt) const;
     int GetKCentreXRestrictInBounds(const juce::Point<int>& pt) const;
     int GetChartIndex(const juce::Point<int>& pt) const;
@@ -60,42 +97,56 @@ private:
 
     void RegisterEraseButton(const std::shared_ptr<juce::Button>& erase_button);
     void UnregisterEraseButton(const std::shared_ptr<juce::Button>& erase_button);
-    std::unordered_map<juce::Uuid, std::weak_ptr<lei::Tool>> GetTools(const std::string& stock_id, lei::DataFrequency data_frequency) const;
+    lei::ToolKey GetToolKey() const;
+    std::unordered_map<juce::Uuid, std::weak_ptr<lei::Tool>> GetTools(const lei::ToolKey& key) const;
 
 private:
     enum
     {
         kMainIndicatorSize = 3,
-        kSubsidiaryChartSize = 3
+        kSubsidiaryChartSize = 3,
+        kCompactSubsidiaryChartSize = 1
     };
 
     juce::TextEditor stock_search_bar_;
     juce::TextButton data_frequency_button_;
     juce::TextButton tool_button_;
+    juce::TextButton indicator_button_;
+    juce::TextButton screener_button_;
+    juce::TextButton backtest_button_;
 
     juce::Rectangle<int> toolbar_bounds_;
-    juce::Rectangle<int> header_bounds_;
-    juce::Rectangle<int> chart_bounds_;
-    juce::Rectangle<int> time_label_bounds_;
+    lei::ChartLayout chart_layout_;
 
-    juce::Rectangle<int> k_chart_bounds_;
-    juce::Rectangle<int> k_price_label_bounds_;
+    juce::ScrollBar chart_scroll_bar_;
+    bool compact_ = false;
 
-    std::deque<juce::Rectangle<int>> subsidiary_charts_bounds_;
-    std::deque<juce::Rectangle<int>> subsidiary_labels_bounds_;
+    // Everything below the crosshair, redrawn only after data, zoom, scroll or tool changes.
+    float chart_layer_scale_ = 0.0f;
+    bool chart_layer_valid_ = false;
 
-    juce::ScrollBar chart_scroll_bar_;
+    lei::RepaintStats repaint_stats_;
+    bool log_repaint_stats_ = false;
+
+    // Scroll, zoom, mouse moves, drags and repaints wait for the next frame, so a burst of them costs one frame.
+    lei::FrameScheduler frame_scheduler_;
+    bool zoom_changed_pending_ = false;
+    std::optional<juce::Point<int>> pending_mouse_position_;
+    std::optional<juce::Point<int>> pending_drag_position_;
+    juce::RectangleList<int> pending_repaint_;
 
     juce::ImageButton zoom_in_button_;
     juce::ImageButton zoom_out_button_;
     juce::ImageButton zoom_reset_button_;
-    int bar_width_ = lei::kDefaultBarWidth;
+    float bar_pitch_ = lei::kDefaultBarWidth + lei::kBarGap;
 
     std::string stock_id_;
     lei::DataFrequency data_frequency_;
+    lei::BarSetting bar_setting_;
+    double bar_size_in_atr_ = 0.0; // Renko and range sizes follow the volatility of the stock and frequency shown
 
     lei::ToolType tool_type_;
-    std::unordered_map<std::pair<std::string, lei::DataFrequency>, std::unordered_map<juce::Uuid, std::shared_ptr<lei::Tool>>> tools_;
+    std::unordered_map<lei::ToolKey, std::unordered_map<juce::Uuid, std::shared_ptr<lei::Tool>>> tools_;
     std::unique_ptr<lei::Tool> tool_;
 
     int k_index_ = 0;
@@ -105,8 +156,12 @@ private:
 
     std::array<std::unique_ptr<lei::Indicator>, kMainIndicatorSize> main_indicators_;
     std::array<std::unique_ptr<lei::Indicator>, kSubsidiaryChartSize> subsidiary_indicators_;
+    std::vector<std::unique_ptr<lei::Indicator>> overlay_indicators_;
 
     std::unique_ptr<lei::KChart> k_chart_;
 
+    // Last, so a frame still rendering finishes before the rest of the component goes.
+    lei::PaneRenderer pane_renderer_;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MainComponent)
 };
@@ -0,0 +1,268 @@
+// © 2023 Lei Cheng
+
+#include "CandlestickScanner.h"
+#include "Kernel/TaskScheduler.h"
+
+namespace lei
+{
+    namespace
+    {
+        constexpr std::size_t kWordBits = 64;
+
+        // Shape thresholds as fractions of the high-low range or of the body.
+        constexpr double kDojiBodyRatio = 0.1;
+        constexpr double kSmallBodyRatio = 0.3;
+        constexpr double kLongBodyRatio = 0.6;
+        constexpr double kSmallShadowRatio = 0.1;
+        constexpr double kLongShadowBodyMultiple = 2.0;
+    }
+
+    juce::String GetPatternName(CandlestickPattern pattern)
+    {
+        switch (pattern)
+        {
+        case CandlestickPattern::kDoji:
+            return "doji";
+        case CandlestickPattern::kHammer:
+            return "hammer";
+        case CandlestickPattern::kShootingStar:
+            return "shooting star";
+        case CandlestickPattern::kBullishEngulfing:
+            return "bullish engulfing";
+        case CandlestickPattern::kBearishEngulfing:
+            return "bearish engulfing";
+        case CandlestickPattern::kBullishHarami:
+            return "bullish harami";
+        case CandlestickPattern::kBearishHarami:
+            return "bearish harami";
+        case CandlestickPattern::kMorningStar:
+            return "morning star";
+        case CandlestickPattern::kEveningStar:
+            return "evening star";
+        default:
+            break;
+        }
+
+        return "";
+    }
+
+    int GetPatternDirection(CandlestickPattern pattern)
+    {
+        switch (pattern)
+        {
+        case CandlestickPattern::kHammer:
+        case CandlestickPattern::kBullishEngulfing:
+        case CandlestickPattern::kBullishHarami:
+        case CandlestickPattern::kMorningStar:
+            return 1;
+        case CandlestickPattern::kShootingStar:
+        case CandlestickPattern::kBearishEngulfing:
+        case CandlestickPattern::kBearishHarami:
+        case CandlestickPattern::kEveningStar:
+            return -1;
+        default:
+            break;
+        }
+
+        return 0;
+    }
+
+    void CandlestickScanner::Reset()
+    {
+        for (auto& feature : features_)
+        {
+            feature.clear();
+        }
+
+        for (auto& pattern : patterns_)
+        {
+            pattern.clear();
+        }
+
+        any_.clear();
+        size_ = 0;
+    }
+
+    void CandlestickScanner::Update(const KArray& k_array)
+    {
+        const auto size = std::get<4>(k_array).size();
+        if (size < size_)
+        {
+            Reset();
+        }
+
+        if (size == size_)
+        {
+            return;
+        }
+
+        const auto first_word = size_ / kWordBits;
+        const auto word_size = (size + kWordBits - 1) / kWordBits;
+        for (auto& feature : features_)
+        {
+            feature.resize(word_size);
+        }
+
+        for (auto& pattern : patterns_)
+        {
+            pattern.resize(word_size);
+        }
+
+        any_.resize(word_size);
+
+        size_ = size;
+        for (auto word_index = first_word; word_index < word_size; ++word_index)
+        {
+            ScanFeatures(k_array, word_index);
+            CombinePatterns(word_index);
+        }
+    }
+
+    bool CandlestickScanner::Test(CandlestickPattern pattern, std::size_t index) const
+    {
+        const auto& mask = patterns_[static_cast<std::size_t>(pattern)];
+        return index < size_ && (mask[index / kWordBits] >> (index % kWordBits) & 1) != 0;
+    }
+
+    std::uint64_t CandlestickScanner::GetAnyWord(std::size_t word_index) const
+    {
+        return word_index < any_.size() ? any_[word_index] : 0;
+    }
+
+    std::size_t CandlestickScanner::size() const
+    {
+        return size_;
+    }
+
+    void CandlestickScanner::ScanFeatures(const KArray& k_array, std::size_t word_index)
+    {
+        const auto* open = std::get<1>(k_array).data();
+        const auto* high = std::get<2>(k_array).data();
+        const auto* low = std::get<3>(k_array).data();
+        const auto* close = std::get<4>(k_array).data();
+
+        // Branch-free predicates over one word of bars, every bit is written so a rescanned word starts clean.
+        std::array<std::uint64_t, kFeatureSize> words{};
+        const auto begin = word_index * kWordBits;
+        const auto end = std::min(begin + kWordBits, size_);
+        for (auto i = begin; i < end; ++i)
+        {
+            const auto bit = i - begin;
+            const auto range = high[i] - low[i];
+            const auto body_top = std::max(open[i], close[i]);
+            const auto body_bottom = std::min(open[i], close[i]);
+            const auto body = body_top - body_bottom;
+            const auto upper = high[i] - body_top;
+            const auto lower = body_bottom - low[i];
+            const bool has_range = range > 0;
+
+            words[kBull] |= static_cast<std::uint64_t>(close[i] > open[i]) << bit;
+            words[kBear] |= static_cast<std::uint64_t>(close[i] < open[i]) << bit;
+            words[kDojiBody] |= static_cast<std::uint64_t>(has_range & (body <= range * kDojiBodyRatio)) << bit;
+            words[kSmallBody] |= static_cast<std::uint64_t>(has_range & (body <= range * kSmallBodyRatio)) << bit;
+            words[kLongBody] |= static_cast<std::uint64_t>(has_range & (body >= range * kLongBodyRatio)) << bit;
+            words[kLongLowerShadow] |= static_cast<std::uint64_t>(has_range & (lower >= body * kLongShadowBodyMultiple)) << bit;
+            words[kLongUpperShadow] |= static_cast<std::uint64_t>(has_range & (upper >= body * kLongShadowBodyMultiple)) << bit;
+            words[kSmallLowerShadow] |= static_cast<std::uint64_t>(lower <= range * kSmallShadowRatio) << bit;
+            words[kSmallUpperShadow] |= static_cast<std::uint64_t>(upper <= range * kSmallShadowRatio) << bit;
+
+            if (i >= 1)
+            {
+                const auto pre_body_top = std::max(open[i - 1], close[i - 1]);
+                const auto pre_body_bottom = std::min(open[i - 1], close[i - 1]);
+                const auto pre_body = pre_body_top - pre_body_bottom;
+                words[kEngulfsPrevious] |= static_cast<std::uint64_t>((body_top >= pre_body_top) & (body_bottom <= pre_body_bottom) & (body > pre_body)) << bit;
+                words[kInsidePrevious] |= static_cast<std::uint64_t>((body_top <= pre_body_top) & (body_bottom >= pre_body_bottom) & (body < pre_body)) << bit;
+                words[kGapUp] |= static_cast<std::uint64_t>(body_bottom > pre_body_top) << bit;
+                words[kGapDown] |= static_cast<std::uint64_t>(body_top < pre_body_bottom) << bit;
+            }
+
+            if (i >= 2)
+            {
+                const auto midpoint = (open[i - 2] + close[i - 2]) / 2;
+                words[kAboveMidpoint] |= static_cast<std::uint64_t>(close[i] > midpoint) << bit;
+                words[kBelowMidpoint] |= static_cast<std::uint64_t>(close[i] < midpoint) << bit;
+            }
+        }
+
+        for (std::size_t feature = 0; feature < kFeatureSize; ++feature)
+        {
+            features_[feature][word_index] = words[feature];
+        }
+    }
+
+    void CandlestickScanner::CombinePatterns(std::size_t word_index)
+    {
+        const auto Word = [this, word_index](Feature feature)
+            {
+                return features_[feature][word_index];
+            };
+
+        const auto Previous = [this, word_index](Feature feature, int shift)
+            {
+                return Shift(features_[feature], word_index, shift);
+            };
+
+        const auto Set = [this, word_index](CandlestickPattern pattern, std::uint64_t word)
+            {
+                patterns_[static_cast<std::size_t>(pattern)][word_index] = word;
+            };
+
+        Set(CandlestickPattern::kDoji, Word(kDojiBody));
+        Set(CandlestickPattern::kHammer, Word(kSmallBody) & ~Word(kDojiBody) & Word(kLongLowerShadow) & Word(kSmallUpperShadow));
+        Set(CandlestickPattern::kShootingStar, Word(kSmallBody) & ~Word(kDojiBody) & Word(kLongUpperShadow) & Word(kSmallLowerShadow));
+        Set(CandlestickPattern::kBullishEngulfing, Word(kBull) & Word(kEngulfsPrevious) & Previous(kBear, 1));
+        Set(CandlestickPattern::kBearishEngulfing, Word(kBear) & Word(kEngulfsPrevious) & Previous(kBull, 1));
+        Set(CandlestickPattern::kBullishHarami, Word(kBull) & Word(kInsidePrevious) & Previous(kBear, 1) & Previous(kLongBody, 1));
+        Set(CandlestickPattern::kBearishHarami, Word(kBear) & Word(kInsidePrevious) & Previous(kBull, 1) & Previous(kLongBody, 1));
+        Set(CandlestickPattern::kMorningStar,
+            Word(kBull) & Word(kAboveMidpoint) & Previous(kSmallBody, 1) & Previous(kGapDown, 1) & Previous(kBear, 2) & Previous(kLongBody, 2));
+        Set(CandlestickPattern::kEveningStar,
+            Word(kBear) & Word(kBelowMidpoint) & Previous(kSmallBody, 1) & Previous(kGapUp, 1) & Previous(kBull, 2) & Previous(kLongBody, 2));
+
+        std::uint64_t any = 0;
+        for (const auto& pattern : patterns_)
+        {
+            any |= pattern[word_index];
+        }
+
+        any_[word_index] = any;
+    }
+
+    std::uint64_t CandlestickScanner::Shift(const BarMask& mask, std::size_t word_index, int shift) const
+    {
+        const auto carry = word_index > 0 ? mask[word_index - 1] >> (kWordBits - shift) : 0;
+        return mask[word_index] << shift | carry;
+    }
+
+    std::vector<PatternHit> ScanPatterns(const std::vector<std::string>& stock_ids, DataFrequency frequency, std::size_t last_size)
+    {
+        std::vector<std::vector<PatternHit>> symbol_hits(stock_ids.size());
+        GetTaskScheduler().ParallelFor(stock_ids.size(), [&](std::size_t i)
+                                       {
+                                           const auto& k_array = GetKDataCenter().GetKData(stock_ids[i], frequency);
+                                           CandlestickScanner scanner;
+                                           scanner.Update(k_array);
+
+                                           const auto size = scanner.size();
+                                           for (auto index = size - std::min(last_size, size); index < size; ++index)
+                                           {
+                                               for (std::size_t pattern = 0; pattern < static_cast<std::size_t>(CandlestickPattern::kSize); ++pattern)
+                                               {
+                                                   if (scanner.Test(static_cast<CandlestickPattern>(pattern), index))
+                                                   {
+                                                       symbol_hits[i].push_back({ stock_ids[i], std::get<0>(k_array)[index], static_cast<CandlestickPattern>(pattern) });
+                                                   }
+                                               }
+                                           }
+                                       });
+
+        std::vector<PatternHit> hits;
+        for (auto& symbol_hit : symbol_hits)
+        {
+            hits.insert(hits.end(), std::make_move_iterator(symbol_hit.begin()), std::make_move_iterator(symbol_hit.end()));
+        }
+
+        return hits;
+    }
+}
@@ -0,0 +1,97 @@
+// © 2023 Lei Cheng
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Data/DataCenter.h"
+
+namespace lei
+{
+    enum class CandlestickPattern
+    {
+        kDoji,
+        kHammer,
+        kShootingStar,
+        kBullishEngulfing,
+        kBearishEngulfing,
+        kBullishHarami,
+        kBearishHarami,
+        kMorningStar,
+        kEveningStar,
+        kSize
+    };
+
+    juce::String GetPatternName(CandlestickPattern pattern);
+
+    // 1 for bullish patterns, -1 for bearish ones and 0 when the pattern only marks indecision.
+    int GetPatternDirection(CandlestickPattern pattern);
+
+    // One bit per bar: bar i is bit i % 64 of word i / 64.
+    using BarMask = std::vector<std::uint64_t>;
+
+    // Per-bar shape predicates are packed into masks 64 bars at a time, then multi-bar patterns combine them with
+    // shifted bitwise operations, e.g. a bullish engulfing is bull & engulfs & (bear shifted by one bar). A pattern only
+    // looks back, so appending bars rescans from the word holding the first new bar.
+    class CandlestickScanner final
+    {
+    public:
+        CandlestickScanner() = default;
+        ~CandlestickScanner() = default;
+
+    public:
+        void Reset();
+
+        void Update(const KArray& k_array);
+
+        bool Test(CandlestickPattern pattern, std::size_t index) const;
+
+        // Bit set when any pattern hits the bar, used to skip empty words quickly.
+        std::uint64_t GetAnyWord(std::size_t word_index) const;
+
+        std::size_t size() const;
+
+    private:
+        enum Feature
+        {
+            kBull,
+            kBear,
+            kDojiBody,
+            kSmallBody,
+            kLongBody,
+            kLongLowerShadow,
+            kLongUpperShadow,
+            kSmallLowerShadow,
+            kSmallUpperShadow,
+            kEngulfsPrevious,
+            kInsidePrevious,
+            kGapUp,
+            kGapDown,
+            kAboveMidpoint,
+            kBelowMidpoint,
+            kFeatureSize
+        };
+
+        void ScanFeatures(const KArray& k_array, std::size_t word_index);
+
+        void CombinePatterns(std::size_t word_index);
+
+        // Word word_index of the mask shifted towards later bars by shift bars.
+        std::uint64_t Shift(const BarMask& mask, std::size_t word_index, int shift) const;
+
+    private:
+        std::array<BarMask, kFeatureSize> features_;
+        std::array<BarMask, static_cast<std::size_t>(CandlestickPattern::kSize)> patterns_;
+        BarMask any_;
+        std::size_t size_ = 0;
+    };
+
+    struct PatternHit
+    {
+        std::string stock_id;
+        juce::Time date_time;
+        CandlestickPattern pattern;
+    };
+
+    // Every pattern hit within the last last_size bars of each symbol, scanned in parallel on the task scheduler.
+    std::vector<PatternHit> ScanPatterns(const std::vector<std::string>& stock_ids, DataFrequency frequency, std::size_t last_size);
+}
@@ -0,0 +1,366 @@
+// © 2023 Lei Cheng
+
+#include "Correlation.h"
+#include "Kernel/TaskScheduler.h"
+
+namespace lei
+{
+    namespace
+    {
+        constexpr std::size_t kSymbolTile = 64;
+        constexpr std::size_t kRowBlock = 256;
+
+        // output[i * n + j] += sum over rows of x(t, i) * x(t, j) for j >= i, rows taken from [begin_row, end_row).
+        void CrossProduct(const double* x, std::size_t n, std::size_t begin_row, std::size_t end_row, double* output)
+        {
+            const auto tile_size = (n + kSymbolTile - 1) / kSymbolTile;
+            std::vector<std::pair<std::size_t, std::size_t>> tiles;
+            for (std::size_t i = 0; i < tile_size; ++i)
+            {
+                for (auto j = i; j < tile_size; ++j)
+                {
+                    tiles.emplace_back(i, j);
+                }
+            }
+
+            GetTaskScheduler().ParallelFor(tiles.size(), [&](std::size_t tile)
+                                           {
+                                               const auto i_begin = tiles[tile].first * kSymbolTile;
+                                               const auto j_begin = tiles[tile].second * kSymbolTile;
+                                               const auto i_end = std::min(i_begin + kSymbolTile, n);
+                                               const auto j_end = std::min(j_begin + kSymbolTile, n);
+                                               const auto width = j_end - j_begin;
+
+                                               std::vector<double> accumulator((i_end - i_begin) * width, 0.0);
+                                               for (auto row_begin = begin_row; row_begin < end_row; row_begin += kRowBlock)
+                                               {
+                                                   const auto row_end = std::min(row_begin + kRowBlock, end_row);
+                                                   for (auto i = i_begin; i < i_end; ++i)
+                                                   {
+                                                       auto* acc = accumulator.data() + (i - i_begin) * width;
+                                                       for (auto t = row_begin; t < row_end; ++t)
+                                                       {
+                                                           const auto* row = x + t * n;
+                                                           const auto xi = row[i];
+                                                           for (std::size_t j = 0; j < width; ++j)
+                                                           {
+                                                               acc[j] += xi * row[j_begin + j];
+                                                           }
+                                                       }
+                                                   }
+                                               }
+
+                                               for (auto i = i_begin; i < i_end; ++i)
+                                               {
+                                                   for (auto j = std::max(i, j_begin); j < j_end; ++j)
+                                                   {
+                                                       output[i * n + j] += accumulator[(i - i_begin) * width + j - j_begin];
+                                                   }
+                                               }
+                                           });
+        }
+
+        void MirrorUpperTriangle(std::vector<double>& matrix, std::size_t n)
+        {
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                for (std::size_t j = 0; j < i; ++j)
+                {
+                    matrix[i * n + j] = matrix[j * n + i];
+                }
+            }
+        }
+    }
+
+    ReturnMatrix BuildReturnMatrix(const std::vector<std::string>& stock_ids, DataFrequency frequency)
+    {
+        ReturnMatrix returns;
+        std::vector<const KArray*> k_arrays;
+        for (const auto& stock_id : stock_ids)
+        {
+            const auto& k_array = GetKDataCenter().GetKData(stock_id, frequency);
+            if (std::get<0>(k_array).size() >= 2)
+            {
+                returns.stock_ids.push_back(stock_id);
+                k_arrays.push_back(&k_array);
+            }
+        }
+
+        const auto n = returns.stock_ids.size();
+        if (n == 0)
+        {
+            return returns;
+        }
+
+        // A date is kept when every symbol has a bar on it.
+        std::map<juce::int64, std::size_t> date_counts;
+        for (const auto* k_array : k_arrays)
+        {
+            auto previous_date = std::numeric_limits<juce::int64>::min();
+            for (const auto& date_time : std::get<0>(*k_array))
+            {
+                const auto date = date_time.toMilliseconds();
+                if (date != previous_date)
+                {
+                    ++date_counts[date];
+                    previous_date = date;
+                }
+            }
+        }
+
+        std::vector<juce::int64> common_dates;
+        for (const auto& [date, count] : date_counts)
+        {
+            if (count == n)
+            {
+                common_dates.push_back(date);
+            }
+        }
+
+        if (common_dates.size() < 2)
+        {
+            return returns;
+        }
+
+        const auto date_size = common_dates.size() - 1;
+        returns.values.resize(date_size * n);
+        for (std::size_t t = 1; t < common_dates.size(); ++t)
+        {
+            returns.dates.emplace_back(common_dates[t]);
+        }
+
+        // Both date lists are sorted, so one merge walk per symbol finds its closes on the common dates.
+        for (std::size_t s = 0; s < n; ++s)
+        {
+            const auto& date_time_array = std::get<0>(*k_arrays[s]);
+            const auto& close_array = std::get<4>(*k_arrays[s]);
+
+            std::size_t k = 0;
+            double previous_close = 0;
+            for (std::size_t t = 0; t < common_dates.size(); ++t)
+            {
+                while (date_time_array[k].toMilliseconds() < common_dates[t])
+                {
+                    ++k;
+                }
+
+                if (t > 0)
+                {
+                    returns.values[(t - 1) * n + s] = previous_close > 0 && close_array[k] > 0 ? std::log(close_array[k] / previous_close) : 0;
+                }
+
+                previous_close = close_array[k];
+            }
+        }
+
+        return returns;
+    }
+
+    std::vector<double> Covariance(const ReturnMatrix& returns, std::size_t begin_row, std::size_t end_row)
+    {
+        const auto n = returns.GetSymbolSize();
+        end_row = std::min(end_row, returns.GetDateSize());
+        if (n == 0 || end_row < begin_row + 2)
+        {
+            return std::vector<double>(n * n, 0.0);
+        }
+
+        // Centring first keeps the products small, so large windows do not lose precision to cancellation.
+        const auto row_size = end_row - begin_row;
+        std::vector<double> mean(n, 0.0);
+        for (auto t = begin_row; t < end_row; ++t)
+        {
+            for (std::size_t s = 0; s < n; ++s)
+            {
+                mean[s] += returns.values[t * n + s];
+            }
+        }
+
+        for (auto& value : mean)
+        {
+            value /= row_size;
+        }
+
+        std::vector<double> centred(row_size * n);
+        for (std::size_t t = 0; t < row_size; ++t)
+        {
+            for (std::size_t s = 0; s < n; ++s)
+            {
+                centred[t * n + s] = returns.values[(begin_row + t) * n + s] - mean[s];
+            }
+        }
+
+        std::vector<double> covariance(n * n, 0.0);
+        CrossProduct(centred.data(), n, 0, row_size, covariance.data());
+        for (auto& value : covariance)
+        {
+            value /= row_size - 1;
+        }
+
+        MirrorUpperTriangle(covariance, n);
+        return covariance;
+    }
+
+    std::vector<double> ToCorrelation(const std::vector<double>& covariance, std::size_t symbol_size)
+    {
+        std::vector<double> deviation(symbol_size);
+        for (std::size_t i = 0; i < symbol_size; ++i)
+        {
+            deviation[i] = std::sqrt(covariance[i * symbol_size + i]);
+        }
+
+        std::vector<double> correlation(covariance.size(), 0.0);
+        for (std::size_t i = 0; i < symbol_size; ++i)
+        {
+            for (std::size_t j = 0; j < symbol_size; ++j)
+            {
+                const auto denominator = deviation[i] * deviation[j];
+                correlation[i * symbol_size + j] = denominator > 0 ? covariance[i * symbol_size + j] / denominator : (i == j ? 1.0 : 0.0);
+            }
+        }
+
+        return correlation;
+    }
+
+    RollingCovariance::RollingCovariance(std::size_t symbol_size, std::size_t window) :
+        symbol_size_(symbol_size),
+        window_(std::max<std::size_t>(window, 2)),
+        rows_(window_ * symbol_size_),
+        mean_(symbol_size_, 0.0),
+        comoment_(symbol_size_ * symbol_size_, 0.0),
+        delta_(symbol_size_)
+    {
+    }
+
+    void RollingCovariance::Add(const double* row)
+    {
+        const auto n = symbol_size_;
+        if (size_ == window_)
+        {
+            Remove(rows_.data() + oldest_ * n);
+            oldest_ = (oldest_ + 1) % window_;
+        }
+
+        std::copy(row, row + n, rows_.begin() + (oldest_ + size_) % window_ * n);
+        ++size_;
+
+        // delta is taken against the old mean, the product against the new one.
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            delta_[i] = row[i] - mean_[i];
+            mean_[i] += delta_[i] / size_;
+        }
+
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            auto* comoment = comoment_.data() + i * n;
+            for (auto j = i; j < n; ++j)
+            {
+                comoment[j] += delta_[i] * (row[j] - mean_[j]);
+            }
+        }
+
+        if (++steps_ == window_)
+        {
+            Rebuild();
+        }
+    }
+
+    std::size_t RollingCovariance::GetSize() const
+    {
+        return size_;
+    }
+
+    std::vector<double> RollingCovariance::GetCovariance() const
+    {
+        const auto n = symbol_size_;
+        std::vector<double> covariance(n * n, 0.0);
+        if (size_ < 2)
+        {
+            return covariance;
+        }
+
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            for (auto j = i; j < n; ++j)
+            {
+                covariance[i * n + j] = comoment_[i * n + j] / (size_ - 1);
+            }
+        }
+
+        MirrorUpperTriangle(covariance, n);
+        return covariance;
+    }
+
+    std::vector<double> RollingCovariance::GetCorrelation() const
+    {
+        return ToCorrelation(GetCovariance(), symbol_size_);
+    }
+
+    void RollingCovariance::Remove(const double* row)
+    {
+        const auto n = symbol_size_;
+        if (--size_ == 0)
+        {
+            std::fill(mean_.begin(), mean_.end(), 0.0);
+            std::fill(comoment_.begin(), comoment_.end(), 0.0);
+            return;
+        }
+
+        // The inverse of Add: delta against the mean with the row, the product against the mean without it.
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            delta_[i] = row[i] - mean_[i];
+            mean_[i] -= delta_[i] / size_;
+        }
+
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            auto* comoment = comoment_.data() + i * n;
+            for (auto j = i; j < n; ++j)
+            {
+                comoment[j] -= delta_[i] * (row[j] - mean_[j]);
+            }
+        }
+    }
+
+    void RollingCovariance::Rebuild()
+    {
+        const auto n = symbol_size_;
+        std::fill(mean_.begin(), mean_.end(), 0.0);
+        std::fill(comoment_.begin(), comoment_.end(), 0.0);
+        steps_ = 0;
+
+        for (std::size_t t = 0; t < size_; ++t)
+        {
+            const auto* row = rows_.data() + (oldest_ + t) % window_ * n;
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                mean_[i] += row[i];
+            }
+        }
+
+        for (auto& value : mean_)
+        {
+            value /= size_;
+        }
+
+        for (std::size_t t = 0; t < size_; ++t)
+        {
+            const auto* row = rows_.data() + (oldest_ + t) % window_ * n;
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                delta_[i] = row[i] - mean_[i];
+            }
+
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                auto* comoment = comoment_.data() + i * n;
+                for (auto j = i; j < n; ++j)
+                {
+                    comoment[j] += delta_[i] * delta_[j];
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,72 @@
+// © 2023 Lei Cheng
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Data/DataCenter.h"
+
+namespace lei
+{
+    // Log returns of several symbols on the dates they all trade, stored row-major: value(t, s) = values[t * n + s].
+    // dates[t] is the day the return ends on.
+    struct ReturnMatrix
+    {
+        std::vector<std::string> stock_ids;
+        DateTimeArray dates;
+        std::vector<double> values;
+
+        std::size_t GetDateSize() const
+        {
+            return dates.size();
+        }
+
+        std::size_t GetSymbolSize() const
+        {
+            return stock_ids.size();
+        }
+    };
+
+    ReturnMatrix BuildReturnMatrix(const std::vector<std::string>& stock_ids, DataFrequency frequency);
+
+    // Sample covariance of rows [begin_row, end_row) as a dense n x n matrix. Symbol tiles are spread over the task
+    // scheduler, each tile streams the rows in blocks so its accumulators stay in cache.
+    std::vector<double> Covariance(const ReturnMatrix& returns, std::size_t begin_row, std::size_t end_row);
+
+    std::vector<double> ToCorrelation(const std::vector<double>& covariance, std::size_t symbol_size);
+
+    // Covariance of the last window rows added, O(n^2) per row instead of O(window * n^2). Means and centred
+    // co-moments are updated Welford style, the oldest row is removed and the new one added as two rank-one updates,
+    // so no large uncentred sums cancel. Both are recomputed from the rows kept in the window once per window length,
+    // so rounding does not drift either.
+    class RollingCovariance final
+    {
+    public:
+        RollingCovariance(std::size_t symbol_size, std::size_t window);
+        ~RollingCovariance() = default;
+
+    public:
+        // Adds a row of symbol_size values, removing the oldest row once the window is full.
+        void Add(const double* row);
+
+        // Rows in the window, at most window.
+        std::size_t GetSize() const;
+
+        std::vector<double> GetCovariance() const;
+        std::vector<double> GetCorrelation() const;
+
+    private:
+        void Remove(const double* row);
+        void Rebuild();
+
+    private:
+        std::size_t symbol_size_;
+        std::size_t window_;
+        std::size_t size_ = 0;
+        std::size_t oldest_ = 0;
+        std::size_t steps_ = 0;
+        std::vector<double> rows_; // window_ x symbol_size_ ring buffer, oldest_ is the first row of the window
+        std::vector<double> mean_;
+        std::vector<double> comoment_; // upper triangle of sum((x_i - mean_i) * (x_j - mean_j)), stored square
+        std::vector<double> delta_;
+    };
+}
@@ -0,0 +1,99 @@
+// © 2023 Lei Cheng
+
+#include "ChartLayer.h"
+#include "DrawUtility.h"
+
+namespace lei
+{
+    namespace
+    {
+        void DrawHeader(juce::Graphics& g, const ChartLayout& layout, const ChartLayerFrame& frame, const KChart& k_chart)
+        {
+            const auto& k_array = *frame.k_array;
+            k_chart.DrawHeader(g,
+                               layout.header.reduced(kChartBorderThickness),
+                               frame.stock_id,
+                               std::get<0>(k_array),
+                               std::get<1>(k_array),
+                               std::get<2>(k_array),
+                               std::get<3>(k_array),
+                               std::get<4>(k_array),
+                               std::get<5>(k_array),
+                               GetHeaderFont(),
+                               frame.frequency);
+        }
+
+        void DrawKChart(juce::Graphics& g, const ChartLayout& layout, const ChartLayerFrame& frame, const KChart& k_chart)
+        {
+            k_chart.DrawBounds(g, layout.k_chart);
+            k_chart.DrawTimeGrid(g,
+                                 layout.k_chart.reduced(kChartBorderThickness),
+                                 std::get<0>(*frame.k_array),
+                                 *frame.time_boundaries,
+                                 frame.scroll_bar_current_range,
+                                 frame.transform,
+                                 frame.frequency);
+
+            for (auto* indicator : frame.k_chart_indicators)
+            {
+                indicator->Draw(g,
+                                layout.k_chart.reduced(kChartBorderThickness),
+                                layout.k_price_label.reduced(kChartBorderThickness),
+                                frame.transform,
+                                frame.scroll_bar_current_range,
+                                frame.k_chart_min_max_label);
+            }
+        }
+
+        void DrawTimeLabel(juce::Graphics& g, const ChartLayout& layout, const ChartLayerFrame& frame, const KChart& k_chart)
+        {
+            k_chart.DrawTimeLabel(g,
+                                  layout.k_chart.reduced(kChartBorderThickness),
+                                  layout.time_label.reduced(kChartBorderThickness),
+                                  std::get<0>(*frame.k_array),
+                                  *frame.time_boundaries,
+                                  frame.scroll_bar_current_range,
+                                  frame.transform,
+                                  frame.frequency);
+        }
+
+        void DrawSubsidiaryChart(juce::Graphics& g, const ChartLayout& layout, const ChartLayerFrame& frame, const KChart& k_chart, std::size_t chart_index)
+        {
+            const auto& chart_bounds = layout.subsidiary_charts[chart_index];
+            k_chart.DrawBounds(g, chart_bounds);
+            k_chart.DrawTimeGrid(g,
+                                 chart_bounds.reduced(kChartBorderThickness),
+                                 std::get<0>(*frame.k_array),
+                                 *frame.time_boundaries,
+                                 frame.scroll_bar_current_range,
+                                 frame.transform,
+                                 frame.frequency);
+
+            auto* indicator = frame.subsidiary_indicators[chart_index];
+            indicator->Draw(g,
+                            chart_bounds.reduced(kChartBorderThickness),
+                            layout.subsidiary_labels[chart_index].reduced(kChartBorderThickness),
+                            frame.transform,
+                            frame.scroll_bar_current_range,
+                            indicator->GetMinMaxLabelValue());
+        }
+    }
+
+    std::vector<PaneRenderer::Pane> MakeChartPanes(const ChartLayout& layout, const ChartLayerFrame& frame, const KChart& k_chart)
+    {
+        jassert(frame.k_array != nullptr && frame.time_boundaries != nullptr);
+        jassert(frame.subsidiary_indicators.size() <= layout.subsidiary_charts.size());
+
+        std::vector<PaneRenderer::Pane> panes;
+        panes.push_back({ layout.header, [&layout, &frame, &k_chart](juce::Graphics& g) { DrawHeader(g, layout, frame, k_chart); } });
+        panes.push_back({ layout.k_chart.getUnion(layout.k_price_label), [&layout, &frame, &k_chart](juce::Graphics& g) { DrawKChart(g, layout, frame, k_chart); } });
+        panes.push_back({ layout.time_label, [&layout, &frame, &k_chart](juce::Graphics& g) { DrawTimeLabel(g, layout, frame, k_chart); } });
+        for (std::size_t i = 0; i < frame.subsidiary_indicators.size(); ++i)
+        {
+            panes.push_back({ layout.subsidiary_charts[i].getUnion(layout.subsidiary_labels[i]),
+                              [&layout, &frame, &k_chart, i](juce::Graphics& g) { DrawSubsidiaryChart(g, layout, frame, k_chart, i); } });
+        }
+
+        return panes;
+    }
+}
@@ -0,0 +1,32 @@
+// © 2023 Lei Cheng
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "DataFrequency.h"
+#include "Indicator/Indicator.h"
+#include "KChart/KChart.h"
+#include "Layout.h"
+#include "Render/PaneRenderer.h"
+
+namespace lei
+{
+    // What the chart layer draws, taken on the message thread when the frame starts. The K chart draws the main and
+    // overlay indicators, each subsidiary chart its indicator.
+    struct ChartLayerFrame
+    {
+        std::string stock_id;
+        DataFrequency frequency = DataFrequency::kDay;
+        juce::Range<int> scroll_bar_current_range;
+        ViewportTransform transform;
+        std::pair<double, double> k_chart_min_max_label;
+        const KArray* k_array = nullptr;
+        const TimeBoundaryIndex* time_boundaries = nullptr;
+        std::vector<Indicator*> k_chart_indicators;
+        std::vector<Indicator*> subsidiary_indicators;
+    };
+
+    // The panes of the chart layer in layout, for PaneRenderer or to be drawn one after another. They refer to layout,
+    // frame and k_chart, which have to outlive them.
+    std::vector<PaneRenderer::Pane> MakeChartPanes(const ChartLayout& layout, const ChartLayerFrame& frame, const KChart& k_chart);
+}
@@ -0,0 +1,140 @@
+// © 2023 Lei Cheng
+
+#include "FrameScheduler.h"
+
+namespace lei
+{
+    FrameScheduler::FrameScheduler(std::function<bool()> on_frame, int frames_per_second) :
+        on_frame_(std::move(on_frame)),
+        frames_per_second_(std::max(frames_per_second, 1))
+    {
+    }
+
+    FrameScheduler::~FrameScheduler()
+    {
+        stopTimer();
+    }
+
+    void FrameScheduler::SetFrameRate(int frames_per_second)
+    {
+        frames_per_second_ = std::max(frames_per_second, 1);
+        if (isTimerRunning())
+        {
+            startTimer(juce::roundToInt(GetIntervalMilliseconds()));
+        }
+    }
+
+    int FrameScheduler::GetFrameRate() const
+    {
+        return frames_per_second_;
+    }
+
+    void FrameScheduler::RequestFrame()
+    {
+        requested_ = true;
+        if (!active_ || isTimerRunning())
+        {
+            return;
+        }
+
+        // The first frame after idling waits only for the rest of the interval since the previous one.
+        const auto now = juce::Time::getMillisecondCounterHiRes();
+        const auto wait = std::max(1.0, last_frame_time_ + GetIntervalMilliseconds() - now);
+        next_slot_time_ = now + wait;
+        startTimer(juce::roundToInt(wait));
+    }
+
+    void FrameScheduler::SetActive(bool active)
+    {
+        active_ = active;
+        if (!active_)
+        {
+            // A hidden view isn't painted, its last frame would count as late when it shows again.
+            stopTimer();
+            unpainted_slot_time_.reset();
+        }
+        else if (requested_)
+        {
+            RequestFrame();
+        }
+    }
+
+    void FrameScheduler::FramePainted()
+    {
+        // Paints the system asks for on its own have no frame to measure.
+        if (!unpainted_slot_time_)
+        {
+            return;
+        }
+
+        const auto interval = GetIntervalMilliseconds();
+        const auto lateness = juce::Time::getMillisecondCounterHiRes() - *unpainted_slot_time_;
+        if (lateness > interval / 2)
+        {
+            ++late_frame_count_;
+            dropped_frame_count_ += static_cast<std::size_t>(lateness / interval);
+        }
+
+        unpainted_slot_time_.reset();
+        ++frame_count_;
+    }
+
+    void FrameScheduler::ResetStats()
+    {
+        frame_count_ = 0;
+        dropped_frame_count_ = 0;
+        late_frame_count_ = 0;
+    }
+
+    std::size_t FrameScheduler::GetFrameCount() const
+    {
+        return frame_count_;
+    }
+
+    std::size_t FrameScheduler::GetDroppedFrameCount() const
+    {
+        return dropped_frame_count_;
+    }
+
+    std::size_t FrameScheduler::GetLateFrameCount() const
+    {
+        return late_frame_count_;
+    }
+
+    juce::String FrameScheduler::ToString() const
+    {
+        return juce::String(frames_per_second_) + " fps cap: " + juce::String(static_cast<juce::int64>(frame_count_)) + " frames, "
+            + juce::String(static_cast<juce::int64>(dropped_frame_count_)) + " dropped, " + juce::String(static_cast<juce::int64>(late_frame_count_)) + " late";
+    }
+
+    void FrameScheduler::timerCallback()
+    {
+        if (!requested_)
+        {
+            stopTimer();
+            return;
+        }
+
+        const auto interval = GetIntervalMilliseconds();
+        const auto now = juce::Time::getMillisecondCounterHiRes();
+
+        // Requests made by the frame itself go to the next one.
+        requested_ = false;
+        if (on_frame_() && !unpainted_slot_time_)
+        {
+            unpainted_slot_time_ = next_slot_time_;
+        }
+
+        last_frame_time_ = now;
+        next_slot_time_ = now + interval;
+        if (getTimerInterval() != juce::roundToInt(interval))
+        {
+            startTimer(juce::roundToInt(interval));
+        }
+    }
+
+    double FrameScheduler::GetIntervalMilliseconds() const
+    {
+        return 1000.0 / frames_per_second_;
+    }
+}
@@ -0,0 +1,63 @@
+// © 2023 Lei Cheng
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <functional>
+#include <optional>
+
+namespace lei
+{
+    // Coalesces frame requests on the message thread: however many arrive between two frames, the frame callback runs
+    // once, at most frames_per_second times a second. The timer stops while no frames are requested.
+    // The frame callback returns whether it repainted anything, and such a frame is measured when the repaint is
+    // painted: it is late when it is painted more than half an interval after its slot, and every whole interval it
+    // is painted past its slot counts as a dropped frame.
+    class FrameScheduler final : private juce::Timer
+    {
+    public:
+        explicit FrameScheduler(std::function<bool()> on_frame, int frames_per_second = 60);
+        ~FrameScheduler() override;
+
+    public:
+        void SetFrameRate(int frames_per_second);
+        int GetFrameRate() const;
+
+        void RequestFrame();
+
+        // An inactive scheduler keeps its requests but runs no frames until it is active again, e.g. while its view
+        // is hidden.
+        void SetActive(bool active);
+
+        // Called at the end of paint, when the frames repainted since the last call are on screen.
+        void FramePainted();
+
+        void ResetStats();
+
+        std::size_t GetFrameCount() const;
+        std::size_t GetDroppedFrameCount() const;
+        std::size_t GetLateFrameCount() const;
+
+        // e.g. "60 fps cap: 240 frames, 3 dropped, 5 late"
+        juce::String ToString() const;
+
+    private:
+        void timerCallback() override;
+
+        double GetIntervalMilliseconds() const;
+
+    private:
+        std::function<bool()> on_frame_;
+        int frames_per_second_;
+        bool requested_ = false;
+        bool active_ = true;
+        double last_frame_time_ = 0.0;
+        double next_slot_time_ = 0.0;
+        // The slot of the earliest frame repainted but not painted yet.
+        std::optional<double> unpainted_slot_time_;
+
+        std::size_t frame_count_ = 0;
+        std::size_t dropped_frame_count_ = 0;
+        std::size_t late_frame_count_ = 0;
+    };
+}
@@ -0,0 +1,193 @@
+// © 2023 Lei Cheng
+
+#include "GraphicsRecorder.h"
+
+namespace lei
+{
+    GraphicsRecorder::GraphicsRecorder(const juce::Rectangle<int>& bounds, float scale)
+    {
+        states_.push_back({ juce::AffineTransform::scale(scale), bounds.toFloat() * scale, juce::Font() });
+    }
+
+    void GraphicsRecorder::Replay(juce::LowLevelGraphicsContext& target) const
+    {
+        for (const auto& command : commands_)
+        {
+            command(target);
+        }
+    }
+
+    bool GraphicsRecorder::isVectorDevice() const
+    {
+        return false;
+    }
+
+    void GraphicsRecorder::setOrigin(juce::Point<int> origin)
+    {
+        auto& state = states_.back();
+        state.transform = juce::AffineTransform::translation(origin.toFloat()).followedBy(state.transform);
+        commands_.push_back([origin](juce::LowLevelGraphicsContext& target) { target.setOrigin(origin); });
+    }
+
+    void GraphicsRecorder::addTransform(const juce::AffineTransform& transform)
+    {
+        auto& state = states_.back();
+        state.transform = transform.followedBy(state.transform);
+        commands_.push_back([transform](juce::LowLevelGraphicsContext& target) { target.addTransform(transform); });
+    }
+
+    float GraphicsRecorder::getPhysicalPixelScaleFactor() const
+    {
+        return std::sqrt(std::abs(states_.back().transform.getDeterminant()));
+    }
+
+    bool GraphicsRecorder::clipToRectangle(const juce::Rectangle<int>& rectangle)
+    {
+        commands_.push_back([rectangle](juce::LowLevelGraphicsContext& target) { target.clipToRectangle(rectangle); });
+        return ClipTo(rectangle.toFloat(), {});
+    }
+
+    bool GraphicsRecorder::clipToRectangleList(const juce::RectangleList<int>& rectangles)
+    {
+        commands_.push_back([rectangles](juce::LowLevelGraphicsContext& target) { target.clipToRectangleList(rectangles); });
+        return ClipTo(rectangles.getBounds().toFloat(), {});
+    }
+
+    void GraphicsRecorder::excludeClipRectangle(const juce::Rectangle<int>& rectangle)
+    {
+        commands_.push_back([rectangle](juce::LowLevelGraphicsContext& target) { target.excludeClipRectangle(rectangle); });
+    }
+
+    void GraphicsRecorder::clipToPath(const juce::Path& path, const juce::AffineTransform& transform)
+    {
+        commands_.push_back([path, transform](juce::LowLevelGraphicsContext& target) { target.clipToPath(path, transform); });
+        ClipTo(path.getBounds(), transform);
+    }
+
+    void GraphicsRecorder::clipToImageAlpha(const juce::Image& image, const juce::AffineTransform& transform)
+    {
+        commands_.push_back([image, transform](juce::LowLevelGraphicsContext& target) { target.clipToImageAlpha(image, transform); });
+        ClipTo(image.getBounds().toFloat(), transform);
+    }
+
+    bool GraphicsRecorder::clipRegionIntersects(const juce::Rectangle<int>& rectangle)
+    {
+        const auto& state = states_.back();
+        return state.clip.intersects(rectangle.toFloat().transformedBy(state.transform));
+    }
+
+    juce::Rectangle<int> GraphicsRecorder::getClipBounds() const
+    {
+        const auto& state = states_.back();
+        return state.clip.transformedBy(state.transform.inverted()).getSmallestIntegerContainer();
+    }
+
+    bool GraphicsRecorder::isClipEmpty() const
+    {
+        return states_.back().clip.isEmpty();
+    }
+
+    void GraphicsRecorder::saveState()
+    {
+        states_.push_back(states_.back());
+        commands_.push_back([](juce::LowLevelGraphicsContext& target) { target.saveState(); });
+    }
+
+    void GraphicsRecorder::restoreState()
+    {
+        jassert(states_.size() > 1);
+        states_.pop_back();
+        commands_.push_back([](juce::LowLevelGraphicsContext& target) { target.restoreState(); });
+    }
+
+    void GraphicsRecorder::beginTransparencyLayer(float opacity)
+    {
+        states_.push_back(states_.back());
+        commands_.push_back([opacity](juce::LowLevelGraphicsContext& target) { target.beginTransparencyLayer(opacity); });
+    }
+
+    void GraphicsRecorder::endTransparencyLayer()
+    {
+        jassert(states_.size() > 1);
+        states_.pop_back();
+        commands_.push_back([](juce::LowLevelGraphicsContext& target) { target.endTransparencyLayer(); });
+    }
+
+    void GraphicsRecorder::setFill(const juce::FillType& fill)
+    {
+        commands_.push_back([fill](juce::LowLevelGraphicsContext& target) { target.setFill(fill); });
+    }
+
+    void GraphicsRecorder::setOpacity(float opacity)
+    {
+        commands_.push_back([opacity](juce::LowLevelGraphicsContext& target) { target.setOpacity(opacity); });
+    }
+
+    void GraphicsRecorder::setInterpolationQuality(juce::Graphics::ResamplingQuality quality)
+    {
+        commands_.push_back([quality](juce::LowLevelGraphicsContext& target) { target.setInterpolationQuality(quality); });
+    }
+
+    void GraphicsRecorder::fillRect(const juce::Rectangle<int>& rectangle, bool replace_existing_contents)
+    {
+        commands_.push_back([rectangle, replace_existing_contents](juce::LowLevelGraphicsContext& target) { target.fillRect(rectangle, replace_existing_contents); });
+    }
+
+    void GraphicsRecorder::fillRect(const juce::Rectangle<float>& rectangle)
+    {
+        commands_.push_back([rectangle](juce::LowLevelGraphicsContext& target) { target.fillRect(rectangle); });
+    }
+
+    void GraphicsRecorder::fillRectList(const juce::RectangleList<float>& rectangles)
+    {
+        commands_.push_back([rectangles](juce::LowLevelGraphicsContext& target) { target.fillRectList(rectangles); });
+    }
+
+    void GraphicsRecorder::fillPath(const juce::Path& path, const juce::AffineTransform& transform)
+    {
+        commands_.push_back([path, transform](juce::LowLevelGraphicsContext& target) { target.fillPath(path, transform); });
+    }
+
+    void GraphicsRecorder::drawImage(const juce::Image& image, const juce::AffineTransform& transform)
+    {
+        commands_.push_back([image, transform](juce::LowLevelGraphicsContext& target) { target.drawImage(image, transform); });
+    }
+
+    void GraphicsRecorder::drawLine(const juce::Line<float>& line)
+    {
+        commands_.push_back([line](juce::LowLevelGraphicsContext& target) { target.drawLine(line); });
+    }
+
+    void GraphicsRecorder::setFont(const juce::Font& font)
+    {
+        states_.back().font = font;
+        commands_.push_back([font](juce::LowLevelGraphicsContext& target) { target.setFont(font); });
+    }
+
+    const juce::Font& GraphicsRecorder::getFont()
+    {
+        return states_.back().font;
+    }
+
+    uint64_t GraphicsRecorder::getFrameId() const
+    {
+        return 0;
+    }
+
+    void GraphicsRecorder::drawGlyphs(juce::Span<const uint16_t> glyphs, juce::Span<const juce::Point<float>> positions, const juce::AffineTransform& transform)
+    {
+        std::vector<uint16_t> glyph_array(glyphs.begin(), glyphs.end());
+        std::vector<juce::Point<float>> position_array(positions.begin(), positions.end());
+        commands_.push_back([glyph_array = std::move(glyph_array), position_array = std::move(position_array), transform](juce::LowLevelGraphicsContext& target)
+                            {
+                                target.drawGlyphs({ glyph_array.data(), glyph_array.size() }, { position_array.data(), position_array.size() }, transform);
+                            });
+    }
+
+    bool GraphicsRecorder::ClipTo(const juce::Rectangle<float>& area, const juce::AffineTransform& transform)
+    {
+        auto& state = states_.back();
+        state.clip = state.clip.getIntersection(area.transformedBy(transform.followedBy(state.transform)));
+        return !state.clip.isEmpty();
+    }
+}
@@ -0,0 +1,75 @@
+// © 2023 Lei Cheng
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <functional>
+#include <vector>
+
+namespace lei
+{
+    // A graphics context that records every call instead of drawing, to be replayed later into another context, e.g.
+    // on another thread. Arguments are copied, so the recording stays valid whatever the drawing code reads changes.
+    // Clip queries are answered from the bounding box of the clip, which is exact for the rectangle clips charts use.
+    class GraphicsRecorder final : public juce::LowLevelGraphicsContext
+    {
+    public:
+        // bounds in the coordinates drawing starts in, scale physical pixels per unit.
+        GraphicsRecorder(const juce::Rectangle<int>& bounds, float scale);
+        ~GraphicsRecorder() override = default;
+
+    public:
+        // Plays the recording into target, relative to its current transform and clip.
+        void Replay(juce::LowLevelGraphicsContext& target) const;
+
+        bool isVectorDevice() const override;
+        void setOrigin(juce::Point<int> origin) override;
+        void addTransform(const juce::AffineTransform& transform) override;
+        float getPhysicalPixelScaleFactor() const override;
+
+        bool clipToRectangle(const juce::Rectangle<int>& rectangle) override;
+        bool clipToRectangleList(const juce::RectangleList<int>& rectangles) override;
+        void excludeClipRectangle(const juce::Rectangle<int>& rectangle) override;
+        void clipToPath(const juce::Path& path, const juce::AffineTransform& transform) override;
+        void clipToImageAlpha(const juce::Image& image, const juce::AffineTransform& transform) override;
+        bool clipRegionIntersects(const juce::Rectangle<int>& rectangle) override;
+        juce::Rectangle<int> getClipBounds() const override;
+        bool isClipEmpty() const override;
+
+        void saveState() override;
+        void restoreState() override;
+        void beginTransparencyLayer(float opacity) override;
+        void endTransparencyLayer() override;
+
+        void setFill(const juce::FillType& fill) override;
+        void setOpacity(float opacity) override;
+        void setInterpolationQuality(juce::Graphics::ResamplingQuality quality) override;
+
+        void fillRect(const juce::Rectangle<int>& rectangle, bool replace_existing_contents) override;
+        void fillRect(const juce::Rectangle<float>& rectangle) override;
+        void fillRectList(const juce::RectangleList<float>& rectangles) override;
+        void fillPath(const juce::Path& path, const juce::AffineTransform& transform) override;
+        void drawImage(const juce::Image& image, const juce::AffineTransform& transform) override;
+        void drawLine(const juce::Line<float>& line) override;
+
+        void setFont(const juce::Font& font) override;
+        const juce::Font& getFont() override;
+        uint64_t getFrameId() const override;
+        void drawGlyphs(juce::Span<const uint16_t> glyphs, juce::Span<const juce::Point<float>> positions, const juce::AffineTransform& transform) override;
+
+    private:
+        struct State
+        {
+            // From the current coordinates to physical pixels, and the clip in physical pixels.
+            juce::AffineTransform transform;
+            juce::Rectangle<float> clip;
+            juce::Font font;
+        };
+
+        bool ClipTo(const juce::Rectangle<float>& area, const juce::AffineTransform& transform);
+
+    private:
+        std::vector<std::function<void(juce::LowLevelGraphicsContext&)>> commands_;
+        std::vector<State> states_;
+    };
+}
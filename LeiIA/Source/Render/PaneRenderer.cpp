@@ -0,0 +1,178 @@
+// © 2023 Lei Cheng
+
+#include "PaneRenderer.h"
+#include "Kernel/TaskScheduler.h"
+
+namespace lei
+{
+    namespace
+    {
+        constexpr int kPaneMargin = 16;
+
+        // A software image of the size, reused while its size holds.
+        void PrepareImage(juce::Image& image, juce::Image::PixelFormat format, int width, int height)
+        {
+            if (!image.isValid() || image.getFormat() != format || image.getWidth() != width || image.getHeight() != height)
+            {
+                image = juce::Image(format, width, height, true, juce::SoftwareImageType());
+            }
+            else if (format == juce::Image::ARGB)
+            {
+                image.clear(image.getBounds());
+            }
+        }
+
+        juce::Rectangle<int> ToPixels(const juce::Rectangle<int>& bounds, float scale)
+        {
+            return (bounds.toFloat() * scale).getSmallestIntegerContainer();
+        }
+    }
+
+    PaneRenderer::PaneRenderer()
+    {
+        idle_.signal();
+    }
+
+    PaneRenderer::~PaneRenderer()
+    {
+        // The task renders into the members, it has to be done before they go.
+        idle_.wait();
+    }
+
+    bool PaneRenderer::Render(const juce::Rectangle<int>& area,
+                              float scale,
+                              juce::Colour background,
+                              const std::vector<Pane>& panes,
+                              const std::function<void(juce::Graphics&)>& draw_overlay,
+                              std::function<void()> on_finished)
+    {
+        JUCE_ASSERT_MESSAGE_THREAD
+        if (rendering_ || area.isEmpty())
+        {
+            return false;
+        }
+
+        auto frame = std::make_shared<Frame>();
+        frame->area = area;
+        frame->scale = scale;
+        frame->background = background;
+        for (const auto& pane : panes)
+        {
+            const auto bounds = pane.bounds.expanded(kPaneMargin).getIntersection(area);
+            auto recorder = std::make_unique<GraphicsRecorder>(bounds, scale);
+            juce::Graphics g(*recorder);
+            pane.draw(g);
+            frame->panes.push_back({ bounds, std::move(recorder) });
+        }
+
+        frame->overlay = std::make_unique<GraphicsRecorder>(area, scale);
+        {
+            juce::Graphics g(*frame->overlay);
+            draw_overlay(g);
+        }
+
+        // The previous task may still be returning from its last signal, it is past every write by then.
+        idle_.wait();
+        rendering_ = true;
+        discarded_ = false;
+        idle_.reset();
+        GetTaskScheduler().Submit([this, weak_this = juce::WeakReference<PaneRenderer>(this), frame, on_finished = std::move(on_finished)]
+                                  {
+                                      RenderFrame(*frame);
+                                      juce::MessageManager::callAsync([weak_this, scale = frame->scale, on_finished]
+                                                                      {
+                                                                          if (weak_this != nullptr)
+                                                                          {
+                                                                              weak_this->FinishFrame(scale);
+                                                                              on_finished();
+                                                                          }
+                                                                      });
+
+                                      // Last, the renderer may be destroyed as soon as it is signalled.
+                                      idle_.signal();
+                                  });
+        return true;
+    }
+
+    void PaneRenderer::Discard()
+    {
+        discarded_ = rendering_;
+    }
+
+    void PaneRenderer::Release()
+    {
+        JUCE_ASSERT_MESSAGE_THREAD
+        Discard();
+        front_ = {};
+        front_scale_ = 1.0f;
+
+        // The task may still be rendering into the back buffer and the pane images, they go with the next frame then.
+        if (!rendering_)
+        {
+            back_ = {};
+            pane_images_.clear();
+        }
+    }
+
+    bool PaneRenderer::IsRendering() const
+    {
+        return rendering_;
+    }
+
+    const juce::Image& PaneRenderer::GetImage() const
+    {
+        return front_;
+    }
+
+    float PaneRenderer::GetScale() const
+    {
+        return front_scale_;
+    }
+
+    void PaneRenderer::RenderFrame(const Frame& frame)
+    {
+        const auto& panes = frame.panes;
+        const auto frame_pixels = ToPixels(frame.area, frame.scale);
+        pane_images_.resize(panes.size());
+        std::vector<juce::Rectangle<int>> pane_pixels(panes.size());
+        GetTaskScheduler().ParallelFor(panes.size(), [&](std::size_t i)
+                                       {
+                                           pane_pixels[i] = ToPixels(panes[i].bounds, frame.scale).getIntersection(frame_pixels);
+                                           if (pane_pixels[i].isEmpty())
+                                           {
+                                               return;
+                                           }
+
+                                           PrepareImage(pane_images_[i], juce::Image::ARGB, pane_pixels[i].getWidth(), pane_pixels[i].getHeight());
+                                           juce::Graphics g(pane_images_[i]);
+                                           g.addTransform(juce::AffineTransform::scale(frame.scale).translated(-pane_pixels[i].getPosition().toFloat()));
+                                           panes[i].recorder->Replay(g.getInternalContext());
+                                       });
+
+        PrepareImage(back_, juce::Image::RGB, frame_pixels.getWidth(), frame_pixels.getHeight());
+        juce::Graphics g(back_);
+        g.fillAll(frame.background);
+        for (std::size_t i = 0; i < panes.size(); ++i)
+        {
+            if (!pane_pixels[i].isEmpty())
+            {
+                g.drawImageAt(pane_images_[i], pane_pixels[i].getX() - frame_pixels.getX(), pane_pixels[i].getY() - frame_pixels.getY());
+            }
+        }
+
+        g.addTransform(juce::AffineTransform::scale(frame.scale).translated(-frame_pixels.getPosition().toFloat()));
+        frame.overlay->Replay(g.getInternalContext());
+    }
+
+    void PaneRenderer::FinishFrame(float scale)
+    {
+        if (!discarded_)
+        {
+            std::swap(front_, back_);
+            front_scale_ = scale;
+        }
+
+        rendering_ = false;
+        discarded_ = false;
+    }
+}
@@ -0,0 +1,86 @@
+// © 2023 Lei Cheng
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Render/GraphicsRecorder.h"
+#include <functional>
+#include <memory>
+
+namespace lei
+{
+    // Renders a frame of chart panes off the message thread. The draw callbacks are recorded on the message thread when
+    // the frame starts, so the frame owns everything it draws and the caller's state may change right after Render.
+    // The recordings are rasterised on the task scheduler, each pane in parallel into its own software image, the
+    // panes and the overlay are composited into the back buffer, and the back buffer is swapped with the front one on
+    // the message thread. The message thread keeps painting the front buffer meanwhile.
+    class PaneRenderer final
+    {
+    public:
+        struct Pane
+        {
+            // In component coordinates. The pane image has a margin around it for labels drawn across the edge.
+            juce::Rectangle<int> bounds;
+            std::function<void(juce::Graphics&)> draw;
+        };
+
+        PaneRenderer();
+        ~PaneRenderer();
+
+    public:
+        // Starts a frame covering area at scale physical pixels per unit, unless one is still rendering or not swapped
+        // in yet, and returns whether it did. on_finished is called on the message thread once the frame is done,
+        // swapped in or discarded.
+        bool Render(const juce::Rectangle<int>& area,
+                    float scale,
+                    juce::Colour background,
+                    const std::vector<Pane>& panes,
+                    const std::function<void(juce::Graphics&)>& draw_overlay,
+                    std::function<void()> on_finished);
+
+        // The frame being rendered is out of date and is dropped instead of swapped in when it is done.
+        void Discard();
+
+        // Drops the frame being rendered and frees the buffers, e.g. while the view is hidden. The next frame starts
+        // from an empty image.
+        void Release();
+
+        bool IsRendering() const;
+
+        // The latest swapped in frame and its scale. The image is invalid before the first frame.
+        const juce::Image& GetImage() const;
+        float GetScale() const;
+
+    private:
+        struct RecordedPane
+        {
+            juce::Rectangle<int> bounds;
+            std::unique_ptr<GraphicsRecorder> recorder;
+        };
+
+        struct Frame
+        {
+            juce::Rectangle<int> area;
+            float scale = 1.0f;
+            juce::Colour background;
+            std::vector<RecordedPane> panes;
+            std::unique_ptr<GraphicsRecorder> overlay;
+        };
+
+        void RenderFrame(const Frame& frame);
+        void FinishFrame(float scale);
+
+    private:
+        juce::Image front_;
+        juce::Image back_;
+        std::vector<juce::Image> pane_images_;
+        float front_scale_ = 1.0f;
+
+        // Signalled unless a task of the scheduler renders into the back buffer and the pane images.
+        juce::WaitableEvent idle_ { true };
+        bool rendering_ = false;
+        bool discarded_ = false;
+
+        JUCE_DECLARE_WEAK_REFERENCEABLE(PaneRenderer)
+    };
+}
@@ -0,0 +1,31 @@
+// © 2023 Lei Cheng
+
+#include "RectangleBatch.h"
+
+namespace lei
+{
+    void RectangleBatch::Add(juce::Colour colour, const juce::Rectangle<float>& rectangle)
+    {
+        // Charts use two or three colours, a linear search beats hashing.
+        auto pos = std::find_if(batches_.begin(), batches_.end(), [colour](const auto& batch)
+                                {
+                                    return batch.first == colour;
+                                });
+
+        if (pos == batches_.end())
+        {
+            pos = batches_.emplace(batches_.end(), colour, juce::RectangleList<float>());
+        }
+
+        pos->second.addWithoutMerging(rectangle);
+    }
+
+    void RectangleBatch::Fill(juce::Graphics& g) const
+    {
+        for (const auto& [colour, rectangles] : batches_)
+        {
+            g.setColour(colour);
+            g.fillRectList(rectangles);
+        }
+    }
+}
@@ -0,0 +1,25 @@
+// © 2023 Lei Cheng
+
+#pragma once
+
+#include <JuceHeader.h>
+
+namespace lei
+{
+    // Rectangles collected per colour and filled with one call per colour, instead of a colour change and a fill per
+    // bar. Overlaps are not merged, which is harmless for opaque colours.
+    class RectangleBatch final
+    {
+    public:
+        RectangleBatch() = default;
+        ~RectangleBatch() = default;
+
+    public:
+        void Add(juce::Colour colour, const juce::Rectangle<float>& rectangle);
+
+        void Fill(juce::Graphics& g) const;
+
+    private:
+        std::vector<std::pair<juce::Colour, juce::RectangleList<float>>> batches_;
+    };
+}
@@ -0,0 +1,66 @@
+// © 2023 Lei Cheng
+
+#include "RepaintStats.h"
+
+namespace lei
+{
+    namespace
+    {
+        juce::String ToKilo(double pixels)
+        {
+            return pixels < 1000.0 ? juce::String(juce::roundToInt(pixels)) : juce::String(pixels / 1000.0, 1) + "k";
+        }
+    }
+
+    void RepaintStats::Reset()
+    {
+        pixels_ = {};
+        milliseconds_ = {};
+        frame_count_ = 0;
+        repainted_pixels_ = 0;
+    }
+
+    void RepaintStats::AddRepaint(const juce::RectangleList<int>& repainted)
+    {
+        for (const auto& rectangle : repainted)
+        {
+            repainted_pixels_ += static_cast<long long>(rectangle.getWidth()) * rectangle.getHeight();
+        }
+    }
+
+    void RepaintStats::AddFrame(double paint_ms)
+    {
+        pixels_[frame_count_ % kWindowSize] = repainted_pixels_;
+        repainted_pixels_ = 0;
+        milliseconds_[frame_count_ % kWindowSize] = paint_ms;
+        ++frame_count_;
+    }
+
+    std::size_t RepaintStats::GetFrameCount() const
+    {
+        return frame_count_;
+    }
+
+    long long RepaintStats::GetLastPixels() const
+    {
+        return frame_count_ == 0 ? 0 : pixels_[(frame_count_ - 1) % kWindowSize];
+    }
+
+    double RepaintStats::GetMeanPixels() const
+    {
+        const auto size = std::min<std::size_t>(frame_count_, kWindowSize);
+        return size == 0 ? 0.0 : std::accumulate(pixels_.begin(), pixels_.begin() + size, 0.0) / size;
+    }
+
+    double RepaintStats::GetMeanMilliseconds() const
+    {
+        const auto size = std::min<std::size_t>(frame_count_, kWindowSize);
+        return size == 0 ? 0.0 : std::accumulate(milliseconds_.begin(), milliseconds_.begin() + size, 0.0) / size;
+    }
+
+    juce::String RepaintStats::ToString() const
+    {
+        return "frame " + juce::String(static_cast<juce::int64>(frame_count_)) + ": " + ToKilo(static_cast<double>(GetLastPixels())) + " px, mean "
+            + ToKilo(GetMeanPixels()) + " px " + juce::String(GetMeanMilliseconds(), 2) + " ms";
+    }
+}
@@ -0,0 +1,43 @@
+// © 2023 Lei Cheng
+
+#pragma once
+
+#include <JuceHeader.h>
+
+namespace lei
+{
+    // Pixels and time of every paint call, averaged over the latest kWindowSize frames. The pixels are the area of the
+    // rectangles passed to repaint since the previous paint, not of the clip bounds, so two small dirty rectangles far
+    // apart count as what they are rather than as their bounding box.
+    class RepaintStats final
+    {
+    public:
+        enum
+        {
+            kWindowSize = 60
+        };
+
+        RepaintStats() = default;
+        ~RepaintStats() = default;
+
+    public:
+        void Reset();
+
+        void AddRepaint(const juce::RectangleList<int>& repainted);
+        void AddFrame(double paint_ms);
+
+        std::size_t GetFrameCount() const;
+        long long GetLastPixels() const;
+        double GetMeanPixels() const;
+        double GetMeanMilliseconds() const;
+
+        // e.g. "frame 240: 1.9k px, mean 12.4k px 0.35 ms"
+        juce::String ToString() const;
+
+    private:
+        std::array<long long, kWindowSize> pixels_ = {};
+        std::array<double, kWindowSize> milliseconds_ = {};
+        std::size_t frame_count_ = 0;
+        long long repainted_pixels_ = 0;
+    };
+}
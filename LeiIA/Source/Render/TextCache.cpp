@@ -0,0 +1,122 @@
+// © 2023 Lei Cheng
+
+#include "TextCache.h"
+
+namespace lei
+{
+    namespace
+    {
+        // Areas are often sized to the rounded string width.
+        constexpr float kWidthTolerance = 1.0f;
+    }
+
+    bool TextCache::Key::operator==(const Key& other) const
+    {
+        return text == other.text && font == other.font;
+    }
+
+    std::size_t TextCache::KeyHash::operator()(const Key& key) const
+    {
+        return static_cast<std::size_t>(key.text.hash()) * 31 + static_cast<std::size_t>(key.font.getTypefaceName().hash())
+            + std::hash<float>()(key.font.getHeight()) * 17 + static_cast<std::size_t>(key.font.getStyleFlags());
+    }
+
+    TextCache::TextCache(std::size_t capacity) :
+        capacity_(std::max<std::size_t>(capacity, 1))
+    {
+    }
+
+    void TextCache::DrawText(juce::Graphics& g, const juce::String& text, const juce::Rectangle<float>& area, juce::Justification justification)
+    {
+        // Text outside the dirty region is neither shaped nor drawn.
+        if (text.isEmpty() || !g.clipRegionIntersects(area.getSmallestIntegerContainer()))
+        {
+            return;
+        }
+
+        const auto& entry = Find(g.getCurrentFont(), text);
+        if (entry.bounds.getWidth() > area.getWidth() + kWidthTolerance)
+        {
+            g.drawText(text, area, justification, false);
+            return;
+        }
+
+        const auto target = justification.appliedToRectangle(entry.bounds, area);
+        entry.glyphs.draw(g, juce::AffineTransform::translation(target.getX() - entry.bounds.getX(), target.getY() - entry.bounds.getY()));
+    }
+
+    float TextCache::GetStringWidth(const juce::Font& font, const juce::String& text)
+    {
+        return Find(font, text).width;
+    }
+
+    void TextCache::Clear()
+    {
+        entries_.clear();
+        lru_.clear();
+        hit_count_ = miss_count_ = 0;
+    }
+
+    std::size_t TextCache::size() const
+    {
+        return entries_.size();
+    }
+
+    std::size_t TextCache::GetHitCount() const
+    {
+        return hit_count_;
+    }
+
+    std::size_t TextCache::GetMissCount() const
+    {
+        return miss_count_;
+    }
+
+    const TextCache::Entry& TextCache::Find(const juce::Font& font, const juce::String& text)
+    {
+        Key key{ text, font };
+        const auto pos = entries_.find(key);
+        if (pos != entries_.end())
+        {
+            ++hit_count_;
+            lru_.splice(lru_.begin(), lru_, pos->second.lru_position);
+            return pos->second;
+        }
+
+        ++miss_count_;
+        if (entries_.size() >= capacity_)
+        {
+            entries_.erase(lru_.back());
+            lru_.pop_back();
+        }
+
+        lru_.push_front(key);
+        auto& entry = entries_[std::move(key)];
+        entry.glyphs.addLineOfText(font, text, 0.0f, 0.0f);
+        entry.bounds = entry.glyphs.getBoundingBox(0, -1, true);
+        entry.width = font.getStringWidthFloat(text);
+        entry.lru_position = lru_.begin();
+        return entry;
+    }
+
+    TextCache& GetTextCache()
+    {
+        thread_local TextCache cache;
+        return cache;
+    }
+
+    void DrawCachedText(juce::Graphics& g, const juce::String& text, const juce::Rectangle<float>& area, juce::Justification justification)
+    {
+        GetTextCache().DrawText(g, text, area, justification);
+    }
+
+    void DrawCachedText(juce::Graphics& g, const juce::String& text, const juce::Rectangle<int>& area, juce::Justification justification)
+    {
+        GetTextCache().DrawText(g, text, area.toFloat(), justification);
+    }
+
+    float GetCachedStringWidth(const juce::Font& font, const juce::String& text)
+    {
+        return GetTextCache().GetStringWidth(font, text);
+    }
+}
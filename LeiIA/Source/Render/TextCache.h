@@ -0,0 +1,70 @@
+// © 2023 Lei Cheng
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <list>
+#include <unordered_map>
+
+namespace lei
+{
+    // Shaped lines of text keyed by string and font, so labels and messages repeated from frame to frame are laid out
+    // once. The least recently used entries are evicted past the capacity.
+    class TextCache final
+    {
+    public:
+        explicit TextCache(std::size_t capacity = 2048);
+        ~TextCache() = default;
+
+    public:
+        // Like Graphics::drawText without ellipses, in the current font and colour. Text that must be curtailed to fit
+        // the area is left to Graphics::drawText.
+        void DrawText(juce::Graphics& g, const juce::String& text, const juce::Rectangle<float>& area, juce::Justification justification);
+
+        float GetStringWidth(const juce::Font& font, const juce::String& text);
+
+        void Clear();
+
+        std::size_t size() const;
+        std::size_t GetHitCount() const;
+        std::size_t GetMissCount() const;
+
+    private:
+        struct Key
+        {
+            juce::String text;
+            juce::Font font;
+
+            bool operator==(const Key& other) const;
+        };
+
+        struct KeyHash
+        {
+            std::size_t operator()(const Key& key) const;
+        };
+
+        struct Entry
+        {
+            juce::GlyphArrangement glyphs;
+            juce::Rectangle<float> bounds;
+            float width = 0.0f;
+            std::list<Key>::iterator lru_position;
+        };
+
+        const Entry& Find(const juce::Font& font, const juce::String& text);
+
+    private:
+        std::size_t capacity_;
+        std::unordered_map<Key, Entry, KeyHash> entries_;
+        std::list<Key> lru_;
+        std::size_t hit_count_ = 0;
+        std::size_t miss_count_ = 0;
+    };
+
+    // One cache per painting thread, so charts rendered off the message thread need no locking.
+    TextCache& GetTextCache();
+
+    void DrawCachedText(juce::Graphics& g, const juce::String& text, const juce::Rectangle<float>& area, juce::Justification justification);
+    void DrawCachedText(juce::Graphics& g, const juce::String& text, const juce::Rectangle<int>& area, juce::Justification justification);
+    float GetCachedStringWidth(const juce::Font& font, const juce::String& text);
+}
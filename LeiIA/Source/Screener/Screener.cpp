@@ -0,0 +1,85 @@
+// © 2023 Lei Cheng
+
+#include "Kernel/TaskScheduler.h"
+#include "Screener.h"
+
+namespace lei
+{
+    juce::Result Screener::SetCondition(const juce::String& text)
+    {
+        const auto result = condition_.Compile(text);
+        has_condition_ = result.wasOk();
+        return result;
+    }
+
+    juce::Result Screener::SetRank(const juce::String& text)
+    {
+        has_rank_ = false;
+        if (text.trim().isEmpty())
+        {
+            return juce::Result::ok();
+        }
+
+        const auto result = rank_.Compile(text);
+        has_rank_ = result.wasOk();
+        return result;
+    }
+
+    std::vector<ScreenerResult> Screener::Run(const std::vector<std::string>& stock_ids, DataFrequency frequency) const
+    {
+        if (!has_condition_)
+        {
+            return {};
+        }
+
+        std::vector<std::optional<ScreenerResult>> matches(stock_ids.size());
+        GetTaskScheduler().ParallelFor(stock_ids.size(), [&](std::size_t i)
+                                       {
+                                           const auto& k_array = GetKDataCenter().GetKData(stock_ids[i], frequency);
+                                           const auto& close_array = std::get<4>(k_array);
+                                           if (close_array.empty())
+                                           {
+                                               return;
+                                           }
+
+                                           // Compiled plans carry no values, copying one per symbol keeps the workers independent.
+                                           auto condition = condition_;
+                                           condition.Update(k_array);
+                                           const auto value = condition.GetResult().back();
+                                           if (!std::isfinite(value) || value == 0)
+                                           {
+                                               return;
+                                           }
+
+                                           double score = 0;
+                                           if (has_rank_)
+                                           {
+                                               auto rank = rank_;
+                                               rank.Update(k_array);
+                                               score = rank.GetResult().back();
+                                               if (!std::isfinite(score))
+                                               {
+                                                   score = std::numeric_limits<double>::lowest();
+                                               }
+                                           }
+
+                                           matches[i] = ScreenerResult{ stock_ids[i], score, close_array.back() };
+                                       });
+
+        std::vector<ScreenerResult> results;
+        for (auto& match : matches)
+        {
+            if (match)
+            {
+                results.push_back(std::move(*match));
+            }
+        }
+
+        std::stable_sort(results.begin(), results.end(), [](const ScreenerResult& x, const ScreenerResult& y)
+                         {
+                             return x.score > y.score;
+                         });
+
+        return results;
+    }
+}
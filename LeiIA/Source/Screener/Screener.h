@@ -0,0 +1,41 @@
+// © 2023 Lei Cheng
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Data/DataCenter.h"
+#include "Expression/ExpressionPlan.h"
+
+namespace lei
+{
+    struct ScreenerResult
+    {
+        std::string stock_id;
+        double score = 0;
+        double close = 0;
+    };
+
+    // Evaluates an expression condition on the last bar of every symbol, e.g.
+    // "C > MA(C, 22) AND CROSS(K(9, 3), D(9, 3, 3))", spread over the task scheduler. No UI dependency, so the same
+    // object serves the screener menu and the --screen command line.
+    class Screener final
+    {
+    public:
+        Screener() = default;
+        ~Screener() = default;
+
+    public:
+        juce::Result SetCondition(const juce::String& text);
+
+        // Matches are ranked by this expression on the last bar, highest first. Empty keeps the stock id order.
+        juce::Result SetRank(const juce::String& text);
+
+        std::vector<ScreenerResult> Run(const std::vector<std::string>& stock_ids, DataFrequency frequency) const;
+
+    private:
+        ExpressionPlan condition_;
+        ExpressionPlan rank_;
+        bool has_condition_ = false;
+        bool has_rank_ = false;
+    };
+}
@@ -0,0 +1,492 @@
+// © 2023 Lei Cheng
+
+#include "SelfTest.h"
+#include "Benchmark/IndicatorBenchmark.h"
+#include "Data/FrequencyMap.h"
+#include "Expression/ExpressionPlan.h"
+#include "Indicator/KD.h"
+#include "Indicator/MA.h"
+#include "Indicator/MACD.h"
+#include "Kernel/Recurrence.h"
+#include "Kernel/TaskScheduler.h"
+#include "Layout.h"
+#include "Portfolio/Correlation.h"
+#include <chrono>
+
+namespace lei
+{
+    namespace
+    {
+        constexpr juce::int64 kSeed = 2023;
+
+        // Long enough for LinearRecurrence to take the block-parallel path.
+        constexpr std::size_t kScanSize = 1 << 20;
+
+        using Check = std::pair<const char*, std::function<juce::Result()>>;
+
+        CloseArray MakeCloseArray(std::size_t size)
+        {
+            return std::get<4>(MakeRandomKArray(size, kSeed));
+        }
+
+        // The largest |value - expected| relative to max(|expected|, 1).
+        template<typename Value>
+        double GetMaxRelativeError(const std::vector<Value>& value_array, const std::vector<double>& expected_array)
+        {
+            jassert(value_array.size() == expected_array.size());
+            double max_error = 0;
+            for (std::size_t i = 0; i < expected_array.size(); ++i)
+            {
+                const auto error = std::abs(value_array[i] - expected_array[i]) / std::max(std::abs(expected_array[i]), 1.0);
+                max_error = std::max(max_error, error);
+            }
+
+            return max_error;
+        }
+
+        // The textbook EMA, 0 before period - 1 and seeded there with the mean of the first period values.
+        std::vector<double> SerialEma(const std::vector<double>& value_array, int period)
+        {
+            std::vector<double> ema_array(value_array.size(), 0);
+            if (static_cast<std::size_t>(period) > value_array.size())
+            {
+                return ema_array;
+            }
+
+            ema_array[period - 1] = std::accumulate(value_array.begin(), value_array.begin() + period, 0.0) / period;
+            const auto alpha = 2.0 / (period + 1);
+            for (std::size_t i = period; i < value_array.size(); ++i)
+            {
+                ema_array[i] = ema_array[i - 1] * (1 - alpha) + value_array[i] * alpha;
+            }
+
+            return ema_array;
+        }
+
+        juce::Result ExpectMaxRelativeError(double max_error, double bound)
+        {
+            return max_error <= bound ? juce::Result::ok() : juce::Result::fail("max relative error " + juce::String(max_error) + " over " + juce::String(bound));
+        }
+
+        juce::Result CheckLinearRecurrenceScan()
+        {
+            const auto close_array = MakeCloseArray(kScanSize);
+            std::vector<double> scan_array(close_array.size());
+            LinearRecurrence(close_array.data(), scan_array.data(), close_array.size(), 0.9, 0.1, close_array[0]);
+
+            std::vector<double> serial_array(close_array.size());
+            auto value = close_array[0];
+            for (std::size_t i = 0; i < close_array.size(); ++i)
+            {
+                value = 0.9 * value + 0.1 * close_array[i];
+                serial_array[i] = value;
+            }
+
+            return ExpectMaxRelativeError(GetMaxRelativeError(scan_array, serial_array), 1e-12);
+        }
+
+        juce::Result CheckEma()
+        {
+            const auto close_array = MakeCloseArray(kScanSize);
+            return ExpectMaxRelativeError(GetMaxRelativeError(EMA(close_array, 26), SerialEma(close_array, 26)), 1e-12);
+        }
+
+        // DIF = EMA(short) - EMA(long), MACD = EMA(DIF), OSC = DIF - MACD, each materialised before the next. A long
+        // close array takes the block scan when the scheduler has workers.
+        juce::Result CheckFusedMacd(int ema_short_period, int ema_long_period, int macd_period, std::size_t size)
+        {
+            const auto close_array = MakeCloseArray(size);
+            IndicatorArray dif_array;
+            IndicatorArray macd_array;
+            IndicatorArray osc_array;
+            CalculateMACD(close_array, ema_short_period, ema_long_period, macd_period, dif_array, macd_array, osc_array);
+
+            const auto ema_short_array = SerialEma(close_array, ema_short_period);
+            const auto ema_long_array = SerialEma(close_array, ema_long_period);
+            std::vector<double> expected_dif_array(close_array.size(), 0);
+            for (std::size_t i = ema_long_period; i < close_array.size(); ++i)
+            {
+                expected_dif_array[i] = ema_short_array[i] - ema_long_array[i];
+            }
+
+            const auto expected_macd_array = SerialEma(expected_dif_array, macd_period);
+            std::vector<double> expected_osc_array(close_array.size(), 0);
+            for (std::size_t i = std::max(ema_long_period, macd_period); i < close_array.size(); ++i)
+            {
+                expected_osc_array[i] = expected_dif_array[i] - expected_macd_array[i];
+            }
+
+            const auto max_error = std::max({ GetMaxRelativeError(dif_array, expected_dif_array),
+                                              GetMaxRelativeError(macd_array, expected_macd_array),
+                                              GetMaxRelativeError(osc_array, expected_osc_array) });
+            return ExpectMaxRelativeError(max_error, 1e-12);
+        }
+
+        // Float storage only narrows the stored values, the EMA state stays double, so the error stays at float rounding.
+        juce::Result CheckFloatMacd()
+        {
+            const auto close_array = MakeCloseArray(kScanSize);
+            std::vector<double> dif_array;
+            std::vector<double> macd_array;
+            std::vector<double> osc_array;
+            CalculateMACD(close_array, 12, 26, 9, dif_array, macd_array, osc_array);
+
+            std::vector<float> float_dif_array;
+            std::vector<float> float_macd_array;
+            std::vector<float> float_osc_array;
+            CalculateMACD(close_array, 12, 26, 9, float_dif_array, float_macd_array, float_osc_array);
+
+            const auto max_error = std::max({ GetMaxRelativeError(float_dif_array, dif_array),
+                                              GetMaxRelativeError(float_macd_array, macd_array),
+                                              GetMaxRelativeError(float_osc_array, osc_array) });
+            return ExpectMaxRelativeError(max_error, 1e-6);
+        }
+
+        juce::Result CheckFloatMa()
+        {
+            const auto close_array = MakeCloseArray(kScanSize);
+            std::vector<double> ma_array;
+            CalculateMA(close_array, 20, ma_array);
+
+            std::vector<float> float_ma_array;
+            CalculateMA(close_array, 20, float_ma_array);
+            return ExpectMaxRelativeError(GetMaxRelativeError(float_ma_array, ma_array), 1e-6);
+        }
+
+        juce::Result CheckFloatKd()
+        {
+            const auto k_array = MakeRandomKArray(kScanSize, kSeed);
+            std::vector<double> rsv_array;
+            std::vector<double> k_value_array;
+            std::vector<double> d_array;
+            CalculateKD(k_array, 9, 3, 3, rsv_array, k_value_array, d_array);
+
+            std::vector<float> float_rsv_array;
+            std::vector<float> float_k_value_array;
+            std::vector<float> float_d_array;
+            CalculateKD(k_array, 9, 3, 3, float_rsv_array, float_k_value_array, float_d_array);
+
+            const auto max_error = std::max({ GetMaxRelativeError(float_rsv_array, rsv_array),
+                                              GetMaxRelativeError(float_k_value_array, k_value_array),
+                                              GetMaxRelativeError(float_d_array, d_array) });
+            return ExpectMaxRelativeError(max_error, 1e-6);
+        }
+
+        // Back-to-back small jobs, where a worker is still leaving one job while the next one is published.
+        juce::Result CheckParallelForStress()
+        {
+            TaskScheduler scheduler(std::max(4, static_cast<int>(std::thread::hardware_concurrency())));
+            std::vector<std::atomic<int>> hit_array(16);
+            for (int job = 0; job < 200000; ++job)
+            {
+                scheduler.ParallelFor(hit_array.size(), [&hit_array](std::size_t i)
+                                      {
+                                          ++hit_array[i];
+                                      });
+            }
+
+            for (std::size_t i = 0; i < hit_array.size(); ++i)
+            {
+                if (hit_array[i] != 200000)
+                {
+                    return juce::Result::fail("index " + juce::String(static_cast<int>(i)) + " ran " + juce::String(hit_array[i].load()) + " times");
+                }
+            }
+
+            return juce::Result::ok();
+        }
+
+        // Submitted tasks run their own ParallelFor while the calling thread runs others, and none of them is lost.
+        juce::Result CheckSubmittedTasks()
+        {
+            constexpr int kTaskSize = 2000;
+            TaskScheduler scheduler(std::max(4, static_cast<int>(std::thread::hardware_concurrency())));
+            std::vector<std::atomic<int>> hit_array(16);
+            std::atomic<int> done_size = 0;
+            for (int task = 0; task < kTaskSize; ++task)
+            {
+                scheduler.Submit([&scheduler, &hit_array, &done_size]
+                                 {
+                                     scheduler.ParallelFor(hit_array.size(), [&hit_array](std::size_t i)
+                                                           {
+                                                               ++hit_array[i];
+                                                           });
+                                     ++done_size;
+                                 });
+
+                scheduler.ParallelFor(hit_array.size(), [&hit_array](std::size_t i)
+                                      {
+                                          ++hit_array[i];
+                                      });
+            }
+
+            const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(60);
+            while (done_size < kTaskSize && std::chrono::steady_clock::now() < deadline)
+            {
+                std::this_thread::yield();
+            }
+
+            if (done_size != kTaskSize)
+            {
+                return juce::Result::fail(juce::String(done_size.load()) + " of " + juce::String(kTaskSize) + " tasks finished");
+            }
+
+            for (std::size_t i = 0; i < hit_array.size(); ++i)
+            {
+                if (hit_array[i] != kTaskSize * 2)
+                {
+                    return juce::Result::fail("index " + juce::String(static_cast<int>(i)) + " ran " + juce::String(hit_array[i].load()) + " times");
+                }
+            }
+
+            return juce::Result::ok();
+        }
+
+        // A sweep's plan evaluates shared nodes once and each combination's own nodes per block, as the optimizer does.
+        juce::Result CheckSharedPlanGroups()
+        {
+            const auto k_array = MakeRandomKArray(5000, kSeed);
+            juce::StringArray texts;
+            for (int fast = 3; fast <= 8; ++fast)
+            {
+                for (int slow = 10; slow <= 30; slow += 5)
+                {
+                    texts.add("CROSS(MA(C, " + juce::String(fast) + "), EMA(C, " + juce::String(slow) + "))");
+                    texts.add("CROSS(EMA(C, " + juce::String(slow) + "), MA(C, " + juce::String(fast) + ")) AND V > " + juce::String(fast * 1000));
+                }
+            }
+
+            ExpressionPlan grouped_plan;
+            const auto result = grouped_plan.Compile(texts);
+            if (result.failed())
+            {
+                return result;
+            }
+
+            const auto group_count = static_cast<std::size_t>(texts.size()) / 2;
+            grouped_plan.SetRootGroupSize(2);
+            grouped_plan.UpdateShared(k_array);
+            for (std::size_t begin = 0; begin < group_count; begin += 7)
+            {
+                const auto end = std::min(begin + 7, group_count);
+                grouped_plan.UpdateGroups(k_array, begin, end);
+                for (auto i = begin * 2; i < end * 2; ++i)
+                {
+                    ExpressionPlan plan;
+                    plan.Compile(texts[static_cast<int>(i)]);
+                    plan.Update(k_array);
+                    const auto& expected_array = plan.GetResult();
+                    const auto& value_array = grouped_plan.GetResult(i);
+                    if (!std::equal(value_array.begin(), value_array.end(), expected_array.begin(), expected_array.end(), [](double x, double y)
+                                    {
+                                        return x == y || (std::isnan(x) && std::isnan(y));
+                                    }))
+                    {
+                        return juce::Result::fail("root " + juce::String(static_cast<int>(i)) + " differs from " + texts[static_cast<int>(i)]);
+                    }
+                }
+
+                grouped_plan.ReleaseGroups(begin, end);
+            }
+
+            return juce::Result::ok();
+        }
+
+        // Values far from 0 with a small spread, where uncentred running sums lose most of their digits.
+        juce::Result CheckRollingCovariance()
+        {
+            constexpr std::size_t kSymbolSize = 5;
+            constexpr std::size_t kWindow = 60;
+            juce::Random random(kSeed);
+            ReturnMatrix returns;
+            for (std::size_t t = 0; t < 2000; ++t)
+            {
+                returns.dates.push_back(juce::Time(static_cast<juce::int64>(t) * 24 * 60 * 60 * 1000));
+                for (std::size_t s = 0; s < kSymbolSize; ++s)
+                {
+                    returns.values.push_back(1000 + (random.nextDouble() - 0.5) * 0.01 * (s + 1));
+                }
+            }
+
+            returns.stock_ids.resize(kSymbolSize);
+            RollingCovariance rolling(kSymbolSize, kWindow);
+            double max_error = 0;
+            for (std::size_t t = 0; t < returns.GetDateSize(); ++t)
+            {
+                rolling.Add(returns.values.data() + t * kSymbolSize);
+                if (rolling.GetSize() == kWindow)
+                {
+                    const auto expected = Covariance(returns, t + 1 - kWindow, t + 1);
+                    const auto covariance = rolling.GetCovariance();
+                    for (std::size_t i = 0; i < covariance.size(); ++i)
+                    {
+                        max_error = std::max(max_error, std::abs(covariance[i] - expected[i]) / expected[0]);
+                    }
+                }
+            }
+
+            return ExpectMaxRelativeError(max_error, 1e-8);
+        }
+
+        // A day formula shown on 1 min bars must equal the formula evaluated on the days before the bar's own day.
+        juce::Result CheckSourceFormulaLookahead()
+        {
+            constexpr std::size_t kSessionMinutes = 270;
+            const auto minute_array = MakeRandomKArray(kSessionMinutes * 40, kSeed);
+            KArray day_array;
+            for (std::size_t i = 0; i < std::get<0>(minute_array).size(); ++i)
+            {
+                if (i % kSessionMinutes == 0)
+                {
+                    std::get<0>(day_array).push_back(std::get<0>(minute_array)[i]);
+                    std::get<1>(day_array).push_back(std::get<1>(minute_array)[i]);
+                    std::get<2>(day_array).push_back(std::get<2>(minute_array)[i]);
+                    std::get<3>(day_array).push_back(std::get<3>(minute_array)[i]);
+                    std::get<4>(day_array).push_back(std::get<4>(minute_array)[i]);
+                    std::get<5>(day_array).push_back(0);
+                }
+
+                std::get<2>(day_array).back() = std::max(std::get<2>(day_array).back(), std::get<2>(minute_array)[i]);
+                std::get<3>(day_array).back() = std::min(std::get<3>(day_array).back(), std::get<3>(minute_array)[i]);
+                std::get<4>(day_array).back() = std::get<4>(minute_array)[i];
+                std::get<5>(day_array).back() += std::get<5>(minute_array)[i];
+            }
+
+            ExpressionPlan plan;
+            plan.Compile("MA(C, 3) + HHV(H, 2)");
+            plan.Update(day_array);
+
+            FrequencyMap frequency_map;
+            frequency_map.Update(std::get<0>(minute_array), std::get<0>(day_array));
+            for (std::size_t i = 0; i < frequency_map.size(); i += 37)
+            {
+                const auto day = static_cast<std::size_t>(frequency_map[i]);
+                const auto closed = frequency_map.GetClosedIndex(i);
+                const auto shown = closed >= 0 ? plan.GetResult()[closed] : std::numeric_limits<double>::quiet_NaN();
+
+                // Only the days before the bar's own day are known at it.
+                KArray known_array;
+                std::get<0>(known_array).assign(std::get<0>(day_array).begin(), std::get<0>(day_array).begin() + day);
+                std::get<1>(known_array).assign(std::get<1>(day_array).begin(), std::get<1>(day_array).begin() + day);
+                std::get<2>(known_array).assign(std::get<2>(day_array).begin(), std::get<2>(day_array).begin() + day);
+                std::get<3>(known_array).assign(std::get<3>(day_array).begin(), std::get<3>(day_array).begin() + day);
+                std::get<4>(known_array).assign(std::get<4>(day_array).begin(), std::get<4>(day_array).begin() + day);
+                std::get<5>(known_array).assign(std::get<5>(day_array).begin(), std::get<5>(day_array).begin() + day);
+
+                ExpressionPlan known_plan;
+                known_plan.Compile("MA(C, 3) + HHV(H, 2)");
+                known_plan.Update(known_array);
+                const auto expected = day > 0 ? known_plan.GetResult()[day - 1] : std::numeric_limits<double>::quiet_NaN();
+                if (shown != expected && !(std::isnan(shown) && std::isnan(expected)))
+                {
+                    return juce::Result::fail("bar " + juce::String(static_cast<int>(i)) + " shows " + juce::String(shown) + " instead of " + juce::String(expected));
+                }
+            }
+
+            return juce::Result::ok();
+        }
+
+        // Bars appended a few at a time must give the lines a single Calculate over the whole history gives.
+        juce::Result CheckStreamingAppend()
+        {
+            constexpr std::size_t kBarSize = 3000;
+            const auto source = MakeRandomKArray(kBarSize, kSeed);
+            for (const auto& [name, maker] : GetStreamingIndicatorMakers())
+            {
+                auto full_indicator = maker([&source]() -> const KArray& { return source; });
+                full_indicator->Calculate({ 0, static_cast<int>(kBarSize) });
+
+                KArray k_array;
+                auto indicator = maker([&k_array]() -> const KArray& { return k_array; });
+                for (std::size_t i = 0; i < kBarSize; ++i)
+                {
+                    AppendBar(source, i, k_array);
+                    if (i % 7 == 0 || i + 1 == kBarSize)
+                    {
+                        indicator->Calculate({ 0, static_cast<int>(i + 1) });
+                    }
+                }
+
+                for (std::size_t line_index = 0; line_index < indicator->GetLineSize(); ++line_index)
+                {
+                    const auto& value_array = indicator->GetLine(line_index);
+                    const auto& expected_array = full_indicator->GetLine(line_index);
+                    for (std::size_t i = 0; i < kBarSize; ++i)
+                    {
+                        const auto value = value_array[i];
+                        const auto expected = expected_array[i];
+                        if (std::isnan(value) != std::isnan(expected) || std::abs(value - expected) > 1e-9 * std::max(std::abs(expected), 1.0))
+                        {
+                            return juce::Result::fail(name + " line " + juce::String(static_cast<int>(line_index)) + " differs at bar " + juce::String(static_cast<int>(i)));
+                        }
+                    }
+                }
+            }
+
+            return juce::Result::ok();
+        }
+
+        juce::Result CheckViewportRoundTrip()
+        {
+            // Every bar maps back to itself from its centre, or to a bar of its column when bars share columns.
+            for (const auto bar_pitch : { 0.625f, 2.5f, 3.3f, 5.0f, 5.3f, 6.75f, 8.5f, 13.0f, 21.9f })
+            {
+                for (const auto first_position : { 0.0, 0.25, 0.5, 0.999, 12345.6 })
+                {
+                    const ViewportTransform transform(10, first_position, bar_pitch);
+                    const auto first_index = static_cast<int>(std::ceil(first_position));
+                    for (int i = first_index; i < first_index + 2000; ++i)
+                    {
+                        const auto index = transform.XToIndex(transform.IndexToX(i));
+                        if (transform.GetColumnStart(index) != transform.GetColumnStart(i) || (transform.GetStride() == 1 && index != i))
+                        {
+                            return juce::Result::fail("bar " + juce::String(i) + " maps back to " + juce::String(index) + " at pitch " + juce::String(bar_pitch)
+                                                      + " from " + juce::String(first_position));
+                        }
+                    }
+                }
+            }
+
+            return juce::Result::ok();
+        }
+    }
+
+    int RunSelfTest(std::ostream& output)
+    {
+        const std::vector<Check> checks = {
+            { "linear recurrence scan", CheckLinearRecurrenceScan },
+            { "EMA", CheckEma },
+            { "fused MACD(12, 26, 9)", [] { return CheckFusedMacd(12, 26, 9, 10000); } },
+            { "fused MACD(5, 35, 5)", [] { return CheckFusedMacd(5, 35, 5, 10000); } },
+            { "fused MACD(12, 26, 9) block scan", [] { return CheckFusedMacd(12, 26, 9, kScanSize); } },
+            { "fused MACD(5, 35, 5) block scan", [] { return CheckFusedMacd(5, 35, 5, kScanSize); } },
+            { "float MACD storage", CheckFloatMacd },
+            { "float MA storage", CheckFloatMa },
+            { "float KD storage", CheckFloatKd },
+            { "ParallelFor stress", CheckParallelForStress },
+            { "submitted tasks", CheckSubmittedTasks },
+            { "shared plan groups", CheckSharedPlanGroups },
+            { "rolling covariance", CheckRollingCovariance },
+            { "source formula lookahead", CheckSourceFormulaLookahead },
+            { "streaming indicator append", CheckStreamingAppend },
+            { "viewport round trip", CheckViewportRoundTrip }
+        };
+
+        std::size_t failed_size = 0;
+        for (const auto& [name, check] : checks)
+        {
+            const auto result = check();
+            output << (result.wasOk() ? "PASS " : "FAIL ") << name;
+            if (result.failed())
+            {
+                output << ": " << result.getErrorMessage();
+                ++failed_size;
+            }
+
+            output << "\n";
+        }
+
+        output << (checks.size() - failed_size) << "/" << checks.size() << " checks passed\n";
+        return failed_size == 0 ? 0 : 1;
+    }
+}
@@ -0,0 +1,11 @@
+// © 2023 Lei Cheng
+
+#pragma once
+
+#include <ostream>
+
+namespace lei
+{
+    // Runs every check of the kernels against a plain reference, one line per check. Returns 0 when all of them pass.
+    int RunSelfTest(std::ostream& output);
+}
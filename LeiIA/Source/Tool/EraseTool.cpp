@@ -45,7 +45,7 @@ namespace lei
                               const juce::Rectangle<int>& chart_bounds,
                               const std::pair<double, double>& min_max_label,
                               const juce::Range<int>& scroll_bar_current_range,
-                              int bar_width,
+                              const ViewportTransform& transform,
                               int chart_index)
     {
     }
@@ -103,6 +103,11 @@ namespace lei
         return nullptr;
     }
 
+    juce::Rectangle<int> EraseTool::GetPaintBounds() const
+    {
+        return {};
+    }
+
     void EraseTool::Paint(juce::Graphics& g)
     {
     }
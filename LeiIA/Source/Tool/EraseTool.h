@@ -21,7 +21,7 @@ namespace lei
                        const juce::Rectangle<int>& chart_bounds,
                        const std::pair<double, double>& min_max_label,
                        const juce::Range<int>& scroll_bar_current_range,
-                       int bar_width,
+                       const ViewportTransform& transform,
                        int chart_index) override;
 
         void ToolProcess(const juce::Point<int>& position) override;
@@ -30,7 +30,7 @@ namespace lei
         void ZoomChanged(const juce::Rectangle<int>& chart_bounds,
                          const std::pair<double, double>& min_max_label,
                          const juce::Range<int>& scroll_bar_current_range,
-                         int bar_width) override;
+                         const ViewportTransform& transform) override;
 
         int GetChartIndex() const override;
         juce::Uuid GetKey() const override;
@@ -38,6 +38,7 @@ namespace lei
         ToolType GetToolType() const override;
         juce::Rectangle<int> GetEraseButtonBounds() const override;
         std::shared_ptr<juce::Button> GetEraseButton() const override;
+        juce::Rectangle<int> GetPaintBounds() const override;
         void Paint(juce::Graphics& g) override;
 
     private:
@@ -6,9 +6,12 @@
 
 namespace lei
 {
-    HorizontalLineTool::HorizontalLineTool(juce::Component* target_component, const std::function<const KArray& ()>& GetKArray) :
+    HorizontalLineTool::HorizontalLineTool(juce::Component* target_component,
+                                           const std::function<const KArray& ()>& GetKArray,
+                                           const std::function<void(const juce::Rectangle<int>&)>& Repaint) :
         component_(target_component),
-        GetKArray_(GetKArray)
+        GetKArray_(GetKArray),
+        Repaint_(Repaint)
     {
         component_->setMouseCursor(juce::MouseCursor::CrosshairCursor);
     }
@@ -21,7 +24,7 @@ namespace lei
                                        const juce::Rectangle<int>& chart_bounds,
                                        const std::pair<double, double>& min_max_label,
                                        const juce::Range<int>& scroll_bar_current_range,
-                                       int bar_width,
+                                       const ViewportTransform& transform,
                                        int chart_index)
     {
         if (!chart_bounds.contains(position))
@@ -32,35 +35,39 @@ namespace lei
         chart_bounds_ = chart_bounds;
         min_max_label_ = min_max_label;
         scroll_bar_current_range_ = scroll_bar_current_range;
-        bar_width_ = bar_width;
+        transform_ = transform;
         chart_index_ = chart_index;
-        tool_position_.first = ToKTime(position, GetKArray_, scroll_bar_current_range, chart_bounds, bar_width);
+        tool_position_.first = ToKTime(position, GetKArray_, scroll_bar_current_range, transform);
         tool_position_.second = ToPrice(position, chart_bounds, min_max_label);
-        component_->repaint();
+        Repaint_(GetPaintBounds());
     }
 
     void HorizontalLineTool::ToolProcess(const juce::Point<int>& position)
     {
+        const auto dirty_bounds = GetPaintBounds();
         tool_position_.second = ToPrice(GetBoundsPoint(position, chart_bounds_), chart_bounds_, min_max_label_);
-        component_->repaint();
+        Repaint_(dirty_bounds);
+        Repaint_(GetPaintBounds());
     }
 
     void HorizontalLineTool::ToolEnd(const juce::Point<int>& position)
     {
+        const auto dirty_bounds = GetPaintBounds();
         tool_position_.second = ToPrice(GetBoundsPoint(position, chart_bounds_), chart_bounds_, min_max_label_);
         confirmed_ = true;
-        component_->repaint();
+        Repaint_(dirty_bounds);
+        Repaint_(GetPaintBounds());
     }
 
     void HorizontalLineTool::ZoomChanged(const juce::Rectangle<int>& chart_bounds,
                                          const std::pair<double, double>& min_max_label,
                                          const juce::Range<int>& scroll_bar_current_range,
-                                         int bar_width)
+                                         const ViewportTransform& transform)
     {
         chart_bounds_ = chart_bounds;
         min_max_label_ = min_max_label;
         scroll_bar_current_range_ = scroll_bar_current_range;
-        bar_width_ = bar_width;
+        transform_ = transform;
     }
 
     int HorizontalLineTool::GetChartIndex() const
@@ -109,6 +116,12 @@ namespace lei
         return erase_button_;
     }
 
+    juce::Rectangle<int> HorizontalLineTool::GetPaintBounds() const
+    {
+        const auto y = ToPositionY(tool_position_.second, chart_bounds_, min_max_label_);
+        return GetLineBounds({ chart_bounds_.getX(), y, chart_bounds_.getRight(), y }).getIntersection(chart_bounds_);
+    }
+
     void HorizontalLineTool::Paint(juce::Graphics& g)
     {
         juce::Graphics::ScopedSaveState raii(g);
@@ -18,7 +18,7 @@ namespace lei
                              const juce::Rectangle<int>& chart_bounds,
                              const std::pair<double, double>& min_max_label,
                              const juce::Range<int>& scroll_bar_current_range,
-                             int bar_width,
+                             const ViewportTransform& transform,
                              int chart_index)
     {
     }
@@ -34,7 +34,7 @@ namespace lei
     void NoneTool::ZoomChanged(const juce::Rectangle<int>& chart_bounds,
                                const std::pair<double, double>& min_max_label,
                                const juce::Range<int>& scroll_bar_current_range,
-                               int bar_width)
+                               const ViewportTransform& transform)
     {
     }
 
@@ -68,6 +68,11 @@ namespace lei
         return nullptr;
     }
 
+    juce::Rectangle<int> NoneTool::GetPaintBounds() const
+    {
+        return {};
+    }
+
     void NoneTool::Paint(juce::Graphics& g)
     {
     }
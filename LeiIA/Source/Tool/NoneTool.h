@@ -17,7 +17,7 @@ namespace lei
                        const juce::Rectangle<int>& chart_bounds,
                        const std::pair<double, double>& min_max_label,
                        const juce::Range<int>& scroll_bar_current_range,
-                       int bar_width,
+                       const ViewportTransform& transform,
                        int chart_index) override;
 
         void ToolProcess(const juce::Point<int>& position) override;
@@ -26,7 +26,7 @@ namespace lei
         void ZoomChanged(const juce::Rectangle<int>& chart_bounds,
                          const std::pair<double, double>& min_max_label,
                          const juce::Range<int>& scroll_bar_current_range,
-                         int bar_width) override;
+                         const ViewportTransform& transform) override;
 
         int GetChartIndex() const override;
         juce::Uuid GetKey() const override;
@@ -34,6 +34,7 @@ namespace lei
         ToolType GetToolType() const override;
         juce::Rectangle<int> GetEraseButtonBounds() const override;
         std::shared_ptr<juce::Button> GetEraseButton() const override;
+        juce::Rectangle<int> GetPaintBounds() const override;
         void Paint(juce::Graphics& g) override;
     };
 }
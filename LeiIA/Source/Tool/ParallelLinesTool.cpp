@@ -6,9 +6,12 @@
 
 namespace lei
 {
-    ParallelLinesTool::ParallelLinesTool(juce::Component* target_component, const std::function<const KArray& ()>& GetKArray) :
+    ParallelLinesTool::ParallelLinesTool(juce::Component* target_component,
+                                         const std::function<const KArray& ()>& GetKArray,
+                                         const std::function<void(const juce::Rectangle<int>&)>& Repaint) :
         component_(target_component),
-        GetKArray_(GetKArray)
+        GetKArray_(GetKArray),
+        Repaint_(Repaint)
     {
         component_->setMouseCursor(juce::MouseCursor::CrosshairCursor);
     }
@@ -21,7 +24,7 @@ namespace lei
                                       const juce::Rectangle<int>& chart_bounds,
                                       const std::pair<double, double>& min_max_label,
                                       const juce::Range<int>& scroll_bar_current_range,
-                                      int bar_width,
+                                      const ViewportTransform& transform,
                                       int chart_index)
     {
         if (second_position_confirmed_)
@@ -30,7 +33,7 @@ namespace lei
         }
         else
         {
-            ToolBeginPhase1(position, chart_bounds, min_max_label, scroll_bar_current_range, bar_width, chart_index);
+            ToolBeginPhase1(position, chart_bounds, min_max_label, scroll_bar_current_range, transform, chart_index);
         }
     }
 
@@ -61,12 +64,12 @@ namespace lei
     void ParallelLinesTool::ZoomChanged(const juce::Rectangle<int>& chart_bounds,
                                         const std::pair<double, double>& min_max_label,
                                         const juce::Range<int>& scroll_bar_current_range,
-                                        int bar_width)
+                                        const ViewportTransform& transform)
     {
         chart_bounds_ = chart_bounds;
         min_max_label_ = min_max_label;
         scroll_bar_current_range_ = scroll_bar_current_range;
-        bar_width_ = bar_width;
+        transform_ = transform;
     }
 
     int ParallelLinesTool::GetChartIndex() const
@@ -91,9 +94,9 @@ namespace lei
 
     juce::Rectangle<int> ParallelLinesTool::GetEraseButtonBounds() const
     {
-        const auto x1 = ToPositionX(first_position_.first, GetKArray_, scroll_bar_current_range_, chart_bounds_, bar_width_);
+        const auto x1 = ToPositionX(first_position_.first, GetKArray_, transform_);
         const auto y1 = ToPositionY(first_position_.second, chart_bounds_, min_max_label_);
-        const auto x2 = ToPositionX(second_position_.first, GetKArray_, scroll_bar_current_range_, chart_bounds_, bar_width_);
+        const auto x2 = ToPositionX(second_position_.first, GetKArray_, transform_);
         const auto y2 = ToPositionY(second_position_.second, chart_bounds_, min_max_label_);
         const auto line = GetExtendLine(chart_bounds_, { x1, y1 }, { x2, y2 }).toFloat();
 
@@ -115,7 +118,7 @@ namespace lei
             }
         }
 
-        const auto x3 = ToPositionX(third_position_.first, GetKArray_, scroll_bar_current_range_, chart_bounds_, bar_width_);
+        const auto x3 = ToPositionX(third_position_.first, GetKArray_, transform_);
         const auto y3 = ToPositionY(third_position_.second, chart_bounds_, min_max_label_);
         for (const auto& line : GetParallelLines({ x1, y1, x2, y2 }, { x3, y3 }))
         {
@@ -144,6 +147,29 @@ namespace lei
         return erase_button_;
     }
 
+    juce::Rectangle<int> ParallelLinesTool::GetPaintBounds() const
+    {
+        const juce::Point<int> pt1(ToPositionX(first_position_.first, GetKArray_, transform_),
+                                   ToPositionY(first_position_.second, chart_bounds_, min_max_label_));
+
+        const juce::Point<int> pt2(ToPositionX(second_position_.first, GetKArray_, transform_),
+                                   ToPositionY(second_position_.second, chart_bounds_, min_max_label_));
+
+        auto bounds = GetLineBounds(GetExtendLine(chart_bounds_, pt1, pt2));
+        if (phase2_start_)
+        {
+            const juce::Point<int> pt3(ToPositionX(third_position_.first, GetKArray_, transform_),
+                                       ToPositionY(third_position_.second, chart_bounds_, min_max_label_));
+
+            for (const auto& line : GetParallelLines({ pt1, pt2 }, pt3))
+            {
+                bounds = bounds.getUnion(GetLineBounds(line));
+            }
+        }
+
+        return bounds.getIntersection(chart_bounds_);
+    }
+
     void ParallelLinesTool::Paint(juce::Graphics& g)
     {
         juce::Graphics::ScopedSaveState raii(g);
@@ -159,10 +185,10 @@ namespace lei
             g.setColour(juce::Colours::white);
         }
 
-        const juce::Point<int> pt1(ToPositionX(first_position_.first, GetKArray_, scroll_bar_current_range_, chart_bounds_, bar_width_),
+        const juce::Point<int> pt1(ToPositionX(first_position_.first, GetKArray_, transform_),
                                    ToPositionY(first_position_.second, chart_bounds_, min_max_label_));
 
-        const juce::Point<int> pt2(ToPositionX(second_position_.first, GetKArray_, scroll_bar_current_range_, chart_bounds_, bar_width_),
+        const juce::Point<int> pt2(ToPositionX(second_position_.first, GetKArray_, transform_),
                                    ToPositionY(second_position_.second, chart_bounds_, min_max_label_));
 
         g.drawLine(GetExtendLine(chart_bounds_, pt1, pt2).toFloat());
@@ -178,7 +204,7 @@ namespace lei
                 g.setColour(juce::Colours::white);
             }
 
-            const juce::Point<int> pt3(ToPositionX(third_position_.first, GetKArray_, scroll_bar_current_range_, chart_bounds_, bar_width_),
+            const juce::Point<int> pt3(ToPositionX(third_position_.first, GetKArray_, transform_),
                                        ToPositionY(third_position_.second, chart_bounds_, min_max_label_));
 
             for (const auto& line : GetParallelLines({ pt1, pt2 }, pt3))
@@ -192,7 +218,7 @@ namespace lei
                                             const juce::Rectangle<int>& chart_bounds,
                                             const std::pair<double, double>& min_max_label,
                                             const juce::Range<int>& scroll_bar_current_range,
-                                            int bar_width,
+                                            const ViewportTransform& transform,
                                             int chart_index)
     {
         if (!chart_bounds.contains(position))
@@ -203,49 +229,59 @@ namespace lei
         chart_bounds_ = chart_bounds;
         min_max_label_ = min_max_label;
         scroll_bar_current_range_ = scroll_bar_current_range;
-        bar_width_ = bar_width;
+        transform_ = transform;
         chart_index_ = chart_index;
-        second_position_.first = first_position_.first = ToKTime(position, GetKArray_, scroll_bar_current_range, chart_bounds, bar_width);
+        second_position_.first = first_position_.first = ToKTime(position, GetKArray_, scroll_bar_current_range, transform);
         second_position_.second = first_position_.second = ToPrice(position, chart_bounds, min_max_label);
-        component_->repaint();
+        Repaint_(GetPaintBounds());
     }
 
     void ParallelLinesTool::ToolProcessPhase1(const juce::Point<int>& position)
     {
-        second_position_.first = ToKTime(GetBoundsPoint(position, chart_bounds_), GetKArray_, scroll_bar_current_range_, chart_bounds_, bar_width_);
+        const auto dirty_bounds = GetPaintBounds();
+        second_position_.first = ToKTime(GetBoundsPoint(position, chart_bounds_), GetKArray_, scroll_bar_current_range_, transform_);
         second_position_.second = ToPrice(GetBoundsPoint(position, chart_bounds_), chart_bounds_, min_max_label_);
-        component_->repaint();
+        Repaint_(dirty_bounds);
+        Repaint_(GetPaintBounds());
     }
 
     void ParallelLinesTool::ToolEndPhase1(const juce::Point<int>& position)
     {
-        second_position_.first = ToKTime(GetBoundsPoint(position, chart_bounds_), GetKArray_, scroll_bar_current_range_, chart_bounds_, bar_width_);
+        const auto dirty_bounds = GetPaintBounds();
+        second_position_.first = ToKTime(GetBoundsPoint(position, chart_bounds_), GetKArray_, scroll_bar_current_range_, transform_);
         second_position_.second = ToPrice(GetBoundsPoint(position, chart_bounds_), chart_bounds_, min_max_label_);
         second_position_confirmed_ = true;
-        component_->repaint();
+        Repaint_(dirty_bounds);
+        Repaint_(GetPaintBounds());
     }
 
     void ParallelLinesTool::ToolBeginPhase2(const juce::Point<int>& position)
     {
+        const auto dirty_bounds = GetPaintBounds();
         phase2_start_ = true;
-        third_position_.first = ToKTime(GetBoundsPoint(position, chart_bounds_), GetKArray_, scroll_bar_current_range_, chart_bounds_, bar_width_);
+        third_position_.first = ToKTime(GetBoundsPoint(position, chart_bounds_), GetKArray_, scroll_bar_current_range_, transform_);
         third_position_.second = ToPrice(GetBoundsPoint(position, chart_bounds_), chart_bounds_, min_max_label_);
-        component_->repaint();
+        Repaint_(dirty_bounds);
+        Repaint_(GetPaintBounds());
     }
 
     void ParallelLinesTool::ToolProcessPhase2(const juce::Point<int>& position)
     {
-        third_position_.first = ToKTime(GetBoundsPoint(position, chart_bounds_), GetKArray_, scroll_bar_current_range_, chart_bounds_, bar_width_);
+        const auto dirty_bounds = GetPaintBounds();
+        third_position_.first = ToKTime(GetBoundsPoint(position, chart_bounds_), GetKArray_, scroll_bar_current_range_, transform_);
         third_position_.second = ToPrice(GetBoundsPoint(position, chart_bounds_), chart_bounds_, min_max_label_);
-        component_->repaint();
+        Repaint_(dirty_bounds);
+        Repaint_(GetPaintBounds());
     }
 
     void ParallelLinesTool::ToolEndPhase2(const juce::Point<int>& position)
     {
-        third_position_.first = ToKTime(GetBoundsPoint(position, chart_bounds_), GetKArray_, scroll_bar_current_range_, chart_bounds_, bar_width_);
+        const auto dirty_bounds = GetPaintBounds();
+        third_position_.first = ToKTime(GetBoundsPoint(position, chart_bounds_), GetKArray_, scroll_bar_current_range_, transform_);
         third_position_.second = ToPrice(GetBoundsPoint(position, chart_bounds_), chart_bounds_, min_max_label_);
         third_position_confirmed_ = true;
-        component_->repaint();
+        Repaint_(dirty_bounds);
+        Repaint_(GetPaintBounds());
     }
 
     std::vector<juce::Line<int>> ParallelLinesTool::GetParallelLines(const juce::Line<int>& line, const juce::Point<int>& pt) const
@@ -4,13 +4,16 @@
 
 #include "Tool/Tool.h"
 #include "Data/DataCenter.h"
+#include "Layout.h"
 
 namespace lei
 {
     class ParallelLinesTool : public Tool
     {
     public:
-        ParallelLinesTool(juce::Component* target_component, const std::function<const KArray& ()>& GetKArray);
+        ParallelLinesTool(juce::Component* target_component,
+                          const std::function<const KArray& ()>& GetKArray,
+                          const std::function<void(const juce::Rectangle<int>&)>& Repaint);
         ~ParallelLinesTool() override;
 
     public:
@@ -18,7 +21,7 @@ namespace lei
                        const juce::Rectangle<int>& chart_bounds,
                        const std::pair<double, double>& min_max_label,
                        const juce::Range<int>& scroll_bar_current_range,
-                       int bar_width,
+                       const ViewportTransform& transform,
                        int chart_index) override;
 
         void ToolProcess(const juce::Point<int>& position) override;
@@ -27,7 +30,7 @@ namespace lei
         void ZoomChanged(const juce::Rectangle<int>& chart_bounds,
                          const std::pair<double, double>& min_max_label,
                          const juce::Range<int>& scroll_bar_current_range,
-                         int bar_width) override;
+                         const ViewportTransform& transform) override;
 
         int GetChartIndex() const override;
         juce::Uuid GetKey() const override;
@@ -35,6 +38,7 @@ namespace lei
         ToolType GetToolType() const override;
         juce::Rectangle<int> GetEraseButtonBounds() const override;
         std::shared_ptr<juce::Button> GetEraseButton() const override;
+        juce::Rectangle<int> GetPaintBounds() const override;
         void Paint(juce::Graphics& g) override;
 
     private:
@@ -42,7 +46,7 @@ namespace lei
                              const juce::Rectangle<int>& chart_bounds,
                              const std::pair<double, double>& min_max_label,
                              const juce::Range<int>& scroll_bar_current_range,
-                             int bar_width,
+                             const ViewportTransform& transform,
                              int chart_index);
 
         void ToolProcessPhase1(const juce::Point<int>& position);
@@ -57,13 +61,14 @@ namespace lei
     private:
         juce::Component* component_;
         std::function<const KArray& ()> GetKArray_;
+        std::function<void(const juce::Rectangle<int>&)> Repaint_;
         ToolPosition first_position_;
         ToolPosition second_position_;
         ToolPosition third_position_;
         juce::Rectangle<int> chart_bounds_;
         std::pair<double, double> min_max_label_;
         juce::Range<int> scroll_bar_current_range_;
-        int bar_width_;
+        ViewportTransform transform_;
         juce::Uuid key_;
         int chart_index_ = 0;
         bool phase2_start_ = false;
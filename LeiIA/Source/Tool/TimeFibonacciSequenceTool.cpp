@@ -2,13 +2,17 @@
 
 #include "TimeFibonacciSequenceTool.h"
 #include "Layout.h"
+#include "Render/TextCache.h"
 #include "ToolType.h"
 
 namespace lei
 {
-    TimeFibonacciSequenceTool::TimeFibonacciSequenceTool(juce::Component* target_component, const std::function<const KArray& ()>& GetKArray) :
+    TimeFibonacciSequenceTool::TimeFibonacciSequenceTool(juce::Component* target_component,
+                                                         const std::function<const KArray& ()>& GetKArray,
+                                                         const std::function<void(const juce::Rectangle<int>&)>& Repaint) :
         component_(target_component),
-        GetKArray_(GetKArray)
+        GetKArray_(GetKArray),
+        Repaint_(Repaint)
     {
         component_->setMouseCursor(juce::MouseCursor::CrosshairCursor);
     }
@@ -21,7 +25,7 @@ namespace lei
                                               const juce::Rectangle<int>& chart_bounds,
                                               const std::pair<double, double>& min_max_label,
                                               const juce::Range<int>& scroll_bar_current_range,
-                                              int bar_width,
+                                              const ViewportTransform& transform,
                                               int chart_index)
     {
         if (!chart_bounds.contains(position))
@@ -32,35 +36,39 @@ namespace lei
         chart_bounds_ = chart_bounds;
         min_max_label_ = min_max_label;
         scroll_bar_current_range_ = scroll_bar_current_range;
-        bar_width_ = bar_width;
+        transform_ = transform;
         chart_index_ = chart_index;
-        tool_position_.first = ToKTime(position, GetKArray_, scroll_bar_current_range, chart_bounds, bar_width);
+        tool_position_.first = ToKTime(position, GetKArray_, scroll_bar_current_range, transform);
         tool_position_.second = ToPrice(position, chart_bounds, min_max_label);
-        component_->repaint();
+        Repaint_(GetPaintBounds());
     }
 
     void TimeFibonacciSequenceTool::ToolProcess(const juce::Point<int>& position)
     {
-        tool_position_.first = ToKTime(position, GetKArray_, scroll_bar_current_range_, chart_bounds_, bar_width_);
-        component_->repaint();
+        const auto dirty_bounds = GetPaintBounds();
+        tool_position_.first = ToKTime(position, GetKArray_, scroll_bar_current_range_, transform_);
+        Repaint_(dirty_bounds);
+        Repaint_(GetPaintBounds());
     }
 
     void TimeFibonacciSequenceTool::ToolEnd(const juce::Point<int>& position)
     {
-        tool_position_.first = ToKTime(position, GetKArray_, scroll_bar_current_range_, chart_bounds_, bar_width_);
+        const auto dirty_bounds = GetPaintBounds();
+        tool_position_.first = ToKTime(position, GetKArray_, scroll_bar_current_range_, transform_);
         confirmed_ = true;
-        component_->repaint();
+        Repaint_(dirty_bounds);
+        Repaint_(GetPaintBounds());
     }
 
     void TimeFibonacciSequenceTool::ZoomChanged(const juce::Rectangle<int>& chart_bounds,
                                                 const std::pair<double, double>& min_max_label,
                                                 const juce::Range<int>& scroll_bar_current_range,
-                                                int bar_width)
+                                                const ViewportTransform& transform)
     {
         chart_bounds_ = chart_bounds;
         min_max_label_ = min_max_label;
         scroll_bar_current_range_ = scroll_bar_current_range;
-        bar_width_ = bar_width;
+        transform_ = transform;
     }
 
     int TimeFibonacciSequenceTool::GetChartIndex() const
@@ -85,7 +93,7 @@ namespace lei
 
     juce::Rectangle<int> TimeFibonacciSequenceTool::GetEraseButtonBounds() const
     {
-        const auto x = ToPositionX(tool_position_.first, GetKArray_, scroll_bar_current_range_, chart_bounds_, bar_width_);
+        const auto x = ToPositionX(tool_position_.first, GetKArray_, transform_);
         juce::Rectangle<int> erase_button(x - kToolEraseButtonWidthHeight / 2,
                                           chart_bounds_.getY() - kToolEraseButtonWidthHeight / 2,
                                           kToolEraseButtonWidthHeight,
@@ -109,6 +117,18 @@ namespace lei
         return erase_button_;
     }
 
+    juce::Rectangle<int> TimeFibonacciSequenceTool::GetPaintBounds() const
+    {
+        // From the first line to the right edge, with the labels below the chart.
+        const auto font = juce::Font().withStyle(juce::Font::bold);
+        const auto label_width = juce::roundToInt(GetCachedStringWidth(font, juce::String(scroll_bar_current_range_.getLength())));
+        const auto x = ToPositionX(tool_position_.first, GetKArray_, transform_) - label_width / 2 - 1;
+        return juce::Rectangle<int>(x,
+                                    chart_bounds_.getY(),
+                                    chart_bounds_.getRight() + label_width / 2 + 1 - x,
+                                    chart_bounds_.getHeight() + lei::kChartBorderThickness + juce::roundToInt(font.getHeight()));
+    }
+
     void TimeFibonacciSequenceTool::Paint(juce::Graphics& g)
     {
         juce::Graphics::ScopedSaveState raii(g);
@@ -129,15 +149,14 @@ namespace lei
         const auto k_index = KTimeToKIndex(tool_position_.first, GetKArray_);
         for (const auto& fibonacci_number : FibonacciSequence(scroll_bar_current_range_.getEnd() - k_index - 1))
         {
-            const auto x = ToPositionX(tool_position_.first, fibonacci_number, GetKArray_, scroll_bar_current_range_, chart_bounds_, bar_width_);
+            const auto x = ToPositionX(tool_position_.first, fibonacci_number, GetKArray_, transform_);
             g.drawVerticalLine(x, chart_bounds_.getY(), chart_bounds_.getBottom());
 
             const juce::String label_string(fibonacci_number);
-            const auto width = font.getStringWidthFloat(label_string);
-            g.drawText(label_string,
-                       juce::Rectangle<float>(x - width / 2, chart_bounds_.getBottom() + lei::kChartBorderThickness, width, font.getHeight()),
-                       juce::Justification::centred,
-                       false);
+            const auto width = GetCachedStringWidth(font, label_string);
+            DrawCachedText(g, label_string,
+                           juce::Rectangle<float>(x - width / 2, chart_bounds_.getBottom() + lei::kChartBorderThickness, width, font.getHeight()),
+                           juce::Justification::centred);
         }
     }
 
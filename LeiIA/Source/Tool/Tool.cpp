@@ -27,6 +27,11 @@ namespace lei
         }
     }
 
+    juce::Rectangle<int> GetLineBounds(const juce::Line<int>& line)
+    {
+        return juce::Rectangle<int>(line.getStart(), line.getEnd()).expanded(2);
+    }
+
     std::shared_ptr<juce::Button> CreateEraseButton(const juce::String& tool_key)
     {
         juce::Path shape;
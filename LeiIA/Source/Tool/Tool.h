@@ -7,8 +7,11 @@
 namespace lei
 {
     enum class ToolType;
+    class ViewportTransform;
 
     juce::Line<int> GetExtendLine(const juce::Rectangle<int>& chart_bounds, const juce::Point<int>& pt1, const juce::Point<int>& pt2);
+    // The pixels a line drawn between the points can touch, used to repaint only what a tool covers.
+    juce::Rectangle<int> GetLineBounds(const juce::Line<int>& line);
     std::shared_ptr<juce::Button> CreateEraseButton(const juce::String& tool_key);
     bool IsAcrossCharts(ToolType tool_type);
 
@@ -25,7 +28,7 @@ namespace lei
                                const juce::Rectangle<int>& chart_bounds,
                                const std::pair<double, double>& min_max_label,
                                const juce::Range<int>& scroll_bar_current_range,
-                               int bar_width,
+                               const ViewportTransform& transform,
                                int chart_index) = 0;
 
         virtual void ToolProcess(const juce::Point<int>& position) = 0;
@@ -34,7 +37,7 @@ namespace lei
         virtual void ZoomChanged(const juce::Rectangle<int>& chart_bounds,
                                  const std::pair<double, double>& min_max_label,
                                  const juce::Range<int>& scroll_bar_current_range,
-                                 int bar_width) = 0;
+                                 const ViewportTransform& transform) = 0;
 
         virtual int GetChartIndex() const = 0;
         virtual juce::Uuid GetKey() const = 0;
@@ -42,6 +45,7 @@ namespace lei
         virtual ToolType GetToolType() const = 0;
         virtual juce::Rectangle<int> GetEraseButtonBounds() const = 0;
         virtual std::shared_ptr<juce::Button> GetEraseButton() const = 0;
+        virtual juce::Rectangle<int> GetPaintBounds() const = 0;
         virtual void Paint(juce::Graphics& g) = 0;
     };
 }
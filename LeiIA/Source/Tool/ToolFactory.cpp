@@ -22,6 +22,7 @@ namespace lei
     std::unique_ptr<Tool> ToolFactory::GetTool(ToolType type,
                                                juce::Component* component,
                                                const std::function<const KArray& ()>& GetKArray,
+                                               const std::function<void(const juce::Rectangle<int>&)>& Repaint,
                                                const std::unordered_map<juce::Uuid, std::weak_ptr<lei::Tool>>& tools,
                                                const std::function<void(const std::shared_ptr<juce::Button>&)>& RegisterEraseButton,
                                                const std::function<void(const std::shared_ptr<juce::Button>&)>& UnregisterEraseButton)
@@ -31,17 +32,17 @@ namespace lei
         case lei::ToolType::kNone:
             return std::make_unique<lei::NoneTool>(component);
         case lei::ToolType::kVerticalLine:
-            return std::make_unique<lei::VerticalLineTool>(component, GetKArray);
+            return std::make_unique<lei::VerticalLineTool>(component, GetKArray, Repaint);
         case lei::ToolType::kHorizontalLine:
-            return std::make_unique<lei::HorizontalLineTool>(component, GetKArray);
+            return std::make_unique<lei::HorizontalLineTool>(component, GetKArray, Repaint);
         case lei::ToolType::kTrendline:
-            return std::make_unique<lei::TrendlineTool>(component, GetKArray);
+            return std::make_unique<lei::TrendlineTool>(component, GetKArray, Repaint);
         case lei::ToolType::kParallelLines:
-            return std::make_unique<lei::ParallelLinesTool>(component, GetKArray);
+            return std::make_unique<lei::ParallelLinesTool>(component, GetKArray, Repaint);
         case lei::ToolType::kLine:
-            return std::make_unique<lei::LineTool>(component, GetKArray);
+            return std::make_unique<lei::LineTool>(component, GetKArray, Repaint);
         case lei::ToolType::kTimeFibonacciSequence:
-            return std::make_unique<lei::TimeFibonacciSequenceTool>(component, GetKArray);
+            return std::make_unique<lei::TimeFibonacciSequenceTool>(component, GetKArray, Repaint);
         case lei::ToolType::kErase:
             return std::make_unique<lei::EraseTool>(component, tools, RegisterEraseButton, UnregisterEraseButton);
         default:
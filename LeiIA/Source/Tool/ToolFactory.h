@@ -21,6 +21,7 @@ namespace lei
         static std::unique_ptr<Tool> GetTool(ToolType type,
                                              juce::Component* component,
                                              const std::function<const KArray& ()>& GetKArray,
+                                             const std::function<void(const juce::Rectangle<int>&)>& Repaint,
                                              const std::unordered_map<juce::Uuid, std::weak_ptr<lei::Tool>>& tools,
                                              const std::function<void(const std::shared_ptr<juce::Button>&)>& RegisterEraseButton,
                                              const std::function<void(const std::shared_ptr<juce::Button>&)>& UnregisterEraseButton);
@@ -6,9 +6,12 @@
 
 namespace lei
 {
-    TrendlineTool::TrendlineTool(juce::Component* target_component, const std::function<const KArray& ()>& GetKArray) :
+    TrendlineTool::TrendlineTool(juce::Component* target_component,
+                                 const std::function<const KArray& ()>& GetKArray,
+                                 const std::function<void(const juce::Rectangle<int>&)>& Repaint) :
         component_(target_component),
-        GetKArray_(GetKArray)
+        GetKArray_(GetKArray),
+        Repaint_(Repaint)
     {
         component_->setMouseCursor(juce::MouseCursor::CrosshairCursor);
     }
@@ -21,7 +24,7 @@ namespace lei
                                   const juce::Rectangle<int>& chart_bounds,
                                   const std::pair<double, double>& min_max_label,
                                   const juce::Range<int>& scroll_bar_current_range,
-                                  int bar_width,
+                                  const ViewportTransform& transform,
                                   int chart_index)
     {
         if (!chart_bounds.contains(position))
@@ -32,37 +35,41 @@ namespace lei
         chart_bounds_ = chart_bounds;
         min_max_label_ = min_max_label;
         scroll_bar_current_range_ = scroll_bar_current_range;
-        bar_width_ = bar_width;
+        transform_ = transform;
         chart_index_ = chart_index;
-        second_position_.first = first_position_.first = ToKTime(position, GetKArray_, scroll_bar_current_range, chart_bounds, bar_width);
+        second_position_.first = first_position_.first = ToKTime(position, GetKArray_, scroll_bar_current_range, transform);
         second_position_.second = first_position_.second = ToPrice(position, chart_bounds, min_max_label);
-        component_->repaint();
+        Repaint_(GetPaintBounds());
     }
 
     void TrendlineTool::ToolProcess(const juce::Point<int>& position)
     {
-        second_position_.first = ToKTime(GetBoundsPoint(position, chart_bounds_), GetKArray_, scroll_bar_current_range_, chart_bounds_, bar_width_);
+        const auto dirty_bounds = GetPaintBounds();
+        second_position_.first = ToKTime(GetBoundsPoint(position, chart_bounds_), GetKArray_, scroll_bar_current_range_, transform_);
         second_position_.second = ToPrice(GetBoundsPoint(position, chart_bounds_), chart_bounds_, min_max_label_);
-        component_->repaint();
+        Repaint_(dirty_bounds);
+        Repaint_(GetPaintBounds());
     }
 
     void TrendlineTool::ToolEnd(const juce::Point<int>& position)
     {
-        second_position_.first = ToKTime(GetBoundsPoint(position, chart_bounds_), GetKArray_, scroll_bar_current_range_, chart_bounds_, bar_width_);
+        const auto dirty_bounds = GetPaintBounds();
+        second_position_.first = ToKTime(GetBoundsPoint(position, chart_bounds_), GetKArray_, scroll_bar_current_range_, transform_);
         second_position_.second = ToPrice(GetBoundsPoint(position, chart_bounds_), chart_bounds_, min_max_label_);
         confirmed_ = true;
-        component_->repaint();
+        Repaint_(dirty_bounds);
+        Repaint_(GetPaintBounds());
     }
 
     void TrendlineTool::ZoomChanged(const juce::Rectangle<int>& chart_bounds,
                                     const std::pair<double, double>& min_max_label,
                                     const juce::Range<int>& scroll_bar_current_range,
-                                    int bar_width)
+                                    const ViewportTransform& transform)
     {
         chart_bounds_ = chart_bounds;
         min_max_label_ = min_max_label;
         scroll_bar_current_range_ = scroll_bar_current_range;
-        bar_width_ = bar_width;
+        transform_ = transform;
     }
 
     int TrendlineTool::GetChartIndex() const
@@ -87,9 +94,9 @@ namespace lei
 
     juce::Rectangle<int> TrendlineTool::GetEraseButtonBounds() const
     {
-        const auto x1 = ToPositionX(first_position_.first, GetKArray_, scroll_bar_current_range_, chart_bounds_, bar_width_);
+        const auto x1 = ToPositionX(first_position_.first, GetKArray_, transform_);
         const auto y1 = ToPositionY(first_position_.second, chart_bounds_, min_max_label_);
-        const auto x2 = ToPositionX(second_position_.first, GetKArray_, scroll_bar_current_range_, chart_bounds_, bar_width_);
+        const auto x2 = ToPositionX(second_position_.first, GetKArray_, transform_);
         const auto y2 = ToPositionY(second_position_.second, chart_bounds_, min_max_label_);
         const auto line = GetExtendLine(chart_bounds_, { x1, y1 }, { x2, y2 }).toFloat();
 
@@ -124,6 +131,15 @@ namespace lei
         return erase_button_;
     }
 
+    juce::Rectangle<int> TrendlineTool::GetPaintBounds() const
+    {
+        return GetLineBounds(GetExtendLine(chart_bounds_,
+                                           { ToPositionX(first_position_.first, GetKArray_, transform_),
+                                             ToPositionY(first_position_.second, chart_bounds_, min_max_label_) },
+                                           { ToPositionX(second_position_.first, GetKArray_, transform_),
+                                             ToPositionY(second_position_.second, chart_bounds_, min_max_label_) })).getIntersection(chart_bounds_);
+    }
+
     void TrendlineTool::Paint(juce::Graphics& g)
     {
         juce::Graphics::ScopedSaveState raii(g);
@@ -140,9 +156,9 @@ namespace lei
         }
 
         g.drawLine(GetExtendLine(chart_bounds_,
-                                 { ToPositionX(first_position_.first, GetKArray_, scroll_bar_current_range_, chart_bounds_, bar_width_),
+                                 { ToPositionX(first_position_.first, GetKArray_, transform_),
                                    ToPositionY(first_position_.second, chart_bounds_, min_max_label_) },
-                                 { ToPositionX(second_position_.first, GetKArray_, scroll_bar_current_range_, chart_bounds_, bar_width_),
+                                 { ToPositionX(second_position_.first, GetKArray_, transform_),
                                    ToPositionY(second_position_.second, chart_bounds_, min_max_label_) }).toFloat());
     }
 }
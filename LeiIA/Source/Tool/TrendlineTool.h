@@ -4,13 +4,16 @@
 
 #include "Tool/Tool.h"
 #include "Data/DataCenter.h"
+#include "Layout.h"
 
 namespace lei
 {
     class TrendlineTool : public Tool
     {
     public:
-        TrendlineTool(juce::Component* target_component, const std::function<const KArray& ()>& GetKArray);
+        TrendlineTool(juce::Component* target_component,
+                      const std::function<const KArray& ()>& GetKArray,
+                      const std::function<void(const juce::Rectangle<int>&)>& Repaint);
         ~TrendlineTool() override;
 
     public:
@@ -18,7 +21,7 @@ namespace lei
                        const juce::Rectangle<int>& chart_bounds,
                        const std::pair<double, double>& min_max_label,
                        const juce::Range<int>& scroll_bar_current_range,
-                       int bar_width,
+                       const ViewportTransform& transform,
                        int chart_index) override;
 
         void ToolProcess(const juce::Point<int>& position) override;
@@ -27,7 +30,7 @@ namespace lei
         void ZoomChanged(const juce::Rectangle<int>& chart_bounds,
                          const std::pair<double, double>& min_max_label,
                          const juce::Range<int>& scroll_bar_current_range,
-                         int bar_width) override;
+                         const ViewportTransform& transform) override;
 
         int GetChartIndex() const override;
         juce::Uuid GetKey() const override;
@@ -35,17 +38,19 @@ namespace lei
         ToolType GetToolType() const override;
         juce::Rectangle<int> GetEraseButtonBounds() const override;
         std::shared_ptr<juce::Button> GetEraseButton() const override;
+        juce::Rectangle<int> GetPaintBounds() const override;
         void Paint(juce::Graphics& g) override;
 
     private:
         juce::Component* component_;
         std::function<const KArray& ()> GetKArray_;
+        std::function<void(const juce::Rectangle<int>&)> Repaint_;
         ToolPosition first_position_;
         ToolPosition second_position_;
         juce::Rectangle<int> chart_bounds_;
         std::pair<double, double> min_max_label_;
         juce::Range<int> scroll_bar_current_range_;
-        int bar_width_;
+        ViewportTransform transform_;
         juce::Uuid key_;
         int chart_index_ = 0;
         bool confirmed_ = false;
@@ -6,9 +6,12 @@
 
 namespace lei
 {
-    VerticalLineTool::VerticalLineTool(juce::Component* target_component, const std::function<const KArray& ()>& GetKArray) :
+    VerticalLineTool::VerticalLineTool(juce::Component* target_component,
+                                       const std::function<const KArray& ()>& GetKArray,
+                                       const std::function<void(const juce::Rectangle<int>&)>& Repaint) :
         component_(target_component),
-        GetKArray_(GetKArray)
+        GetKArray_(GetKArray),
+        Repaint_(Repaint)
     {
         component_->setMouseCursor(juce::MouseCursor::CrosshairCursor);
     }
@@ -21,7 +24,7 @@ namespace lei
                                      const juce::Rectangle<int>& chart_bounds,
                                      const std::pair<double, double>& min_max_label,
                                      const juce::Range<int>& scroll_bar_current_range,
-                                     int bar_width,
+                                     const ViewportTransform& transform,
                                      int chart_index)
     {
         if (!chart_bounds.contains(position))
@@ -32,35 +35,39 @@ namespace lei
         chart_bounds_ = chart_bounds;
         min_max_label_ = min_max_label;
         scroll_bar_current_range_ = scroll_bar_current_range;
-        bar_width_ = bar_width;
+        transform_ = transform;
         chart_index_ = chart_index;
-        tool_position_.first = ToKTime(position, GetKArray_, scroll_bar_current_range, chart_bounds, bar_width);
+        tool_position_.first = ToKTime(position, GetKArray_, scroll_bar_current_range, transform);
         tool_position_.second = ToPrice(position, chart_bounds, min_max_label);
-        component_->repaint();
+        Repaint_(GetPaintBounds());
     }
 
     void VerticalLineTool::ToolProcess(const juce::Point<int>& position)
     {
-        tool_position_.first = ToKTime(position, GetKArray_, scroll_bar_current_range_, chart_bounds_, bar_width_);
-        component_->repaint();
+        const auto dirty_bounds = GetPaintBounds();
+        tool_position_.first = ToKTime(position, GetKArray_, scroll_bar_current_range_, transform_);
+        Repaint_(dirty_bounds);
+        Repaint_(GetPaintBounds());
     }
 
     void VerticalLineTool::ToolEnd(const juce::Point<int>& position)
     {
-        tool_position_.first = ToKTime(position, GetKArray_, scroll_bar_current_range_, chart_bounds_, bar_width_);
+        const auto dirty_bounds = GetPaintBounds();
+        tool_position_.first = ToKTime(position, GetKArray_, scroll_bar_current_range_, transform_);
         confirmed_ = true;
-        component_->repaint();
+        Repaint_(dirty_bounds);
+        Repaint_(GetPaintBounds());
     }
 
     void VerticalLineTool::ZoomChanged(const juce::Rectangle<int>& chart_bounds,
                                        const std::pair<double, double>& min_max_label,
                                        const juce::Range<int>& scroll_bar_current_range,
-                                       int bar_width)
+                                       const ViewportTransform& transform)
     {
         chart_bounds_ = chart_bounds;
         min_max_label_ = min_max_label;
         scroll_bar_current_range_ = scroll_bar_current_range;
-        bar_width_ = bar_width;
+        transform_ = transform;
     }
 
     int VerticalLineTool::GetChartIndex() const
@@ -85,7 +92,7 @@ namespace lei
 
     juce::Rectangle<int> VerticalLineTool::GetEraseButtonBounds() const
     {
-        const auto x = ToPositionX(tool_position_.first, GetKArray_, scroll_bar_current_range_, chart_bounds_, bar_width_);
+        const auto x = ToPositionX(tool_position_.first, GetKArray_, transform_);
         juce::Rectangle<int> erase_button(x - kToolEraseButtonWidthHeight / 2,
                                           chart_bounds_.getY() - kToolEraseButtonWidthHeight / 2,
                                           kToolEraseButtonWidthHeight,
@@ -109,6 +116,12 @@ namespace lei
         return erase_button_;
     }
 
+    juce::Rectangle<int> VerticalLineTool::GetPaintBounds() const
+    {
+        const auto x = ToPositionX(tool_position_.first, GetKArray_, transform_);
+        return GetLineBounds({ x, chart_bounds_.getY(), x, chart_bounds_.getBottom() }).getIntersection(chart_bounds_);
+    }
+
     void VerticalLineTool::Paint(juce::Graphics& g)
     {
         juce::Graphics::ScopedSaveState raii(g);
@@ -124,7 +137,7 @@ namespace lei
             g.setColour(juce::Colours::white);
         }
 
-        g.drawVerticalLine(ToPositionX(tool_position_.first, GetKArray_, scroll_bar_current_range_, chart_bounds_, bar_width_),
+        g.drawVerticalLine(ToPositionX(tool_position_.first, GetKArray_, transform_),
                            chart_bounds_.getY(),
                            chart_bounds_.getBottom());
     }
@@ -3,12 +3,16 @@
 #include "WatchTool/WatchTool.h"
 #include "DrawUtility.h"
 #include "Layout.h"
+#include "Render/TextCache.h"
 
 namespace lei
 {
-    WatchTool::WatchTool(juce::Component* target_component, const std::function<const KArray& ()>& GetKArray) :
+    WatchTool::WatchTool(juce::Component* target_component,
+                         const std::function<const KArray& ()>& GetKArray,
+                         const std::function<void(const juce::Rectangle<int>&)>& Repaint) :
         component_(target_component),
-        GetKArray_(GetKArray)
+        GetKArray_(GetKArray),
+        Repaint_(Repaint)
     {
 
     }
@@ -28,6 +32,8 @@ namespace lei
                                lei::DataFrequency data_frequency,
                                int k_centre_x)
     {
+        // Only the old and the new crosshair with their labels are repainted, over the cached charts.
+        const auto dirty_area = GetPaintArea();
         k_index_ = k_index;
         all_chart_bounds_ = all_chart_bounds;
         if (!chart_bounds.isEmpty())
@@ -43,7 +49,13 @@ namespace lei
         if (mouse_position_ != position)
         {
             mouse_position_ = position;
-            component_->repaint();
+            for (const auto& area : { dirty_area, GetPaintArea() })
+            {
+                for (const auto& rectangle : area)
+                {
+                    Repaint_(rectangle);
+                }
+            }
         }
     }
 
@@ -56,10 +68,7 @@ namespace lei
 
         juce::Graphics::ScopedSaveState raii(g);
 
-        const auto y = std::min(std::max(mouse_position_.getY(), chart_bounds_.getY()),
-                                chart_bounds_.getBottom() - 1);
-
-        juce::Point pt(k_centre_x_, y);
+        const auto y = GetCrosshairY();
 
         g.setColour(juce::Colours::aqua);
         g.drawVerticalLine(k_centre_x_, all_chart_bounds_.getY(), all_chart_bounds_.getBottom());
@@ -68,29 +77,70 @@ namespace lei
         const auto font = lei::GetWatchToolMessageFont();
         g.setFont(font);
 
-        const auto font_height = font.getHeight();
         const auto ratio = (min_max_label_.second - min_max_label_.first) / chart_bounds_.getHeight();
         const auto price = min_max_label_.second - ratio * (y - chart_bounds_.getY());
-        g.drawText(juce::String(price),
-                   juce::Rectangle<float>(price_label_bounds_.getX(),
-                                          y - font_height / 2.0,
-                                          price_label_bounds_.getWidth(),
-                                          font_height),
-                   juce::Justification::centredLeft,
-                   false);
+        DrawCachedText(g, juce::String(price), GetPriceLabelBounds(), juce::Justification::centredLeft);
 
+        const auto time_label_string = GetTimeLabelString();
+        if (time_label_string.isNotEmpty())
+        {
+            DrawCachedText(g, time_label_string, GetTimeLabelBounds(time_label_string), juce::Justification::centredTop);
+        }
+    }
+
+    int WatchTool::GetCrosshairY() const
+    {
+        return std::min(std::max(mouse_position_.getY(), chart_bounds_.getY()), chart_bounds_.getBottom() - 1);
+    }
+
+    juce::Rectangle<float> WatchTool::GetPriceLabelBounds() const
+    {
+        const auto font_height = lei::GetWatchToolMessageFont().getHeight();
+        return { static_cast<float>(price_label_bounds_.getX()),
+                 GetCrosshairY() - font_height / 2.0f,
+                 static_cast<float>(price_label_bounds_.getWidth()),
+                 font_height };
+    }
+
+    juce::String WatchTool::GetTimeLabelString() const
+    {
         const auto& date_time_array = std::get<0>(GetKArray_());
-        if (!date_time_array.empty() && k_index_ < date_time_array.size())
+        if (date_time_array.empty() || k_index_ < 0 || k_index_ >= static_cast<int>(date_time_array.size()))
+        {
+            return {};
+        }
+
+        return date_time_array[k_index_].formatted(GetTimeFormat(data_frequency_));
+    }
+
+    juce::Rectangle<float> WatchTool::GetTimeLabelBounds(const juce::String& time_label_string) const
+    {
+        const auto time_label_width = lei::GetCachedStringWidth(lei::GetWatchToolMessageFont(), time_label_string);
+        auto x = std::min(k_centre_x_ - time_label_width / 2, component_->getRight() - time_label_width);
+        x = std::max<float>(x, component_->getX());
+        return { x, static_cast<float>(time_label_bounds_.getY()), time_label_width, static_cast<float>(time_label_bounds_.getHeight()) };
+    }
+
+    juce::RectangleList<int> WatchTool::GetPaintArea() const
+    {
+        juce::RectangleList<int> area;
+        if (k_index_ == -1 || all_chart_bounds_.isEmpty())
+        {
+            return area;
+        }
+
+        const auto y = GetCrosshairY();
+        area.add(k_centre_x_, all_chart_bounds_.getY(), 1, all_chart_bounds_.getHeight());
+        area.add(all_chart_bounds_.getX(), y, all_chart_bounds_.getWidth(), 1);
+        area.add(GetPriceLabelBounds().getSmallestIntegerContainer());
+
+        const auto time_label_string = GetTimeLabelString();
+        if (time_label_string.isNotEmpty())
         {
-            const auto time_label_string = date_time_array[k_index_].formatted(GetTimeFormat(data_frequency_));
-            const auto time_label_width = font.getStringWidthFloat(time_label_string);
-            auto x = std::min(k_centre_x_ - time_label_width / 2, component_->getRight() - time_label_width);
-            x = std::max<float>(x, component_->getX());
-            g.drawText(time_label_string,
-                       juce::Rectangle<float>(x, time_label_bounds_.getY(), time_label_width, time_label_bounds_.getHeight()),
-                       juce::Justification::centredTop,
-                       false);
+            area.add(GetTimeLabelBounds(time_label_string).getSmallestIntegerContainer());
         }
+
+        return area;
     }
 
     void WatchTool::Clear()
@@ -11,7 +11,9 @@ namespace lei
     class WatchTool final
     {
     public:
-        WatchTool(juce::Component* target_component, const std::function<const KArray& ()>& GetKArray);
+        WatchTool(juce::Component* target_component,
+                  const std::function<const KArray& ()>& GetKArray,
+                  const std::function<void(const juce::Rectangle<int>&)>& Repaint);
         ~WatchTool();
 
     public:
@@ -28,9 +30,17 @@ namespace lei
         void Paint(juce::Graphics& g);
         void Clear();
 
+    private:
+        int GetCrosshairY() const;
+        juce::Rectangle<float> GetPriceLabelBounds() const;
+        juce::String GetTimeLabelString() const;
+        juce::Rectangle<float> GetTimeLabelBounds(const juce::String& time_label_string) const;
+        juce::RectangleList<int> GetPaintArea() const;
+
     private:
         juce::Component* component_;
         std::function<const KArray& ()> GetKArray_;
+        std::function<void(const juce::Rectangle<int>&)> Repaint_;
         juce::Rectangle<int> all_chart_bounds_;
         juce::Rectangle<int> chart_bounds_;
         juce::Rectangle<int> price_label_bounds_;
@@ -0,0 +1,100 @@
+// © 2023 Lei Cheng
+
+#include "Workspace.h"
+#include "Layout.h"
+
+Workspace::Workspace()
+{
+    layout_button_.onClick = [this]
+        {
+            const std::array<std::pair<int, int>, 7> grid_sizes = { { { 1, 1 }, { 1, 2 }, { 2, 2 }, { 2, 3 }, { 3, 3 }, { 3, 4 }, { 4, 4 } } };
+
+            juce::PopupMenu menu;
+            for (const auto& [rows, columns] : grid_sizes)
+            {
+                menu.addItem(juce::String(rows) + " x " + juce::String(columns),
+                             FitsGrid(rows, columns),
+                             rows == rows_ && columns == columns_,
+                             [this, rows, columns]() { SetGridSize(rows, columns); });
+            }
+
+            menu.showMenuAsync(juce::PopupMenu::Options().withTargetComponent(layout_button_));
+        };
+
+    layout_button_.setButtonText(juce::translate("layout"));
+    addAndMakeVisible(layout_button_);
+
+    SetGridSize(1, 1);
+    setSize(1850, 900);
+}
+
+Workspace::~Workspace()
+{
+}
+
+void Workspace::paint(juce::Graphics& g)
+{
+    // Only the toolbar and the gaps between views, every view is opaque and paints itself.
+    g.fillAll(getLookAndFeel().findColour(juce::ResizableWindow::backgroundColourId));
+}
+
+void Workspace::resized()
+{
+    auto bounds = getLocalBounds();
+    toolbar_bounds_ = bounds.removeFromTop(lei::kToolbarHeight);
+    layout_button_.setBounds(toolbar_bounds_.withSizeKeepingCentre(lei::kLayoutButtonWidth, lei::kLayoutButtonHeight).withX(toolbar_bounds_.getX() + lei::kToolGap));
+
+    // A window too small for the grid shows the rows and columns that fit, the others are hidden until it grows.
+    const auto rows = std::clamp((bounds.getHeight() + lei::kChartGap) / (lei::kMinViewHeight + lei::kChartGap), 1, rows_);
+    const auto columns = std::clamp((bounds.getWidth() + lei::kChartGap) / (lei::kMinViewWidth + lei::kChartGap), 1, columns_);
+    const auto cell_width = (bounds.getWidth() - lei::kChartGap * (columns - 1)) / columns;
+    const auto cell_height = (bounds.getHeight() - lei::kChartGap * (rows - 1)) / rows;
+    for (std::size_t i = 0; i < views_.size(); ++i)
+    {
+        const auto row = static_cast<int>(i) / columns_;
+        const auto column = static_cast<int>(i) % columns_;
+        auto& view = *views_[i];
+        if (row >= rows || column >= columns)
+        {
+            view.setVisible(false);
+            continue;
+        }
+
+        view.SetCompact(rows * columns > 1);
+        view.setBounds(bounds.getX() + column * (cell_width + lei::kChartGap),
+                       bounds.getY() + row * (cell_height + lei::kChartGap),
+                       cell_width,
+                       cell_height);
+        view.setVisible(true);
+    }
+}
+
+bool Workspace::FitsGrid(int rows, int columns) const
+{
+    const auto bounds = getLocalBounds().withTrimmedTop(lei::kToolbarHeight);
+    return (bounds.getWidth() - lei::kChartGap * (columns - 1)) / columns >= lei::kMinViewWidth
+        && (bounds.getHeight() - lei::kChartGap * (rows - 1)) / rows >= lei::kMinViewHeight;
+}
+
+void Workspace::SetGridSize(int rows, int columns)
+{
+    jassert(rows >= 1 && rows <= lei::kMaxWorkspaceGridSize && columns >= 1 && columns <= lei::kMaxWorkspaceGridSize);
+
+    // New views start on the next stocks with data, so a fresh grid shows different charts.
+    const auto view_size = static_cast<std::size_t>(rows * columns);
+    if (views_.size() < view_size)
+    {
+        const auto stock_ids = lei::GetKDataCenter().GetStockIds(lei::DataFrequency::kDay);
+        while (views_.size() < view_size)
+        {
+            auto view = std::make_unique<MainComponent>(stock_ids.empty() ? "2330.tw" : stock_ids[views_.size() % stock_ids.size()]);
+            view->setOpaque(true);
+            addChildComponent(*view);
+            views_.push_back(std::move(view));
+        }
+    }
+
+    rows_ = rows;
+    columns_ = columns;
+    resized();
+}
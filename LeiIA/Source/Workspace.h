@@ -0,0 +1,35 @@
+// © 2023 Lei Cheng
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "MainComponent.h"
+
+// A grid of independent chart views, each with its own stock, frequency, zoom, indicators and tools. The views share
+// the data center, the task scheduler and the font and text caches, and each one repaints only its own bounds.
+class Workspace : public juce::Component
+{
+public:
+    Workspace();
+    ~Workspace() override;
+
+public:
+    void paint(juce::Graphics& g) override;
+    void resized() override;
+
+private:
+    void SetGridSize(int rows, int columns);
+    bool FitsGrid(int rows, int columns) const;
+
+private:
+    juce::TextButton layout_button_;
+    juce::Rectangle<int> toolbar_bounds_;
+    int rows_ = 1;
+    int columns_ = 1;
+
+    // Views past the current grid stay alive and hidden, so shrinking the grid keeps their stocks, indicators and tools.
+    // Hidden views run no frames and keep no chart layer.
+    std::vector<std::unique_ptr<MainComponent>> views_;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Workspace)
+};